@@ -0,0 +1,65 @@
+#include "harness.hpp"
+#include "corpus.hpp"
+
+#include <cstring>
+
+namespace
+{
+// Runs the program `name` of the corpus until it exits, the items are its retired instructions
+void run( bench::State &state, char const *name ) noexcept
+{
+  for ( auto const &program : corpus::programs() )
+  {
+    if ( std::strcmp( program.name, name ) )
+      continue;
+
+    corpus::Runner runner;
+
+    // Also verifies the checksum before measuring
+    if ( runner.run( program ) )
+    {
+      state.skip( "the program failed or printed a wrong checksum" );
+      return;
+    }
+
+    bool error = false;
+
+    state.set_items( double( runner.instructions() ) );
+    state.measure( [ & ]
+    {
+      error |= runner.run( program );
+    } );
+
+    if ( error )
+      state.skip( "the program failed or printed a wrong checksum" );
+    return;
+  }
+
+  state.skip( "no such program" );
+}
+} // namespace
+
+BENCHMARK( "corpus/integer_mix" )
+{
+  run( state, "integer_mix" );
+}
+
+BENCHMARK( "corpus/fp_matmul" )
+{
+  run( state, "fp_matmul" );
+}
+
+BENCHMARK( "corpus/memcpy_strlen" )
+{
+  run( state, "memcpy_strlen" );
+}
+
+BENCHMARK( "corpus/recursion" )
+{
+  run( state, "recursion" );
+}
+
+BENCHMARK( "corpus/syscall_io" )
+{
+  run( state, "syscall_io" );
+}
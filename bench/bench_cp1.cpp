@@ -0,0 +1,71 @@
+#include "harness.hpp"
+
+#include "../src/cp1.hpp"
+
+using namespace mips32;
+
+namespace
+{
+constexpr std::uint32_t COP1{ 0b010001 << 26 };
+constexpr std::uint32_t FMT_D{ 0x11 << 21 };
+
+constexpr std::uint32_t ADD{ 0x00 };
+constexpr std::uint32_t MUL{ 0x02 };
+constexpr std::uint32_t DIV{ 0x03 };
+constexpr std::uint32_t SQRT{ 0x04 };
+
+// `function`.D $f0, $f2, $f4 executed through `CP1::execute`
+void arithmetic( bench::State &state, std::uint32_t function, FPUBackend backend = FPUBackend::HOST ) noexcept
+{
+  CP1 cp1{ backend };
+  cp1.reset();
+
+  // Values that don't overflow nor underflow whatever the repetitions
+  cp1.mtc1( 2, 0x5555'5555 );
+  cp1.mthc1( 2, 0x3FF5'5555 ); // 1.333...
+  cp1.mtc1( 4, 0x0000'0000 );
+  cp1.mthc1( 4, 0x3FF0'0000 ); // 1.0
+
+  auto const word = COP1 | FMT_D | 4 << 16 | 2 << 11 | 0 << 6 | function;
+
+  cp1.enter();
+
+  state.set_items( 1 );
+  state.measure( [ & ]
+  {
+    bench::do_not_optimize( cp1.execute( word ) );
+  } );
+
+  cp1.leave();
+}
+} // namespace
+
+BENCHMARK( "cp1/add.d" )
+{
+  arithmetic( state, ADD );
+}
+
+BENCHMARK( "cp1/mul.d" )
+{
+  arithmetic( state, MUL );
+}
+
+BENCHMARK( "cp1/div.d" )
+{
+  arithmetic( state, DIV );
+}
+
+BENCHMARK( "cp1/sqrt.d" )
+{
+  arithmetic( state, SQRT );
+}
+
+BENCHMARK( "cp1/add.d/soft" )
+{
+  arithmetic( state, ADD, FPUBackend::SOFT );
+}
+
+BENCHMARK( "cp1/div.d/soft" )
+{
+  arithmetic( state, DIV, FPUBackend::SOFT );
+}
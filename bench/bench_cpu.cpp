@@ -0,0 +1,114 @@
+#include "harness.hpp"
+
+#include <mips32/machine_inspector.hpp>
+#include "../src/cpu.hpp"
+
+#include "test_cpu_instructions.hpp"
+
+#include <iterator>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+constexpr std::uint32_t text_segment{ 0x8000'0000 };
+
+// Iterations of each loop, loaded with AUI $t0, $zero, 1
+constexpr double loop_count{ 0x1'0000 };
+
+// Encodes a branch from the instruction at `from` to the one at `to` (indices of the program)
+constexpr std::uint32_t offset( int from, int to ) noexcept
+{
+  return std::uint32_t( to - from - 1 ) & 0xFFFF;
+}
+
+// Runs `program` from the beginning until it exits, `instructions` are the ones it executes.
+template<std::size_t N>
+void run( bench::State &state, std::uint32_t const ( &program )[N], double instructions ) noexcept
+{
+  RAM ram{ 16_MB };
+  CPU cpu{ ram };
+
+  MachineInspector inspector;
+  inspector.inspect( ram ).inspect( cpu );
+
+  cpu.hard_reset();
+
+  for ( std::uint32_t i = 0; i < N; ++i )
+    ram[text_segment + i * 4] = program[i];
+
+  std::uint32_t result{ CPU::NONE };
+
+  state.set_items( instructions );
+  state.measure( [ & ]
+  {
+    inspector.CPU_pc() = text_segment;
+    result = cpu.start();
+  } );
+
+  if ( result != CPU::EXIT )
+    state.skip( "the program didn't exit" );
+}
+} // namespace
+
+// ALU instructions and one backward branch per iteration
+BENCHMARK( "cpu/start/integer_loop" )
+{
+  constexpr std::uint32_t program[] = {
+    "AUI"_cpu | 8_rt | 0_rs | 1,
+    // loop
+    "ADDU"_cpu | 9_rd | 9_rs | 8_rt,
+    "XOR"_cpu | 10_rd | 10_rs | 9_rt,
+    "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF,
+    "BNE"_cpu | 8_rs | 0_rt | offset( 4, 1 ),
+    // exit
+    "ORI"_cpu | 2_rt | 0_rs | 10,
+    "SYSCALL"_cpu,
+  };
+
+  run( state, program, 4 * loop_count + 3 );
+}
+
+// Two data dependent forward branches per iteration, taken half of the times
+BENCHMARK( "cpu/start/branch_heavy" )
+{
+  constexpr std::uint32_t program[] = {
+    "AUI"_cpu | 8_rt | 0_rs | 1,
+    // loop
+    "ANDI"_cpu | 11_rt | 8_rs | 1,
+    "BEQ"_cpu | 11_rs | 0_rt | offset( 2, 4 ),
+    "ADDIU"_cpu | 9_rt | 9_rs | 1,
+    "ANDI"_cpu | 11_rt | 8_rs | 2,
+    "BNE"_cpu | 11_rs | 0_rt | offset( 5, 7 ),
+    "ADDIU"_cpu | 10_rt | 10_rs | 1,
+    "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF,
+    "BNE"_cpu | 8_rs | 0_rt | offset( 8, 1 ),
+    // exit
+    "ORI"_cpu | 2_rt | 0_rs | 10,
+    "SYSCALL"_cpu,
+  };
+
+  run( state, program, 7 * loop_count + 3 );
+}
+
+// A load and a store per iteration, walking 256KB of data
+BENCHMARK( "cpu/start/load_store" )
+{
+  constexpr std::uint32_t program[] = {
+    "AUI"_cpu | 8_rt | 0_rs | 1,
+    "XOR"_cpu | 4_rd | 4_rs | 4_rt,
+    // loop
+    "LW"_cpu | 9_rt | 4_rs | 0,
+    "ADDU"_cpu | 9_rd | 9_rs | 8_rt,
+    "SW"_cpu | 9_rt | 4_rs | 0,
+    "ADDIU"_cpu | 4_rt | 4_rs | 4,
+    "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF,
+    "BNE"_cpu | 8_rs | 0_rt | offset( 7, 2 ),
+    // exit
+    "ORI"_cpu | 2_rt | 0_rs | 10,
+    "SYSCALL"_cpu,
+  };
+
+  run( state, program, 6 * loop_count + 4 );
+}
@@ -0,0 +1,189 @@
+#include "harness.hpp"
+
+#include "../src/mmu.hpp"
+#include "../src/ram.hpp"
+#include "../src/ram_io.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+// Same segments of the CPU, see `fixed_mapping_segments`
+MMU make_mmu( RAM &ram ) noexcept
+{
+  return MMU{ ram, {
+    { 0x0000'0000, 0x7FFF'FFFF, MMU::Segment::ALL },
+    { 0x8000'0000, 0x3FFF'FFFF, MMU::Segment::KERNEL },
+    { 0xC000'0000, 0x1FFF'FFFF, MMU::Segment::SUPERVISOR | MMU::Segment::KERNEL },
+    { 0xE000'0000, 0x1FFF'FFFF, MMU::Segment::KERNEL },
+  } };
+}
+
+// Hits a resident block, `base` selects the segment that contains it
+void mmu_hit( bench::State &state, std::uint32_t base, std::uint32_t mode ) noexcept
+{
+  RAM  ram{ 1_MB };
+  auto mmu = make_mmu( ram );
+
+  ram[base] = 0;
+
+  std::uint32_t i{ 0 };
+
+  state.set_items( 1 );
+  state.measure( [ & ]
+  {
+    i = ( i + 4 ) & ( RAM::block_size - 4 );
+    bench::do_not_optimize( mmu.access( base + i, mode, MMU::Access::LOAD ) );
+  } );
+}
+
+// The interpreter's pattern: an instruction fetch in kseg0, then a load from useg
+void mmu_fetch_and_load( bench::State &state ) noexcept
+{
+  RAM  ram{ 1_MB };
+  auto mmu = make_mmu( ram );
+
+  ram[0x0000'0000] = 0;
+  ram[0x8000'0000] = 0;
+
+  std::uint32_t i{ 0 };
+
+  state.set_items( 2 );
+  state.measure( [ & ]
+  {
+    i = ( i + 4 ) & ( RAM::block_size - 4 );
+    bench::do_not_optimize( mmu.access( 0x8000'0000 + i, MMU::Segment::KERNEL, MMU::Access::FETCH ) );
+    bench::do_not_optimize( mmu.access( 0x0000'0000 + i, MMU::Segment::KERNEL, MMU::Access::LOAD ) );
+  } );
+}
+
+// Reads words scattered over `blocks` resident blocks
+void ram_resident( bench::State &state, std::uint32_t blocks ) noexcept
+{
+  RAM ram{ blocks * RAM::block_size };
+
+  for ( std::uint32_t b = 0; b < blocks; ++b )
+    ram[b * RAM::block_size] = b;
+
+  // A fixed pseudo random walk, the same on every run
+  std::uint32_t seed{ 1 };
+
+  state.set_items( 1 );
+  state.measure( [ & ]
+  {
+    seed = seed * 1'664'525 + 1'013'904'223;
+    auto const block = ( seed >> 8 ) % blocks;
+    bench::do_not_optimize( ram[block * RAM::block_size + ( seed & ( RAM::block_size - 4 ) )] );
+  } );
+}
+} // namespace
+
+BENCHMARK( "mmu/access/hit_useg" )
+{
+  mmu_hit( state, 0x0000'0000, MMU::Segment::USER );
+}
+
+BENCHMARK( "mmu/access/hit_kseg0" )
+{
+  mmu_hit( state, 0x8000'0000, MMU::Segment::KERNEL );
+}
+
+BENCHMARK( "mmu/access/fetch_and_load" )
+{
+  mmu_fetch_and_load( state );
+}
+
+BENCHMARK( "ram/operator[]/1_block" )
+{
+  ram_resident( state, 1 );
+}
+
+BENCHMARK( "ram/operator[]/64_blocks" )
+{
+  ram_resident( state, 64 );
+}
+
+BENCHMARK( "ram/operator[]/4096_blocks" )
+{
+  ram_resident( state, 4096 );
+}
+
+// Every access changes block, both are resident
+BENCHMARK( "ram/operator[]/2_blocks_alternating" )
+{
+  RAM ram{ 2 * RAM::block_size };
+
+  ram[0x0000'0000] = 0;
+  ram[RAM::block_size] = 1;
+
+  std::uint32_t i{ 0 };
+
+  state.set_items( 1 );
+  state.measure( [ & ]
+  {
+    i += 4;
+    bench::do_not_optimize( ram[( i & 4 ) << 14 | ( i & ( RAM::block_size - 8 ) )] );
+  } );
+}
+
+// Each operation swaps a block out to disk and another one in
+BENCHMARK( "ram/swap" )
+{
+  {
+    RAM ram{ RAM::block_size };
+
+    ram[0x0000'0000] = 0;
+    ram[RAM::block_size] = 1;
+
+    std::uint32_t b{ 0 };
+
+    state.set_bytes( 2 * RAM::block_size );
+    state.measure( [ & ]
+    {
+      b ^= 1;
+      bench::do_not_optimize( ram[b * RAM::block_size] );
+    } );
+  }
+
+  // The swapped block
+  std::remove( "0x00000000.block" );
+  std::remove( "0x00010000.block" );
+}
+
+BENCHMARK( "ram_io/read/1MB" )
+{
+  constexpr std::uint32_t size{ 1_MB };
+
+  RAM   ram{ 2_MB };
+  RAMIO io{ ram };
+
+  std::vector<char> data( size, 'A' );
+  io.write( 0x0000'0000, data.data(), size );
+
+  state.set_bytes( size );
+  state.measure( [ & ]
+  {
+    io.read( 0x0000'0000, size, false, data );
+    bench::do_not_optimize( data.data() );
+  } );
+}
+
+BENCHMARK( "ram_io/write/1MB" )
+{
+  constexpr std::uint32_t size{ 1_MB };
+
+  RAM   ram{ 2_MB };
+  RAMIO io{ ram };
+
+  std::vector<char> const data( size, 'A' );
+
+  state.set_bytes( size );
+  state.measure( [ & ]
+  {
+    io.write( 0x0000'0000, data.data(), size );
+  } );
+}
@@ -0,0 +1,139 @@
+#include "harness.hpp"
+
+#include <mips32/machine_inspector.hpp>
+#include "../src/cpu.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+constexpr char const *state_name{ "bench_state" };
+constexpr char const *state_file{ "bench_state.state" };
+
+// Resident blocks of the saved Machine, 16MB
+constexpr std::uint32_t blocks{ 256 };
+
+struct Machine
+{
+  RAM              ram{ blocks * RAM::block_size };
+  CPU              cpu{ ram };
+  MachineInspector inspector;
+
+  Machine() noexcept
+  {
+    inspector.inspect( ram ).inspect( cpu );
+    cpu.hard_reset();
+
+    // Every word is different, so compressing the blocks is not trivial
+    for ( std::uint32_t b = 0; b < blocks; ++b )
+      for ( std::uint32_t i = 0; i < RAM::block_size; i += 4 )
+        ram[b * RAM::block_size + i] = b * RAM::block_size + i * 2'654'435'761u;
+  }
+};
+} // namespace
+
+BENCHMARK( "state/save" )
+{
+  Machine m;
+
+  bool error = false;
+
+  state.set_bytes( blocks * RAM::block_size );
+  state.measure( [ & ]
+  {
+    error |= m.inspector.save_state( MachineInspector::Component::ALL, state_name );
+  } );
+
+  if ( error )
+    state.skip( "couldn't save the state" );
+
+  std::remove( state_file );
+}
+
+BENCHMARK( "state/restore" )
+{
+  Machine m;
+
+  if ( m.inspector.save_state( MachineInspector::Component::ALL, state_name ) )
+  {
+    state.skip( "couldn't save the state" );
+    return;
+  }
+
+  bool error = false;
+
+  // The restored blocks are mapped copy-on-write, reading all of them is part of the restore
+  std::vector<char> block( RAM::block_size );
+
+  state.set_bytes( blocks * RAM::block_size );
+  state.measure( [ & ]
+  {
+    error |= m.inspector.restore_state( MachineInspector::Component::ALL, state_name );
+
+    for ( std::uint32_t b = 0; b < blocks; ++b )
+      error |= m.inspector.RAM_read_into( b * RAM::block_size, block.data(), RAM::block_size ) != RAM::block_size;
+  } );
+
+  if ( error )
+    state.skip( "couldn't restore the state" );
+
+  std::remove( state_file );
+}
+
+BENCHMARK( "state/save_compressed" )
+{
+  Machine m;
+
+  auto *file = std::tmpfile();
+  if ( !file )
+  {
+    state.skip( "couldn't create a temporary file" );
+    return;
+  }
+
+  bool error = false;
+
+  state.set_bytes( blocks * RAM::block_size );
+  state.measure( [ & ]
+  {
+    std::rewind( file );
+    error |= m.inspector.save_compressed_state( file );
+  } );
+
+  if ( error )
+    state.skip( "couldn't save the state" );
+
+  std::fclose( file );
+}
+
+BENCHMARK( "state/restore_compressed" )
+{
+  Machine m;
+
+  auto *file = std::tmpfile();
+  if ( !file || m.inspector.save_compressed_state( file ) )
+  {
+    state.skip( "couldn't save the state" );
+    if ( file )
+      std::fclose( file );
+    return;
+  }
+
+  bool error = false;
+
+  state.set_bytes( blocks * RAM::block_size );
+  state.measure( [ & ]
+  {
+    std::rewind( file );
+    error |= m.inspector.restore_compressed_state( file );
+  } );
+
+  if ( error )
+    state.skip( "couldn't restore the state" );
+
+  std::fclose( file );
+}
@@ -0,0 +1,396 @@
+#include "json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Performance regression gate
+ *
+ * Runs `Benchmarks` `--runs` times, each run in its own process, and takes the median ns/op of every benchmark.
+ * The medians are compared to the ones of the baseline, the command fails if a gated benchmark is missing
+ * from the runs or regressed: its whole confidence interval is slower than the baseline by more than `--threshold`.
+ *
+ * The confidence interval of the median is distribution free, made of 2 order statistics of the runs.
+ * With less than 6 runs it can't reach 95%, the interval is then [fastest, slowest] run.
+ *
+ * `--update` writes the medians as the new baseline, the baseline holds the numbers of a single machine:
+ * regenerate it on the machine that runs the gate.
+ **/
+namespace
+{
+// Hot paths, a regression of any of them fails the gate. The other benchmarks are only reported.
+char const *const default_gates[] = {
+  "cpu/start/",  // interpreter MIPS
+  "corpus/",     // interpreter MIPS on the guest workloads
+  "mmu/access/", // MMU hit latency
+  "ram/swap",    // swap throughput
+};
+
+constexpr char const *run_file{ "bench-compare.run.json" };
+
+struct Samples
+{
+  std::vector<double> ns_per_op;
+  std::vector<double> items_per_second;
+  std::vector<double> bytes_per_second;
+  std::string         error;
+};
+
+struct Summary
+{
+  double median;
+  double low;
+  double high;
+  double confidence; // of [low, high]
+};
+
+void usage( char const *program ) noexcept
+{
+  std::fprintf( stderr,
+                "Usage: %s [--baseline <file.json>] [--benchmarks <executable>] [--runs <n>] [--threshold <fraction>]\n"
+                "          [--min-time <seconds>] [--filter <substring>] [--gate <prefix>]... [--update]\n"
+                "  --baseline    baseline to compare with, bench/baseline.json by default\n"
+                "  --benchmarks  the Benchmarks executable, the one next to this program by default\n"
+                "  --runs        runs of the whole suite, 5 by default\n"
+                "  --threshold   regression allowed on a gated benchmark, 0.10 (10%%) by default\n"
+                "  --min-time    forwarded to Benchmarks, 0.2 seconds by default\n"
+                "  --filter      forwarded to Benchmarks\n"
+                "  --gate        prefix of the gated benchmarks, replaces the default ones when given\n"
+                "  --update      writes the medians into the baseline instead of comparing\n",
+                program );
+}
+
+// Probability of at most `k` successes over `n` fair trials
+double binomial_cdf( int k, int n ) noexcept
+{
+  double sum = 0.0;
+  double coefficient = 1.0; // n choose i
+
+  for ( int i = 0; i <= k; ++i )
+  {
+    sum += coefficient;
+    coefficient = coefficient * ( n - i ) / ( i + 1 );
+  }
+
+  return sum / std::pow( 2.0, n );
+}
+
+Summary summarize( std::vector<double> values ) noexcept
+{
+  std::sort( values.begin(), values.end() );
+
+  auto const n = int( values.size() );
+  auto const median = n % 2 ? values[n / 2] : ( values[n / 2 - 1] + values[n / 2] ) / 2.0;
+
+  // The widest k such that [x(k), x(n-k+1)] covers the median with 95% confidence, or k = 1
+  int k = 1;
+  while ( k + 1 <= n / 2 && 1.0 - 2.0 * binomial_cdf( k, n ) >= 0.95 )
+    ++k;
+
+  return { median, values[k - 1], values[n - k], 1.0 - 2.0 * binomial_cdf( k - 1, n ) };
+}
+
+double median_of( std::vector<double> const &values ) noexcept
+{
+  return values.empty() ? 0.0 : summarize( values ).median;
+}
+
+// Quotes `s` for the shell
+std::string quote( char const *s )
+{
+#ifdef _WIN32
+  return std::string( "\"" ) + s + "\"";
+#else
+  std::string quoted{ "'" };
+  for ( ; *s; ++s )
+    quoted += *s == '\'' ? std::string( "'\\''" ) : std::string( 1, *s );
+  return quoted + "'";
+#endif
+}
+
+// The Benchmarks executable in the same directory of `program`
+std::string sibling_benchmarks( char const *program )
+{
+  std::string path{ program };
+  auto const separator = path.find_last_of( "/\\" );
+
+  auto const directory = separator == std::string::npos ? std::string( "." ) : path.substr( 0, separator );
+#ifdef _WIN32
+  return directory + "\\Benchmarks.exe";
+#else
+  return directory + "/Benchmarks";
+#endif
+}
+
+// Runs the suite once, appending the results to `samples`. Returns `true` in case of failure.
+bool run_suite( std::string const &command, std::map<std::string, Samples> &samples, std::vector<std::string> &order )
+{
+  std::remove( run_file );
+
+  // Benchmarks fails when one of them fails, its results are still valid
+  std::system( command.c_str() );
+
+  bench::json::Value document;
+  if ( bench::json::parse_file( run_file, document ) )
+    return true;
+
+  std::remove( run_file );
+
+  auto const *benchmarks = document.find( "benchmarks" );
+  if ( !benchmarks || benchmarks->type != bench::json::Value::Type::ARRAY )
+    return true;
+
+  for ( auto const &b : benchmarks->array )
+  {
+    auto const *name = b.find( "name" );
+    if ( !name || name->type != bench::json::Value::Type::STRING )
+      return true;
+
+    if ( !samples.count( name->string ) )
+      order.push_back( name->string );
+
+    auto &s = samples[name->string];
+
+    if ( auto const *error = b.find( "error" ) )
+    {
+      s.error = error->string;
+      continue;
+    }
+
+    auto const number = [ & ]( char const *key )
+    {
+      auto const *value = b.find( key );
+      return value && value->type == bench::json::Value::Type::NUMBER ? value->number : 0.0;
+    };
+
+    s.ns_per_op.push_back( number( "ns_per_op" ) );
+    s.items_per_second.push_back( number( "items_per_second" ) );
+    s.bytes_per_second.push_back( number( "bytes_per_second" ) );
+  }
+
+  return false;
+}
+
+// Writes the medians as a baseline, same layout of the Benchmarks results
+bool write_baseline( char const *name, std::map<std::string, Samples> const &samples, std::vector<std::string> const &order,
+                     int runs, double min_time )
+{
+  auto *out = std::fopen( name, "w" );
+  if ( !out )
+    return true;
+
+  char date[32]{};
+  auto const now = std::time( nullptr );
+  std::strftime( date, sizeof( date ), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) );
+
+  std::fprintf( out, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"runs\": %d,\n    \"min_time\": %g\n  },\n  \"benchmarks\": [",
+                date, runs, min_time );
+
+  bool first = true;
+  for ( auto const &name : order )
+  {
+    auto const &s = samples.at( name );
+    if ( s.ns_per_op.empty() )
+      continue;
+
+    auto const summary = summarize( s.ns_per_op );
+
+    // The names are the ones of the BENCHMARK macros, nothing to escape
+    std::fprintf( out,
+                  "%s\n    {\n      \"name\": \"%s\",\n      \"ns_per_op\": %.3f,\n      \"ci_low\": %.3f,\n      \"ci_high\": %.3f,\n"
+                  "      \"items_per_second\": %.1f,\n      \"bytes_per_second\": %.1f\n    }",
+                  first ? "" : ",", name.c_str(), summary.median, summary.low, summary.high,
+                  median_of( s.items_per_second ), median_of( s.bytes_per_second ) );
+    first = false;
+  }
+
+  std::fprintf( out, "\n  ]\n}\n" );
+
+  return std::fclose( out ) != 0;
+}
+} // namespace
+
+int main( int argc, char **argv )
+{
+  char const              *baseline_name = "bench/baseline.json";
+  std::string              benchmarks = sibling_benchmarks( argv[0] );
+  char const              *filter = nullptr;
+  int                      runs = 5;
+  double                   threshold = 0.10;
+  double                   min_time = 0.2;
+  bool                     update = false;
+  std::vector<std::string> gates;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    auto const has_value = i + 1 < argc;
+
+    if ( !std::strcmp( argv[i], "--baseline" ) && has_value )
+      baseline_name = argv[++i];
+    else if ( !std::strcmp( argv[i], "--benchmarks" ) && has_value )
+      benchmarks = argv[++i];
+    else if ( !std::strcmp( argv[i], "--runs" ) && has_value )
+      runs = std::atoi( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--threshold" ) && has_value )
+      threshold = std::atof( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--min-time" ) && has_value )
+      min_time = std::atof( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--filter" ) && has_value )
+      filter = argv[++i];
+    else if ( !std::strcmp( argv[i], "--gate" ) && has_value )
+      gates.push_back( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--update" ) )
+      update = true;
+    else
+    {
+      usage( argv[0] );
+      return 2;
+    }
+  }
+
+  if ( runs < 1 )
+    runs = 1;
+
+  if ( gates.empty() )
+    gates.assign( std::begin( default_gates ), std::end( default_gates ) );
+
+  bench::json::Value baseline;
+  if ( !update && bench::json::parse_file( baseline_name, baseline ) )
+  {
+    std::fprintf( stderr, "Couldn't read the baseline %s\n", baseline_name );
+    return 2;
+  }
+
+  char min_time_string[32];
+  std::snprintf( min_time_string, sizeof( min_time_string ), "%g", min_time );
+
+  auto command = quote( benchmarks.c_str() ) + " --min-time " + min_time_string + " --out " + run_file;
+  if ( filter )
+    command += std::string( " --filter " ) + quote( filter );
+
+  // Only the report of this program is printed
+#ifdef _WIN32
+  command += " 2>NUL";
+#else
+  command += " 2>/dev/null";
+#endif
+
+  std::map<std::string, Samples> samples;
+  std::vector<std::string>       order;
+
+  for ( int r = 0; r < runs; ++r )
+  {
+    std::fprintf( stderr, "Run %d/%d\n", r + 1, runs );
+
+    if ( run_suite( command, samples, order ) )
+    {
+      std::fprintf( stderr, "Couldn't run %s\n", command.c_str() );
+      return 2;
+    }
+  }
+
+  if ( update )
+  {
+    if ( write_baseline( baseline_name, samples, order, runs, min_time ) )
+    {
+      std::fprintf( stderr, "Couldn't write the baseline %s\n", baseline_name );
+      return 2;
+    }
+
+    std::printf( "Baseline %s updated with the medians of %d runs\n", baseline_name, runs );
+    return 0;
+  }
+
+  // The baseline's medians
+  std::map<std::string, double> expected;
+  if ( auto const *list = baseline.find( "benchmarks" ) )
+  {
+    for ( auto const &b : list->array )
+    {
+      auto const *name = b.find( "name" );
+      auto const *ns = b.find( "ns_per_op" );
+      if ( name && ns && ns->type == bench::json::Value::Type::NUMBER )
+        expected[name->string] = ns->number;
+    }
+  }
+
+  auto const gated = [ & ]( std::string const &name )
+  {
+    return std::any_of( gates.begin(), gates.end(), [ & ]( std::string const &prefix )
+    {
+      return !name.compare( 0, prefix.size(), prefix );
+    } );
+  };
+
+  int regressions = 0;
+  int errors = 0;
+
+  std::printf( "%-32s %14s %14s %31s %9s  %s\n", "benchmark", "baseline ns", "median ns", "confidence interval", "change", "status" );
+
+  for ( auto const &name : order )
+  {
+    auto const &s = samples.at( name );
+    auto const  gate = gated( name );
+
+    if ( !s.error.empty() )
+    {
+      std::printf( "%-32s %s\n", name.c_str(), ( "FAILED: " + s.error ).c_str() );
+      ++errors;
+      continue;
+    }
+
+    auto const summary = summarize( s.ns_per_op );
+
+    char interval[64];
+    std::snprintf( interval, sizeof( interval ), "[%.1f, %.1f] %2.0f%%", summary.low, summary.high, summary.confidence * 100.0 );
+
+    auto const it = expected.find( name );
+    if ( it == expected.end() || it->second <= 0.0 )
+    {
+      std::printf( "%-32s %14s %14.1f %31s %9s  new\n", name.c_str(), "-", summary.median, interval, "-" );
+      continue;
+    }
+
+    auto const base = it->second;
+    auto const change = summary.median / base - 1.0;
+
+    char const *status = "ok";
+    if ( summary.low > base * ( 1.0 + threshold ) )
+    {
+      status = gate ? "REGRESSION" : "slower (not gated)";
+      regressions += gate;
+    }
+    else if ( summary.high < base * ( 1.0 - threshold ) )
+      status = "faster";
+
+    std::printf( "%-32s %14.1f %14.1f %31s %+8.1f%%  %s\n", name.c_str(), base, summary.median, interval, change * 100.0, status );
+  }
+
+  // A gated benchmark that didn't run can't be compared, e.g. it was renamed or the runs crashed before it
+  for ( auto const &e : expected )
+  {
+    if ( samples.count( e.first ) || ( filter && e.first.find( filter ) == std::string::npos ) )
+      continue;
+
+    auto const gate = gated( e.first );
+
+    std::printf( "%-32s %s\n", e.first.c_str(), gate ? "MISSING from the runs" : "missing from the runs (not gated)" );
+    errors += gate;
+  }
+
+  if ( regressions || errors )
+  {
+    std::printf( "\n%d gated benchmark(s) regressed by more than %.0f%%, %d failed or missing\n", regressions, threshold * 100.0, errors );
+    return 1;
+  }
+
+  std::printf( "\nNo regressions beyond %.0f%% over %d runs\n", threshold * 100.0, runs );
+  return 0;
+}
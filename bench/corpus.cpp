@@ -0,0 +1,661 @@
+#include "corpus.hpp"
+
+#include <mips32/executable.hpp>
+#include <mips32/literals.hpp>
+#include <mips32/timing_model.hpp>
+#include "../src/cpu.hpp"
+
+#include "test_cpu_instructions.hpp"
+#include "test_cp1_instructions.hpp"
+
+#include <cstring>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+constexpr std::uint32_t data_segment{ 0x1000'0000 };
+constexpr std::uint32_t text_segment{ 0x0040'0000 };
+
+// Registers
+constexpr std::uint32_t zero{ 0 }, v0{ 2 }, a0{ 4 }, a1{ 5 };
+constexpr std::uint32_t t0{ 8 }, t1{ 9 }, t2{ 10 }, t3{ 11 }, t4{ 12 }, t5{ 13 }, t6{ 14 }, t7{ 15 };
+constexpr std::uint32_t s0{ 16 }, s1{ 17 }, s2{ 18 }, s3{ 19 }, s4{ 20 }, s5{ 21 }, s6{ 22 }, s7{ 23 };
+constexpr std::uint32_t t8{ 24 }, t9{ 25 }, sp{ 29 }, ra{ 31 };
+
+constexpr std::uint32_t FMT_D{ 0x11 << 21 };
+
+// Same fields of `_rs`, `_rt`, `_rd` and `_imm16`, for registers known at run time
+constexpr std::uint32_t rs( std::uint32_t r ) noexcept { return r << 21; }
+constexpr std::uint32_t rt( std::uint32_t r ) noexcept { return r << 16; }
+constexpr std::uint32_t rd( std::uint32_t r ) noexcept { return r << 11; }
+constexpr std::uint32_t imm( std::int32_t i ) noexcept { return std::uint32_t( i ) & 0xFFFF; }
+
+// `op` $d, $s, $t
+constexpr std::uint32_t r_type( std::uint32_t op, std::uint32_t d, std::uint32_t s, std::uint32_t t ) noexcept
+{
+  return op | rd( d ) | rs( s ) | rt( t );
+}
+
+// `op` $t, $s, i - and loads/stores: `op` $t, i($s)
+constexpr std::uint32_t i_type( std::uint32_t op, std::uint32_t t, std::uint32_t s, std::int32_t i ) noexcept
+{
+  return op | rt( t ) | rs( s ) | imm( i );
+}
+
+// `op`.D $fd, $fs, $ft
+constexpr std::uint32_t fp_d( std::uint32_t op, std::uint32_t fd, std::uint32_t fs, std::uint32_t ft ) noexcept
+{
+  return op | FMT_D | fd << 6 | fs << 11 | ft << 16;
+}
+
+/**
+ * Builds an executable with a .data and a .text section.
+ *
+ * Branches can target labels not bound yet, their offsets are patched by `image()`.
+ **/
+class Assembler
+{
+public:
+  using Label = std::size_t;
+
+  Label label() noexcept
+  {
+    labels.push_back( unbound );
+    return labels.size() - 1;
+  }
+
+  void bind( Label l ) noexcept { labels[l] = text.size(); }
+
+  void emit( std::uint32_t word ) noexcept { text.push_back( word ); }
+
+  // BEQ, BNE: 16 bits offset
+  void branch( std::uint32_t word, Label target ) noexcept
+  {
+    fixups.push_back( { text.size(), target, 0xFFFF } );
+    emit( word );
+  }
+
+  // BC, BALC: 26 bits offset
+  void jump( std::uint32_t word, Label target ) noexcept
+  {
+    fixups.push_back( { text.size(), target, 0x03FF'FFFF } );
+    emit( word );
+  }
+
+  // $r = value
+  void li( std::uint32_t r, std::uint32_t value ) noexcept
+  {
+    if ( value >> 16 )
+    {
+      emit( i_type( "AUI"_cpu, r, zero, std::int32_t( value >> 16 ) ) );
+      emit( i_type( "ORI"_cpu, r, r, std::int32_t( value & 0xFFFF ) ) );
+    }
+    else
+      emit( i_type( "ORI"_cpu, r, zero, std::int32_t( value ) ) );
+  }
+
+  // $d = $s
+  void move( std::uint32_t d, std::uint32_t s ) noexcept { emit( r_type( "OR"_cpu, d, s, zero ) ); }
+
+  // Prints $a0 as an integer
+  void print_integer() noexcept
+  {
+    li( v0, 1 );
+    emit( "SYSCALL"_cpu );
+  }
+
+  void exit() noexcept
+  {
+    li( v0, 10 );
+    emit( "SYSCALL"_cpu );
+  }
+
+  // Appends `size` bytes to .data, word aligned, returns their address
+  std::uint32_t data_bytes( void const *bytes, std::size_t size ) noexcept
+  {
+    auto const address = data_segment + std::uint32_t( data.size() );
+
+    data.insert( data.end(), static_cast<char const *>( bytes ), static_cast<char const *>( bytes ) + size );
+    data.resize( ( data.size() + 3 ) & ~std::size_t( 3 ) );
+
+    return address;
+  }
+
+  template<typename T>
+  std::uint32_t data_array( std::vector<T> const &values ) noexcept
+  {
+    return data_bytes( values.data(), values.size() * sizeof( T ) );
+  }
+
+  std::vector<char> image() noexcept
+  {
+    for ( auto const &f : fixups )
+      text[f.index] |= std::uint32_t( labels[f.target] - f.index - 1 ) & f.mask;
+
+    ExecutableHeader header{};
+    std::memcpy( header.magic, ExecutableHeader::magic_string, sizeof( header.magic ) );
+    header.version = ExecutableHeader::current_version;
+    header.data_sz = std::uint32_t( data.size() );
+    header.text_sz = std::uint32_t( text.size() * 4 );
+    header.data_addr = data_segment;
+    header.text_addr = text_segment;
+
+    // Without symbols, .symtab_sz is 0
+    std::vector<char> image( sizeof( header ) + header.data_sz + header.text_sz + sizeof( std::uint32_t ) );
+
+    auto *p = image.data();
+    std::memcpy( p, &header, sizeof( header ) );
+    std::memcpy( p + sizeof( header ), data.data(), data.size() );
+    std::memcpy( p + sizeof( header ) + data.size(), text.data(), text.size() * 4 );
+
+    return image;
+  }
+
+private:
+  static constexpr std::size_t unbound{ ~std::size_t( 0 ) };
+
+  struct Fixup
+  {
+    std::size_t   index;
+    Label         target;
+    std::uint32_t mask;
+  };
+
+  std::vector<char>          data;
+  std::vector<std::uint32_t> text;
+  std::vector<std::size_t>   labels;
+  std::vector<Fixup>         fixups;
+};
+
+std::uint64_t bits_of( double d ) noexcept
+{
+  std::uint64_t i;
+  std::memcpy( &i, &d, sizeof( i ) );
+  return i;
+}
+
+/**
+ * Dhrystone-like integer mix: arithmetic with MUL/DIV/MOD, a record copy,
+ * a switch lowered to a chain of branches and a string compare.
+ **/
+corpus::Program integer_mix() noexcept
+{
+  constexpr std::uint32_t iterations{ 20'000 };
+
+  char const str_1[] = "DHRYSTONE, 1'ST STRING";
+  char const str_2[] = "DHRYSTONE, 1'ST STRINg";
+
+  Assembler as;
+
+  auto const rec_a = as.data_array( std::vector<std::uint32_t>{ 1, 2, 3, 4 } );
+  auto const rec_b = as.data_array( std::vector<std::uint32_t>{ 0, 0, 0, 0 } );
+  auto const str_1_addr = as.data_bytes( str_1, sizeof( str_1 ) );
+  auto const str_2_addr = as.data_bytes( str_2, sizeof( str_2 ) );
+
+  auto const loop = as.label(), case_0 = as.label(), case_1 = as.label(), case_2 = as.label();
+  auto const end_switch = as.label(), compare = as.label(), end_compare = as.label();
+
+  as.li( s0, iterations );
+  as.li( s1, rec_a );
+  as.li( s2, rec_b );
+  as.li( s3, 0 );
+  as.li( s4, 7 );
+
+  as.bind( loop );
+  as.emit( r_type( "ADDU"_cpu, t0, s0, s3 ) );
+  as.emit( r_type( "MUL"_cpu, t1, t0, t0 ) );
+  as.emit( r_type( "MOD"_cpu, t2, t1, s4 ) );
+  as.emit( r_type( "DIV"_cpu, t3, t1, s4 ) );
+  as.emit( r_type( "SLL"_cpu, t4, 0, t2 ) | 2 << 6 );
+  as.emit( r_type( "XOR"_cpu, s3, s3, t4 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t3 ) );
+
+  // *rec_b = *rec_a, with 2 fields changed, then the records are swapped
+  as.emit( i_type( "LW"_cpu, t5, s1, 0 ) );
+  as.emit( i_type( "SW"_cpu, t5, s2, 0 ) );
+  as.emit( i_type( "LW"_cpu, t5, s1, 4 ) );
+  as.emit( r_type( "ADDU"_cpu, t5, t5, t2 ) );
+  as.emit( i_type( "SW"_cpu, t5, s2, 4 ) );
+  as.emit( i_type( "LW"_cpu, t5, s1, 8 ) );
+  as.emit( i_type( "SW"_cpu, t5, s2, 8 ) );
+  as.emit( i_type( "LW"_cpu, t5, s1, 12 ) );
+  as.emit( r_type( "XOR"_cpu, t5, t5, s0 ) );
+  as.emit( i_type( "SW"_cpu, t5, s2, 12 ) );
+  as.move( t6, s1 );
+  as.move( s1, s2 );
+  as.move( s2, t6 );
+
+  // switch ( t2 & 3 )
+  as.emit( i_type( "ANDI"_cpu, t6, t2, 3 ) );
+  as.branch( i_type( "BEQ"_cpu, zero, t6, 0 ), case_0 );
+  as.emit( i_type( "ADDIU"_cpu, t7, t6, -1 ) );
+  as.branch( i_type( "BEQ"_cpu, zero, t7, 0 ), case_1 );
+  as.emit( i_type( "ADDIU"_cpu, t7, t7, -1 ) );
+  as.branch( i_type( "BEQ"_cpu, zero, t7, 0 ), case_2 );
+  as.emit( i_type( "ADDIU"_cpu, s3, s3, 3 ) );
+  as.jump( "BC"_cpu, end_switch );
+  as.bind( case_0 );
+  as.emit( r_type( "SRL"_cpu, t7, 0, s3 ) | 1 << 6 );
+  as.emit( r_type( "XOR"_cpu, s3, s3, t7 ) );
+  as.jump( "BC"_cpu, end_switch );
+  as.bind( case_1 );
+  as.emit( i_type( "ADDIU"_cpu, s3, s3, 1 ) );
+  as.jump( "BC"_cpu, end_switch );
+  as.bind( case_2 );
+  as.emit( r_type( "SLT"_cpu, t7, s3, t1 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t7 ) );
+  as.bind( end_switch );
+
+  // s3 += strcmp( str_1, str_2 )
+  as.li( a0, str_1_addr );
+  as.li( a1, str_2_addr );
+  as.bind( compare );
+  as.emit( i_type( "LBU"_cpu, t0, a0, 0 ) );
+  as.emit( i_type( "LBU"_cpu, t1, a1, 0 ) );
+  as.branch( r_type( "BNE"_cpu, 0, t0, t1 ), end_compare );
+  as.branch( r_type( "BEQ"_cpu, 0, t0, zero ), end_compare );
+  as.emit( i_type( "ADDIU"_cpu, a0, a0, 1 ) );
+  as.emit( i_type( "ADDIU"_cpu, a1, a1, 1 ) );
+  as.jump( "BC"_cpu, compare );
+  as.bind( end_compare );
+  as.emit( r_type( "SUBU"_cpu, t0, t0, t1 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t0 ) );
+
+  as.emit( i_type( "ADDIU"_cpu, s0, s0, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s0, zero ), loop );
+
+  as.emit( i_type( "LW"_cpu, t0, s1, 4 ) );
+  as.emit( r_type( "ADDU"_cpu, a0, s3, t0 ) );
+  as.print_integer();
+  as.exit();
+
+  // The same computation on the host
+  std::uint32_t records[2][4] = { { 1, 2, 3, 4 }, { 0, 0, 0, 0 } };
+  std::uint32_t *a = records[0], *b = records[1];
+  std::uint32_t  acc = 0;
+
+  auto const str_cmp = [ & ]
+  {
+    std::size_t i = 0;
+    while ( str_1[i] == str_2[i] && str_1[i] )
+      ++i;
+    return std::uint32_t( ( unsigned char )str_1[i] ) - std::uint32_t( ( unsigned char )str_2[i] );
+  }();
+
+  for ( std::uint32_t n = iterations; n; --n )
+  {
+    auto const product = ( n + acc ) * ( n + acc );
+    auto const mod = std::uint32_t( std::int32_t( product ) % 7 );
+    auto const div = std::uint32_t( std::int32_t( product ) / 7 );
+
+    acc ^= mod << 2;
+    acc += div;
+
+    b[0] = a[0];
+    b[1] = a[1] + mod;
+    b[2] = a[2];
+    b[3] = a[3] ^ n;
+    std::swap( a, b );
+
+    switch ( mod & 3 )
+    {
+    case 0: acc ^= acc >> 1; break;
+    case 1: acc += 1; break;
+    case 2: acc += std::int32_t( acc ) < std::int32_t( product ); break;
+    default: acc += 3; break;
+    }
+
+    acc += str_cmp;
+  }
+
+  return { "integer_mix", as.image(), acc + a[1] };
+}
+
+/**
+ * C = A * B on 16x16 doubles, repeated, then the sum of C is printed.
+ **/
+corpus::Program fp_matmul() noexcept
+{
+  constexpr std::uint32_t n{ 16 };
+  constexpr std::uint32_t repetitions{ 32 };
+
+  std::vector<double> a( n * n ), b( n * n ), c( n * n, 0.0 );
+  for ( std::uint32_t i = 0; i < n; ++i )
+    for ( std::uint32_t j = 0; j < n; ++j )
+    {
+      a[i * n + j] = double( ( i + j ) % 5 ) + 0.5;
+      b[i * n + j] = double( ( i * j ) % 7 ) * 0.25 - 0.75;
+    }
+
+  Assembler as;
+
+  auto const a_addr = as.data_array( a );
+  auto const b_addr = as.data_array( b );
+  auto const c_addr = as.data_array( c );
+
+  auto const repeat = as.label(), row = as.label(), column = as.label(), inner = as.label(), sum = as.label();
+
+  as.li( s4, a_addr );
+  as.li( s5, b_addr );
+  as.li( s6, c_addr );
+  as.li( t9, n );
+  as.li( s7, repetitions );
+
+  as.bind( repeat );
+  as.move( s0, zero );
+  as.bind( row );
+  as.move( s1, zero );
+  as.bind( column );
+  as.emit( "MTC1"_cpu | rt( zero ) | rd( 0 ) );
+  as.emit( "MTHC1"_cpu | rt( zero ) | rd( 0 ) );
+  as.emit( r_type( "SLL"_cpu, t0, 0, s0 ) | 7 << 6 ); // &A[i][0]
+  as.emit( r_type( "ADDU"_cpu, t0, t0, s4 ) );
+  as.emit( r_type( "SLL"_cpu, t1, 0, s1 ) | 3 << 6 ); // &B[0][j]
+  as.emit( r_type( "ADDU"_cpu, t1, t1, s5 ) );
+  as.move( s2, zero );
+  as.bind( inner );
+  as.emit( i_type( "LDC1"_cpu, 2, t0, 0 ) );
+  as.emit( i_type( "LDC1"_cpu, 4, t1, 0 ) );
+  as.emit( fp_d( "MUL"_cp1, 6, 2, 4 ) );
+  as.emit( fp_d( "ADD"_cp1, 0, 0, 6 ) );
+  as.emit( i_type( "ADDIU"_cpu, t0, t0, 8 ) );
+  as.emit( i_type( "ADDIU"_cpu, t1, t1, n * 8 ) );
+  as.emit( i_type( "ADDIU"_cpu, s2, s2, 1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s2, t9 ), inner );
+  as.emit( r_type( "SLL"_cpu, t2, 0, s0 ) | 7 << 6 ); // &C[i][j]
+  as.emit( r_type( "SLL"_cpu, t3, 0, s1 ) | 3 << 6 );
+  as.emit( r_type( "ADDU"_cpu, t2, t2, t3 ) );
+  as.emit( r_type( "ADDU"_cpu, t2, t2, s6 ) );
+  as.emit( i_type( "SDC1"_cpu, 0, t2, 0 ) );
+  as.emit( i_type( "ADDIU"_cpu, s1, s1, 1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s1, t9 ), column );
+  as.emit( i_type( "ADDIU"_cpu, s0, s0, 1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s0, t9 ), row );
+  as.emit( i_type( "ADDIU"_cpu, s7, s7, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s7, zero ), repeat );
+
+  // $f12 = sum of C
+  as.emit( "MTC1"_cpu | rt( zero ) | rd( 12 ) );
+  as.emit( "MTHC1"_cpu | rt( zero ) | rd( 12 ) );
+  as.move( t0, s6 );
+  as.li( t1, n * n );
+  as.bind( sum );
+  as.emit( i_type( "LDC1"_cpu, 2, t0, 0 ) );
+  as.emit( fp_d( "ADD"_cp1, 12, 12, 2 ) );
+  as.emit( i_type( "ADDIU"_cpu, t0, t0, 8 ) );
+  as.emit( i_type( "ADDIU"_cpu, t1, t1, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, t1, zero ), sum );
+
+  as.li( v0, 3 );
+  as.emit( "SYSCALL"_cpu );
+  as.exit();
+
+  // The same computation on the host, in the same order
+  for ( std::uint32_t i = 0; i < n; ++i )
+    for ( std::uint32_t j = 0; j < n; ++j )
+    {
+      double acc = 0.0;
+      for ( std::uint32_t k = 0; k < n; ++k )
+      {
+        double const product = a[i * n + k] * b[k * n + j];
+        acc = acc + product;
+      }
+      c[i * n + j] = acc;
+    }
+
+  double total = 0.0;
+  for ( auto const v : c )
+    total = total + v;
+
+  return { "fp_matmul", as.image(), bits_of( total ) };
+}
+
+/**
+ * A word copy of 4KB unrolled by 4, a byte copy of 255 unaligned bytes and a strlen of 1023 characters.
+ **/
+corpus::Program memcpy_strlen() noexcept
+{
+  constexpr std::uint32_t repetitions{ 200 };
+  constexpr std::uint32_t words{ 1024 };
+  constexpr std::uint32_t bytes{ 255 };
+  constexpr std::uint32_t length{ 1023 };
+
+  std::vector<std::uint32_t> src( words );
+  for ( std::uint32_t i = 0; i < words; ++i )
+    src[i] = i * 2'654'435'761u;
+
+  std::vector<char> string( length + 1, '\0' );
+  for ( std::uint32_t i = 0; i < length; ++i )
+    string[i] = char( 'a' + i % 26 );
+
+  Assembler as;
+
+  auto const src_addr = as.data_array( src );
+  auto const dst_addr = as.data_array( std::vector<std::uint32_t>( words, 0 ) );
+  auto const str_addr = as.data_array( string );
+
+  auto const repeat = as.label(), copy_words = as.label(), copy_bytes = as.label();
+  auto const scan = as.label(), end_scan = as.label();
+
+  as.li( s4, src_addr );
+  as.li( s5, dst_addr );
+  as.li( s6, str_addr );
+  as.li( s3, 0 );
+  as.li( s7, repetitions );
+
+  as.bind( repeat );
+
+  // memcpy( dst, src, 4KB )
+  as.move( t0, s4 );
+  as.move( t1, s5 );
+  as.li( t2, words / 4 );
+  as.bind( copy_words );
+  as.emit( i_type( "LW"_cpu, t3, t0, 0 ) );
+  as.emit( i_type( "LW"_cpu, t4, t0, 4 ) );
+  as.emit( i_type( "LW"_cpu, t5, t0, 8 ) );
+  as.emit( i_type( "LW"_cpu, t6, t0, 12 ) );
+  as.emit( i_type( "SW"_cpu, t3, t1, 0 ) );
+  as.emit( i_type( "SW"_cpu, t4, t1, 4 ) );
+  as.emit( i_type( "SW"_cpu, t5, t1, 8 ) );
+  as.emit( i_type( "SW"_cpu, t6, t1, 12 ) );
+  as.emit( i_type( "ADDIU"_cpu, t0, t0, 16 ) );
+  as.emit( i_type( "ADDIU"_cpu, t1, t1, 16 ) );
+  as.emit( i_type( "ADDIU"_cpu, t2, t2, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, t2, zero ), copy_words );
+
+  // memcpy( dst + 1, str, 255 )
+  as.move( t0, s6 );
+  as.emit( i_type( "ADDIU"_cpu, t1, s5, 1 ) );
+  as.li( t2, bytes );
+  as.bind( copy_bytes );
+  as.emit( i_type( "LBU"_cpu, t3, t0, 0 ) );
+  as.emit( i_type( "SB"_cpu, t3, t1, 0 ) );
+  as.emit( i_type( "ADDIU"_cpu, t0, t0, 1 ) );
+  as.emit( i_type( "ADDIU"_cpu, t1, t1, 1 ) );
+  as.emit( i_type( "ADDIU"_cpu, t2, t2, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, t2, zero ), copy_bytes );
+
+  // s3 += strlen( str ) + dst[200] + dst_words[1023]
+  as.move( t0, s6 );
+  as.bind( scan );
+  as.emit( i_type( "LBU"_cpu, t3, t0, 0 ) );
+  as.branch( r_type( "BEQ"_cpu, 0, t3, zero ), end_scan );
+  as.emit( i_type( "ADDIU"_cpu, t0, t0, 1 ) );
+  as.jump( "BC"_cpu, scan );
+  as.bind( end_scan );
+  as.emit( r_type( "SUBU"_cpu, t3, t0, s6 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t3 ) );
+  as.emit( i_type( "LBU"_cpu, t3, s5, 200 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t3 ) );
+  as.emit( i_type( "LW"_cpu, t3, s5, ( words - 1 ) * 4 ) );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, t3 ) );
+
+  as.emit( i_type( "ADDIU"_cpu, s7, s7, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s7, zero ), repeat );
+
+  as.move( a0, s3 );
+  as.print_integer();
+  as.exit();
+
+  auto const checksum = repetitions * ( length + std::uint32_t( ( unsigned char )string[199] ) + src[words - 1] );
+
+  return { "memcpy_strlen", as.image(), checksum };
+}
+
+/**
+ * Recursive Fibonacci, every call saves its frame on the stack.
+ **/
+corpus::Program recursion() noexcept
+{
+  constexpr std::uint32_t n{ 24 };
+
+  Assembler as;
+
+  auto const fib = as.label(), recurse = as.label();
+
+  as.li( a0, n );
+  as.jump( "BALC"_cpu, fib );
+  as.move( a0, v0 );
+  as.print_integer();
+  as.exit();
+
+  // v0 = fib( a0 )
+  as.bind( fib );
+  as.emit( i_type( "SLTI"_cpu, t0, a0, 2 ) );
+  as.branch( r_type( "BEQ"_cpu, 0, t0, zero ), recurse );
+  as.move( v0, a0 );
+  as.emit( "JR"_cpu | rs( ra ) );
+  as.bind( recurse );
+  as.emit( i_type( "ADDIU"_cpu, sp, sp, -12 ) );
+  as.emit( i_type( "SW"_cpu, ra, sp, 8 ) );
+  as.emit( i_type( "SW"_cpu, a0, sp, 4 ) );
+  as.emit( i_type( "ADDIU"_cpu, a0, a0, -1 ) );
+  as.jump( "BALC"_cpu, fib );
+  as.emit( i_type( "SW"_cpu, v0, sp, 0 ) );
+  as.emit( i_type( "LW"_cpu, a0, sp, 4 ) );
+  as.emit( i_type( "ADDIU"_cpu, a0, a0, -2 ) );
+  as.jump( "BALC"_cpu, fib );
+  as.emit( i_type( "LW"_cpu, t1, sp, 0 ) );
+  as.emit( r_type( "ADDU"_cpu, v0, v0, t1 ) );
+  as.emit( i_type( "LW"_cpu, ra, sp, 8 ) );
+  as.emit( i_type( "ADDIU"_cpu, sp, sp, 12 ) );
+  as.emit( "JR"_cpu | rs( ra ) );
+
+  std::uint32_t previous = 0, current = 1;
+  for ( std::uint32_t i = 1; i < n; ++i )
+  {
+    auto const next = previous + current;
+    previous = current;
+    current = next;
+  }
+
+  return { "recursion", as.image(), current };
+}
+
+/**
+ * A syscall every few instructions: reads an integer, prints an integer, a string and a character.
+ **/
+corpus::Program syscall_io() noexcept
+{
+  constexpr std::uint32_t iterations{ 20'000 };
+
+  char const message[] = " tick";
+
+  Assembler as;
+
+  auto const message_addr = as.data_bytes( message, sizeof( message ) );
+
+  auto const loop = as.label();
+
+  as.li( s0, iterations );
+  as.li( s3, 0 );
+
+  as.bind( loop );
+  as.li( v0, 5 ); // read int
+  as.emit( "SYSCALL"_cpu );
+  as.emit( r_type( "ADDU"_cpu, s3, s3, v0 ) );
+  as.move( a0, s3 );
+  as.print_integer();
+  as.li( v0, 4 ); // print string
+  as.li( a0, message_addr );
+  as.emit( "SYSCALL"_cpu );
+  as.li( v0, 11 ); // print char
+  as.li( a0, '\n' );
+  as.emit( "SYSCALL"_cpu );
+  as.emit( i_type( "ADDIU"_cpu, s0, s0, -1 ) );
+  as.branch( r_type( "BNE"_cpu, 0, s0, zero ), loop );
+
+  as.move( a0, s3 );
+  as.print_integer();
+  as.exit();
+
+  // read_integer returns 1, 2, 3...
+  return { "syscall_io", as.image(), iterations * ( iterations + 1 ) / 2 };
+}
+} // namespace
+
+namespace corpus
+{
+std::vector<Program> programs() noexcept
+{
+  std::vector<Program> all;
+  all.push_back( integer_mix() );
+  all.push_back( fp_matmul() );
+  all.push_back( memcpy_strlen() );
+  all.push_back( recursion() );
+  all.push_back( syscall_io() );
+  return all;
+}
+
+void Sink::print_integer( std::uint32_t value ) noexcept { last = value; }
+
+void Sink::print_float( float value ) noexcept { last = bits_of( value ); }
+
+void Sink::print_double( double value ) noexcept { last = bits_of( value ); }
+
+void Sink::print_string( char const * ) noexcept {}
+
+void Sink::read_integer( std::uint32_t *value ) noexcept { *value = next_input++; }
+
+void Sink::read_float( float *value ) noexcept { *value = 0.0f; }
+
+void Sink::read_double( double *value ) noexcept { *value = 0.0; }
+
+void Sink::read_string( char *string, std::uint32_t max_count ) noexcept
+{
+  if ( string && max_count )
+    *string = '\0';
+}
+
+void Sink::reset() noexcept
+{
+  last = 0;
+  next_input = 1;
+}
+
+Runner::Runner() noexcept
+  : machine( 64_MB, &sink, nullptr )
+{
+  machine.get_inspector().CPU_set_timing_model( TimingModel{ 1, 1, 1, 1, 1 } );
+}
+
+bool Runner::run( Program const &program ) noexcept
+{
+  sink.reset();
+
+  if ( machine.load( program.image.data() ) )
+    return true;
+
+  if ( machine.start() != CPU::EXIT )
+    return true;
+
+  return sink.last != program.checksum;
+}
+
+std::uint64_t Runner::instructions() noexcept
+{
+  return machine.get_inspector().CPU_cycles();
+}
+} // namespace corpus
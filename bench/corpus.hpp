@@ -0,0 +1,72 @@
+#pragma once
+
+#include <mips32/io_device.hpp>
+#include <mips32/machine.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Guest workloads, generated as executables (see `executable_format.md`).
+ *
+ * Each program prints a checksum as its last output and then exits,
+ * the checksum is computed on the host too, so a run can be verified.
+ **/
+namespace corpus
+{
+struct Program
+{
+  char const       *name;
+  std::vector<char> image;
+  std::uint64_t     checksum; // last integer printed, or the bits of the last double
+};
+
+// Every program of the corpus, built on each call
+std::vector<Program> programs() noexcept;
+
+// Discards the output, but keeps the last value printed.
+// `read_integer` returns 1, 2, 3... to keep the programs deterministic.
+class Sink : public mips32::IODevice
+{
+public:
+  using mips32::IODevice::print_string;
+  using mips32::IODevice::read_string;
+
+  void print_integer( std::uint32_t value ) noexcept override;
+  void print_float( float value ) noexcept override;
+  void print_double( double value ) noexcept override;
+  void print_string( char const *string ) noexcept override;
+  void read_integer( std::uint32_t *value ) noexcept override;
+  void read_float( float *value ) noexcept override;
+  void read_double( double *value ) noexcept override;
+  void read_string( char *string, std::uint32_t max_count ) noexcept override;
+
+  void reset() noexcept;
+
+  std::uint64_t last{ 0 };
+  std::uint32_t next_input{ 1 };
+};
+
+/**
+ * Runs the programs of the corpus on a Machine,
+ * each instruction costs 1 cycle, so the cycles are the retired instructions.
+ **/
+class Runner
+{
+public:
+  Runner() noexcept;
+
+  // Loads `program` and runs it until it exits.
+  // Returns:
+  // `true`  - in case of *failure*, the image is not valid, the program didn't exit or printed a wrong checksum
+  // `false` - in case of success
+  bool run( Program const &program ) noexcept;
+
+  // Instructions retired by the last run
+  std::uint64_t instructions() noexcept;
+
+private:
+  Sink            sink;
+  mips32::Machine machine;
+};
+} // namespace corpus
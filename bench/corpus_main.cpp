@@ -0,0 +1,105 @@
+#include "corpus.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+void usage( char const *program ) noexcept
+{
+  std::fprintf( stderr,
+                "Usage: %s [--filter <substring>] [--repeat <n>] [--out <directory>]\n"
+                "  --filter  runs only the programs whose name contains <substring>\n"
+                "  --repeat  runs each program <n> times and reports the fastest run, 3 by default\n"
+                "  --out     writes each executable into <directory>/<name>.fama\n",
+                program );
+}
+
+// Returns `true` in case of failure
+bool write_image( std::string const &directory, corpus::Program const &program ) noexcept
+{
+  auto const name = directory + '/' + program.name + ".fama";
+
+  auto *file = std::fopen( name.c_str(), "wb" );
+  if ( !file )
+    return true;
+
+  auto const written = std::fwrite( program.image.data(), 1, program.image.size(), file );
+  return ( std::fclose( file ) != 0 ) | ( written != program.image.size() );
+}
+} // namespace
+
+int main( int argc, char **argv )
+{
+  char const *filter = nullptr;
+  char const *out = nullptr;
+  int         repeat = 3;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    auto const has_value = i + 1 < argc;
+
+    if ( !std::strcmp( argv[i], "--filter" ) && has_value )
+      filter = argv[++i];
+    else if ( !std::strcmp( argv[i], "--repeat" ) && has_value )
+      repeat = std::atoi( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--out" ) && has_value )
+      out = argv[++i];
+    else
+    {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  if ( repeat < 1 )
+    repeat = 1;
+
+  bool failed = false;
+
+  std::printf( "%-16s %14s %12s %10s\n", "program", "instructions", "wall (ms)", "MIPS" );
+
+  for ( auto const &program : corpus::programs() )
+  {
+    if ( filter && !std::strstr( program.name, filter ) )
+      continue;
+
+    if ( out && write_image( out, program ) )
+    {
+      std::fprintf( stderr, "Couldn't write %s/%s.fama\n", out, program.name );
+      failed = true;
+    }
+
+    corpus::Runner runner;
+
+    double best = 0.0;
+    bool   error = false;
+
+    for ( int r = 0; r < repeat && !error; ++r )
+    {
+      auto const begin = std::chrono::steady_clock::now();
+      error = runner.run( program );
+      auto const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+
+      if ( !r || seconds < best )
+        best = seconds;
+    }
+
+    if ( error )
+    {
+      std::printf( "%-16s failed or printed a wrong checksum\n", program.name );
+      failed = true;
+      continue;
+    }
+
+    auto const instructions = runner.instructions();
+
+    std::printf( "%-16s %14llu %12.3f %10.1f\n", program.name, ( unsigned long long )instructions, best * 1e3,
+                 double( instructions ) / best / 1e6 );
+  }
+
+  return failed;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal benchmark harness
+ *
+ * A benchmark is a function registered with BENCHMARK( name ).
+ * It prepares what it needs, then calls `State::measure` with the operation to time.
+ * The operation is repeated, doubling the repetitions, until it runs for at least `--min-time` seconds,
+ * the result is the average time of one operation.
+ *
+ * `State::set_items` and `State::set_bytes` declare how much work one operation does,
+ * so the throughput (e.g. instructions or bytes per second) is reported too.
+ *
+ * The results are printed as JSON on stdout or into the file given with `--out`,
+ * a human readable summary goes to stderr.
+ **/
+namespace bench
+{
+
+class State
+{
+public:
+  explicit State( double min_time ) noexcept : min_time( min_time ) {}
+
+  // Times `operation()`, see above.
+  template<typename Operation>
+  void measure( Operation operation ) noexcept
+  {
+    using clock = std::chrono::steady_clock;
+
+    operation(); // warm up: caches, page faults, lazily allocated blocks
+
+    for ( std::uint64_t n = 1;; n *= 2 )
+    {
+      auto const begin = clock::now();
+
+      for ( std::uint64_t i = 0; i < n; ++i )
+        operation();
+
+      auto const elapsed = std::chrono::duration<double>( clock::now() - begin ).count();
+
+      if ( elapsed >= min_time || n >= max_iterations )
+      {
+        iterations = n;
+        seconds = elapsed;
+        return;
+      }
+    }
+  }
+
+  // Work done by one operation, used to compute the throughput
+  void set_items( double items ) noexcept { items_per_op = items; }
+  void set_bytes( double bytes ) noexcept { bytes_per_op = bytes; }
+
+  // Set when the benchmark can't run, e.g. a file can't be created
+  void skip( char const *reason ) noexcept { error = reason; }
+
+  static inline constexpr std::uint64_t max_iterations{ std::uint64_t( 1 ) << 40 };
+
+  double        min_time;
+  std::uint64_t iterations{ 0 };
+  double        seconds{ 0 };
+  double        items_per_op{ 0 };
+  double        bytes_per_op{ 0 };
+  std::string   error;
+};
+
+using Function = void ( * )( State & );
+
+struct Benchmark
+{
+  char const *name;
+  Function    function;
+};
+
+std::vector<Benchmark> &registry() noexcept;
+
+struct Register
+{
+  Register( char const *name, Function function ) noexcept { registry().push_back( { name, function } ); }
+};
+
+// Prevents the compiler from discarding the computation of `value`.
+template<typename T>
+inline void do_not_optimize( T const &value ) noexcept
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+  asm volatile( "" : : "r,m"( value ) : "memory" );
+#else
+  static volatile char sink;
+  sink = *reinterpret_cast<char const volatile *>( &value );
+#endif
+}
+
+} // namespace bench
+
+#define BENCHMARK_CONCAT_( a, b ) a##b
+#define BENCHMARK_CONCAT( a, b ) BENCHMARK_CONCAT_( a, b )
+
+// Defines and registers a benchmark, `name` is the one reported in the results.
+#define BENCHMARK( name )                                                                   \
+  static void BENCHMARK_CONCAT( benchmark_, __LINE__ )( bench::State & );                   \
+  static bench::Register BENCHMARK_CONCAT( register_, __LINE__ ){ name, BENCHMARK_CONCAT( benchmark_, __LINE__ ) }; \
+  static void BENCHMARK_CONCAT( benchmark_, __LINE__ )( bench::State & state )
@@ -0,0 +1,230 @@
+#include "json.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace bench::json
+{
+namespace
+{
+class Parser
+{
+public:
+  explicit Parser( std::string const &text ) noexcept : p( text.c_str() ), end( text.c_str() + text.size() ) {}
+
+  bool document( Value &value ) noexcept
+  {
+    if ( parse_value( value ) )
+      return true;
+
+    skip_spaces();
+    return p != end;
+  }
+
+private:
+  void skip_spaces() noexcept
+  {
+    while ( p != end && ( *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' ) )
+      ++p;
+  }
+
+  bool literal( char const *word ) noexcept
+  {
+    auto const length = std::strlen( word );
+    if ( std::size_t( end - p ) < length || std::strncmp( p, word, length ) )
+      return true;
+
+    p += length;
+    return false;
+  }
+
+  bool parse_value( Value &value ) noexcept
+  {
+    skip_spaces();
+    if ( p == end )
+      return true;
+
+    switch ( *p )
+    {
+    case '{': return parse_object( value );
+    case '[': return parse_array( value );
+    case '"': value.type = Value::Type::STRING; return parse_string( value.string );
+    case 't': value.type = Value::Type::BOOLEAN; value.boolean = true; return literal( "true" );
+    case 'f': value.type = Value::Type::BOOLEAN; value.boolean = false; return literal( "false" );
+    case 'n': value.type = Value::Type::NUL; return literal( "null" );
+    default: return parse_number( value );
+    }
+  }
+
+  bool parse_number( Value &value ) noexcept
+  {
+    // The text is null terminated, strtod stops at the first character that isn't part of the number
+    char *after = nullptr;
+    value.number = std::strtod( p, &after );
+
+    if ( after == p || after > end )
+      return true;
+
+    value.type = Value::Type::NUMBER;
+    p = after;
+    return false;
+  }
+
+  bool parse_string( std::string &string ) noexcept
+  {
+    ++p; // "
+
+    for ( ; p != end && *p != '"'; ++p )
+    {
+      if ( *p != '\\' )
+      {
+        string.push_back( *p );
+        continue;
+      }
+
+      if ( ++p == end )
+        return true;
+
+      switch ( *p )
+      {
+      case '"':
+      case '\\':
+      case '/': string.push_back( *p ); break;
+      case 'n': string.push_back( '\n' ); break;
+      case 't': string.push_back( '\t' ); break;
+      case 'u':
+      {
+        if ( end - p < 5 )
+          return true;
+
+        char digits[5]{ p[1], p[2], p[3], p[4], '\0' };
+        auto const code = std::strtoul( digits, nullptr, 16 );
+        if ( code > 0x7F )
+          return true;
+
+        string.push_back( char( code ) );
+        p += 4;
+        break;
+      }
+      default: return true;
+      }
+    }
+
+    if ( p == end )
+      return true;
+
+    ++p; // "
+    return false;
+  }
+
+  bool parse_array( Value &value ) noexcept
+  {
+    value.type = Value::Type::ARRAY;
+    ++p; // [
+
+    skip_spaces();
+    if ( p != end && *p == ']' )
+    {
+      ++p;
+      return false;
+    }
+
+    for ( ;; )
+    {
+      value.array.emplace_back();
+      if ( parse_value( value.array.back() ) )
+        return true;
+
+      skip_spaces();
+      if ( p == end )
+        return true;
+
+      if ( *p++ == ']' )
+        return false;
+
+      if ( p[-1] != ',' )
+        return true;
+    }
+  }
+
+  bool parse_object( Value &value ) noexcept
+  {
+    value.type = Value::Type::OBJECT;
+    ++p; // {
+
+    skip_spaces();
+    if ( p != end && *p == '}' )
+    {
+      ++p;
+      return false;
+    }
+
+    for ( ;; )
+    {
+      skip_spaces();
+      if ( p == end || *p != '"' )
+        return true;
+
+      value.object.emplace_back();
+      auto &member = value.object.back();
+
+      if ( parse_string( member.first ) )
+        return true;
+
+      skip_spaces();
+      if ( p == end || *p++ != ':' )
+        return true;
+
+      if ( parse_value( member.second ) )
+        return true;
+
+      skip_spaces();
+      if ( p == end )
+        return true;
+
+      if ( *p++ == '}' )
+        return false;
+
+      if ( p[-1] != ',' )
+        return true;
+    }
+  }
+
+  char const *p;
+  char const *end;
+};
+} // namespace
+
+Value const *Value::find( char const *key ) const noexcept
+{
+  for ( auto const &member : object )
+    if ( member.first == key )
+      return &member.second;
+
+  return nullptr;
+}
+
+bool parse( std::string const &text, Value &value ) noexcept
+{
+  value = Value{};
+  return Parser( text ).document( value );
+}
+
+bool parse_file( char const *name, Value &value ) noexcept
+{
+  auto *file = std::fopen( name, "rb" );
+  if ( !file )
+    return true;
+
+  std::string text;
+  char        buffer[4096];
+
+  for ( std::size_t read; ( read = std::fread( buffer, 1, sizeof( buffer ), file ) ) > 0; )
+    text.append( buffer, read );
+
+  std::fclose( file );
+
+  return parse( text, value );
+}
+} // namespace bench::json
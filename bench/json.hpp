@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Minimal JSON reader for the results of the benchmarks
+ *
+ * Supports objects, arrays, strings, numbers, booleans and null.
+ * String escapes other than \" \\ \/ \n \t and \uXXXX (ASCII only) are rejected.
+ **/
+namespace bench::json
+{
+struct Value
+{
+  enum class Type
+  {
+    NUL,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT,
+  };
+
+  Type                                       type{ Type::NUL };
+  bool                                       boolean{ false };
+  double                                     number{ 0.0 };
+  std::string                                string;
+  std::vector<Value>                         array;
+  std::vector<std::pair<std::string, Value>> object;
+
+  // Returns the member `key` of an object, `nullptr` if there's none
+  Value const *find( char const *key ) const noexcept;
+};
+
+// Returns:
+// `true`  - in case of *failure*, `text` is not valid JSON
+// `false` - in case of success, `value` holds the document
+bool parse( std::string const &text, Value &value ) noexcept;
+
+// Same as above, the document is read from the file `name`
+bool parse_file( char const *name, Value &value ) noexcept;
+} // namespace bench::json
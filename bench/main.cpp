@@ -0,0 +1,162 @@
+#include "harness.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace bench
+{
+std::vector<Benchmark> &registry() noexcept
+{
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+} // namespace bench
+
+namespace
+{
+void usage( char const *program ) noexcept
+{
+  std::fprintf( stderr,
+                "Usage: %s [--filter <substring>] [--min-time <seconds>] [--out <file.json>] [--list]\n"
+                "  --filter    runs only the benchmarks whose name contains <substring>\n"
+                "  --min-time  minimum time of each measurement, 0.5 seconds by default\n"
+                "  --out       writes the JSON results into <file.json> instead of stdout\n"
+                "  --list      prints the name of every benchmark\n",
+                program );
+}
+
+// Escapes `s` as the content of a JSON string
+void write_string( std::FILE *out, char const *s ) noexcept
+{
+  std::fputc( '"', out );
+
+  for ( ; *s; ++s )
+  {
+    if ( *s == '"' || *s == '\\' )
+      std::fprintf( out, "\\%c", *s );
+    else if ( ( unsigned char )*s < 0x20 )
+      std::fprintf( out, "\\u%04X", ( unsigned )( unsigned char )*s );
+    else
+      std::fputc( *s, out );
+  }
+
+  std::fputc( '"', out );
+}
+
+char const *compiler() noexcept
+{
+#if defined( __clang__ )
+  return "clang " __clang_version__;
+#elif defined( __GNUC__ )
+  return "gcc " __VERSION__;
+#elif defined( _MSC_VER )
+  return "msvc";
+#else
+  return "unknown";
+#endif
+}
+} // namespace
+
+int main( int argc, char **argv )
+{
+  char const *filter = nullptr;
+  char const *out_name = nullptr;
+  double      min_time = 0.5;
+  bool        list = false;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    auto const has_value = i + 1 < argc;
+
+    if ( !std::strcmp( argv[i], "--filter" ) && has_value )
+      filter = argv[++i];
+    else if ( !std::strcmp( argv[i], "--min-time" ) && has_value )
+      min_time = std::atof( argv[++i] );
+    else if ( !std::strcmp( argv[i], "--out" ) && has_value )
+      out_name = argv[++i];
+    else if ( !std::strcmp( argv[i], "--list" ) )
+      list = true;
+    else
+    {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  if ( list )
+  {
+    for ( auto const &b : bench::registry() )
+      std::printf( "%s\n", b.name );
+    return 0;
+  }
+
+  auto *out = out_name ? std::fopen( out_name, "w" ) : stdout;
+  if ( !out )
+  {
+    std::fprintf( stderr, "Couldn't open %s\n", out_name );
+    return 1;
+  }
+
+  char date[32]{};
+  auto const now = std::time( nullptr );
+  std::strftime( date, sizeof( date ), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) );
+
+  std::fprintf( out, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"compiler\": ", date );
+  write_string( out, compiler() );
+  std::fprintf( out, ",\n    \"build_type\": " );
+  write_string( out, MIPS32_BUILD_TYPE );
+  std::fprintf( out, ",\n    \"min_time\": %g\n  },\n  \"benchmarks\": [", min_time );
+
+  bool first = true;
+  bool failed = false;
+
+  for ( auto const &b : bench::registry() )
+  {
+    if ( filter && !std::strstr( b.name, filter ) )
+      continue;
+
+    bench::State state{ min_time };
+    b.function( state );
+
+    std::fprintf( out, "%s\n    {\n      \"name\": ", first ? "" : "," );
+    write_string( out, b.name );
+    first = false;
+
+    if ( !state.error.empty() || !state.iterations )
+    {
+      auto const reason = state.error.empty() ? "nothing measured" : state.error.c_str();
+
+      std::fprintf( out, ",\n      \"error\": " );
+      write_string( out, reason );
+      std::fprintf( out, "\n    }" );
+      std::fprintf( stderr, "%-40s %s\n", b.name, reason );
+
+      failed = true;
+      continue;
+    }
+
+    auto const ns_per_op = state.seconds * 1e9 / double( state.iterations );
+    auto const items_per_second = state.items_per_op * double( state.iterations ) / state.seconds;
+    auto const bytes_per_second = state.bytes_per_op * double( state.iterations ) / state.seconds;
+
+    std::fprintf( out,
+                  ",\n      \"iterations\": %llu,\n      \"ns_per_op\": %.3f,\n      \"items_per_second\": %.1f,\n      \"bytes_per_second\": %.1f\n    }",
+                  ( unsigned long long )state.iterations, ns_per_op, items_per_second, bytes_per_second );
+
+    std::fprintf( stderr, "%-40s %14.1f ns/op", b.name, ns_per_op );
+    if ( state.items_per_op )
+      std::fprintf( stderr, " %12.2f M items/s", items_per_second / 1e6 );
+    if ( state.bytes_per_op )
+      std::fprintf( stderr, " %12.2f MB/s", bytes_per_second / 1e6 );
+    std::fprintf( stderr, "\n" );
+  }
+
+  std::fprintf( out, "\n  ]\n}\n" );
+
+  if ( out != stdout )
+    std::fclose( out );
+
+  return failed;
+}
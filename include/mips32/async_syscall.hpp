@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * An I/O syscall that completes asynchronously.
+ *
+ * When a `FileHandler` or an `IODevice` accepts an asynchronous request,
+ * the CPU stops with the exit code `WAITING_IO` and the syscall stays pending.
+ * The handler performs the I/O whenever it wants, writing directly into the
+ * regions it received, then calls `complete`.
+ *
+ * Starting the CPU while the syscall is still pending returns `WAITING_IO` immediately,
+ * once it has been completed the CPU stores the result and continues
+ * from the instruction that follows the syscall.
+ *
+ * A reset drops the pending syscall: the CPU doesn't wait for it and discards its result,
+ * but its regions stay valid until `complete` is called. Meanwhile the next I/O syscalls are synchronous,
+ * and the Machine can't be loaded nor restored.
+ *
+ * #!#!#!
+ * [WARNING] The regions of the request are valid until `complete` is called.
+ * [WARNING] `complete` must be called exactly once per request.
+ * !#!#!#
+ **/
+class AsyncSyscall
+{
+  friend class CPU;
+
+public:
+  using Notify = void ( * )( void *user_data );
+
+  // Completes the syscall, `result` has the same meaning as the value returned by the synchronous version.
+  // Can be called from any thread.
+  void complete( std::uint32_t result ) noexcept
+  {
+    this->result = result;
+    done.store( true, std::memory_order_release );
+
+    if ( notify )
+      notify( user_data );
+  }
+
+  bool completed() const noexcept
+  {
+    return done.load( std::memory_order_acquire );
+  }
+
+  // `notify` will be called by `complete`, on the completing thread,
+  // e.g. to let a scheduler resume the machine that was waiting.
+  void on_complete( Notify notify, void *user_data ) noexcept
+  {
+    this->notify = notify;
+    this->user_data = user_data;
+  }
+
+private:
+  std::atomic<bool> done{ false };
+  std::uint32_t     result{ 0 };
+
+  Notify notify{ nullptr };
+  void * user_data{ nullptr };
+
+  // CPU's bookkeeping
+  bool          pending{ false };
+  bool          dropped{ false }; // by a reset, the result is discarded
+  bool          writes_v0{ false };
+  std::uint32_t address{ 0 };
+  std::uint32_t count{ 0 };
+};
+} // namespace mips32
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <mips32/export.hpp>
+#include <mips32/io_device.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * IODevice adapter that buffers the output of another IODevice.
+ *
+ * Every `print_*` is stored into a buffer instead of reaching the wrapped device,
+ * the buffered output is delivered, in order, when:
+ * - the buffer holds at least half of its capacity, by a background thread,
+ * - the buffer is full, by the caller,
+ * - every `flush_interval`, by a background thread,
+ * - `flush()` is called, e.g. by the CPU on `exit` and `break`,
+ * - any `read_*` is called, so prompts are shown before reading,
+ * - the adapter is destroyed.
+ *
+ * Consecutive strings are joined and delivered with a single `print_string`.
+ * The wrapped device is never accessed by more than one thread at a time.
+ **/
+class MIPS32_EXPORT BufferedIODevice : public IODevice
+{
+public:
+  // `device` must outlive the adapter.
+  // A `flush_interval` of zero disables the background thread,
+  // the output is then delivered only by the caller.
+  explicit BufferedIODevice( IODevice *                device,
+                             std::uint32_t             capacity = 64 * 1024,
+                             std::chrono::milliseconds flush_interval = std::chrono::milliseconds( 10 ) ) noexcept;
+
+  // Non copyable, non movable: the background thread refers to the adapter
+  BufferedIODevice( BufferedIODevice const & ) = delete;
+  BufferedIODevice &operator=( BufferedIODevice const & ) = delete;
+
+  ~BufferedIODevice() override;
+
+  void print_integer( std::uint32_t value ) noexcept override;
+  void print_float( float value ) noexcept override;
+  void print_double( double value ) noexcept override;
+  void print_string( char const *string ) noexcept override;
+  void print_string( IOVec const *regions, std::uint32_t count ) noexcept override;
+
+  void read_integer( std::uint32_t *value ) noexcept override;
+  void read_float( float *value ) noexcept override;
+  void read_double( double *value ) noexcept override;
+  void read_string( char *string, std::uint32_t max_count ) noexcept override;
+  void read_string( IOVec const *regions, std::uint32_t count ) noexcept override;
+  bool read_string_async( IOVec const *regions, std::uint32_t count, AsyncSyscall *syscall ) noexcept override;
+
+  // Delivers all the buffered output to the wrapped device.
+  void flush() noexcept override;
+
+private:
+  enum Record : char
+  {
+    INTEGER,
+    FLOAT,
+    DOUBLE,
+    STRING, // followed by the length (std::uint32_t) and the characters
+  };
+
+  void append( Record record, void const *data, std::size_t size ) noexcept;
+  void append_string( IOVec const *regions, std::uint32_t count ) noexcept;
+
+  // Called with `buffer_mutex` locked, after some output has been buffered.
+  void buffered( std::unique_lock<std::mutex> &lock ) noexcept;
+
+  void deliver( std::vector<char> const &records ) noexcept;
+
+  void background_flush() noexcept;
+
+  IODevice *                      device;
+  std::uint32_t                   capacity;
+  std::chrono::milliseconds const flush_interval;
+
+  std::mutex        buffer_mutex;
+  std::vector<char> buffer;  // records not delivered yet
+  bool              quit{ false };
+
+  std::mutex        flush_mutex; // serializes the access to `device`
+  std::vector<char> delivering;  // records being delivered, swapped with `buffer`
+  std::string       text;        // joined strings
+
+  std::condition_variable wake;
+  std::thread             flusher;
+};
+} // namespace mips32
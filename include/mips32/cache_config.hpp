@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * Geometry of a simulated cache, sizes are in bytes.
+ * Every value must be a power of 2.
+ *
+ * `size` must hold at least one set: `line_size * associativity`.
+ * `associativity` can't exceed 32 ways.
+ **/
+struct CacheConfig
+{
+  std::uint32_t size;
+  std::uint32_t line_size;
+  std::uint32_t associativity;
+};
+
+struct CacheStats
+{
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::uint64_t writebacks; // dirty lines evicted
+};
+} // namespace mips32
@@ -15,11 +15,19 @@ public:
 
   std::uint32_t read( std::uint32_t reg, std::uint32_t sel ) noexcept;
 
+  // Cause TI, the timer interrupt is pending
+  static inline constexpr std::uint32_t timer_interrupt{ 0x4000'0000 };
+
+  // Cause IP bit raised by the timer, IntCtl IPTI tells which one
+  std::uint32_t timer_ip() const noexcept { return 1u << ( 8 + ( int_ctl >> 29 ) ); }
+
   std::uint32_t
     user_local,
     hwr_ena,
     bad_vaddr,
     bad_instr,
+    count, // updated lazily by the CPU, see CPU::sync_count
+    compare,
     status,
     int_ctl,
     srs_ctl,
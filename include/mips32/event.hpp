@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * A callback scheduled to run after a number of cycles, see `Machine::schedule`.
+ *
+ * It's called by the thread running the CPU, between two instructions,
+ * so it can schedule other events or raise interrupts.
+ *
+ * #!#!#!
+ * [WARNING] It must not start, single step or reset the Machine.
+ * !#!#!#
+ **/
+using EventCallback = void ( * )( void *user_data );
+
+// Identifies a scheduled event, never 0
+using EventId = std::uint64_t;
+} // namespace mips32
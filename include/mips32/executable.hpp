@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * Header of an executable, read `executable_format.md` on the repository.
+ * The sections follow it in order: .data, .text, .kdata and .ktext.
+ * Since version 2 they're followed by the size of the symbol table and the symbol table.
+ **/
+struct ExecutableHeader
+{
+  static constexpr char          magic_string[4]{ 'f', 'a', 'm', 'a' };
+  static constexpr std::uint32_t current_version{ 2 };
+
+  char          magic[4];
+  std::uint32_t version;
+  std::uint32_t data_sz;
+  std::uint32_t text_sz;
+  std::uint32_t kdata_sz;
+  std::uint32_t ktext_sz;
+  std::uint32_t data_addr;
+  std::uint32_t text_addr;
+  std::uint32_t kdata_addr;
+  std::uint32_t ktext_addr;
+};
+
+static_assert( sizeof( ExecutableHeader ) == 40, "The header's layout is the one of `executable_format.md`" );
+} // namespace mips32
@@ -0,0 +1,7 @@
+#pragma once
+
+#ifdef _MSC_VER
+#  define MIPS32_EXPORT __declspec(dllexport)
+#else
+#  define MIPS32_EXPORT
+#endif
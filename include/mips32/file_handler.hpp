@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mips32/async_syscall.hpp>
+#include <mips32/io_vec.hpp>
+
 #include <cstdint>
 
 namespace mips32
@@ -47,6 +50,93 @@ public:
   // !#!#!#
   virtual std::uint32_t write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept = 0;
 
+  // Scatter-gather version of `read`, used when the destination lies in RAM blocks resident in memory.
+  // Fills the `count` regions in order, they point directly inside the guest's memory.
+  //
+  // Returns the number of bytes written to the regions, negative if error
+  //
+  // The default implementation calls `read` for each region, until one isn't filled completely.
+  virtual std::uint32_t readv( std::uint32_t fd, IOVec const *regions, std::uint32_t count ) noexcept
+  {
+    std::uint32_t total = 0;
+
+    for ( std::uint32_t i = 0; i < count; ++i )
+    {
+      auto const n = read( fd, regions[i].data, regions[i].size );
+
+      if ( std::int32_t( n ) < 0 )
+        return total ? total : n;
+
+      total += n;
+
+      if ( n < regions[i].size )
+        break;
+    }
+
+    return total;
+  }
+
+  // Scatter-gather version of `write`, used when the source lies in RAM blocks resident in memory.
+  // Writes the `count` regions in order, they point directly inside the guest's memory.
+  //
+  // Returns the number of bytes read from the regions, negative if error
+  //
+  // The default implementation calls `write` for each region, until one isn't written completely.
+  virtual std::uint32_t writev( std::uint32_t fd, IOVec const *regions, std::uint32_t count ) noexcept
+  {
+    std::uint32_t total = 0;
+
+    for ( std::uint32_t i = 0; i < count; ++i )
+    {
+      auto const n = write( fd, regions[i].data, regions[i].size );
+
+      if ( std::int32_t( n ) < 0 )
+        return total ? total : n;
+
+      total += n;
+
+      if ( n < regions[i].size )
+        break;
+    }
+
+    return total;
+  }
+
+  // Asynchronous version of `readv`.
+  // The handler can keep the regions until it calls `syscall->complete( bytes_read )`.
+  //
+  // Returns:
+  // `true`  - if the request has been accepted, it will be completed through `syscall`
+  // `false` - if the request must be performed synchronously
+  //
+  // The default implementation doesn't accept any request.
+  virtual bool read_async( std::uint32_t /*fd*/, IOVec const * /*regions*/, std::uint32_t /*count*/, AsyncSyscall * /*syscall*/ ) noexcept
+  {
+    return false;
+  }
+
+  // Asynchronous version of `writev`.
+  // The handler can keep the regions until it calls `syscall->complete( bytes_written )`.
+  //
+  // Returns:
+  // `true`  - if the request has been accepted, it will be completed through `syscall`
+  // `false` - if the request must be performed synchronously
+  //
+  // The default implementation doesn't accept any request.
+  virtual bool write_async( std::uint32_t /*fd*/, IOVec const * /*regions*/, std::uint32_t /*count*/, AsyncSyscall * /*syscall*/ ) noexcept
+  {
+    return false;
+  }
+
+  // Returns the host's file descriptor of `fd` (a HANDLE on Windows), used to map the file into the guest's memory.
+  // The file must be readable, the guest never modifies it through the mapping.
+  //
+  // The default implementation returns -1, the file can't be mapped.
+  virtual std::intptr_t native_handle( std::uint32_t /*fd*/ ) noexcept
+  {
+    return -1;
+  }
+
   // Close a file
   virtual void close( std::uint32_t fd ) noexcept = 0;
 
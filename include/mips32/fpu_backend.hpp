@@ -0,0 +1,23 @@
+#pragma once
+
+namespace mips32
+{
+/**
+ * Arithmetic used by the FPU (Coprocessor 1), chosen when the Machine is constructed.
+ *
+ * HOST  - the host's FPU through MXCSR, results and exceptions depend on it
+ *         and on the build flags.
+ * SOFT  - every rounding is computed in software, results and exceptions are the same
+ *         on every host. Round to nearest still runs on the host's FPU
+ *         when the operands are far from the overflow and underflow thresholds.
+ *
+ * With SOFT the instructions that neither round nor raise an exception (moves, selections,
+ * comparisons, classification) are still executed by the host. Minimum and maximum don't round,
+ * but a signaling NaN operand raises Invalid Operation, so they're computed in software too.
+ **/
+enum class FPUBackend
+{
+  HOST,
+  SOFT,
+};
+} // namespace mips32
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <mips32/async_syscall.hpp>
+#include <mips32/io_vec.hpp>
+
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
 
 namespace mips32
 {
@@ -59,6 +66,64 @@ public:
   // !#!#!#
   virtual void read_string( char *string, std::uint32_t max_count ) noexcept = 0;
 
+  // Writes a string, split into `count` regions, to the device.
+  // It's called instead of `print_string( char const* )` when the string spans more than one block of RAM.
+  // The regions don't contain the null terminator.
+  //
+  // The default implementation joins the regions and calls `print_string( char const* )`.
+  virtual void print_string( IOVec const *regions, std::uint32_t count ) noexcept
+  {
+    std::string string;
+
+    for ( std::uint32_t i = 0; i < count; ++i )
+      string.append( regions[i].data, regions[i].size );
+
+    print_string( string.c_str() );
+  }
+
+  // Reads a string from the device and stores it into `count` regions, filled in order.
+  // It's called instead of `read_string( char*, std::uint32_t )` when the destination spans more than one block of RAM.
+  //
+  // #!#!#!
+  // [WARNING] Writing more than `regions[i].size` characters into a region is undefined behaviour.
+  // !#!#!#
+  //
+  // The default implementation reads into a temporary buffer and copies it into the regions.
+  virtual void read_string( IOVec const *regions, std::uint32_t count ) noexcept
+  {
+    std::uint32_t max_count = 0;
+
+    for ( std::uint32_t i = 0; i < count; ++i )
+      max_count += regions[i].size;
+
+    std::unique_ptr<char[]> string( new ( std::nothrow ) char[max_count] );
+    if ( !string )
+      return;
+
+    read_string( string.get(), max_count );
+
+    for ( std::uint32_t i = 0, offset = 0; i < count; offset += regions[i].size, ++i )
+      std::memcpy( regions[i].data, string.get() + offset, regions[i].size );
+  }
+
+  // Asynchronous version of `read_string`, the regions are filled in order.
+  // The device can keep the regions until it calls `syscall->complete( 0 )`.
+  //
+  // Returns:
+  // `true`  - if the request has been accepted, it will be completed through `syscall`
+  // `false` - if the request must be performed synchronously
+  //
+  // The default implementation doesn't accept any request.
+  virtual bool read_string_async( IOVec const * /*regions*/, std::uint32_t /*count*/, AsyncSyscall * /*syscall*/ ) noexcept
+  {
+    return false;
+  }
+
+  // Delivers any output held by the device.
+  // Called by the CPU when the program stops through `exit` or `break`.
+  virtual void flush() noexcept
+  {}
+
   virtual ~IODevice()
   {}
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * A contiguous region of the guest's memory.
+ *
+ * Used by the scatter-gather functions of `IODevice` and `FileHandler`:
+ * a buffer of the guest is described by one region per RAM block it spans,
+ * and each region points directly inside the simulated RAM.
+ *
+ * #!#!#!
+ * [WARNING] `data` is valid only until the callback returns.
+ * !#!#!#
+ **/
+struct IOVec
+{
+  char *        data;
+  std::uint32_t size;
+};
+} // namespace mips32
@@ -1,13 +1,10 @@
 #pragma once
 
-#ifdef _MSC_VER
-#  define MIPS32_EXPORT __declspec(dllexport)
-#else
-#  define MIPS32_EXPORT
-#endif
-
+#include <mips32/event.hpp>
+#include <mips32/export.hpp>
 #include <mips32/io_device.hpp>
 #include <mips32/file_handler.hpp>
+#include <mips32/fpu_backend.hpp>
 #include <mips32/machine_inspector.hpp>
 
 #include <cstdint>
@@ -19,6 +16,9 @@ inline namespace v0
 class MachineImpl;
 }
 
+class MemoryTracer;
+class Profiler;
+
 /**
  * 
  * MIPS32 Machine Interface
@@ -29,7 +29,9 @@ class MachineImpl;
 class MIPS32_EXPORT Machine
 {
 public:
-  Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept;
+  // `fpu_backend` selects the FPU's arithmetic, see FPUBackend
+  Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler,
+           FPUBackend fpu_backend = FPUBackend::HOST ) noexcept;
 
   // Movable only
   Machine( Machine const& ) = delete;
@@ -43,6 +45,13 @@ public:
    * For the Executable File Format, read `executable_format.md` on the repository
    * 
    * `data` must point to a valid memory region
+   * 
+   * The symbol table of the executable, if any, is added to the attached Profiler
+   *
+   * Returns:
+   * `true`  - in case of *failure*, the header is not valid or an asynchronous syscall is in flight
+   *           (see AsyncSyscall), the Machine is untouched
+   * `false` - in case of success, the next `start()` runs from the entry point
    **/
   bool load( void const * data ) noexcept;
 
@@ -56,6 +65,11 @@ public:
    * - an interrupt/exception is triggered
    * - the exit syscall is called
    * - manually called stop()
+   * - an asynchronous syscall is pending, see AsyncSyscall
+   *
+   * The guest's FPU settings (MXCSR) are loaded on the calling thread
+   * only while it runs, so many Machines can share the same thread.
+   * Callbacks invoked by the Machine see the guest's settings.
    **/
   std::uint32_t start() noexcept;
 
@@ -71,15 +85,46 @@ public:
 
   /**
    * Resets the CPU and its Coprocessors
-   * The RAM is left untouched
+   * The RAM is left untouched, the scheduled events and the pending asynchronous syscall are discarded
    **/
   void reset() noexcept;
 
+  /**
+   * Schedules `callback( user_data )` to run once `delay` more cycles have been retired,
+   * see `TimingModel`. It runs at the first taken branch, jump or exception after that,
+   * so the CPU never checks for events between sequential instructions.
+   * Events due at the same cycle run in the order they have been scheduled.
+   *
+   * These functions must be called while the Machine is stopped,
+   * or by the callback of an event (e.g. a periodic timer reschedules itself).
+   *
+   * Returns the event's id, used to cancel it
+   **/
+  EventId schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept;
+
+  // Returns:
+  // `true`  - in case of *failure*, the event already ran or doesn't exist
+  // `false` - in case of success
+  bool cancel( EventId id ) noexcept;
+
+  // Asserts or deasserts the hardware interrupt `line` [0, 6), that's CP0 Cause IP2..IP7.
+  // The interrupt is taken at the next block boundary, if enabled and not masked.
+  void raise_interrupt( std::uint32_t line ) noexcept;
+  void clear_interrupt( std::uint32_t line ) noexcept;
+
   // Used to modify the handlers to perform I/O
   // Returns the previous handler
   IODevice* swap_iodevice( IODevice *device ) noexcept;
   FileHandler* swap_file_handler( FileHandler *handler ) noexcept;
 
+  // Attaches a profiler, `nullptr` detaches the current one
+  // Returns the previous profiler
+  Profiler* swap_profiler( Profiler *profiler ) noexcept;
+
+  // Attaches a memory tracer, `nullptr` detaches the current one
+  // Returns the previous tracer
+  MemoryTracer* swap_tracer( MemoryTracer *tracer ) noexcept;
+
 private:
   MachineImpl *_impl;
 };
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <mips32/cache_config.hpp>
 #include <mips32/fpr.hpp>
 #include <mips32/header.hpp>
+#include <mips32/timing_model.hpp>
 
 #include <array>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace mips32
@@ -52,11 +56,15 @@ public:
     CP0,
     CP1,
     CPU,
-    ALL // saves all components
+    ALL // saves all components inside a single file
   };
 
   // Save the state of the given component into the filename `name`.
   // All the components are left untouched *excepts* the CPU that will be stopped.
+  //
+  // `Component::ALL` produces a single file whose RAM blocks are page-aligned,
+  // restoring it maps the file in memory and the blocks are used in place:
+  // only the touched blocks are read from disk, and writing to them never modifies the file.
   //! This function is free to *add* a custom extension to the filename.
   // Returns:
   // `true`  - in case of *failure*
@@ -65,11 +73,29 @@ public:
 
   // Restore the state of the given component from the filename `name`.
   //! This function is free to *add* a custom extension to the filename.
+  // It fails without touching the Machine while an asynchronous syscall is in flight, see AsyncSyscall.
   // Returns:
   // `true`  - in case of *failure*. !!! it is not guaranteed to have a valid component in this case !!!
   // `false` - in case of success
   bool restore_state( Component c, char const *name ) noexcept;
 
+  // Writes the state of the entire Machine, with compressed RAM blocks, to `out`.
+  // The stream is written sequentially and the whole image is never staged in memory,
+  // so `out` can be a pipe (e.g. obtained through `fdopen`).
+  // The blocks are compressed in parallel by `threads` threads, 0 uses every hardware thread.
+  // The CPU will be stopped, `out` is neither flushed nor closed.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool save_compressed_state( std::FILE *out, unsigned threads = 0 ) noexcept;
+
+  // Restores the state written by `save_compressed_state`, reading `in` sequentially.
+  // Same as `restore_state`, it fails while an asynchronous syscall is in flight.
+  // Returns:
+  // `true`  - in case of *failure*. !!! it is not guaranteed to have a valid Machine in this case !!!
+  // `false` - in case of success
+  bool restore_compressed_state( std::FILE *in ) noexcept;
+
   /* * * *
    *     *
    * RAM *
@@ -95,6 +121,9 @@ public:
   std::vector<std::uint32_t> RAM_allocated_addresses() const noexcept;
   std::vector<std::uint32_t> RAM_swapped_addresses() const noexcept;
 
+  // Files whose memory is used by the allocated blocks, see the mmap syscall and `Component::ALL`
+  std::uint32_t RAM_mapped_files_no() const noexcept;
+
   // Read `count` bytes from the RAM starting at `address`.
   // If you want to read a string with unspecified length, call `RAM_read(0xABCD'1234, -1, true)`
   // 
@@ -110,6 +139,46 @@ public:
   // !#!#!#
   void RAM_write( std::uint32_t address, void const *src, std::uint32_t count ) noexcept;
 
+  // Contiguous region of a block, it's valid only inside the callback it was passed to.
+  struct RAMSpan
+  {
+    std::uint32_t address; // guest address of `data[0]`
+    char *        data;
+    std::uint32_t size;
+  };
+
+  using RAMVisitor = bool ( * )( RAMSpan span, void *user_data );
+
+  // Calls `visitor` once for every block overlapping [address, address + count), in address order,
+  // with a view of the overlapping bytes. No data is copied.
+  // While the callback runs its block is pinned: it will never be swapped on disk,
+  // even if the callback accesses other parts of the RAM.
+  //
+  // Only blocks resident in memory are visited, it stops at the first one that
+  // is swapped or doesn't exist, or when `visitor` returns `false`.
+  // Returns the number of bytes visited.
+  std::uint32_t RAM_visit( std::uint32_t address, std::uint32_t count, RAMVisitor visitor, void *user_data ) noexcept;
+
+  // Same as above, `visitor` is any callable like `bool( RAMSpan )`.
+  template<typename Visitor>
+  std::uint32_t RAM_visit( std::uint32_t address, std::uint32_t count, Visitor &&visitor ) noexcept
+  {
+    return RAM_visit( address, count, []( RAMSpan span, void *user_data ) -> bool
+    {
+      return ( *static_cast<std::remove_reference_t<Visitor> *>( user_data ) )( span );
+    }, const_cast<void *>( static_cast<void const *>( std::addressof( visitor ) ) ) );
+  }
+
+  // Copies up to `count` bytes starting at `address` into `dst`, with a single memcpy per block.
+  // Swapped blocks are read from disk without swapping them in.
+  // Stops at the first block that doesn't exist.
+  // Returns the number of bytes copied.
+  std::uint32_t RAM_read_into( std::uint32_t address, void *dst, std::uint32_t count ) noexcept;
+
+  // Same as `RAM_write`, with a single memcpy per block.
+  // Returns the number of bytes written.
+  std::uint32_t RAM_write_from( std::uint32_t address, void const *src, std::uint32_t count ) noexcept;
+
   /* * * * *
    *       *
    * COP 0 *
@@ -132,6 +201,12 @@ public:
   std::uint32_t CP1_fir() const noexcept;
   std::uint32_t CP1_fcsr() const noexcept;
 
+  // Vector register of MSA, the least significant half first
+  std::array<std::uint64_t, 2> CP1_read_vpr( std::uint32_t reg ) const noexcept;
+  void                         CP1_write_vpr( std::uint32_t reg, std::array<std::uint64_t, 2> value ) noexcept;
+
+  std::uint32_t CP1_msacsr() const noexcept;
+
   /* * * *
    *     *
    * CPU *
@@ -145,9 +220,71 @@ public:
 
   std::uint32_t& CPU_pc() noexcept;
 
+  // Current end of the heap, moved by the sbrk syscall
+  std::uint32_t& CPU_program_break() noexcept;
+
   std::uint32_t CPU_read_exit_code() const noexcept;
   void          CPU_write_exit_code( std::uint32_t value ) noexcept;
 
+  // Cycles elapsed since the last reset, every instruction costs as much as the TimingModel says.
+  // CP0 Count increments once per cycle and raises the timer interrupt when it reaches Compare.
+  std::uint64_t CPU_cycles() const noexcept;
+  void          CPU_set_timing_model( TimingModel const &model ) noexcept;
+
+  // Instructions executed per primary opcode, SPECIAL function and COP1 function (arithmetic formats only).
+  // They are counted only if the library has been built with MIPS32_ENABLE_COUNTERS,
+  // otherwise every counter reads 0.
+  enum class CounterGroup
+  {
+    OPCODE,
+    SPECIAL,
+    COP1,
+  };
+
+  enum class CounterFormat
+  {
+    JSON,
+    CSV,
+  };
+
+  bool          CPU_counters_enabled() const noexcept;
+  std::uint64_t CPU_counter( CounterGroup group, std::uint32_t code ) const noexcept;
+  void          CPU_reset_counters() noexcept;
+
+  // Writes the counters that aren't 0 to `out`, that is neither flushed nor closed:
+  // JSON - {"opcode":{"0x08":12,...},"special":{...},"cop1":{...}}
+  // CSV  - the header `group,code,count`, followed by one row per counter
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool CPU_export_counters( std::FILE *out, CounterFormat format ) const noexcept;
+
+  /* * * * *
+   *       *
+   * CACHE *
+   *       *
+   * * * * */
+
+  enum class CacheLevel
+  {
+    L1I,
+    L1D,
+    L2,
+  };
+
+  // Enables the cache model: L1 instruction and data caches backed by an unified L2.
+  // The MMU feeds it with every access, it only counts hits, misses and write-backs.
+  // Enabling it again discards the previous caches.
+  // Returns:
+  // `true`  - in case of *failure*, at least one config isn't valid (see CacheConfig)
+  // `false` - in case of success
+  bool Cache_enable( CacheConfig const &l1i, CacheConfig const &l1d, CacheConfig const &l2 ) noexcept;
+  void Cache_disable() noexcept;
+  bool Cache_enabled() const noexcept;
+
+  // Every counter is 0 if the cache model is disabled
+  CacheStats Cache_stats( CacheLevel level ) const noexcept;
+
 private:
   RAM *ram;
   CP0 *cp0;
@@ -158,11 +295,16 @@ private:
   bool save_state_cp0( char const*name ) const noexcept;
   bool save_state_cp1( char const*name ) const noexcept;
   bool save_state_cpu( char const*name ) const noexcept;
+  bool save_state_all( char const*name ) const noexcept;
 
   bool restore_state_ram( char const*name ) noexcept;
   bool restore_state_cp0( char const*name ) noexcept;
   bool restore_state_cp1( char const*name ) noexcept;
   bool restore_state_cpu( char const*name ) noexcept;
+  bool restore_state_all( char const*name ) noexcept;
+
+  bool write_registers( std::FILE *file ) const noexcept;
+  bool read_registers( std::FILE *file ) noexcept;
 };
 
 } // namespace mips32
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <mips32/export.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Records every memory access of the CPU: instruction fetches, loads and stores.
+ *
+ * The CPU pushes the accesses into a lock-free single producer single consumer ring,
+ * a consumer thread drains it and writes the trace to a file.
+ * When the consumer falls behind, the CPU either drops the access (it's counted)
+ * or waits for a free slot, depending on `Overflow`.
+ *
+ * An instruction is a single access, e.g. LDC1 is a load of 8 bytes and LD.df of 16 bytes.
+ *
+ * The accesses are recorded only if the library has been built with MIPS32_ENABLE_TRACING,
+ * otherwise the CPU ignores the attached tracer.
+ *
+ * Trace format, every integer is little endian:
+ * - header: "mtrc", uint32_t version (2)
+ * - an access: uint8_t tag, followed by the address delta as a varint
+ *   tag bits [0, 2) kind (see `Kind`), bits [2, 5) log2( size ), up to 16 bytes
+ *   (version 1 had bits [2, 4), up to 8 bytes)
+ *   the delta is the difference from the previous address of the same kind,
+ *   zigzag encoded as a 32-bit signed integer, 7 bits per byte, the least significant first
+ * - dropped accesses: uint8_t tag 3, followed by the number of dropped accesses as a varint
+ **/
+class MIPS32_EXPORT MemoryTracer
+{
+public:
+  enum class Kind : std::uint8_t
+  {
+    FETCH,
+    LOAD,
+    STORE,
+  };
+
+  enum class Overflow
+  {
+    DROP, // the access is dropped and counted, the CPU never waits
+    BLOCK // the CPU waits until the consumer frees a slot
+  };
+
+  struct Access
+  {
+    std::uint32_t address;
+    Kind          kind;
+    std::uint8_t  size; // in bytes
+  };
+
+  // `out` must outlive the tracer, it's neither flushed nor closed.
+  // `capacity` is rounded up to a power of 2.
+  explicit MemoryTracer( std::FILE *out, std::uint32_t capacity = 64 * 1024, Overflow overflow = Overflow::DROP ) noexcept;
+
+  // Non copyable, non movable: the consumer thread refers to the tracer
+  MemoryTracer( MemoryTracer const & ) = delete;
+  MemoryTracer &operator=( MemoryTracer const & ) = delete;
+
+  // Writes the accesses still inside the ring
+  ~MemoryTracer();
+
+  // Called by the CPU, only one thread at a time can record.
+  void record( Kind kind, std::uint32_t address, std::uint8_t size ) noexcept;
+
+  // Waits until every recorded access has been written, then flushes `out`.
+  // Must not be called while the CPU is recording.
+  void flush() noexcept;
+
+  std::uint64_t dropped() const noexcept { return dropped_no.load( std::memory_order_relaxed ); }
+
+  // Reads a whole trace from `in`, appending the accesses to `accesses`.
+  // `dropped`, if not nullptr, receives the number of dropped accesses.
+  // Returns:
+  // `true`  - in case of *failure*, the trace is malformed
+  // `false` - in case of success
+  static bool read_trace( std::FILE *in, std::vector<Access> &accesses, std::uint64_t *dropped = nullptr ) noexcept;
+
+private:
+  void consume() noexcept;
+  void encode( Access const &access ) noexcept;
+  void encode_dropped() noexcept;
+
+  std::FILE *    out;
+  std::uint32_t  mask;
+  Overflow const overflow;
+
+  std::vector<Access> ring;
+
+  alignas( 64 ) std::atomic<std::uint64_t> head{ 0 }; // written by the producer
+  std::uint64_t cached_tail{ 0 };                     // producer's view of `tail`
+
+  alignas( 64 ) std::atomic<std::uint64_t> tail{ 0 }; // written by the consumer
+  std::atomic<std::uint64_t> dropped_no{ 0 };
+  std::atomic<bool>          quit{ false };
+
+  // Consumer's state
+  std::uint64_t             written_dropped{ 0 };
+  std::uint32_t             previous[3]{};
+  std::vector<std::uint8_t> buffer;
+
+  std::thread consumer;
+};
+} // namespace mips32
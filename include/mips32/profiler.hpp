@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mips32/export.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Sampling profiler of the guest's code.
+ *
+ * Once attached to a Machine, every `interval` executed instructions
+ * it records the PC together with a shallow call stack.
+ * The call stack isn't read from the guest's memory, the CPU notifies every
+ * call (JAL, JALR, BAL, BALC, JIALC) and every indirect jump, that is treated as a return
+ * when it targets the return address of one of the tracked calls.
+ * Calls deeper than the maximum depth aren't part of the samples, but the return addresses
+ * of the innermost `max_depth` of them are kept too, so a jump table doesn't look like a return.
+ *
+ * The samples are exported in the folded stack format, `caller;callee;... count`,
+ * understood by the flamegraph tools. Addresses are resolved through the symbol table,
+ * if any, otherwise they're printed in hexadecimal.
+ *
+ * Not thread safe: it must be accessed only while the Machine isn't running.
+ **/
+class MIPS32_EXPORT Profiler
+{
+  friend class CPU;
+
+public:
+  // `interval` must be greater than 0.
+  // Calls nested deeper than `max_depth` aren't tracked.
+  explicit Profiler( std::uint32_t interval = 1000, std::uint32_t max_depth = 16 ) noexcept;
+
+  // The symbol at `address` covers every address up to the next symbol.
+  void add_symbol( std::uint32_t address, std::string name ) noexcept;
+
+  // Reads a symbol per line, either `address name` or `address type name` like `nm` does,
+  // the address is in hexadecimal. Lines that don't match are ignored.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool load_symbols( std::FILE *in ) noexcept;
+
+  // Same as above, the listing is the `size` bytes of `text`, e.g. the symbol table of an executable.
+  void load_symbols( char const *text, std::size_t size ) noexcept;
+
+  // Writes every sample to `out` in the folded stack format, one stack per line.
+  // `out` is neither flushed nor closed.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool export_folded( std::FILE *out ) const noexcept;
+
+  std::uint64_t sample_no() const noexcept { return samples; }
+
+  // Discards the samples and the tracked calls, the symbols are kept.
+  void clear() noexcept;
+
+private:
+  struct Frame
+  {
+    std::uint32_t call_site;
+    std::uint32_t entry;
+    std::uint32_t return_address;
+  };
+
+  struct StackHash
+  {
+    std::size_t operator()( std::vector<std::uint32_t> const &stack ) const noexcept;
+  };
+
+  // Adds the symbol of a line of a listing, if it matches
+  void parse_symbol( char const *line ) noexcept;
+
+  void sample( std::uint32_t pc ) noexcept;
+  void call( std::uint32_t call_site, std::uint32_t entry, std::uint32_t return_address ) noexcept;
+  void jump( std::uint32_t target ) noexcept;
+
+  std::string symbolize( std::uint32_t address ) const noexcept;
+
+  std::uint32_t interval;
+  std::uint32_t max_depth;
+
+  std::vector<Frame> frames;
+
+  // Calls past `max_depth`, the return addresses of the innermost `retained` ones are in a ring
+  std::vector<std::uint32_t> untracked_returns;
+  std::uint32_t              untracked{ 0 };
+  std::uint32_t              retained{ 0 };
+
+  std::map<std::uint32_t, std::string> symbols;
+
+  // The call site of the outermost call, the entry of every call, the PC
+  std::unordered_map<std::vector<std::uint32_t>, std::uint64_t, StackHash> stacks;
+  std::vector<std::uint32_t>                                                key;
+  std::uint64_t                                                             samples{ 0 };
+};
+} // namespace mips32
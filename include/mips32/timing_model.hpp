@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * Cycles spent by every retired instruction, grouped by class.
+ * The CPU advances its cycle counter by these amounts, CP0 Count increments once per cycle.
+ *
+ * It's an approximation: there's no pipeline, every instruction costs the same
+ * regardless of the previous ones, the cache model doesn't affect it.
+ **/
+struct TimingModel
+{
+  std::uint32_t base{ 1 };    // every instruction not listed below
+  std::uint32_t load{ 2 };    // integer, FPU and vector loads
+  std::uint32_t store{ 1 };   // integer, FPU and vector stores
+  std::uint32_t mul_div{ 4 }; // MUL, MUH, DIV, MOD and their unsigned variants
+  std::uint32_t fp{ 4 };      // every COP1 instruction
+};
+} // namespace mips32
@@ -0,0 +1,243 @@
+#include "block_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mips32
+{
+constexpr std::uint16_t run_flag{ 0x8000 };
+constexpr std::uint32_t max_token_words{ 0x7FFF };
+
+// Runs shorter than this are cheaper to store as literals.
+constexpr std::uint32_t min_run_words{ 3 };
+
+std::uint32_t run_length( std::uint32_t const *words, std::uint32_t pos, std::uint32_t word_count ) noexcept
+{
+  std::uint32_t const limit = std::min( word_count, pos + max_token_words );
+
+  std::uint32_t end = pos + 1;
+  while ( end < limit && words[end] == words[pos] )
+    ++end;
+
+  return end - pos;
+}
+
+template<typename T>
+void append( std::vector<std::uint8_t> &out, T const *src, std::size_t count ) noexcept
+{
+  auto const size = out.size();
+  out.resize( size + sizeof( T ) * count );
+  std::memcpy( out.data() + size, src, sizeof( T ) * count );
+}
+
+BlockEncoding encode_block( std::uint32_t const *words, std::uint32_t word_count, std::vector<std::uint8_t> &out ) noexcept
+{
+  out.clear();
+
+  if ( std::all_of( words, words + word_count, [first = words[0]]( std::uint32_t w ) { return w == first; } ) )
+  {
+    append( out, words, 1 );
+    return BlockEncoding::UNIFORM;
+  }
+
+  std::size_t const raw_size = sizeof( std::uint32_t ) * word_count;
+
+  std::uint32_t pos = 0;
+  while ( pos < word_count && out.size() < raw_size )
+  {
+    auto const run = run_length( words, pos, word_count );
+
+    if ( run >= min_run_words )
+    {
+      std::uint16_t const token = std::uint16_t( run | run_flag );
+      append( out, &token, 1 );
+      append( out, words + pos, 1 );
+      pos += run;
+      continue;
+    }
+
+    // Literals, until the next profitable run
+    std::uint32_t end = pos + run;
+    while ( end < word_count && end - pos < max_token_words && run_length( words, end, word_count ) < min_run_words )
+      ++end;
+
+    end = std::min( end, pos + max_token_words );
+
+    std::uint16_t const token = std::uint16_t( end - pos );
+    append( out, &token, 1 );
+    append( out, words + pos, end - pos );
+    pos = end;
+  }
+
+  if ( out.size() < raw_size )
+    return BlockEncoding::RLE;
+
+  out.clear();
+  append( out, words, word_count );
+  return BlockEncoding::RAW;
+}
+
+bool decode_block( BlockEncoding encoding, std::uint8_t const *src, std::size_t size, std::uint32_t *words, std::uint32_t word_count ) noexcept
+{
+  if ( encoding == BlockEncoding::UNIFORM )
+  {
+    if ( size != sizeof( std::uint32_t ) )
+      return true;
+
+    std::uint32_t word;
+    std::memcpy( &word, src, sizeof( word ) );
+    std::fill_n( words, word_count, word );
+
+    return false;
+  }
+
+  if ( encoding == BlockEncoding::RAW )
+  {
+    if ( size != sizeof( std::uint32_t ) * word_count )
+      return true;
+
+    std::memcpy( words, src, size );
+    return false;
+  }
+
+  if ( encoding != BlockEncoding::RLE )
+    return true;
+
+  std::uint8_t const *const end = src + size;
+  std::uint32_t             pos = 0;
+
+  while ( src != end )
+  {
+    std::uint16_t token;
+    if ( std::size_t( end - src ) < sizeof( token ) )
+      return true;
+
+    std::memcpy( &token, src, sizeof( token ) );
+    src += sizeof( token );
+
+    std::uint32_t const count = token & ~run_flag;
+    if ( count > word_count - pos )
+      return true;
+
+    if ( token & run_flag )
+    {
+      if ( std::size_t( end - src ) < sizeof( std::uint32_t ) )
+        return true;
+
+      std::uint32_t word;
+      std::memcpy( &word, src, sizeof( word ) );
+      src += sizeof( word );
+
+      std::fill_n( words + pos, count, word );
+    }
+    else
+    {
+      if ( std::size_t( end - src ) < sizeof( std::uint32_t ) * count )
+        return true;
+
+      std::memcpy( words + pos, src, sizeof( std::uint32_t ) * count );
+      src += sizeof( std::uint32_t ) * count;
+    }
+
+    pos += count;
+  }
+
+  return pos != word_count;
+}
+
+BlockEncoderPool::BlockEncoderPool( unsigned threads ) noexcept
+{
+  if ( !threads )
+    threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+  workers.reserve( threads - 1 );
+  for ( unsigned i = 1; i < threads; ++i )
+    workers.emplace_back( &BlockEncoderPool::work, this );
+}
+
+BlockEncoderPool::~BlockEncoderPool()
+{
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    quit = true;
+  }
+  wake.notify_all();
+
+  for ( auto &worker : workers )
+    worker.join();
+}
+
+void BlockEncoderPool::encode( std::vector<std::uint32_t const *> const &batch,
+                               std::uint32_t                             word_count,
+                               std::vector<BlockEncoding> &              encodings,
+                               std::vector<std::vector<std::uint8_t>> &  outputs ) noexcept
+{
+  encodings.resize( batch.size() );
+  outputs.resize( batch.size() );
+
+  if ( batch.empty() )
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    this->batch = &batch;
+    this->word_count = word_count;
+    this->encodings = &encodings;
+    this->outputs = &outputs;
+    next_job.store( 0, std::memory_order_relaxed );
+    pending = batch.size();
+    ++generation;
+  }
+  wake.notify_all();
+
+  auto const finished = run_jobs();
+
+  std::unique_lock<std::mutex> lock( mutex );
+  pending -= finished;
+  // Waits also for the workers that joined the batch, they are still reading it
+  done.wait( lock, [this] { return !pending && !busy; } );
+}
+
+void BlockEncoderPool::work() noexcept
+{
+  std::uint64_t seen = 0;
+
+  for ( ;; )
+  {
+    {
+      std::unique_lock<std::mutex> lock( mutex );
+      // A batch is joined only while it has pending jobs, otherwise `encode` may be changing it
+      wake.wait( lock, [&] { return quit || ( generation != seen && pending ); } );
+
+      if ( quit )
+        return;
+
+      seen = generation;
+      ++busy;
+    }
+
+    auto const finished = run_jobs();
+
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      pending -= finished;
+      --busy;
+    }
+    done.notify_all();
+  }
+}
+
+std::size_t BlockEncoderPool::run_jobs() noexcept
+{
+  std::size_t finished = 0;
+
+  for ( std::size_t job = next_job.fetch_add( 1, std::memory_order_relaxed ); job < batch->size();
+        job = next_job.fetch_add( 1, std::memory_order_relaxed ) )
+  {
+    ( *encodings )[job] = encode_block( ( *batch )[job], word_count, ( *outputs )[job] );
+    ++finished;
+  }
+
+  return finished;
+}
+} // namespace mips32
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Compression of RAM blocks.
+ *
+ * A block is encoded in the smallest of these representations:
+ * - UNIFORM, every word has the same value, only that word is stored
+ *   (e.g. blocks filled with the sigrie instruction or zeroes)
+ * - RLE, a sequence of tokens:
+ *   uint16_t count | 0x8000, followed by a word repeated `count` times
+ *   uint16_t count,          followed by `count` literal words
+ * - RAW, the words as they are
+ **/
+enum class BlockEncoding : std::uint8_t
+{
+  UNIFORM,
+  RLE,
+  RAW,
+};
+
+// Encodes `word_count` words into `out`, that is overwritten.
+// Returns the chosen encoding.
+BlockEncoding encode_block( std::uint32_t const *words, std::uint32_t word_count, std::vector<std::uint8_t> &out ) noexcept;
+
+// Decodes `size` bytes from `src` into exactly `word_count` words.
+// Returns:
+// `true`  - in case of *failure*, the data is malformed
+// `false` - in case of success
+bool decode_block( BlockEncoding encoding, std::uint8_t const *src, std::size_t size, std::uint32_t *words, std::uint32_t word_count ) noexcept;
+
+/**
+ * Pool of threads that encodes batches of blocks in parallel.
+ * The calling thread takes part in the work too,
+ * so a pool of 1 thread doesn't spawn anything.
+ **/
+class BlockEncoderPool
+{
+public:
+  explicit BlockEncoderPool( unsigned threads ) noexcept;
+
+  // Non copyable, non movable: the workers refer to the pool
+  BlockEncoderPool( BlockEncoderPool const & ) = delete;
+  BlockEncoderPool &operator=( BlockEncoderPool const & ) = delete;
+
+  ~BlockEncoderPool();
+
+  // Encodes every block inside `batch`, each of `word_count` words.
+  // `encodings` and `outputs` are resized to `batch.size()`.
+  // Returns once all the blocks are encoded.
+  void encode( std::vector<std::uint32_t const *> const &batch,
+               std::uint32_t                             word_count,
+               std::vector<BlockEncoding> &              encodings,
+               std::vector<std::vector<std::uint8_t>> &  outputs ) noexcept;
+
+private:
+  void work() noexcept;
+  // Returns the number of encoded blocks
+  std::size_t run_jobs() noexcept;
+
+  std::vector<std::thread> workers;
+
+  std::mutex              mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  // Current batch, valid while `pending` > 0
+  std::vector<std::uint32_t const *> const *batch{ nullptr };
+  std::uint32_t                             word_count{ 0 };
+  std::vector<BlockEncoding> *              encodings{ nullptr };
+  std::vector<std::vector<std::uint8_t>> *  outputs{ nullptr };
+
+  std::atomic<std::size_t> next_job{ 0 };
+  std::size_t              pending{ 0 }; // jobs of the current batch not encoded yet
+  std::size_t              busy{ 0 };    // workers that joined the current batch
+  std::uint64_t            generation{ 0 };
+  bool                     quit{ false };
+};
+} // namespace mips32
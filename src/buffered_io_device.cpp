@@ -0,0 +1,262 @@
+#include <mips32/buffered_io_device.hpp>
+
+#include <cstring>
+
+namespace mips32
+{
+BufferedIODevice::BufferedIODevice( IODevice *device, std::uint32_t capacity, std::chrono::milliseconds flush_interval ) noexcept
+  : device( device ), capacity( capacity ), flush_interval( flush_interval )
+{
+  buffer.reserve( capacity );
+  delivering.reserve( capacity );
+
+  if ( flush_interval.count() > 0 )
+    flusher = std::thread( &BufferedIODevice::background_flush, this );
+}
+
+BufferedIODevice::~BufferedIODevice()
+{
+  {
+    std::lock_guard<std::mutex> lock( buffer_mutex );
+    quit = true;
+  }
+  wake.notify_one();
+
+  if ( flusher.joinable() )
+    flusher.join();
+
+  flush();
+}
+
+/* * * * * *
+ *         *
+ * OUTPUT  *
+ *         *
+ * * * * * */
+
+void BufferedIODevice::print_integer( std::uint32_t value ) noexcept
+{
+  append( INTEGER, &value, sizeof( value ) );
+}
+
+void BufferedIODevice::print_float( float value ) noexcept
+{
+  append( FLOAT, &value, sizeof( value ) );
+}
+
+void BufferedIODevice::print_double( double value ) noexcept
+{
+  append( DOUBLE, &value, sizeof( value ) );
+}
+
+// A null string has nothing to print, so it's dropped
+void BufferedIODevice::print_string( char const *string ) noexcept
+{
+  if ( !string )
+    return;
+
+  IOVec region{ const_cast<char *>( string ), ( std::uint32_t )std::strlen( string ) };
+  append_string( &region, 1 );
+}
+
+void BufferedIODevice::print_string( IOVec const *regions, std::uint32_t count ) noexcept
+{
+  append_string( regions, count );
+}
+
+/* * * * * *
+ *         *
+ *  INPUT  *
+ *         *
+ * * * * * */
+
+void BufferedIODevice::read_integer( std::uint32_t *value ) noexcept
+{
+  flush();
+  device->read_integer( value );
+}
+
+void BufferedIODevice::read_float( float *value ) noexcept
+{
+  flush();
+  device->read_float( value );
+}
+
+void BufferedIODevice::read_double( double *value ) noexcept
+{
+  flush();
+  device->read_double( value );
+}
+
+void BufferedIODevice::read_string( char *string, std::uint32_t max_count ) noexcept
+{
+  flush();
+  device->read_string( string, max_count );
+}
+
+void BufferedIODevice::read_string( IOVec const *regions, std::uint32_t count ) noexcept
+{
+  flush();
+  device->read_string( regions, count );
+}
+
+bool BufferedIODevice::read_string_async( IOVec const *regions, std::uint32_t count, AsyncSyscall *syscall ) noexcept
+{
+  flush();
+  return device->read_string_async( regions, count, syscall );
+}
+
+/* * * * * *
+ *         *
+ * BUFFER  *
+ *         *
+ * * * * * */
+
+/**
+ * Records are stored as a tag followed by their data:
+ * INTEGER -> std::uint32_t
+ * FLOAT   -> float
+ * DOUBLE  -> double
+ * STRING  -> std::uint32_t length, char * length
+ **/
+void BufferedIODevice::append( Record record, void const *data, std::size_t size ) noexcept
+{
+  std::unique_lock<std::mutex> lock( buffer_mutex );
+
+  auto const old_size = buffer.size();
+  buffer.resize( old_size + 1 + size );
+  buffer[old_size] = record;
+  std::memcpy( buffer.data() + old_size + 1, data, size );
+
+  buffered( lock );
+}
+
+void BufferedIODevice::append_string( IOVec const *regions, std::uint32_t count ) noexcept
+{
+  std::uint32_t length = 0;
+  for ( std::uint32_t i = 0; i < count; ++i )
+    length += regions[i].size;
+
+  std::unique_lock<std::mutex> lock( buffer_mutex );
+
+  auto old_size = buffer.size();
+  buffer.resize( old_size + 1 + sizeof( length ) + length );
+  buffer[old_size] = STRING;
+  std::memcpy( buffer.data() + old_size + 1, &length, sizeof( length ) );
+
+  old_size += 1 + sizeof( length );
+  for ( std::uint32_t i = 0; i < count; ++i )
+  {
+    std::memcpy( buffer.data() + old_size, regions[i].data, regions[i].size );
+    old_size += regions[i].size;
+  }
+
+  buffered( lock );
+}
+
+void BufferedIODevice::buffered( std::unique_lock<std::mutex> &lock ) noexcept
+{
+  auto const size = buffer.size();
+
+  if ( size >= capacity || !flusher.joinable() && size >= capacity / 2 )
+  {
+    // Full, the caller pays for the delivery so the buffer can't grow without bounds
+    lock.unlock();
+    flush();
+  }
+  else if ( size >= capacity / 2 )
+  {
+    lock.unlock();
+    wake.notify_one();
+  }
+}
+
+void BufferedIODevice::flush() noexcept
+{
+  std::lock_guard<std::mutex> flush_lock( flush_mutex );
+
+  {
+    std::lock_guard<std::mutex> lock( buffer_mutex );
+    buffer.swap( delivering );
+  }
+
+  deliver( delivering );
+  delivering.clear();
+}
+
+void BufferedIODevice::deliver( std::vector<char> const &records ) noexcept
+{
+  auto print_text = [this]
+  {
+    if ( !text.empty() )
+    {
+      device->print_string( text.c_str() );
+      text.clear();
+    }
+  };
+
+  for ( std::size_t pos = 0; pos < records.size(); )
+  {
+    auto const record = ( Record )records[pos++];
+    char const *data = records.data() + pos;
+
+    if ( record == STRING )
+    {
+      std::uint32_t length;
+      std::memcpy( &length, data, sizeof( length ) );
+
+      text.append( data + sizeof( length ), length );
+      pos += sizeof( length ) + length;
+      continue;
+    }
+
+    // Strings are delivered before anything else to keep the order
+    print_text();
+
+    if ( record == INTEGER )
+    {
+      std::uint32_t value;
+      std::memcpy( &value, data, sizeof( value ) );
+      device->print_integer( value );
+      pos += sizeof( value );
+    }
+    else if ( record == FLOAT )
+    {
+      float value;
+      std::memcpy( &value, data, sizeof( value ) );
+      device->print_float( value );
+      pos += sizeof( value );
+    }
+    else // DOUBLE
+    {
+      double value;
+      std::memcpy( &value, data, sizeof( value ) );
+      device->print_double( value );
+      pos += sizeof( value );
+    }
+  }
+
+  print_text();
+}
+
+/**
+ * Wakes up when the buffer is half full or every `flush_interval`,
+ * so the output never stays buffered for much longer than that.
+ **/
+void BufferedIODevice::background_flush() noexcept
+{
+  std::unique_lock<std::mutex> lock( buffer_mutex );
+
+  while ( !quit )
+  {
+    wake.wait_for( lock, flush_interval, [this] { return quit || buffer.size() >= capacity / 2; } );
+
+    if ( buffer.empty() )
+      continue;
+
+    lock.unlock();
+    flush();
+    lock.lock();
+  }
+}
+} // namespace mips32
@@ -0,0 +1,103 @@
+#include "cache.hpp"
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+namespace mips32
+{
+constexpr bool is_power_of_2( std::uint32_t value ) noexcept
+{
+  return value && !( value & ( value - 1 ) );
+}
+
+std::uint32_t first_way( std::uint32_t ways ) noexcept
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward( &index, ways );
+  return index;
+#else
+  return __builtin_ctz( ways );
+#endif
+}
+
+Cache::Cache( CacheConfig const &config, Cache *next ) noexcept
+  : ways( config.associativity ), next( next )
+{
+  line_shift = 0;
+  while ( ( 1u << line_shift ) < config.line_size )
+    ++line_shift;
+
+  auto const sets = config.size / config.line_size / ways;
+
+  set_mask = sets - 1;
+  all_ways = ways == 32 ? 0xFFFF'FFFF : ( 1u << ways ) - 1;
+
+  tags.resize( std::size_t( sets ) * ways );
+  valid.resize( sets );
+  dirty.resize( sets );
+  recent.resize( sets );
+}
+
+bool Cache::invalid( CacheConfig const &config ) noexcept
+{
+  return !is_power_of_2( config.size )
+         || !is_power_of_2( config.line_size )
+         || !is_power_of_2( config.associativity )
+         || config.line_size < 4
+         || config.associativity > 32
+         || config.size / config.line_size < config.associativity;
+}
+
+void Cache::access( std::uint32_t address, bool write ) noexcept
+{
+  auto const line = address >> line_shift;
+  auto const set = line & set_mask;
+
+  auto *const set_tags = &tags[std::size_t( set ) * ways];
+
+  for ( std::uint32_t way = 0; way < ways; ++way )
+  {
+    if ( set_tags[way] == line && valid[set] >> way & 1 )
+    {
+      ++stats.hits;
+      touch( set, way );
+
+      if ( write )
+        dirty[set] |= 1u << way;
+
+      return;
+    }
+  }
+
+  ++stats.misses;
+
+  // An empty way, otherwise the first one not used recently (a direct mapped cache has only one)
+  auto const empty = ~valid[set] & all_ways;
+  auto const old = ~recent[set] & all_ways;
+  auto const way = first_way( empty ? empty : old ? old : all_ways );
+  auto const bit = 1u << way;
+
+  if ( dirty[set] & bit )
+  {
+    ++stats.writebacks;
+
+    if ( next )
+      next->access( set_tags[way] << line_shift, true );
+  }
+
+  if ( next )
+    next->access( address, false );
+
+  set_tags[way] = line;
+  valid[set] |= bit;
+
+  if ( write )
+    dirty[set] |= bit;
+  else
+    dirty[set] &= ~bit;
+
+  touch( set, way );
+}
+} // namespace mips32
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mips32/cache_config.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Set-associative, write-back and write-allocate cache model.
+ *
+ * It doesn't hold any data, the RAM is always up to date:
+ * only the tags are tracked to count hits, misses and write-backs.
+ *
+ * The tags of a set are contiguous (SoA), the valid, dirty and
+ * recently used flags of a set are bitmasks, one bit per way.
+ * The victim is chosen with the bit-PLRU policy:
+ * every access marks its way, when every way is marked only the last one stays marked.
+ **/
+class Cache
+{
+  friend class MachineInspector;
+
+public:
+  // `next` receives the misses and the write-backs, it can be nullptr (the RAM).
+  Cache( CacheConfig const &config, Cache *next ) noexcept;
+
+  // Returns `true` if the cache can't be built with the given config.
+  static bool invalid( CacheConfig const &config ) noexcept;
+
+  void access( std::uint32_t address, bool write ) noexcept;
+
+private:
+  void touch( std::uint32_t set, std::uint32_t way ) noexcept
+  {
+    auto const bit = 1u << way;
+
+    recent[set] |= bit;
+    if ( recent[set] == all_ways )
+      recent[set] = bit;
+  }
+
+  std::uint32_t line_shift;
+  std::uint32_t set_mask;
+  std::uint32_t ways;
+  std::uint32_t all_ways; // a bit for each way
+
+  std::vector<std::uint32_t> tags; // sets * ways, the line number
+  std::vector<std::uint32_t> valid;
+  std::vector<std::uint32_t> dirty;
+  std::vector<std::uint32_t> recent;
+
+  Cache *next;
+
+  CacheStats stats{};
+};
+
+// L1 instruction and data caches, backed by an unified L2
+struct CacheHierarchy
+{
+  CacheHierarchy( CacheConfig const &l1i, CacheConfig const &l1d, CacheConfig const &l2 ) noexcept
+    : l2( l2, nullptr ), l1i( l1i, &this->l2 ), l1d( l1d, &this->l2 )
+  {}
+
+  // Non copyable, non movable: the L1 caches refer to the L2
+  CacheHierarchy( CacheHierarchy const & ) = delete;
+  CacheHierarchy &operator=( CacheHierarchy const & ) = delete;
+
+  Cache l2;
+  Cache l1i;
+  Cache l1d;
+};
+} // namespace mips32
@@ -74,12 +74,13 @@ void CP0::reset() noexcept
   /*
   Config3
   31 -> Config4 present -> 1
+  28 -> MSAP            -> 1
   27 -> BadInstrP       -> 1
   26 -> BadInstr        -> 1
   13 -> UserLocal       -> 1
   12                    -> 1
   */
-  config[3] = 0x8C00'2000;
+  config[3] = 0x9C00'2000;
 
   /*
   Config4
@@ -96,6 +97,20 @@ void CP0::write( std::uint32_t reg, std::uint32_t sel, std::uint32_t data ) noex
     if ( sel == 2 )
       user_local = data;
   }
+  else if ( reg == 9 )
+  {
+    if ( sel == 0 )
+      count = data;
+  }
+  else if ( reg == 11 )
+  {
+    // Acknowledges the timer interrupt: clears Cause TI and the IP bit selected by IntCtl IPTI
+    if ( sel == 0 )
+    {
+      compare = data;
+      cause &= ~( timer_interrupt | timer_ip() );
+    }
+  }
   else if ( reg == 12 )
   {
     if ( sel == 0 )
@@ -144,6 +159,14 @@ std::uint32_t CP0::read( std::uint32_t reg, std::uint32_t sel ) noexcept
     if ( sel == 0 ) return bad_vaddr;
     if ( sel == 1 ) return bad_instr;
   }
+  else if ( reg == 9 )
+  {
+    if ( sel == 0 ) return count;
+  }
+  else if ( reg == 11 )
+  {
+    if ( sel == 0 ) return compare;
+  }
   else if ( reg == 12 )
   {
     if ( sel == 0 ) return status;
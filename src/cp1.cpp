@@ -1,7 +1,6 @@
 #include "cp1.hpp"
 
 #include <cassert>
-#include <cfenv>
 #include <cmath>
 #include <cstring>
 #include <limits>
@@ -43,16 +42,53 @@ inline constexpr std::uint64_t CMP_FALSE{ 0 };
 namespace mips32
 {
 
-CP1::CP1() noexcept
+CP1::CP1( FPUBackend backend ) noexcept : backend( backend ), mxcsr( _MM_MASK_MASK ), host_mxcsr( 0 ), active( false )
 {
-  std::fexcept_t flags;
-  std::fegetenv( &env );
-  std::fesetexceptflag( &flags, FE_ALL_EXCEPT );
 }
 
-CP1::~CP1() noexcept
+void CP1::enter() noexcept
 {
-  std::fesetenv( &env );
+  assert( !active && "CP1 entered twice!" );
+
+  host_mxcsr = _mm_getcsr();
+
+  // Reloading MXCSR is slow, guests on the same thread often share it
+  if ( host_mxcsr != mxcsr )
+    _mm_setcsr( mxcsr );
+
+  active = true;
+}
+
+void CP1::leave() noexcept
+{
+  assert( active && "CP1 left without entering!" );
+
+  mxcsr = _mm_getcsr();
+
+  if ( mxcsr != host_mxcsr )
+    _mm_setcsr( host_mxcsr );
+
+  active = false;
+}
+
+void CP1::update_mxcsr( std::uint32_t mask, std::uint32_t bits ) noexcept
+{
+  mxcsr = mxcsr & ~mask | bits;
+
+  if ( active )
+    _mm_setcsr( _mm_getcsr() & ~mask | bits );
+}
+
+void CP1::restore_mxcsr() noexcept
+{
+  // A state file can hold anything, the reserved bits and the unmasked exceptions would crash the host
+  mxcsr = _MM_MASK_MASK | mxcsr & _MM_EXCEPT_MASK;
+
+  if ( active )
+    _mm_setcsr( mxcsr );
+
+  set_round_mode();
+  set_denormal_flush();
 }
 
 std::uint32_t CP1::round() const noexcept
@@ -78,42 +114,74 @@ void CP1::set_flags( std::uint32_t flag ) noexcept
 }
 void CP1::set_cause( std::uint32_t data ) noexcept
 {
-  fcsr |= ( data & 0x2F ) << 12;
+  fcsr |= ( data & 0x3F ) << 12;
+}
+
+std::uint32_t CP1::host_exceptions() const noexcept
+{
+  return exceptions_of( active ? _mm_getcsr() : mxcsr );
+}
+
+std::uint32_t CP1::exceptions_of( std::uint32_t csr ) noexcept
+{
+  std::uint32_t ex{ NONE };
+
+  if ( csr & _MM_EXCEPT_INVALID ) ex |= INVALID;
+  if ( csr & _MM_EXCEPT_DIV_ZERO ) ex |= DIVBYZERO;
+  if ( csr & _MM_EXCEPT_OVERFLOW ) ex |= OVERFLOW_;
+  if ( csr & _MM_EXCEPT_UNDERFLOW ) ex |= UNDERFLOW_;
+  if ( csr & _MM_EXCEPT_INEXACT ) ex |= INEXACT;
+
+  return ex;
+}
+
+void CP1::clear_host_exceptions() noexcept
+{
+  update_mxcsr( _MM_EXCEPT_MASK, 0 );
+}
+
+void CP1::collect_exceptions() noexcept
+{
+  // The soft backend raises its exceptions directly, the host's ones come from its fast path
+  if ( backend == FPUBackend::SOFT ) return;
+
+  auto const ex = host_exceptions();
+
+  if ( !ex ) return;
+
+  clear_host_exceptions();
+
+  set_cause( ex );
+  set_flags( ex );
 }
 
 bool CP1::handle_fpu_ex() noexcept
 {
-  if ( !std::fetestexcept( FE_ALL_EXCEPT ) ) return false;
+  // Untrapped exceptions are collected lazily
+  if ( !enable() || backend == FPUBackend::SOFT ) return false;
 
-  static constexpr std::array<std::uint32_t, 5> _flags{
-      INVALID,
-      DIVBYZERO,
-      OVERFLOW_,
-      UNDERFLOW_,
-      INEXACT,
-  };
+  auto const ex = host_exceptions();
 
-  std::uint32_t ex{ 0 };
+  if ( !ex ) return false;
 
-  switch ( std::fetestexcept( FE_ALL_EXCEPT ) )
-  {
-  case FE_INVALID: ex = 0; break;
-  case FE_DIVBYZERO: ex = 1; break;
-  case FE_OVERFLOW: ex = 2; break;
-  case FE_UNDERFLOW: ex = 3; break;
-  case FE_INEXACT: ex = 4; break;
-  }
-  std::feclearexcept( FE_ALL_EXCEPT );
+  clear_host_exceptions();
 
-  set_cause( _flags[ex] );
+  return raise( ex );
+}
 
-  if ( enable() & _flags[ex] )
+bool CP1::raise( std::uint32_t ex ) noexcept
+{
+  if ( !ex ) return false;
+
+  set_cause( ex );
+
+  if ( enable() & ex )
   {
     return true; // Trap
   }
   else
   {
-    set_cause( _flags[ex] );
+    set_flags( ex );
     return false;
   }
 }
@@ -152,29 +220,86 @@ bool valid_fmt( std::uint32_t word ) noexcept
   }
 }
 
-void CP1::set_round_mode() noexcept
+soft_float::Env CP1::soft_env() const noexcept
 {
-  switch ( round() )
-  {
-  case ROUND_NEAREST: std::fesetround( FE_TONEAREST ); break;
-  case ROUND_ZERO: std::fesetround( FE_TOWARDZERO ); break;
-  case ROUND_UP: std::fesetround( FE_UPWARD ); break;
-  case ROUND_DOWN: std::fesetround( FE_DOWNWARD ); break;
-  }
+  return { round(), ( fcsr & ( 1 << 24 ) ) != 0, 0 };
 }
 
-void CP1::set_denormal_flush() noexcept
+template<std::uint32_t Fmt, typename Operation>
+int CP1::soft_arithmetic( std::uint32_t word, Operation operation ) noexcept
 {
-  if ( fcsr & ( 1 << 24 ) )
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
+
+  auto env = soft_env();
+
+  if constexpr ( Fmt == FMT_S )
   {
-    _MM_SET_FLUSH_ZERO_MODE( _MM_FLUSH_ZERO_ON );
-    _MM_SET_DENORMALS_ZERO_MODE( _MM_DENORMALS_ZERO_ON );
+    auto const res = operation( soft_float::Binary32{}, env, fpr[_fs].i32, fpr[_ft].i32, fpr[_fd].i32 );
+    if ( raise( env.flags ) ) return 1;
+    fpr[_fd].i32 = res;
   }
   else
   {
-    _MM_SET_FLUSH_ZERO_MODE( _MM_FLUSH_ZERO_OFF );
-    _MM_SET_DENORMALS_ZERO_MODE( _MM_DENORMALS_ZERO_OFF );
+    auto const res = operation( soft_float::Binary64{}, env, fpr[_fs].i64, fpr[_ft].i64, fpr[_fd].i64 );
+    if ( raise( env.flags ) ) return 1;
+    fpr[_fd].i64 = res;
   }
+
+  return 0;
+}
+
+template<std::uint32_t Fmt, int Width>
+int CP1::soft_to_int( std::uint32_t word, std::uint32_t round ) noexcept
+{
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+
+  auto env = soft_env();
+
+  std::uint64_t res;
+
+  if constexpr ( Fmt == FMT_S )
+    res = soft_float::to_int<soft_float::Binary32, Width>( env, fpr[_fs].i32, round );
+  else
+    res = soft_float::to_int<soft_float::Binary64, Width>( env, fpr[_fs].i64, round );
+
+  if ( raise( env.flags ) ) return 1;
+
+  if constexpr ( Width == 32 )
+    fpr[_fd].i32 = std::uint32_t( res );
+  else
+    fpr[_fd].i64 = res;
+
+  return 0;
+}
+
+void CP1::set_round_mode() noexcept
+{
+  // The soft backend rounds by itself, its fast path needs the host to round to nearest
+  std::uint32_t mode{ _MM_ROUND_NEAREST };
+
+  if ( backend == FPUBackend::HOST )
+  {
+    switch ( round() )
+    {
+    case ROUND_NEAREST: mode = _MM_ROUND_NEAREST; break;
+    case ROUND_ZERO: mode = _MM_ROUND_TOWARD_ZERO; break;
+    case ROUND_UP: mode = _MM_ROUND_UP; break;
+    case ROUND_DOWN: mode = _MM_ROUND_DOWN; break;
+    }
+  }
+
+  update_mxcsr( _MM_ROUND_MASK, mode );
+}
+
+void CP1::set_denormal_flush() noexcept
+{
+  if ( fcsr & ( 1 << 24 ) && backend == FPUBackend::HOST )
+    update_mxcsr( _MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK, _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON );
+  else
+    update_mxcsr( _MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK, _MM_FLUSH_ZERO_OFF | _MM_DENORMALS_ZERO_OFF );
 }
 
 void CP1::reset() noexcept
@@ -202,6 +327,19 @@ void CP1::reset() noexcept
   */
   fcsr = 0x010C'0000;
 
+  std::memset( vpr_high.data(), 0, sizeof( std::uint64_t ) * vpr_high.size() );
+
+  /*
+  msair
+     16 -> WRP         -> 0
+  15..8 -> ProcessorID -> 0
+   7..0 -> Revision    -> 0
+  */
+  msair = 0x0000'0000;
+  msacsr = 0x0000'0000;
+
+  clear_host_exceptions();
+
   set_round_mode();
 
   set_denormal_flush();
@@ -211,6 +349,8 @@ std::uint32_t CP1::read( std::uint32_t reg ) noexcept
 {
   assert( ( reg == 0 || reg == 31 || reg == 26 || reg == 28 ) && "Unimplemented Coprocessor 1 Register." );
 
+  collect_exceptions();
+
   if ( reg == 0 )
     return fir;
   else if ( reg == 31 )
@@ -227,7 +367,11 @@ void CP1::write( std::uint32_t reg, std::uint32_t data ) noexcept
 
   if ( reg == 0 )
     return; // fir is read only
-  else if ( reg == 31 )
+
+  // The pending exceptions happened before the write, they must not trap afterwards
+  collect_exceptions();
+
+  if ( reg == 31 )
     fcsr = fcsr & ~0x0163'FFFF | data & 0x0163'FFFF;
   else if ( reg == 26 )
     fcsr = fcsr & ~0x0003'F07C | data & 0x0003'F07C;
@@ -239,164 +383,175 @@ void CP1::write( std::uint32_t reg, std::uint32_t data ) noexcept
   set_denormal_flush();
 }
 
+template<std::uint32_t Fmt>
+constexpr std::array<CP1::Handler, 64> CP1::function_table() noexcept
+{
+  if constexpr ( Fmt == FMT_S || Fmt == FMT_D )
+    return {
+      &CP1::add<Fmt>,
+      &CP1::sub<Fmt>,
+      &CP1::mul<Fmt>,
+      &CP1::div<Fmt>,
+      &CP1::sqrt<Fmt>,
+      &CP1::abs<Fmt>,
+      &CP1::mov<Fmt>,
+      &CP1::neg<Fmt>,
+      &CP1::round_l<Fmt>,
+      &CP1::trunc_l<Fmt>,
+      &CP1::ceil_l<Fmt>,
+      &CP1::floor_l<Fmt>,
+      &CP1::round_w<Fmt>,
+      &CP1::trunc_w<Fmt>,
+      &CP1::ceil_w<Fmt>,
+      &CP1::floor_w<Fmt>,
+      &CP1::sel<Fmt>,
+      &CP1::reserved, // MOVCF
+      &CP1::reserved, // MOVZ
+      &CP1::reserved, // MOVN
+      &CP1::seleqz<Fmt>,
+      &CP1::recip<Fmt>,
+      &CP1::rsqrt<Fmt>,
+      &CP1::selnez<Fmt>,
+      &CP1::maddf<Fmt>,
+      &CP1::msubf<Fmt>,
+      &CP1::rint<Fmt>,
+      &CP1::class_<Fmt>,
+      &CP1::min<Fmt>,
+      &CP1::max<Fmt>,
+      &CP1::mina<Fmt>,
+      &CP1::maxa<Fmt>,
+      &CP1::cvt_s<Fmt>,
+      &CP1::cvt_d<Fmt>,
+      &CP1::reserved, // *
+      &CP1::reserved, // *
+      &CP1::cvt_w<Fmt>,
+      &CP1::cvt_l<Fmt>,
+      &CP1::reserved, // *
+      &CP1::reserved, // *
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      // Pre-Release 6 c.condn.fmt
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+    };
+  else
+    return {
+      &CP1::cmp_af<Fmt>,
+      &CP1::cmp_un<Fmt>,
+      &CP1::cmp_eq<Fmt>,
+      &CP1::cmp_ueq<Fmt>,
+      &CP1::cmp_lt<Fmt>,
+      &CP1::cmp_ult<Fmt>,
+      &CP1::cmp_le<Fmt>,
+      &CP1::cmp_ule<Fmt>,
+      &CP1::unimplemented, // CMP.SAF.fmt
+      &CP1::unimplemented, // CMP.SUN.fmt
+      &CP1::unimplemented, // CMP.SEQ.fmt
+      &CP1::unimplemented, // CMP.SUEQ.fmt
+      &CP1::unimplemented, // CMP.SLT.fmt
+      &CP1::unimplemented, // CMP.SULT.fmt
+      &CP1::unimplemented, // CMP.SLE.fmt
+      &CP1::unimplemented, // CMP.SULE.fmt
+      &CP1::reserved,
+      &CP1::cmp_or<Fmt>,
+      &CP1::cmp_une<Fmt>,
+      &CP1::cmp_ne<Fmt>,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::unimplemented, // CMP.SOR.FMT
+      &CP1::unimplemented, // CMP.SUNE.FMT
+      &CP1::unimplemented, // CMP.SNE.FMT
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::cvt_s<Fmt>,
+      &CP1::cvt_d<Fmt>,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved, // CVT.PS.PW
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+      &CP1::reserved,
+    };
+}
+
 CP1::Exception CP1::execute( std::uint32_t word ) noexcept
 {
   assert( ( ( ( word & 0xFC00'0000 ) >> 26 ) == 0b010001 ) && "Invalid Opcode!" );
 
   assert( valid_fmt( word ) && "Invalid format!" );
 
-  static constexpr std::array<int ( CP1::* )( std::uint32_t ) noexcept, 64>
-    fmt_S_D_fn_table{
-        &CP1::add,
-        &CP1::sub,
-        &CP1::mul,
-        &CP1::div,
-        &CP1::sqrt,
-        &CP1::abs,
-        &CP1::mov,
-        &CP1::neg,
-        &CP1::round_l,
-        &CP1::trunc_l,
-        &CP1::ceil_l,
-        &CP1::floor_l,
-        &CP1::round_w,
-        &CP1::trunc_w,
-        &CP1::ceil_w,
-        &CP1::floor_w,
-        &CP1::sel,
-        &CP1::reserved, // MOVCF
-        &CP1::reserved, // MOVZ
-        &CP1::reserved, // MOVN
-        &CP1::seleqz,
-        &CP1::recip,
-        &CP1::rsqrt,
-        &CP1::selnez,
-        &CP1::maddf,
-        &CP1::msubf,
-        &CP1::rint,
-        &CP1::class_,
-        &CP1::min,
-        &CP1::max,
-        &CP1::mina,
-        &CP1::maxa,
-        &CP1::cvt_s,
-        &CP1::cvt_d,
-        &CP1::reserved, // *
-        &CP1::reserved, // *
-        &CP1::cvt_w,
-        &CP1::cvt_l,
-        &CP1::reserved, // *
-        &CP1::reserved, // *
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        // Pre-Release 6 c.condn.fmt
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-  };
+  // One row of 64 functions for each format: S, D, W and L
+  static constexpr auto fn_table = [] {
+    std::array<Handler, 4 * 64> table{};
+    std::array<std::array<Handler, 64>, 4> const rows{
+      function_table<FMT_S>(),
+      function_table<FMT_D>(),
+      function_table<FMT_W>(),
+      function_table<FMT_L>(),
+    };
 
-  static constexpr std::array<int ( CP1::* )( std::uint32_t ) noexcept, 64>
-    fmt_W_L_fn_table{
-        &CP1::cmp_af,
-        &CP1::cmp_un,
-        &CP1::cmp_eq,
-        &CP1::cmp_ueq,
-        &CP1::cmp_lt,
-        &CP1::cmp_ult,
-        &CP1::cmp_le,
-        &CP1::cmp_ule,
-        &CP1::unimplemented, // CMP.SAF.fmt
-        &CP1::unimplemented, // CMP.SUN.fmt
-        &CP1::unimplemented, // CMP.SEQ.fmt
-        &CP1::unimplemented, // CMP.SUEQ.fmt
-        &CP1::unimplemented, // CMP.SLT.fmt
-        &CP1::unimplemented, // CMP.SULT.fmt
-        &CP1::unimplemented, // CMP.SLE.fmt
-        &CP1::unimplemented, // CMP.SULE.fmt
-        &CP1::reserved,
-        &CP1::cmp_or,
-        &CP1::cmp_une,
-        &CP1::cmp_ne,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::unimplemented, // CMP.SOR.FMT
-        &CP1::unimplemented, // CMP.SUNE.FMT
-        &CP1::unimplemented, // CMP.SNE.FMT
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::cvt_s,
-        &CP1::cvt_d,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved, // CVT.PS.PW
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-        &CP1::reserved,
-  };
+    for ( std::size_t i = 0; i < table.size(); ++i )
+      table[i] = rows[i / 64][i % 64];
 
-  int v;
+    return table;
+  }();
 
-  switch ( fmt( word ) )
-  {
-  default:
+  if ( !valid_fmt( word ) )
     return RESERVED;
-  case FMT_S:
-  case FMT_D:
-    v = ( this->*fmt_S_D_fn_table[word & FUNCTION] )( word );
-    break;
-  case FMT_W:
-  case FMT_L:
-    v = ( this->*fmt_W_L_fn_table[word & FUNCTION] )( word );
-    break;
-  }
+
+  // S, D, W and L differ in bits 0 and 2 of fmt
+  auto const row = ( word >> 21 & 0b001 ) | ( word >> 22 & 0b010 );
+
+  int const v = ( this->*fn_table[row << 6 | word & FUNCTION] )( word );
 
   if ( v == 1 )
   {
@@ -445,8 +600,16 @@ int CP1::unimplemented( std::uint32_t ) noexcept
   return 1;
 }
 
+template<std::uint32_t Fmt>
 int CP1::add( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::add<F>( env, a, b );
+    } );
+
   auto _add = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -454,20 +617,26 @@ int CP1::add( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fs].*t + this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _add( &FPR::f );
   else
     return _add( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::sub( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::sub<F>( env, a, b );
+    } );
+
   auto _sub = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -475,21 +644,27 @@ int CP1::sub( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fs].*t - this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _sub( &FPR::f );
   else
     return _sub( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::mul( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::mul<F>( env, a, b );
+    } );
+
   auto _mul = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -497,21 +672,27 @@ int CP1::mul( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fs].*t * this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _mul( &FPR::f );
   else
     return _mul( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::div( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::div<F>( env, a, b );
+    } );
+
   auto _div = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -519,22 +700,26 @@ int CP1::div( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fs].*t / this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _div( &FPR::f );
   else
     return _div( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::sqrt( std::uint32_t word ) noexcept
 {
-  auto const _fmt = fmt( word );
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto, auto )
+    {
+      using F = decltype( format );
+      return soft_float::sqrt<F>( env, a );
+    } );
 
   auto _sqrt = [ this, word ] ( auto t )
   {
@@ -542,17 +727,17 @@ int CP1::sqrt( std::uint32_t word ) noexcept
     auto const _fs = fs( word );
 
     auto const res = std::sqrt( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _sqrt( &FPR::f );
   else
     return _sqrt( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::abs( std::uint32_t word ) noexcept
 {
   auto _abs = [ this, word ] ( auto t )
@@ -561,19 +746,18 @@ int CP1::abs( std::uint32_t word ) noexcept
     auto const _fs = fs( word );
 
     auto const res = std::fabs( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _abs( &FPR::f );
   else
     return _abs( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::mov( std::uint32_t word ) noexcept
 {
   auto _mov = [ this, word ] ( auto t )
@@ -582,19 +766,18 @@ int CP1::mov( std::uint32_t word ) noexcept
     auto const _fs = fs( word );
 
     auto const res = this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _mov( &FPR::f );
   else
     return _mov( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::neg( std::uint32_t word ) noexcept
 {
   auto _neg = [ this, word ] ( auto t )
@@ -603,187 +786,202 @@ int CP1::neg( std::uint32_t word ) noexcept
     auto const _fs = fs( word );
 
     auto const res = -( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _neg( &FPR::f );
   else
     return _neg( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::round_l( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 64>( word, soft_float::NEAREST );
+
   auto _round_l = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = std::llround( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i64 = std::uint64_t( res );
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _round_l( &FPR::f );
   else
     return _round_l( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::trunc_l( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 64>( word, soft_float::ZERO );
+
   auto _trunc_l = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint64_t )std::trunc( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i64 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _trunc_l( &FPR::f );
   else
     return _trunc_l( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::ceil_l( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 64>( word, soft_float::UP );
+
   auto _ceil_l = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint64_t )std::ceil( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i64 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _ceil_l( &FPR::f );
   else
     return _ceil_l( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::floor_l( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 64>( word, soft_float::DOWN );
+
   auto _floor_l = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint64_t )std::floor( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i64 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _floor_l( &FPR::f );
   else
     return _floor_l( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::round_w( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 32>( word, soft_float::NEAREST );
+
   auto _round_w = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = std::lround( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i32 = std::uint32_t( res );
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _round_w( &FPR::f );
   else
     return _round_w( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::trunc_w( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 32>( word, soft_float::ZERO );
+
   auto _trunc_w = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint32_t )std::trunc( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i32 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _trunc_w( &FPR::f );
   else
     return _trunc_w( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::ceil_w( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 32>( word, soft_float::UP );
+
   auto _ceil_w = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint32_t )std::ceil( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i32 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _ceil_w( &FPR::f );
   else
     return _ceil_w( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::floor_w( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 32>( word, soft_float::DOWN );
+
   auto _floor_w = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint32_t )std::floor( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i32 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _floor_w( &FPR::f );
   else
     return _floor_w( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::sel( std::uint32_t word ) noexcept
 {
   auto _sel = [ this, word ] ( auto t, auto i )
@@ -793,19 +991,18 @@ int CP1::sel( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fd].*i & 0x1 ? this->fpr[_ft].*t : this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _sel( &FPR::f, &FPR::i32 );
   else
     return _sel( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::seleqz( std::uint32_t word ) noexcept
 {
   auto _seleqz = [ this, word ] ( auto t, auto i )
@@ -815,61 +1012,72 @@ int CP1::seleqz( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_ft].*i & 0x1 ? 0 : this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _seleqz( &FPR::f, &FPR::i32 );
   else
     return _seleqz( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::recip( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto, auto )
+    {
+      using F = decltype( format );
+      return soft_float::div<F>( env, F::one, a );
+    } );
+
   auto _recip = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = MIPS32_STATIC_CAST( t, 1.0 ) / this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _recip( &FPR::f );
   else
     return _recip( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::rsqrt( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto, auto )
+    {
+      using F = decltype( format );
+      return soft_float::div<F>( env, F::one, soft_float::sqrt<F>( env, a ) );
+    } );
+
   auto _rsqrt = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = 1.0f / std::sqrt( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _rsqrt( &FPR::f );
   else
     return _rsqrt( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::selnez( std::uint32_t word ) noexcept
 {
   auto _selnez = [ this, word ] ( auto t, auto i )
@@ -879,21 +1087,27 @@ int CP1::selnez( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_ft].*i & 0x1 ? this->fpr[_fs].*t : 0;
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _selnez( &FPR::f, &FPR::i32 );
   else
     return _selnez( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::maddf( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto c )
+    {
+      using F = decltype( format );
+      return soft_float::fma<F>( env, a, b, c );
+    } );
+
   auto _maddf = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -901,21 +1115,27 @@ int CP1::maddf( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = std::fma( this->fpr[_fs].*t, this->fpr[_ft].*t, this->fpr[_fd].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _maddf( &FPR::f );
   else
     return _maddf( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::msubf( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto c )
+    {
+      using F = decltype( format );
+      return soft_float::fma<F>( env, a, b, c, true );
+    } );
+
   auto _msubf = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -923,40 +1143,45 @@ int CP1::msubf( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = this->fpr[_fd].*t - ( this->fpr[_fs].*t / this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _msubf( &FPR::f );
   else
     return _msubf( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::rint( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto, auto )
+    {
+      using F = decltype( format );
+      return soft_float::round_to_integral<F>( env, a );
+    } );
+
   auto _rint = [ this, word ] ( auto t, auto i )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = MIPS32_STATIC_CAST( i, std::llrint( this->fpr[_fs].*t ) );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*i = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _rint( &FPR::f, &FPR::i32 );
   else
     return _rint( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::class_( std::uint32_t word ) noexcept
 {
   /*
@@ -1011,15 +1236,21 @@ int CP1::class_( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _classify( &FPR::f, &FPR::i32 );
   else
     return _classify( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::min( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::min<F>( env, a, b );
+    } );
+
   auto _min = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -1027,21 +1258,27 @@ int CP1::min( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = std::fmin( this->fpr[_fs].*t, this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _min( &FPR::f );
   else
     return _min( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::max( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::max<F>( env, a, b );
+    } );
+
   auto _max = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -1049,21 +1286,27 @@ int CP1::max( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = std::fmax( this->fpr[_fs].*t, this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _max( &FPR::f );
   else
     return _max( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::mina( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::mina<F>( env, a, b );
+    } );
+
   auto _mina = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -1071,21 +1314,27 @@ int CP1::mina( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = std::fmin( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _mina( &FPR::f );
   else
     return _mina( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::maxa( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_arithmetic<Fmt>( word, [] ( auto format, auto &env, auto a, auto b, auto )
+    {
+      using F = decltype( format );
+      return soft_float::maxa<F>( env, a, b );
+    } );
+
   auto _maxa = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
@@ -1093,21 +1342,40 @@ int CP1::maxa( std::uint32_t word ) noexcept
     auto const _ft = ft( word );
 
     auto const res = std::fmax( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].*t = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _maxa( &FPR::f );
   else
     return _maxa( &FPR::d );
 }
+template<std::uint32_t Fmt>
 int CP1::cvt_s( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+  {
+    auto const _fs = fs( word );
+
+    auto env = soft_env();
+
+    std::uint32_t res;
+    if constexpr ( Fmt == FMT_D )
+      res = soft_float::convert<soft_float::Binary64, soft_float::Binary32>( env, fpr[_fs].i64 );
+    else if constexpr ( Fmt == FMT_W )
+      res = soft_float::from_int<soft_float::Binary32>( env, std::int32_t( fpr[_fs].i32 ) );
+    else
+      res = soft_float::from_int<soft_float::Binary32>( env, std::int64_t( fpr[_fs].i64 ) );
+
+    if ( raise( env.flags ) ) return 1;
+    fpr[fd( word )].i32 = res;
+
+    return 0;
+  }
+
   auto _cvt_s = [ this, word ] ( auto t, int raw_data_type )
   {
     auto const _fd = fd( word );
@@ -1122,23 +1390,42 @@ int CP1::cvt_s( std::uint32_t word ) noexcept
     else
       res = ( float )( std::int64_t )( this->fpr[_fs].*t );
 
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].f = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_D )
+  if constexpr ( Fmt == FMT_D )
     return _cvt_s( &FPR::d, 0 );
-  else if ( _fmt == FMT_W )
+  else if constexpr ( Fmt == FMT_W )
     return _cvt_s( &FPR::i32, 1 );
   else
     return _cvt_s( &FPR::i64, 2 );
 }
+template<std::uint32_t Fmt>
 int CP1::cvt_d( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+  {
+    auto const _fs = fs( word );
+
+    auto env = soft_env();
+
+    std::uint64_t res;
+    if constexpr ( Fmt == FMT_S )
+      res = soft_float::convert<soft_float::Binary32, soft_float::Binary64>( env, fpr[_fs].i32 );
+    else if constexpr ( Fmt == FMT_W )
+      res = soft_float::from_int<soft_float::Binary64>( env, std::int32_t( fpr[_fs].i32 ) );
+    else
+      res = soft_float::from_int<soft_float::Binary64>( env, std::int64_t( fpr[_fs].i64 ) );
+
+    if ( raise( env.flags ) ) return 1;
+    fpr[fd( word )].i64 = res;
+
+    return 0;
+  }
+
   auto _cvt_d = [ this, word ] ( auto t, int raw_data_type )
   {
     auto const _fd = fd( word );
@@ -1152,63 +1439,66 @@ int CP1::cvt_d( std::uint32_t word ) noexcept
     else
       res = ( double )( std::int64_t )( this->fpr[_fs].*t );
 
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].d = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
+  if constexpr ( Fmt == FMT_S )
     return _cvt_d( &FPR::f, 0 );
-  else if ( _fmt == FMT_W )
+  else if constexpr ( Fmt == FMT_W )
     return _cvt_d( &FPR::i32, 1 );
   else
     return _cvt_d( &FPR::i64, 2 );
 }
+template<std::uint32_t Fmt>
 int CP1::cvt_l( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 64>( word, round() );
+
   auto _cvt_l = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint64_t )( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i64 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_D )
+  if constexpr ( Fmt == FMT_D )
     return _cvt_l( &FPR::d );
   else
     return _cvt_l( &FPR::f );
 }
+template<std::uint32_t Fmt>
 int CP1::cvt_w( std::uint32_t word ) noexcept
 {
+  if ( backend == FPUBackend::SOFT )
+    return soft_to_int<Fmt, 32>( word, round() );
+
   auto _cvt_w = [ this, word ] ( auto t )
   {
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
     auto const res = ( std::uint32_t )( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
+    if ( handle_fpu_ex( res ) ) return 1;
     this->fpr[_fd].i32 = res;
 
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_D )
+  if constexpr ( Fmt == FMT_D )
     return _cvt_w( &FPR::d );
   else
     return _cvt_w( &FPR::f );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_af( std::uint32_t word ) noexcept
 {
   auto _cmp_af = [ this, word ] ( auto i )
@@ -1220,13 +1510,12 @@ int CP1::cmp_af( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_af( &FPR::i32 );
   else
     return _cmp_af( &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_un( std::uint32_t word ) noexcept
 {
   auto _cmp_un = [ this, word ] ( auto t, auto i )
@@ -1243,13 +1532,12 @@ int CP1::cmp_un( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_un( &FPR::f, &FPR::i32 );
   else
     return _cmp_un( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_eq( std::uint32_t word ) noexcept
 {
   auto _cmp_eq = [ this, word ] ( auto t, auto i )
@@ -1263,13 +1551,12 @@ int CP1::cmp_eq( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_eq( &FPR::f, &FPR::i32 );
   else
     return _cmp_eq( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_ueq( std::uint32_t word ) noexcept
 {
   auto _cmp_ueq = [ this, word ] ( auto t, auto i )
@@ -1284,13 +1571,12 @@ int CP1::cmp_ueq( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_ueq( &FPR::f, &FPR::i32 );
   else
     return _cmp_ueq( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_lt( std::uint32_t word ) noexcept
 {
   auto _cmp_lt = [ this, word ] ( auto t, auto i )
@@ -1304,13 +1590,12 @@ int CP1::cmp_lt( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_lt( &FPR::f, &FPR::i32 );
   else
     return _cmp_lt( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_ult( std::uint32_t word ) noexcept
 {
   auto _cmp_ult = [ this, word ] ( auto t, auto i )
@@ -1325,17 +1610,14 @@ int CP1::cmp_ult( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_ult( &FPR::f, &FPR::i32 );
   else
     return _cmp_ult( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_le( std::uint32_t word ) noexcept
 {
-  auto const _fmt = fmt( word );
-
   auto _cmp_le = [ this, word ] ( auto t, auto i )
   {
     auto const _fd = fd( word );
@@ -1346,12 +1628,12 @@ int CP1::cmp_le( std::uint32_t word ) noexcept
 
     return 0;
   };
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_le( &FPR::f, &FPR::i32 );
   else
     return _cmp_le( &FPR::d, &FPR::i64 );
 }
+template<std::uint32_t Fmt>
 int CP1::cmp_ule( std::uint32_t word ) noexcept
 {
   auto _cmp_ule = [ this, word ] ( auto t, auto i )
@@ -1366,14 +1648,13 @@ int CP1::cmp_ule( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_ule( &FPR::f, &FPR::i32 );
   else
     return _cmp_ule( &FPR::d, &FPR::i64 );
 }
 
+template<std::uint32_t Fmt>
 int CP1::cmp_or( std::uint32_t word ) noexcept
 {
   auto _cmp_or = [ this, word ] ( auto t, auto i )
@@ -1390,14 +1671,13 @@ int CP1::cmp_or( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_or( &FPR::f, &FPR::i32 );
   else
     return _cmp_or( &FPR::d, &FPR::i64 );
 }
 
+template<std::uint32_t Fmt>
 int CP1::cmp_une( std::uint32_t word ) noexcept
 {
   auto _cmp_une = [ this, word ] ( auto t, auto i )
@@ -1414,14 +1694,13 @@ int CP1::cmp_une( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_une( &FPR::f, &FPR::i32 );
   else
     return _cmp_une( &FPR::d, &FPR::i64 );
 }
 
+template<std::uint32_t Fmt>
 int CP1::cmp_ne( std::uint32_t word ) noexcept
 {
   auto _cmp_ne = [ this, word ] ( auto t, auto i )
@@ -1438,9 +1717,7 @@ int CP1::cmp_ne( std::uint32_t word ) noexcept
     return 0;
   };
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
+  if constexpr ( Fmt == CMP_FMT_S )
     return _cmp_ne( &FPR::f, &FPR::i32 );
   else
     return _cmp_ne( &FPR::d, &FPR::i64 );
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <mips32/fpr.hpp>
+#include <mips32/fpu_backend.hpp>
+#include "soft_float.hpp"
 
 #include <array>
-#include <cfenv>
 #include <cstdint>
 
+#include <emmintrin.h>
+
 namespace mips32
 {
 
@@ -14,22 +17,37 @@ namespace mips32
  *
  * Has 32 register of 64-bit width.
  *
- * It heavily relies on the hardware FPU,
+ * With FPUBackend::HOST it heavily relies on the hardware FPU,
  * so every calculation is IEEE 754 compliant
  * based on the hardware FPU compliance itself.
+ *
+ * With FPUBackend::SOFT the instructions that round are computed by `soft_float`.
+ *
+ * The host's FPU is configured through MXCSR, which belongs to the thread:
+ * while a CP1 is not running its MXCSR is kept in memory,
+ * `enter()` loads it and `leave()` gives the thread back its own,
+ * so many CP1 can take turns on the same thread.
+ *
+ * It also implements the MIPS SIMD Architecture (MSA):
+ * the 32 vector registers are 128-bit wide and share their lower half with the FPRs.
  **/
 class CP1
 {
   friend class MachineInspector;
 
 public:
-  CP1() noexcept;
-
-  ~CP1() noexcept;
+  explicit CP1( FPUBackend backend = FPUBackend::HOST ) noexcept;
 
   // Resets the FPU to its default state.
   void reset() noexcept;
 
+  // Loads this FPU's MXCSR on the calling thread, saving the thread's one.
+  // Instructions must be executed between `enter()` and `leave()`.
+  void enter() noexcept;
+
+  // Saves this FPU's MXCSR and restores the one the thread had on `enter()`.
+  void leave() noexcept;
+
   // Reads a FPU's register.
   std::uint32_t read( std::uint32_t reg ) noexcept;
 
@@ -61,6 +79,19 @@ public:
   void mtc1( std::uint32_t reg, std::uint32_t word ) noexcept;
   void mthc1( std::uint32_t reg, std::uint32_t word ) noexcept;
 
+  // Execute an MSA instruction, `gpr` are the CPU's registers.
+  // Returns the exceptions that trapped, as MSACSR's Cause field.
+  Exception execute_msa( std::uint32_t word, std::array<std::uint32_t, 32> &gpr ) noexcept;
+
+  // Returns true if the MSA branch `word` (BZ.V, BNZ.V, BZ.df, BNZ.df) is taken.
+  bool msa_condition( std::uint32_t word ) noexcept;
+
+  // Move operations of the vector registers, used by LD.df and ST.df.
+  // Words are in memory order, the first one is the least significant.
+
+  std::array<std::uint32_t, 4> read_vector( std::uint32_t reg ) noexcept;
+  void                         write_vector( std::uint32_t reg, std::array<std::uint32_t, 4> const &words ) noexcept;
+
 private:
 // Set the underlying FPU rounding mode based on the RN field in FCSR.
   void set_round_mode() noexcept;
@@ -81,61 +112,150 @@ private:
   // Check if the FPU raised any exception and
   // sets the needed flags in the cause field.
   // Returns true to signal a trap.
+  //
+  // While every exception is disabled nothing can trap,
+  // the host FPU keeps accumulating them until `collect_exceptions` is called.
   bool handle_fpu_ex() noexcept;
 
+  // Signals the exceptions `ex` in the cause field,
+  // the ones not enabled are accumulated in the flags field.
+  // Returns true to signal a trap.
+  bool raise( std::uint32_t ex ) noexcept;
+
+  // Same as `handle_fpu_ex()`, `res` is the operation's result.
+  // Storing it to a volatile forces the operation to complete before the host flags are read,
+  // otherwise the compiler may move it past the check.
+  template<typename T>
+  bool handle_fpu_ex( T const &res ) noexcept
+  {
+    volatile T materialized = res;
+    ( void )materialized;
+    return handle_fpu_ex();
+  }
+
+  // Exceptions raised by the host FPU, as FCSR bits (see `Exception`)
+  std::uint32_t host_exceptions() const noexcept;
+
+  // Exceptions in `csr`, a value of MXCSR, as FCSR bits
+  static std::uint32_t exceptions_of( std::uint32_t csr ) noexcept;
+
+  // Clears the exceptions raised by the host FPU.
+  void clear_host_exceptions() noexcept;
+
+  // Replaces the `mask` bits of MXCSR with `bits`, on the thread too if running.
+  void update_mxcsr( std::uint32_t mask, std::uint32_t bits ) noexcept;
+
+  // Rebuilds MXCSR from FCSR after a restore, only the exception flags of the restored value are kept.
+  void restore_mxcsr() noexcept;
+
+  // Moves the exceptions accumulated by the host FPU into the Cause and Flags fields.
+  // Called before FCSR can be observed: reads and writes of the control registers,
+  // inspection and state saving.
+  void collect_exceptions() noexcept;
+
+  // Rounding mode and flushing of the soft backend, from FCSR
+  soft_float::Env soft_env() const noexcept;
+
+  // Executes `operation( format, env, fs, ft, fd )` on the raw registers with the soft backend,
+  // the result is written to `fd` if it doesn't trap.
+  template<std::uint32_t Fmt, typename Operation>
+  int soft_arithmetic( std::uint32_t word, Operation operation ) noexcept;
+
+  // Converts `fs` to an integer of `Width` bits with the soft backend
+  template<std::uint32_t Fmt, int Width>
+  int soft_to_int( std::uint32_t word, std::uint32_t round ) noexcept;
+
   /****************
    *              *
    * INSTRUCTIONS *
    *              *
    ****************/
 
+  using Handler = int ( CP1::* )( std::uint32_t ) noexcept;
+
+  // Handlers of the instructions with format `Fmt`, indexed by their function field.
+  template<std::uint32_t Fmt>
+  static constexpr std::array<Handler, 64> function_table() noexcept;
+
   int reserved( std::uint32_t word ) noexcept;
   int unimplemented( std::uint32_t word ) noexcept;
 
-  int add( std::uint32_t word ) noexcept;
-  int sub( std::uint32_t word ) noexcept;
-  int mul( std::uint32_t word ) noexcept;
-  int div( std::uint32_t word ) noexcept;
-  int sqrt( std::uint32_t word ) noexcept;
-  int abs( std::uint32_t word ) noexcept;
-  int mov( std::uint32_t word ) noexcept;
-  int neg( std::uint32_t word ) noexcept;
-  int round_l( std::uint32_t word ) noexcept;
-  int trunc_l( std::uint32_t word ) noexcept;
-  int ceil_l( std::uint32_t word ) noexcept;
-  int floor_l( std::uint32_t word ) noexcept;
-  int round_w( std::uint32_t word ) noexcept;
-  int trunc_w( std::uint32_t word ) noexcept;
-  int ceil_w( std::uint32_t word ) noexcept;
-  int floor_w( std::uint32_t word ) noexcept;
-  int sel( std::uint32_t word ) noexcept;
-  int seleqz( std::uint32_t word ) noexcept;
-  int recip( std::uint32_t word ) noexcept;
-  int rsqrt( std::uint32_t word ) noexcept;
-  int selnez( std::uint32_t word ) noexcept;
-  int maddf( std::uint32_t word ) noexcept;
-  int msubf( std::uint32_t word ) noexcept;
-  int rint( std::uint32_t word ) noexcept;
-  int class_( std::uint32_t word ) noexcept;
-  int min( std::uint32_t word ) noexcept;
-  int max( std::uint32_t word ) noexcept;
-  int mina( std::uint32_t word ) noexcept;
-  int maxa( std::uint32_t word ) noexcept;
-  int cvt_s( std::uint32_t word ) noexcept;
-  int cvt_d( std::uint32_t word ) noexcept;
-  int cvt_l( std::uint32_t word ) noexcept;
-  int cvt_w( std::uint32_t word ) noexcept;
-  int cmp_af( std::uint32_t word ) noexcept;
-  int cmp_un( std::uint32_t word ) noexcept;
-  int cmp_eq( std::uint32_t word ) noexcept;
-  int cmp_ueq( std::uint32_t word ) noexcept;
-  int cmp_lt( std::uint32_t word ) noexcept;
-  int cmp_ult( std::uint32_t word ) noexcept;
-  int cmp_le( std::uint32_t word ) noexcept;
-  int cmp_ule( std::uint32_t word ) noexcept;
-  int cmp_or( std::uint32_t word ) noexcept;
-  int cmp_une( std::uint32_t word ) noexcept;
-  int cmp_ne( std::uint32_t word ) noexcept;
+  // `Fmt` is the format field of the instruction, the handlers are specialized for it
+
+  template<std::uint32_t Fmt> int add( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int sub( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int mul( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int div( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int sqrt( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int abs( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int mov( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int neg( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int round_l( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int trunc_l( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int ceil_l( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int floor_l( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int round_w( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int trunc_w( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int ceil_w( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int floor_w( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int sel( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int seleqz( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int recip( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int rsqrt( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int selnez( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int maddf( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int msubf( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int rint( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int class_( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int min( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int max( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int mina( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int maxa( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cvt_s( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cvt_d( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cvt_l( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cvt_w( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_af( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_un( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_eq( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_ueq( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_lt( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_ult( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_le( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_ule( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_or( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_une( std::uint32_t word ) noexcept;
+  template<std::uint32_t Fmt> int cmp_ne( std::uint32_t word ) noexcept;
+
+  /*******
+   *     *
+   * MSA *
+   *     *
+   *******/
+
+  // Reads and writes a whole vector register.
+  __m128i load_vr( std::uint32_t reg ) const noexcept;
+  void    store_vr( std::uint32_t reg, __m128i value ) noexcept;
+
+  // MXCSR with the rounding mode and flushing of MSACSR, every exception masked
+  std::uint32_t msa_mxcsr() const noexcept;
+
+  // Same as `raise()` for MSACSR.
+  bool msa_raise( std::uint32_t ex ) noexcept;
+
+  // Computes `operation( ex )` with the MSA's MXCSR, the result is written to `reg` if it doesn't trap.
+  // `ex` are the exceptions the operation detects itself.
+  template<typename Operation>
+  int msa_fp( std::uint32_t reg, Operation operation ) noexcept;
+
+  // Handlers of each instruction format: 0 on success, 1 on trap, -1 if reserved
+
+  int msa_i8( std::uint32_t word ) noexcept;
+  int msa_immediate( std::uint32_t word ) noexcept;
+  int msa_3r( std::uint32_t word, std::array<std::uint32_t, 32> const &gpr ) noexcept;
+  int msa_elm( std::uint32_t word, std::array<std::uint32_t, 32> &gpr ) noexcept;
+  int msa_3rf( std::uint32_t word ) noexcept;
+  int msa_vec_2r( std::uint32_t word, std::array<std::uint32_t, 32> const &gpr ) noexcept;
 
   /* Signaling NaN is not supported
   int cabs_saf( std::uint32_t word ) noexcept;
@@ -152,8 +272,16 @@ private:
 
   std::uint32_t fir, fcsr;
 
-  // Floating Point Environment
-  std::fenv_t env;
+  // Upper 64 bits of the vector registers, the lower ones are `fpr`
+  std::array<std::uint64_t, 32> vpr_high;
+
+  std::uint32_t msair, msacsr;
+
+  FPUBackend backend;
+
+  // MXCSR of this FPU and the thread's one, saved while between `enter()` and `leave()`
+  std::uint32_t mxcsr, host_mxcsr;
+  bool          active;
 };
 
 } // namespace mips32
@@ -1,5 +1,6 @@
 #include "cpu.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace mips32
@@ -32,7 +33,12 @@ constexpr int _sign_extend{ -_zero_extend };
 constexpr int _byte{ 0x9876 };
 constexpr int _halfword{ -_byte };
 
-CPU::CPU( RAM &ram ) noexcept : string_handler( ram ), mmu( ram, fixed_mapping_segments ) {}
+CPU::CPU( RAM &ram, FPUBackend fpu_backend ) noexcept
+  : string_handler( ram ), mmu( ram, fixed_mapping_segments ), cp1( fpu_backend )
+{
+  ram.zero_fill( heap_begin, heap_end );
+  set_timing_model( {} );
+}
 
 IODevice * CPU::attach_iodevice( IODevice * device ) noexcept
 {
@@ -48,13 +54,33 @@ FileHandler * CPU::attach_file_handler( FileHandler * handler ) noexcept
   return old;
 }
 
+Profiler * CPU::attach_profiler( Profiler * profiler ) noexcept
+{
+  auto * old = this->profiler;
+  this->profiler = profiler;
+  until_sample = profiler ? profiler->interval : 0;
+  return old;
+}
+
+MemoryTracer * CPU::attach_tracer( MemoryTracer * tracer ) noexcept
+{
+  auto * old = this->tracer;
+  this->tracer = tracer;
+  return old;
+}
+
 std::uint32_t CPU::start() noexcept
 {
+  if ( waiting_io() )
+    return WAITING_IO;
+
   exit_code.store( NONE, std::memory_order_release );
 
+  cp1.enter();
+
   while ( exit_code.load( std::memory_order_acquire ) == NONE )
   {
-    auto const *const word = mmu.access( pc, running_mode() );
+    auto const *const word = mmu.access( pc, running_mode(), MMU::Access::FETCH );
 
     // fetch
     if ( pc & 0b11 || !word )
@@ -64,12 +90,23 @@ std::uint32_t CPU::start() noexcept
     }
 
     // execute
-    pc += 4;
+    auto const next = pc + 4;
+
+    trace( MemoryTracer::Kind::FETCH, pc, 4 );
+    count( *word );
+    profile();
+    cycles += opcode_cycles[opcode( *word )];
+    pc = next;
     ( this->*function_table[opcode( *word )] )( *word );
 
     gpr[0] = 0;
+
+    if ( pc != next && cycles >= next_event )
+      events();
   }
 
+  cp1.leave();
+
   return exit_code.load( std::memory_order_acquire );
 }
 
@@ -80,9 +117,14 @@ void CPU::stop() noexcept
 
 std::uint32_t CPU::single_step() noexcept
 {
+  if ( waiting_io() )
+    return WAITING_IO;
+
   exit_code.store( NONE, std::memory_order_release );
 
-  auto * word = mmu.access( pc, running_mode() );
+  cp1.enter();
+
+  auto * word = mmu.access( pc, running_mode(), MMU::Access::FETCH );
 
   if ( pc & 0b11 || !word ) // fetch
   {
@@ -90,15 +132,83 @@ std::uint32_t CPU::single_step() noexcept
   }
   else // execute
   {
-    pc += 4;
+    auto const next = pc + 4;
+
+    trace( MemoryTracer::Kind::FETCH, pc, 4 );
+    count( *word );
+    profile();
+    cycles += opcode_cycles[opcode( *word )];
+    pc = next;
     ( this->*function_table[opcode( *word )] )( *word );
 
     gpr[0] = 0;
+
+    if ( pc != next && cycles >= next_event )
+      events();
   }
 
+  cp1.leave();
+
   return exit_code.load( std::memory_order_acquire );
 }
 
+/**
+ * The blocks involved in the request are pinned until its completion,
+ * the handler writes or reads them directly.
+ **/
+template<typename Submit>
+bool CPU::submit_async( std::uint32_t address, std::uint32_t count, bool writes_v0, Submit submit ) noexcept
+{
+  // A syscall dropped by a reset is still using `async_syscall`
+  if ( io_in_flight() )
+    return false;
+
+  async_syscall.done.store( false, std::memory_order_relaxed );
+  async_syscall.pending = true;
+  async_syscall.writes_v0 = writes_v0;
+  async_syscall.address = address;
+  async_syscall.count = count;
+
+  string_handler.pin( address, count );
+
+  if ( submit( &async_syscall ) )
+  {
+    exit_code.store( WAITING_IO, std::memory_order_release );
+    return true;
+  }
+
+  string_handler.unpin( address, count );
+  async_syscall.pending = false;
+
+  return false;
+}
+
+bool CPU::waiting_io() noexcept
+{
+  if ( !io_in_flight() || async_syscall.dropped )
+    return false;
+
+  exit_code.store( WAITING_IO, std::memory_order_release );
+  return true;
+}
+
+bool CPU::io_in_flight() noexcept
+{
+  if ( !async_syscall.pending || !async_syscall.completed() )
+    return async_syscall.pending;
+
+  constexpr std::uint32_t v0{ 2 };
+
+  if ( async_syscall.writes_v0 && !async_syscall.dropped )
+    gpr[v0] = async_syscall.result;
+
+  string_handler.unpin( async_syscall.address, async_syscall.count );
+  async_syscall.pending = false;
+  async_syscall.dropped = false;
+
+  return false;
+}
+
 void CPU::hard_reset() noexcept
 {
   gpr[0] = 0;
@@ -106,6 +216,106 @@ void CPU::hard_reset() noexcept
   cp1.reset();
   enter_kernel_mode();
   pc = 0xBFC0'0000;
+  program_break = heap_begin;
+
+  // The handler of a pending syscall may still be using its blocks, they're unpinned once it completes
+  if ( io_in_flight() )
+    async_syscall.dropped = true;
+
+  cycles = 0;
+  count_cycle = 0;
+  next_event = 0;
+  event_queue.clear();
+  schedule_timer();
+}
+
+EventId CPU::schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept
+{
+  auto const when = cycles + delay;
+
+  if ( when < next_event )
+    next_event = when;
+
+  return event_queue.schedule( when, callback, user_data );
+}
+
+bool CPU::cancel( EventId id ) noexcept
+{
+  // `next_event` may be early now, that only costs a spurious check
+  return event_queue.cancel( id );
+}
+
+void CPU::raise_interrupt( std::uint32_t line ) noexcept
+{
+  if ( line < 6 )
+  {
+    cp0.cause |= 1u << ( 10 + line );
+    check_interrupts();
+  }
+}
+
+void CPU::clear_interrupt( std::uint32_t line ) noexcept
+{
+  if ( line < 6 )
+    cp0.cause &= ~( 1u << ( 10 + line ) );
+}
+
+void CPU::set_timing_model( TimingModel const &model ) noexcept
+{
+  constexpr std::uint32_t loads[]{ 0x20, 0x21, 0x23, 0x24, 0x25, 0x31, 0x35 };  // LB, LH, LW, LBU, LHU, LWC1, LDC1
+  constexpr std::uint32_t stores[]{ 0x28, 0x29, 0x2B, 0x39, 0x3D };            // SB, SH, SW, SWC1, SDC1
+  constexpr std::uint32_t COP1{ 0x11 };
+
+  opcode_cycles.fill( model.base );
+
+  for ( auto op : loads )
+    opcode_cycles[op] = model.load;
+
+  for ( auto op : stores )
+    opcode_cycles[op] = model.store;
+
+  opcode_cycles[COP1] = model.fp;
+
+  mul_div_cycles = std::uint64_t( model.mul_div ) - model.base;
+  vector_load_cycles = std::uint64_t( model.load ) - model.base;
+  vector_store_cycles = std::uint64_t( model.store ) - model.base;
+}
+
+/**
+ * Count increments once per cycle, it matches Compare every 2^32 cycles.
+ * Writing Compare with the current value of Count schedules the interrupt 2^32 cycles later.
+ **/
+void CPU::schedule_timer() noexcept
+{
+  sync_count();
+
+  std::uint64_t distance = cp0.compare - cp0.count;
+  if ( !distance )
+    distance = std::uint64_t( 1 ) << 32;
+
+  timer_deadline = cycles + distance;
+
+  if ( timer_deadline < next_event )
+    next_event = timer_deadline;
+}
+
+void CPU::events() noexcept
+{
+  // The callbacks may schedule other events, `next_event` is computed afterwards
+  next_event = EventQueue::never;
+  event_queue.run( cycles );
+
+  if ( cycles >= timer_deadline )
+  {
+    cp0.cause |= CP0::timer_interrupt | cp0.timer_ip();
+    timer_deadline += std::uint64_t( 1 ) << 32;
+  }
+
+  next_event = std::min( { next_event, timer_deadline, event_queue.next() } );
+
+  // Status IM masks Cause IP, Status IE, EXL and ERL are checked by `signal_exception`
+  if ( cp0.cause & cp0.status & 0xFF00 )
+    signal_exception( ExCause::Int, 0, pc );
 }
 
 constexpr std::uint32_t opcode( std::uint32_t word ) noexcept
@@ -324,15 +534,35 @@ void CPU::pcrel( std::uint32_t word ) noexcept
 void CPU::cop1( std::uint32_t word ) noexcept
 {
   constexpr std::uint32_t MFC1{ 0b00'000 };
+  constexpr std::uint32_t CFC1{ 0b00'010 };
   constexpr std::uint32_t MFHC1{ 0b00'011 };
   constexpr std::uint32_t MTC1{ 0b00'100 };
+  constexpr std::uint32_t CTC1{ 0b00'110 };
   constexpr std::uint32_t MTHC1{ 0b00'111 };
+  constexpr std::uint32_t BZ_V{ 0b01'011 };
+  constexpr std::uint32_t BNZ_V{ 0b01'111 };
+  constexpr std::uint32_t BZ_DF{ 0b11'000 }; // BZ.df and BNZ.df, the lowest 3 bits are df and the condition
 
   auto _ft = rd( word );
   auto _rt = rt( word );
   auto _type = rs( word );
 
-  if ( _type == MFC1 )
+  if ( _type == BZ_V || _type == BNZ_V || ( _type & BZ_DF ) == BZ_DF )
+  {
+    if ( cp1.msa_condition( word ) )
+      pc += sign_extend<_halfword>( immediate( word ) ) << 2;
+  }
+  else if ( _type == CFC1 || _type == CTC1 )
+  {
+    // FIR, FEXR, FENR, FCSR
+    if ( _ft != 0 && _ft != 26 && _ft != 28 && _ft != 31 )
+      reserved( word );
+    else if ( _type == CFC1 )
+      gpr[_rt] = cp1.read( _ft );
+    else
+      cp1.write( _ft, gpr[_rt] );
+  }
+  else if ( _type == MFC1 )
   {
     gpr[_rt] = cp1.mfc1( _ft );
   }
@@ -356,6 +586,80 @@ void CPU::cop1( std::uint32_t word ) noexcept
   }
 }
 
+void CPU::msa( std::uint32_t word ) noexcept
+{
+  constexpr std::uint32_t LD_B{ 0b10'0000 };
+  constexpr std::uint32_t ST_D{ 0b10'0111 };
+
+  auto const minor = word & 0x3F;
+
+  // LD.df and ST.df, the offset is scaled by the element size
+  if ( minor >= LD_B && minor <= ST_D )
+  {
+    auto const is_load = ( minor & 0b100 ) == 0;
+    auto const _wd = word >> 6 & 0x1F;
+    auto const _rs = word >> 11 & 0x1F;
+    auto const _s10 = std::int32_t( word << 6 ) >> 22;
+    auto const address = gpr[_rs] + ( std::uint32_t( _s10 ) << ( minor & 0b11 ) );
+
+    trace( is_load ? MemoryTracer::Kind::LOAD : MemoryTracer::Kind::STORE, address, 16 );
+
+    // The vector can't wrap around the address space
+    if ( address > 0xFFFF'FFF0 )
+    {
+      signal_exception( ExCause::DBE, word, pc - 4 );
+      return;
+    }
+
+    if ( is_load )
+    {
+      cycles += vector_load_cycles;
+
+      std::array<std::uint32_t, 4> words;
+      for ( std::uint32_t i = 0; i < 4; ++i )
+      {
+        if ( auto const ex = access_word<_load>( address + 4 * i, words[i] ) )
+        {
+          signal_exception( ex, word, pc - 4 );
+          return;
+        }
+      }
+
+      cp1.write_vector( _wd, words );
+    }
+    else
+    {
+      cycles += vector_store_cycles;
+
+      // Every word is checked first, a faulting store doesn't write anything
+      auto const spanned = 4 + ( ( address & 0b11 ) != 0 );
+
+      for ( std::uint32_t i = 0; i < spanned; ++i )
+      {
+        if ( !mmu.access( ( address & ~0b11u ) + 4 * i, running_mode(), MMU::Access::STORE ) )
+        {
+          signal_exception( ExCause::AdES, word, pc - 4 );
+          return;
+        }
+      }
+
+      auto words = cp1.read_vector( _wd );
+      for ( std::uint32_t i = 0; i < 4; ++i )
+        access_word<_store>( address + 4 * i, words[i] );
+    }
+
+    return;
+  }
+
+  auto ex = cp1.execute_msa( word, gpr );
+  gpr[0] = 0;
+
+  if ( ex == CP1::Exception::RESERVED )
+    reserved( word );
+  else if ( ex != CP1::Exception::NONE )
+    signal_exception( ExCause::MSAFPE, word, pc - 4 );
+}
+
 void CPU::j( std::uint32_t word ) noexcept
 {
   pc = pc & 0xF000'0000 | word << 6 >> 4;
@@ -365,6 +669,7 @@ void CPU::jal( std::uint32_t word ) noexcept
 {
   gpr[31] = pc + 4;
   pc = pc & 0xF000'0000 | word << 6 >> 4;
+  profile_call( pc, gpr[31] );
 }
 
 void CPU::beq( std::uint32_t word ) noexcept
@@ -725,13 +1030,15 @@ void CPU::op_byte( std::uint32_t word ) noexcept
   auto address = gpr[_base] + sign_extend<_halfword>( immediate( word ) );
   auto align = address & 0b11;
 
+  trace( op == _load ? MemoryTracer::Kind::LOAD : MemoryTracer::Kind::STORE, address, 1 );
+
   std::uint32_t byte;
 
   constexpr std::uint32_t shift_align[] = { 0, 8, 16, 24 };
 
   if constexpr ( op == _load )
   {
-    auto *load_byte = mmu.access( address, running_mode() );
+    auto *load_byte = mmu.access( address, running_mode(), MMU::Access::LOAD );
 
     if ( !load_byte )
     {
@@ -764,7 +1071,7 @@ void CPU::op_byte( std::uint32_t word ) noexcept
         0x00FF'FFFF,
     };
 
-    auto *store_byte = mmu.access( address, running_mode() );
+    auto *store_byte = mmu.access( address, running_mode(), MMU::Access::STORE );
 
     if ( !store_byte )
     {
@@ -819,6 +1126,8 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
 
   auto align = address & 0b11;
 
+  trace( op == _load ? MemoryTracer::Kind::LOAD : MemoryTracer::Kind::STORE, address, 2 );
+
   std::uint32_t lowhalf_value;
   std::uint32_t highhalf_value = 0;
 
@@ -826,7 +1135,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
 
   if constexpr ( op == _load )
   {
-    auto *lowhalf_ptr = mmu.access( address, running_mode() );
+    auto *lowhalf_ptr = mmu.access( address, running_mode(), MMU::Access::LOAD );
     if ( !lowhalf_ptr )
     {
       signal_exception( ExCause::AdEL, word, pc - 4 );
@@ -843,7 +1152,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
         return;
       }
 
-      auto *highhalf_ptr = mmu.access( address + 4, running_mode() );
+      auto *highhalf_ptr = mmu.access( address + 4, running_mode(), MMU::Access::LOAD );
       if ( !highhalf_ptr )
       {
         signal_exception( ExCause::AdEL, word, pc - 4 );
@@ -873,7 +1182,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
 
     lowhalf_value = gpr[_rt] & 0xFFFF;
 
-    auto *lowhalf_ptr = mmu.access( address, running_mode() );
+    auto *lowhalf_ptr = mmu.access( address, running_mode(), MMU::Access::STORE );
     if ( !lowhalf_ptr )
     {
       signal_exception( ExCause::AdES, word, pc - 4 );
@@ -887,7 +1196,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
         signal_exception( ExCause::DBE, word, pc - 4 );
         return;
       }
-      auto *highhalf_ptr = mmu.access( address + 4, running_mode() );
+      auto *highhalf_ptr = mmu.access( address + 4, running_mode(), MMU::Access::STORE );
       if ( !highhalf_ptr )
       {
         signal_exception( ExCause::AdES, word, pc - 4 );
@@ -936,54 +1245,53 @@ void CPU::op_word( std::uint32_t word ) noexcept
   op_word<op>( _rt, address, word );
 }
 
-template <int op>
+template <int op, bool traced>
 void CPU::op_word( std::uint32_t _rt, std::uint32_t address, std::uint32_t _word ) noexcept
 {
   static_assert( op == _load || op == _store, "Invalid operation! Use '_load' or '_store'." );
 
+  if constexpr ( traced )
+    trace( op == _load ? MemoryTracer::Kind::LOAD : MemoryTracer::Kind::STORE, address, 4 );
+
+  if ( auto const ex = access_word<op>( address, gpr[_rt] ) )
+    signal_exception( ex, _word, pc - 4 );
+}
+
+template <int op>
+std::uint32_t CPU::access_word( std::uint32_t address, std::uint32_t &value ) noexcept
+{
+  static_assert( op == _load || op == _store, "Invalid operation! Use '_load' or '_store'." );
+
+  constexpr auto access_kind = op == _load ? MMU::Access::LOAD : MMU::Access::STORE;
+  constexpr auto fault = op == _load ? ExCause::AdEL : ExCause::AdES;
+
   auto align = address & 0b11;
 
   if ( align == 0 )
   {
-    auto *word = mmu.access( address, running_mode() );
+    auto *word = mmu.access( address, running_mode(), access_kind );
+
+    if ( !word )
+      return fault;
 
     if constexpr ( op == _load )
-    {
-      if ( !word )
-      {
-        signal_exception( ExCause::AdEL, _word, pc - 4 );
-        return;
-      }
-      gpr[_rt] = *word;
-    }
+      value = *word;
     else // store
-    {
-      if ( !word )
-      {
-        signal_exception( ExCause::AdES, _word, pc - 4 );
-        return;
-      }
-      *word = gpr[_rt];
-    }
+      *word = value;
   }
   else // unaligned
   {
     if ( address > 0xFFFF'FFFB )
-    {
-      signal_exception( ExCause::DBE, _word, pc - 4 );
-      return;
-    }
+      return ExCause::DBE;
+
+    auto *low = mmu.access( address, running_mode(), access_kind );
+    auto *high = mmu.access( address + 4, running_mode(), access_kind );
 
-    auto *low = mmu.access( address, running_mode() );
-    auto *high = mmu.access( address + 4, running_mode() );
+    if ( !low || !high )
+      return fault;
 
     if constexpr ( op == _load )
     {
-      if ( !low || !high )
-      {
-        signal_exception( ExCause::AdEL, _word, pc - 4 );
-        return;
-      }
       auto low_word = *low;
       auto high_word = *high;
 
@@ -1001,32 +1309,29 @@ void CPU::op_word( std::uint32_t _rt, std::uint32_t address, std::uint32_t _word
       case 3: high_word <<= 8;
       }
 
-      gpr[_rt] = high_word | low_word;
+      value = high_word | low_word;
     }
     else // store
     {
-      if ( !low || !high )
-      {
-        signal_exception( ExCause::AdES, _word, pc - 4 );
-        return;
-      }
       if ( align == 1 )
       {
-        *low = *low & 0xFF | gpr[_rt] << 8;
-        *high = *high & ~0xFF | gpr[_rt] >> 24;
+        *low = *low & 0xFF | value << 8;
+        *high = *high & ~0xFF | value >> 24;
       }
       else if ( align == 2 )
       {
-        *low = *low & 0xFFFF | gpr[_rt] << 16;
-        *high = *high & ~0xFFFF | gpr[_rt] >> 16;
+        *low = *low & 0xFFFF | value << 16;
+        *high = *high & ~0xFFFF | value >> 16;
       }
       else
       {
-        *low = *low & 0x00FF'FFFF | gpr[_rt] << 24;
-        *high = *high & 0xFF00'0000 | gpr[_rt] >> 8;
+        *low = *low & 0x00FF'FFFF | value << 24;
+        *high = *high & 0xFF00'0000 | value >> 8;
       }
     }
   }
+
+  return 0;
 }
 
 void CPU::lb( std::uint32_t word ) noexcept
@@ -1102,8 +1407,10 @@ void CPU::ldc1( std::uint32_t word ) noexcept
   auto copy_1 = gpr[1];
   auto copy_2 = gpr[2];
 
-  op_word<_load>( 1, address, word );
-  op_word<_load>( 2, address + 4, word );
+  trace( MemoryTracer::Kind::LOAD, address, 8 );
+
+  op_word<_load, false>( 1, address, word );
+  op_word<_load, false>( 2, address + 4, word );
   cp1.mtc1( ft, gpr[1] );
   cp1.mthc1( ft, gpr[2] );
 
@@ -1132,6 +1439,7 @@ void CPU::pop66( std::uint32_t word ) noexcept
   {
     auto _imm = sign_extend<_halfword>( immediate( word ) );
     pc = gpr[_rt] + _imm;
+    profile_jump( pc );
   }
 }
 
@@ -1160,6 +1468,7 @@ void CPU::balc( std::uint32_t word ) noexcept
 
   gpr[31] = pc;
   pc += target_offset;
+  profile_call( pc, gpr[31] );
 }
 
 void CPU::sdc1( std::uint32_t word ) noexcept
@@ -1169,11 +1478,13 @@ void CPU::sdc1( std::uint32_t word ) noexcept
   auto _immediate = immediate( word );
   auto address = gpr[_base] + sign_extend<_halfword>( _immediate );
 
+  trace( MemoryTracer::Kind::STORE, address, 8 );
+
   gpr[0] = cp1.mfc1( ft );
-  op_word<_store>( 0, address, word );
+  op_word<_store, false>( 0, address, word );
 
   gpr[0] = cp1.mfhc1( ft );
-  op_word<_store>( 0, address + 4, word );
+  op_word<_store, false>( 0, address + 4, word );
 
   gpr[0] = 0;
 }
@@ -1197,8 +1508,10 @@ void CPU::pop76( std::uint32_t word ) noexcept
   }
   else // JIALC
   {
+    auto const target = gpr[_rt] + sign_extend<_halfword>( immediate( word ) );
     gpr[31] = pc;
-    pc = gpr[_rt] + sign_extend<_halfword>( immediate( word ) );
+    pc = target;
+    profile_call( pc, gpr[31] );
   }
 }
 
@@ -1289,9 +1602,16 @@ void CPU::jalr( std::uint32_t word ) noexcept
   auto _rd = rd( word );
   auto _rs = rs( word );
 
+  auto const target = gpr[_rs];
+
   gpr[_rd] = pc + 4;
 
-  pc = gpr[_rs];
+  pc = target;
+
+  if ( _rd )
+    profile_call( pc, gpr[_rd] );
+  else // JR
+    profile_jump( pc );
 }
 void CPU::syscall( std::uint32_t word ) noexcept
 {
@@ -1301,10 +1621,11 @@ void CPU::syscall( std::uint32_t word ) noexcept
   constexpr std::uint32_t a0{ 4 };
   constexpr std::uint32_t a1{ 5 };
   constexpr std::uint32_t a2{ 6 };
+  constexpr std::uint32_t a3{ 7 };
 
   auto const sysnum = gpr[v0];
 
-  if ( sysnum == 0 || sysnum > 17 )
+  if ( sysnum == 0 || sysnum > 18 )
   {
     signal_exception( ExCause::Sys, word, pc - 4 );
     return;
@@ -1342,8 +1663,20 @@ void CPU::syscall( std::uint32_t word ) noexcept
   else if ( sysnum == 4 ) // print string
   {
     auto address = gpr[a0];
-    auto str = string_handler.read( address, 0xFFFF'FFFF, true);
-    io_device->print_string( str.data() );
+
+    // The string is printed in place, the terminator of a single region follows it inside the block
+    if ( !string_handler.string_regions( address, io_regions ) )
+    {
+      if ( io_regions.size() == 1 )
+        io_device->print_string( io_regions[0].data );
+      else
+        io_device->print_string( io_regions.data(), ( std::uint32_t )io_regions.size() );
+    }
+    else
+    {
+      string_handler.read( address, 0xFFFF'FFFF, true, io_buffer );
+      io_device->print_string( io_buffer.empty() ? nullptr : io_buffer.data() );
+    }
   }
   else if ( sysnum == 5 ) // read int
   {
@@ -1379,21 +1712,55 @@ void CPU::syscall( std::uint32_t word ) noexcept
     auto address = gpr[a0];
     auto length = gpr[a1];
 
-    // Allocate enough space
-    std::unique_ptr<char[]> buf( new( std::nothrow ) char[length] );
+    // Read the string directly into the RAM
+    if ( !string_handler.regions( address, length, io_regions ) )
+    {
+      auto const submitted = submit_async( address, length, false, [this] ( AsyncSyscall *syscall )
+      {
+        return io_device->read_string_async( io_regions.data(), ( std::uint32_t )io_regions.size(), syscall );
+      } );
+
+      if ( submitted )
+        return;
+
+      if ( io_regions.size() == 1 )
+        io_device->read_string( io_regions[0].data, length );
+      else
+        io_device->read_string( io_regions.data(), ( std::uint32_t )io_regions.size() );
+
+      return;
+    }
+
+    // Some blocks aren't in memory, the string goes through a buffer
+    io_buffer.resize( length );
 
     // Read the string from the device
-    io_device->read_string( buf.get(), length );
+    io_device->read_string( io_buffer.data(), length );
 
     // Write the string into the RAM
-    string_handler.write( address, buf.get(), length );
+    string_handler.write( address, io_buffer.data(), length );
   }
   else if ( sysnum == 9 ) // sbrk
   {
-    signal_exception( ExCause::Int, word, pc - 4 );
+    // Only the break moves, the blocks are created on their first access.
+    // The new break is kept word aligned.
+    std::int64_t const next = ( std::int64_t( program_break ) + std::int32_t( gpr[a0] ) + 3 ) & ~std::int64_t( 3 );
+
+    if ( next < heap_begin || next > heap_end )
+    {
+      gpr[v0] = 0xFFFF'FFFF;
+    }
+    else
+    {
+      gpr[v0] = program_break;
+      program_break = std::uint32_t( next );
+    }
   }
   else if ( sysnum == 10 || sysnum == 17 ) // exit
   {
+    if ( io_device )
+      io_device->flush();
+
     exit_code.store( EXIT, std::memory_order_release );
   }
   else if ( sysnum == 11 ) // print char
@@ -1417,12 +1784,23 @@ void CPU::syscall( std::uint32_t word ) noexcept
   {
     auto filename_address = gpr[a0];
 
-    auto filename = string_handler.read( filename_address, 0xFFFF'FFFF, true );
+    char const *filename = nullptr;
+
+    if ( !string_handler.string_regions( filename_address, io_regions ) && io_regions.size() == 1 )
+    {
+      filename = io_regions[0].data;
+    }
+    else
+    {
+      string_handler.read( filename_address, 0xFFFF'FFFF, true, io_buffer );
+      filename = io_buffer.empty() ? nullptr : io_buffer.data();
+    }
+
     char flags[5] = { 0 }; // flags must be null terminated, but $a1 can contain up to 4 chars without '\0'.
 
     std::memcpy( flags, &gpr[a1], 4 );
 
-    gpr[v0] = file_handler->open( filename.data(), flags );
+    gpr[v0] = file_handler->open( filename, flags );
   }
   else if ( sysnum == 14 ) // file read
   {
@@ -1430,14 +1808,28 @@ void CPU::syscall( std::uint32_t word ) noexcept
     auto buf = gpr[a1];
     auto count = gpr[a2];
 
-    // Allocate enough space
-    std::unique_ptr<char[]> data( new char[count] );
+    // Read the data from file directly into the RAM
+    if ( !string_handler.regions( buf, count, io_regions ) )
+    {
+      auto const submitted = submit_async( buf, count, true, [this, fd] ( AsyncSyscall *syscall )
+      {
+        return file_handler->read_async( fd, io_regions.data(), ( std::uint32_t )io_regions.size(), syscall );
+      } );
+
+      if ( !submitted )
+        gpr[v0] = file_handler->readv( fd, io_regions.data(), ( std::uint32_t )io_regions.size() );
+
+      return;
+    }
+
+    // Some blocks aren't in memory, the data goes through a buffer
+    io_buffer.resize( count );
 
     // Read the data from file and store the result
-    gpr[v0] = file_handler->read( fd, data.get(), count );
+    gpr[v0] = file_handler->read( fd, io_buffer.data(), count );
 
     // Write the data into the RAM
-    string_handler.write( buf, data.get(), count );
+    string_handler.write( buf, io_buffer.data(), count );
   }
   else if ( sysnum == 15 ) // file write
   {
@@ -1445,9 +1837,24 @@ void CPU::syscall( std::uint32_t word ) noexcept
     auto buf = gpr[a1];
     auto count = gpr[a2];
 
-    auto data = string_handler.read( buf, count );
+    // Write the data to file directly from the RAM
+    if ( !string_handler.regions( buf, count, io_regions ) )
+    {
+      auto const submitted = submit_async( buf, count, true, [this, fd] ( AsyncSyscall *syscall )
+      {
+        return file_handler->write_async( fd, io_regions.data(), ( std::uint32_t )io_regions.size(), syscall );
+      } );
+
+      if ( !submitted )
+        gpr[v0] = file_handler->writev( fd, io_regions.data(), ( std::uint32_t )io_regions.size() );
+
+      return;
+    }
 
-    gpr[v0] = file_handler->write( fd, data.data(), count );
+    // Some blocks aren't in memory, the data goes through a buffer
+    string_handler.read( buf, count, false, io_buffer );
+
+    gpr[v0] = file_handler->write( fd, io_buffer.empty() ? nullptr : io_buffer.data(), count );
   }
   else if ( sysnum == 16 ) // file close
   {
@@ -1457,6 +1864,25 @@ void CPU::syscall( std::uint32_t word ) noexcept
 
     gpr[v0] = 0;
   }
+  else if ( sysnum == 18 ) // file map
+  {
+    // $a0 = fd, $a1 = address, $a2 = length, $a3 = offset inside the file
+    // Both the address and the offset must be multiples of RAM::block_size.
+    // The guest reads the file directly from the host's mapping, its writes aren't visible in the file.
+    auto fd = gpr[a0];
+    auto address = gpr[a1];
+    auto length = gpr[a2];
+    auto offset = gpr[a3];
+
+    MappedFile file;
+
+    bool const error = address % RAM::block_size
+                       || offset % RAM::block_size
+                       || file.open( file_handler->native_handle( fd ), offset, length )
+                       || string_handler.map_file( address, std::move( file ) );
+
+    gpr[v0] = error ? 0xFFFF'FFFF : address;
+  }
   else
   {
     signal_exception( ExCause::Sys, word, pc - 4 );
@@ -1464,6 +1890,9 @@ void CPU::syscall( std::uint32_t word ) noexcept
 }
 void CPU::break_( std::uint32_t ) noexcept
 {
+  if ( io_device )
+    io_device->flush();
+
   set_ex_cause( ExCause::Bp );
   exit_code.store( EXCEPTION, std::memory_order_release );
 }
@@ -1512,6 +1941,8 @@ void CPU::clo( std::uint32_t word ) noexcept
 }
 void CPU::sop30( std::uint32_t word ) noexcept
 {
+  cycles += mul_div_cycles;
+
   constexpr std::uint32_t MUL{ 0b00010 };
   constexpr std::uint32_t MUH{ 0b00011 };
 
@@ -1542,6 +1973,8 @@ void CPU::sop30( std::uint32_t word ) noexcept
 }
 void CPU::sop31( std::uint32_t word ) noexcept
 {
+  cycles += mul_div_cycles;
+
   constexpr std::uint32_t MULU{ 0b00010 };
   constexpr std::uint32_t MUHU{ 0b00011 };
 
@@ -1569,6 +2002,8 @@ void CPU::sop31( std::uint32_t word ) noexcept
 }
 void CPU::sop32( std::uint32_t word ) noexcept
 {
+  cycles += mul_div_cycles;
+
   constexpr std::uint32_t _DIV{ 0b00010 };
   constexpr std::uint32_t _MOD{ 0b00011 };
 
@@ -1600,6 +2035,8 @@ void CPU::sop32( std::uint32_t word ) noexcept
 }
 void CPU::sop33( std::uint32_t word ) noexcept
 {
+  cycles += mul_div_cycles;
+
   constexpr std::uint32_t _DIVU{ 0b00010 };
   constexpr std::uint32_t _MODU{ 0b00011 };
 
@@ -1832,6 +2269,7 @@ void CPU::bal( std::uint32_t word ) noexcept
 {
   gpr[31] = pc + 4;
   pc += sign_extend<_halfword>( immediate( word ) ) << 2;
+  profile_call( pc, gpr[31] );
 }
 void CPU::sigrie( std::uint32_t word ) noexcept
 {
@@ -1849,6 +2287,9 @@ void CPU::mfc0( std::uint32_t word ) noexcept
   auto _rt = rt( word );
   auto _sel = word & 0x7;
 
+  if ( _rd == 9 ) // Count
+    sync_count();
+
   gpr[_rt] = cp0.read( _rd, _sel );
 }
 void CPU::mfhc0( std::uint32_t word ) noexcept
@@ -1863,7 +2304,15 @@ void CPU::mtc0( std::uint32_t word ) noexcept
   auto _rt = rt( word );
   auto _sel = word & 0x7;
 
+  if ( _rd == 9 ) // Count
+    sync_count();
+
   cp0.write( _rd, _sel, gpr[_rt] );
+
+  if ( _rd == 9 || _rd == 11 ) // Count, Compare
+    schedule_timer();
+  else if ( _rd == 12 ) // Status
+    check_interrupts();
 }
 void CPU::mthc0( std::uint32_t ) noexcept
 {
@@ -1881,6 +2330,8 @@ void CPU::mfmc0( std::uint32_t word ) noexcept
     cp0.status |= 1;
   else
     cp0.status &= ~1;
+
+  check_interrupts();
 }
 
 void CPU::eret( std::uint32_t ) noexcept
@@ -1893,6 +2344,8 @@ void CPU::eret( std::uint32_t ) noexcept
     pc = cp0.epc;
 
   cp0.status &= ~0b110;
+
+  check_interrupts();
 }
 
 /* * * * *
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <mips32/file_handler.hpp>
+#include <mips32/fpu_backend.hpp>
 #include <mips32/io_device.hpp>
+#include <mips32/memory_tracer.hpp>
+#include <mips32/profiler.hpp>
+#include <mips32/timing_model.hpp>
 #include <mips32/cp0.hpp>
 #include "cp1.hpp"
+#include "event_queue.hpp"
 #include "mmu.hpp"
 #include "ram.hpp"
 #include "ram_io.hpp"
@@ -11,6 +16,19 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <vector>
+
+// Counts the executed instructions per opcode, see MachineInspector::CPU_counter.
+// Disabled by default, it doesn't cost anything when off.
+#ifndef MIPS32_ENABLE_COUNTERS
+#  define MIPS32_ENABLE_COUNTERS 0
+#endif
+
+// Records every memory access into the attached MemoryTracer.
+// Disabled by default, it doesn't cost anything when off.
+#ifndef MIPS32_ENABLE_TRACING
+#  define MIPS32_ENABLE_TRACING 0
+#endif
 
 namespace mips32
 {
@@ -19,10 +37,14 @@ class CPU
   friend class MachineInspector;
 
 public:
-  explicit CPU( RAM &ram ) noexcept;
+  explicit CPU( RAM &ram, FPUBackend fpu_backend = FPUBackend::HOST ) noexcept;
 
   IODevice* attach_iodevice( IODevice *device ) noexcept;
   FileHandler* attach_file_handler( FileHandler *handler ) noexcept;
+  Profiler* attach_profiler( Profiler *profiler ) noexcept;
+  MemoryTracer* attach_tracer( MemoryTracer *tracer ) noexcept;
+
+  Profiler* attached_profiler() const noexcept { return profiler; }
 
   enum ExitCode : std::uint32_t
   {
@@ -31,6 +53,7 @@ public:
     INTERRUPT,
     EXCEPTION,
     EXIT,
+    WAITING_IO, // an asynchronous syscall is pending
   };
 
   enum ExCause : std::uint32_t
@@ -46,9 +69,15 @@ public:
     CpU = 0x0B,
     Ov = 0x0C,
     Tr = 0x0D,
+    MSAFPE = 0x0E,
     FPE = 0x0F,
   };
 
+  // Range the heap can grow into through the sbrk syscall, the program break starts at `heap_begin`.
+  // The blocks inside it are zero filled.
+  static inline constexpr std::uint32_t heap_begin{ 0x1004'0000 };
+  static inline constexpr std::uint32_t heap_end{ 0x7000'0000 };
+
   std::uint32_t start() noexcept;
   void          stop() noexcept;
 
@@ -56,6 +85,20 @@ public:
 
   void hard_reset() noexcept;
 
+  // Returns `true` while the handler of an asynchronous syscall can still access the guest's memory,
+  // the RAM can't be replaced meanwhile. A completed syscall is retired first.
+  bool io_in_flight() noexcept;
+
+  // Runs `callback( user_data )` at the first block boundary after `delay` more cycles.
+  // They must be called while the CPU is stopped, or by an event's callback.
+  EventId schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept;
+  bool    cancel( EventId id ) noexcept;
+
+  // Asserts or deasserts the hardware interrupt `line` [0, 6), that's Cause IP2..IP7.
+  // Same restrictions as `schedule`.
+  void raise_interrupt( std::uint32_t line ) noexcept;
+  void clear_interrupt( std::uint32_t line ) noexcept;
+
 private:
   RAMIO string_handler;
 
@@ -67,10 +110,140 @@ private:
 
   std::array<std::uint32_t, 32> gpr;
 
+  std::uint32_t program_break{ heap_begin };
+
+  // Executed instructions:
+  // [0, 64) primary opcode, [64, 128) SPECIAL function, [128, 192) COP1 function
+  static inline constexpr bool          counters_enabled{ MIPS32_ENABLE_COUNTERS != 0 };
+  static inline constexpr std::uint32_t counter_group_size{ 64 };
+
+  std::array<std::uint64_t, counters_enabled ? 3 * counter_group_size : 0> counters{};
+
+  void count( std::uint32_t word ) noexcept
+  {
+    if constexpr ( counters_enabled )
+    {
+      constexpr std::uint32_t SPECIAL{ 0x00 };
+      constexpr std::uint32_t COP1{ 0x11 };
+      constexpr std::uint32_t FMT_S{ 0x10 }; // first arithmetic format
+
+      auto const op = word >> 26;
+      auto const fn = word & 0x3F;
+
+      ++counters[op];
+
+      if ( op == SPECIAL )
+        ++counters[counter_group_size + fn];
+      else if ( op == COP1 && ( word >> 21 & 0x1F ) >= FMT_S )
+        ++counters[2 * counter_group_size + fn];
+    }
+  }
+
+  // Cycles elapsed since the last reset, advanced by every retired instruction
+  std::uint64_t cycles{ 0 };
+  std::uint64_t count_cycle{ 0 }; // `cycles` when CP0 Count has been updated the last time
+
+  // Cost of each primary opcode, built from a TimingModel.
+  // MUL/DIV are SPECIAL instructions and LD.df/ST.df are MSA ones,
+  // they add the difference (modulo 2^64) from `base`.
+  std::array<std::uint32_t, 64> opcode_cycles;
+  std::uint64_t                 mul_div_cycles;
+  std::uint64_t                 vector_load_cycles;
+  std::uint64_t                 vector_store_cycles;
+
+  void set_timing_model( TimingModel const &model ) noexcept;
+
+  // The events are checked only when the control flow leaves the sequential path (a block boundary),
+  // as soon as `cycles` reaches `next_event`, so nothing is polled per instruction.
+  std::uint64_t next_event{ EventQueue::never };
+  std::uint64_t timer_deadline{ EventQueue::never }; // when Count reaches Compare
+
+  EventQueue event_queue;
+
+  void sync_count() noexcept
+  {
+    cp0.count += std::uint32_t( cycles - count_cycle );
+    count_cycle = cycles;
+  }
+
+  // Called after Count or Compare change
+  void schedule_timer() noexcept;
+
+  // Called after CP0 has been restored, the saved Count is taken as the current one
+  void restore_timer() noexcept
+  {
+    count_cycle = cycles;
+    next_event = 0;
+    schedule_timer();
+  }
+
+  // Called after an instruction that might have unmasked a pending interrupt
+  void check_interrupts() noexcept { next_event = 0; }
+
+  // Runs the due events and raises the timer interrupt if its deadline passed,
+  // then takes the pending interrupts, if enabled
+  void events() noexcept;
+
   std::atomic<std::uint32_t> exit_code;
 
-  IODevice* io_device;
-  FileHandler* file_handler;
+  IODevice* io_device{ nullptr };
+  FileHandler* file_handler{ nullptr };
+
+  Profiler*     profiler{ nullptr };
+  std::uint32_t until_sample{ 0 }; // instructions left before the next sample
+
+  // Called before executing the instruction at `pc`
+  void profile() noexcept
+  {
+    if ( profiler && !--until_sample )
+    {
+      profiler->sample( pc );
+      until_sample = profiler->interval;
+    }
+  }
+
+  // `return_address` is the value stored in the link register,
+  // the word that precedes it belongs to the caller.
+  void profile_call( std::uint32_t entry, std::uint32_t return_address ) noexcept
+  {
+    if ( profiler )
+      profiler->call( return_address - 4, entry, return_address );
+  }
+
+  void profile_jump( std::uint32_t target ) noexcept
+  {
+    if ( profiler )
+      profiler->jump( target );
+  }
+
+  static inline constexpr bool tracing_enabled{ MIPS32_ENABLE_TRACING != 0 };
+
+  MemoryTracer* tracer{ nullptr };
+
+  void trace( MemoryTracer::Kind kind, std::uint32_t address, std::uint8_t size ) noexcept
+  {
+    if constexpr ( tracing_enabled )
+    {
+      if ( tracer )
+        tracer->record( kind, address, size );
+    }
+  }
+
+  // Asynchronous syscall waiting for completion, one at most
+  AsyncSyscall async_syscall;
+
+  // Reused by the I/O syscalls, so they don't allocate on every call
+  std::vector<IOVec> io_regions;
+  std::vector<char>  io_buffer;
+
+  // Hands the request to `submit` as an asynchronous syscall, involving the guest's memory [address, address + count)
+  // Returns `true` if it has been accepted, the CPU is then waiting for its completion.
+  template<typename Submit>
+  bool submit_async( std::uint32_t address, std::uint32_t count, bool writes_v0, Submit submit ) noexcept;
+
+  // Returns `true` while the CPU must wait for an asynchronous syscall,
+  // otherwise applies the result of the completed one (if any).
+  bool waiting_io() noexcept;
 
   void reserved( std::uint32_t word ) noexcept;
 
@@ -92,6 +265,7 @@ private:
   void aui( std::uint32_t word ) noexcept;
   void cop0( std::uint32_t word ) noexcept;
   void cop1( std::uint32_t word ) noexcept;
+  void msa( std::uint32_t word ) noexcept;
   void pop26( std::uint32_t word ) noexcept;
   void pop27( std::uint32_t word ) noexcept;
   void pop30( std::uint32_t word ) noexcept;
@@ -208,9 +382,15 @@ private:
   template <int op>
   void op_word( std::uint32_t word ) noexcept;
 
-  template <int op>
+  // Without `traced` the caller records the access, e.g. a doubleword as a whole
+  template <int op, bool traced = true>
   void op_word( std::uint32_t _rt, std::uint32_t address, std::uint32_t word ) noexcept;
 
+  // Loads or stores `value` at `address`, that may be unaligned, without signaling the exception.
+  // Returns the exception's cause, 0 if none.
+  template <int op>
+  std::uint32_t access_word( std::uint32_t address, std::uint32_t &value ) noexcept;
+
   void enter_kernel_mode() noexcept;
   void enter_user_mode() noexcept;
 
@@ -250,7 +430,7 @@ private:
       &CPU::reserved, // beta
       &CPU::reserved, // SPECIAL2
       &CPU::reserved, // JALX
-      &CPU::reserved, // MSA
+      &CPU::msa,
       &CPU::special3,
       &CPU::lb,
       &CPU::lh,
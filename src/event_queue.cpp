@@ -0,0 +1,67 @@
+#include "event_queue.hpp"
+
+#include <algorithm>
+
+namespace mips32
+{
+EventId EventQueue::schedule( std::uint64_t when, EventCallback callback, void *user_data ) noexcept
+{
+  heap.push_back( { when, ++last_id, callback, user_data } );
+  std::push_heap( heap.begin(), heap.end(), later );
+
+  return last_id;
+}
+
+bool EventQueue::cancel( EventId id ) noexcept
+{
+  auto const matches = [id]( Event const &event ) { return event.id == id; };
+
+  auto const pending = std::find_if( heap.begin(), heap.end(), matches );
+
+  if ( pending != heap.end() )
+  {
+    heap.erase( pending );
+    std::make_heap( heap.begin(), heap.end(), later );
+    return false;
+  }
+
+  // Popped by `run`, but not called yet
+  auto const running = std::find_if( due.begin(), due.end(), matches );
+
+  if ( running != due.end() && running->callback )
+  {
+    running->callback = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+void EventQueue::run( std::uint64_t now ) noexcept
+{
+  while ( !heap.empty() && heap.front().when <= now )
+  {
+    std::pop_heap( heap.begin(), heap.end(), later );
+    due.push_back( heap.back() );
+    heap.pop_back();
+  }
+
+  // A callback can cancel the events that follow it
+  for ( std::size_t i = 0; i < due.size(); ++i )
+  {
+    if ( auto const callback = due[i].callback )
+    {
+      due[i].callback = nullptr;
+      callback( due[i].user_data );
+    }
+  }
+
+  due.clear();
+}
+
+void EventQueue::clear() noexcept
+{
+  heap.clear();
+  due.clear();
+}
+} // namespace mips32
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <mips32/event.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Min-heap of events keyed by the cycle they are due at.
+ *
+ * Events due at the same cycle run in the order they have been scheduled,
+ * so a run is deterministic.
+ **/
+class EventQueue
+{
+public:
+  static inline constexpr std::uint64_t never{ ~std::uint64_t( 0 ) };
+
+  EventId schedule( std::uint64_t when, EventCallback callback, void *user_data ) noexcept;
+
+  // Returns:
+  // `true`  - in case of *failure*, the event already ran or doesn't exist
+  // `false` - in case of success
+  bool cancel( EventId id ) noexcept;
+
+  // Cycle of the earliest event, `never` if empty
+  std::uint64_t next() const noexcept { return heap.empty() ? never : heap.front().when; }
+
+  // Runs every event due at `now`.
+  // The events scheduled by the callbacks wait for the next call, even if they are already due.
+  void run( std::uint64_t now ) noexcept;
+
+  void clear() noexcept;
+
+  std::size_t size() const noexcept { return heap.size(); }
+
+private:
+  struct Event
+  {
+    std::uint64_t when;
+    EventId       id;
+    EventCallback callback; // nullptr if cancelled while running
+    void *        user_data;
+  };
+
+  // The heap's top is the earliest event
+  static bool later( Event const &a, Event const &b ) noexcept
+  {
+    return a.when != b.when ? a.when > b.when : a.id > b.id;
+  }
+
+  std::vector<Event> heap;
+  std::vector<Event> due; // popped by `run`, still to be called
+
+  EventId last_id{ 0 };
+};
+} // namespace mips32
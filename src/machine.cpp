@@ -1,9 +1,13 @@
 #include <mips32/machine.hpp>
+#include <mips32/executable.hpp>
 #include <mips32/literals.hpp>
 
 #include "ram.hpp"
+#include "ram_io.hpp"
 #include "cpu.hpp"
 
+#include <cstring>
+
 namespace mips32
 {
 using namespace mips32::literals;
@@ -15,7 +19,7 @@ class MachineImpl
   friend class MachineInspector;
 
 public:
-  MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept;
+  MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, FPUBackend fpu_backend ) noexcept;
 
   MachineImpl( MachineImpl const& ) = delete;
 
@@ -35,8 +39,16 @@ public:
 
   void reset() noexcept;
 
+  EventId schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept;
+  bool    cancel( EventId id ) noexcept;
+
+  void raise_interrupt( std::uint32_t line ) noexcept;
+  void clear_interrupt( std::uint32_t line ) noexcept;
+
   IODevice* swap_io_device( IODevice *device ) noexcept;
   FileHandler* swap_file_handler( FileHandler *handler ) noexcept;
+  Profiler* swap_profiler( Profiler *profiler ) noexcept;
+  MemoryTracer* swap_tracer( MemoryTracer *tracer ) noexcept;
 
 private:
   RAM ram;
@@ -44,8 +56,8 @@ private:
 };
 }
 
-Machine::Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept
-  : _impl( new MachineImpl( ram_alloc_limit, io_device, file_handler ) )
+Machine::Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, FPUBackend fpu_backend ) noexcept
+  : _impl( new MachineImpl( ram_alloc_limit, io_device, file_handler, fpu_backend ) )
 {}
 
 Machine::~Machine() { delete _impl; }
@@ -62,12 +74,24 @@ std::uint32_t Machine::single_step() noexcept { return _impl->single_step(); }
 
 void Machine::reset() noexcept { _impl->reset(); }
 
+EventId Machine::schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept { return _impl->schedule( delay, callback, user_data ); }
+
+bool Machine::cancel( EventId id ) noexcept { return _impl->cancel( id ); }
+
+void Machine::raise_interrupt( std::uint32_t line ) noexcept { _impl->raise_interrupt( line ); }
+
+void Machine::clear_interrupt( std::uint32_t line ) noexcept { _impl->clear_interrupt( line ); }
+
 IODevice* Machine::swap_iodevice( IODevice *device ) noexcept { return _impl->swap_io_device( device ); }
 
 FileHandler* Machine::swap_file_handler( FileHandler *handler ) noexcept { return _impl->swap_file_handler( handler ); }
 
-v0::MachineImpl::MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept
-  : ram( ram_alloc_limit ), cpu( ram )
+Profiler* Machine::swap_profiler( Profiler *profiler ) noexcept { return _impl->swap_profiler( profiler ); }
+
+MemoryTracer* Machine::swap_tracer( MemoryTracer *tracer ) noexcept { return _impl->swap_tracer( tracer ); }
+
+v0::MachineImpl::MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, FPUBackend fpu_backend ) noexcept
+  : ram( ram_alloc_limit ), cpu( ram, fpu_backend )
 {
   cpu.attach_iodevice( io_device );
   cpu.attach_file_handler( file_handler );
@@ -88,10 +112,94 @@ std::uint32_t v0::MachineImpl::single_step() noexcept { return cpu.single_step()
 
 void v0::MachineImpl::reset() noexcept { cpu.hard_reset(); }
 
+EventId v0::MachineImpl::schedule( std::uint64_t delay, EventCallback callback, void *user_data ) noexcept { return cpu.schedule( delay, callback, user_data ); }
+
+bool v0::MachineImpl::cancel( EventId id ) noexcept { return cpu.cancel( id ); }
+
+void v0::MachineImpl::raise_interrupt( std::uint32_t line ) noexcept { cpu.raise_interrupt( line ); }
+
+void v0::MachineImpl::clear_interrupt( std::uint32_t line ) noexcept { cpu.clear_interrupt( line ); }
+
 IODevice* v0::MachineImpl::swap_io_device( IODevice *device ) noexcept { return cpu.attach_iodevice( device ); }
 
 FileHandler* v0::MachineImpl::swap_file_handler( FileHandler *handler ) noexcept { return cpu.attach_file_handler( handler ); }
 
-bool v0::MachineImpl::load( void const * data ) noexcept { return false; }
+Profiler* v0::MachineImpl::swap_profiler( Profiler *profiler ) noexcept { return cpu.attach_profiler( profiler ); }
+
+MemoryTracer* v0::MachineImpl::swap_tracer( MemoryTracer *tracer ) noexcept { return cpu.attach_tracer( tracer ); }
+
+namespace
+{
+// Initial $sp, the top of useg's stack
+constexpr std::uint32_t stack_pointer{ 0x7FFF'EFFC };
+
+// A section can't wrap around the address space
+bool overflows( std::uint32_t address, std::uint32_t size ) noexcept
+{
+  return size && address + ( size - 1 ) < address;
+}
+} // namespace
+
+bool v0::MachineImpl::load( void const * data ) noexcept
+{
+  ExecutableHeader header;
+  std::memcpy( &header, data, sizeof( header ) );
+
+  if ( std::memcmp( header.magic, ExecutableHeader::magic_string, sizeof( header.magic ) ) ||
+       !header.version || header.version > ExecutableHeader::current_version )
+    return true;
+
+  if ( !header.text_sz && !header.ktext_sz )
+    return true;
+
+  if ( overflows( header.data_addr, header.data_sz ) || overflows( header.text_addr, header.text_sz ) ||
+       overflows( header.kdata_addr, header.kdata_sz ) || overflows( header.ktext_addr, header.ktext_sz ) )
+    return true;
+
+  auto const entry = header.text_sz ? header.text_addr : header.ktext_addr;
+  if ( entry & 0b11 )
+    return true;
+
+  // The handler of an asynchronous syscall could write into the new sections
+  if ( cpu.io_in_flight() )
+    return true;
+
+  cpu.hard_reset();
+
+  RAMIO io{ ram };
+  auto const *section = static_cast<char const *>( data ) + sizeof( header );
+
+  struct
+  {
+    std::uint32_t address, size;
+  } const sections[] = {
+    { header.data_addr, header.data_sz },
+    { header.text_addr, header.text_sz },
+    { header.kdata_addr, header.kdata_sz },
+    { header.ktext_addr, header.ktext_sz },
+  };
+
+  for ( auto const &s : sections )
+  {
+    if ( s.size )
+      io.write( s.address, section, s.size );
+    section += s.size;
+  }
+
+  if ( header.version >= 2 )
+  {
+    std::uint32_t symtab_sz;
+    std::memcpy( &symtab_sz, section, sizeof( symtab_sz ) );
+
+    if ( auto *profiler = cpu.attached_profiler() )
+      profiler->load_symbols( section + sizeof( symtab_sz ), symtab_sz );
+  }
+
+  auto inspector = get_inspector();
+  inspector.CPU_pc() = entry;
+  inspector.CPU_gpr_begin()[29] = stack_pointer;
+
+  return false;
+}
 
 }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #include <mips32/cp0.hpp>
+#include "block_codec.hpp"
 #include "cp1.hpp"
 #include "cpu.hpp"
+#include "mapped_file.hpp"
 #include "ram.hpp"
 #include "ram_io.hpp"
 
 #include <mips32/machine_inspector.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
+#include <memory>
+#include <new>
 #include <string>
 
 namespace mips32
@@ -51,15 +56,14 @@ MachineInspector &MachineInspector::inspect( CPU &cpu, bool sub_components ) noe
 bool MachineInspector::save_state( Component c, char const *name ) noexcept
 {
   cpu->stop();
+  cpu->sync_count();
+  cpu->cp1.collect_exceptions();
 
   bool error = true;
 
   if ( c == Component::ALL )
   {
-    error = save_state_cp0( name );
-    error |= save_state_cp1( name );
-    error |= save_state_cpu( name );
-    error |= save_state_ram( name );
+    error = save_state_all( name );
   }
   else if ( c == Component::CP0 )
   {
@@ -85,14 +89,15 @@ bool MachineInspector::restore_state( Component c, char const *name ) noexcept
 {
   cpu->stop();
 
+  // The handler of an asynchronous syscall could write into blocks that are about to be replaced
+  if ( cpu->io_in_flight() )
+    return true;
+
   bool error = true;
 
   if ( c == Component::ALL )
   {
-    error = restore_state_cp0( name );
-    error |= restore_state_cp1( name );
-    error |= restore_state_cpu( name );
-    error |= restore_state_ram( name );
+    error = restore_state_all( name );
   }
   else if ( c == Component::CP0 )
   {
@@ -111,6 +116,12 @@ bool MachineInspector::restore_state( Component c, char const *name ) noexcept
     error = restore_state_ram( name );
   }
 
+  if ( !error )
+  {
+    cpu->restore_timer();
+    cpu->cp1.clear_host_exceptions(); // raised before the restore
+  }
+
   return error;
 }
 
@@ -171,6 +182,20 @@ noexcept
   return addresses;
 }
 
+std::uint32_t MachineInspector::RAM_mapped_files_no() const noexcept
+{
+  std::vector<MappedFile const *> files;
+
+  for ( auto const &block : ram->blocks )
+  {
+    if ( auto const *file = block.data.get_deleter().mapping.get() )
+      files.push_back( file );
+  }
+
+  std::sort( files.begin(), files.end() );
+  return ( std::uint32_t )( std::unique( files.begin(), files.end() ) - files.begin() );
+}
+
 std::vector<char> MachineInspector::RAM_read( std::uint32_t address, std::uint32_t count, bool read_string ) noexcept
 {
   return RAMIO( *ram ).read( address, count, read_string );
@@ -181,6 +206,68 @@ void MachineInspector::RAM_write( std::uint32_t address, void const * src, std::
   RAMIO( *ram ).write( address, src, count );
 }
 
+/**
+ * The blocks are looked up again after each callback,
+ * because the callback may have reordered them (e.g. by swapping another block).
+ **/
+std::uint32_t MachineInspector::RAM_visit( std::uint32_t address, std::uint32_t count, RAMVisitor visitor, void * user_data ) noexcept
+{
+  std::uint32_t visited = 0;
+
+  while ( count )
+  {
+    auto block = std::find_if( ram->blocks.begin(), ram->blocks.end(), [address] ( RAM::Block const &b )
+    {
+      return b.base_address <= address && address - b.base_address < RAM::block_size;
+    } );
+
+    if ( block == ram->blocks.end() )
+      break;
+
+    std::uint32_t const base = block->base_address;
+    std::uint32_t const begin = address - base;
+    std::uint32_t const size = std::min( count, RAM::block_size - begin );
+
+    ++block->pin_count;
+
+    bool const proceed = visitor( { address, ( char * )block->data.get() + begin, size }, user_data );
+
+    for ( auto &b : ram->blocks )
+    {
+      if ( b.base_address == base && b.pin_count )
+      {
+        --b.pin_count;
+        break;
+      }
+    }
+
+    visited += size;
+    count -= size;
+    address += size;
+
+    // Stopped by the visitor, or the address overflowed
+    if ( !proceed || address == 0 )
+      break;
+  }
+
+  return visited;
+}
+
+std::uint32_t MachineInspector::RAM_read_into( std::uint32_t address, void * dst, std::uint32_t count ) noexcept
+{
+  return RAMIO( *ram ).read_into( address, dst, count );
+}
+
+std::uint32_t MachineInspector::RAM_write_from( std::uint32_t address, void const * src, std::uint32_t count ) noexcept
+{
+  // only valid memory region can be used, it may end at the end of the address space
+  if ( count && address + ( count - 1 ) < address )
+    return 0;
+
+  RAMIO( *ram ).write( address, src, count );
+  return count;
+}
+
 /* * * * *
  *       *
  * COP 1 *
@@ -203,8 +290,27 @@ std::uint32_t MachineInspector::CP1_fir() const noexcept
 
 std::uint32_t MachineInspector::CP1_fcsr() const noexcept
 {
+  cp1->collect_exceptions();
   return cp1->fcsr;
 }
+
+std::array<std::uint64_t, 2> MachineInspector::CP1_read_vpr( std::uint32_t reg ) const noexcept
+{
+  assert( reg < 32 && "Invalid Vector Register!" );
+  return { cp1->fpr[reg].i64, cp1->vpr_high[reg] };
+}
+
+void MachineInspector::CP1_write_vpr( std::uint32_t reg, std::array<std::uint64_t, 2> value ) noexcept
+{
+  assert( reg < 32 && "Invalid Vector Register!" );
+  cp1->fpr[reg].i64 = value[0];
+  cp1->vpr_high[reg] = value[1];
+}
+
+std::uint32_t MachineInspector::CP1_msacsr() const noexcept
+{
+  return cp1->msacsr;
+}
 /* * * *
  *     *
  * CPU *
@@ -226,6 +332,11 @@ std::uint32_t &MachineInspector::CPU_pc() noexcept
   return cpu->pc;
 }
 
+std::uint32_t &MachineInspector::CPU_program_break() noexcept
+{
+  return cpu->program_break;
+}
+
 std::uint32_t MachineInspector::CPU_read_exit_code() const noexcept
 {
   return cpu->exit_code.load( std::memory_order_acquire );
@@ -236,6 +347,120 @@ void MachineInspector::CPU_write_exit_code( std::uint32_t value ) noexcept
   cpu->exit_code.store( value, std::memory_order_release );
 }
 
+std::uint64_t MachineInspector::CPU_cycles() const noexcept
+{
+  return cpu->cycles;
+}
+
+void MachineInspector::CPU_set_timing_model( TimingModel const & model ) noexcept
+{
+  cpu->set_timing_model( model );
+}
+
+bool MachineInspector::CPU_counters_enabled() const noexcept
+{
+  return CPU::counters_enabled;
+}
+
+std::uint64_t MachineInspector::CPU_counter( CounterGroup group, std::uint32_t code ) const noexcept
+{
+  auto const index = std::uint64_t( group ) * CPU::counter_group_size + code;
+
+  if ( code >= CPU::counter_group_size || index >= cpu->counters.size() )
+    return 0;
+
+  return cpu->counters[index];
+}
+
+void MachineInspector::CPU_reset_counters() noexcept
+{
+  cpu->counters.fill( 0 );
+}
+
+bool MachineInspector::CPU_export_counters( std::FILE * out, CounterFormat format ) const noexcept
+{
+  constexpr char const *group_names[]{ "opcode", "special", "cop1" };
+
+  bool error = false;
+
+  if ( format == CounterFormat::CSV )
+    error |= std::fputs( "group,code,count\n", out ) < 0;
+  else
+    error |= std::fputc( '{', out ) == EOF;
+
+  for ( std::uint32_t group = 0; group < 3; ++group )
+  {
+    if ( format == CounterFormat::JSON )
+      error |= std::fprintf( out, "%s\"%s\":{", group ? "," : "", group_names[group] ) < 0;
+
+    bool first = true;
+
+    for ( std::uint32_t code = 0; code < CPU::counter_group_size; ++code )
+    {
+      auto const count = CPU_counter( CounterGroup( group ), code );
+      if ( !count )
+        continue;
+
+      if ( format == CounterFormat::CSV )
+        error |= std::fprintf( out, "%s,0x%02X,%llu\n", group_names[group], code, ( unsigned long long )count ) < 0;
+      else
+        error |= std::fprintf( out, "%s\"0x%02X\":%llu", first ? "" : ",", code, ( unsigned long long )count ) < 0;
+
+      first = false;
+    }
+
+    if ( format == CounterFormat::JSON )
+      error |= std::fputc( '}', out ) == EOF;
+  }
+
+  if ( format == CounterFormat::JSON )
+    error |= std::fputs( "}\n", out ) < 0;
+
+  return error || std::ferror( out );
+}
+
+/* * * * *
+ *       *
+ * CACHE *
+ *       *
+ * * * * */
+
+bool MachineInspector::Cache_enable( CacheConfig const & l1i, CacheConfig const & l1d, CacheConfig const & l2 ) noexcept
+{
+  if ( Cache::invalid( l1i ) || Cache::invalid( l1d ) || Cache::invalid( l2 ) )
+    return true;
+
+  cpu->mmu.caches.reset( new ( std::nothrow ) CacheHierarchy( l1i, l1d, l2 ) );
+
+  return !cpu->mmu.caches;
+}
+
+void MachineInspector::Cache_disable() noexcept
+{
+  cpu->mmu.caches.reset();
+}
+
+bool MachineInspector::Cache_enabled() const noexcept
+{
+  return bool( cpu->mmu.caches );
+}
+
+CacheStats MachineInspector::Cache_stats( CacheLevel level ) const noexcept
+{
+  auto const &caches = cpu->mmu.caches;
+
+  if ( !caches )
+    return {};
+
+  if ( level == CacheLevel::L1I )
+    return caches->l1i.stats;
+
+  if ( level == CacheLevel::L1D )
+    return caches->l1d.stats;
+
+  return caches->l2.stats;
+}
+
 CP0 & MachineInspector::access_CP0() noexcept
 {
   return *cp0;
@@ -248,7 +473,7 @@ CP0 & MachineInspector::access_CP0() noexcept
  * * * * * * * * */
 
 constexpr std::uint32_t magic_tag{ 0x66'61'6D'61 };
-constexpr std::uint32_t version_tag{ 0x1 };
+constexpr std::uint32_t version_tag{ 0x4 };
 
 struct StateHeader
 {
@@ -262,6 +487,16 @@ bool is_valid( StateHeader header ) noexcept
     && header.version == version_tag;
 }
 
+// The RAM header of a state: a corrupted one must be rejected before anything is allocated for it.
+// The blocks, allocated and swapped, are distinct, so they can't outnumber the blocks of the address space.
+bool is_valid_ram( std::uint32_t alloc_limit, std::uint32_t blocks_no, std::uint32_t swap_no ) noexcept
+{
+  constexpr std::uint64_t address_space_blocks{ 0x1'0000'0000 / RAM::block_size };
+
+  return alloc_limit && blocks_no <= alloc_limit && alloc_limit <= address_space_blocks
+    && std::uint64_t( blocks_no ) + swap_no <= address_space_blocks;
+}
+
 bool read_tag( std::FILE* file ) noexcept
 {
   StateHeader header;
@@ -401,7 +636,9 @@ bool MachineInspector::save_state_cp0( char const * name ) const noexcept
  * uint32_t * 32, fprs
  * uint32_t, fir
  * uint32_t, fcsr
- * fenv_t, env
+ * uint32_t, mxcsr
+ * uint64_t * 32, upper halves of the vector registers
+ * uint32_t, msacsr
  **/
 bool MachineInspector::save_state_cp1( char const * name ) const noexcept
 {
@@ -422,12 +659,16 @@ bool MachineInspector::save_state_cp1( char const * name ) const noexcept
   [[maybe_unused]] auto fpr_write_count = std::fwrite( cp1->fpr.data(), sizeof( cp1->fpr[0] ), 32, file );
   [[maybe_unused]] auto fir_write_count = std::fwrite( &cp1->fir, sizeof( cp1->fir ), 1, file );
   [[maybe_unused]] auto fcsr_write_count = std::fwrite( &cp1->fcsr, sizeof( cp1->fcsr ), 1, file );
-  [[maybe_unused]] auto env_write_count = std::fwrite( &cp1->env, sizeof( cp1->env ), 1, file );
+  [[maybe_unused]] auto mxcsr_write_count = std::fwrite( &cp1->mxcsr, sizeof( cp1->mxcsr ), 1, file );
+  [[maybe_unused]] auto vpr_write_count = std::fwrite( cp1->vpr_high.data(), sizeof( cp1->vpr_high[0] ), 32, file );
+  [[maybe_unused]] auto msacsr_write_count = std::fwrite( &cp1->msacsr, sizeof( cp1->msacsr ), 1, file );
 
   assert( fpr_write_count == 32 && "Couldn't write the FPRs to file!" );
   assert( fir_write_count == 1 && "Couldn't write FIR to file!" );
   assert( fcsr_write_count == 1 && "Couldn't write FCSR to file!" );
-  assert( env_write_count == 1 && "Couldn't write ENV to file!" );
+  assert( mxcsr_write_count == 1 && "Couldn't write MXCSR to file!" );
+  assert( vpr_write_count == 32 && "Couldn't write the vector registers to file!" );
+  assert( msacsr_write_count == 1 && "Couldn't write MSACSR to file!" );
 
   std::fflush( file );
   bool error = std::ferror( file );
@@ -452,6 +693,7 @@ bool MachineInspector::save_state_cp1( char const * name ) const noexcept
  *
  * uint32_t, pc
  * uint32_t * 32, gprs
+ * uint32_t, program break
  * exit_code is always restored as `NONE`
  **/
 bool MachineInspector::save_state_cpu( char const * name ) const noexcept
@@ -486,9 +728,11 @@ bool MachineInspector::save_state_cpu( char const * name ) const noexcept
   // CPU
   [[maybe_unused]] auto pc_write_count = std::fwrite( &cpu->pc, sizeof( cpu->pc ), 1, file );
   [[maybe_unused]] auto gpr_write_count = std::fwrite( cpu->gpr.data(), sizeof( cpu->gpr[0] ), cpu->gpr.size(), file );
+  [[maybe_unused]] auto brk_write_count = std::fwrite( &cpu->program_break, sizeof( cpu->program_break ), 1, file );
 
   assert( pc_write_count == 1 && "Couldn't write PC to file!" );
   assert( gpr_write_count == cpu->gpr.size() && "Couldn't write GPRs to file!" );
+  assert( brk_write_count == 1 && "Couldn't write the program break to file!" );
 
   //std::fflush( file );
   bool error = std::ferror( file );
@@ -539,6 +783,12 @@ bool MachineInspector::restore_state_ram( char const * name ) noexcept
   assert( blocks_read_count == 1 && "Couldn't read the number of allocated blocks from file!" );
   assert( swap_read_count == 1 && "Couldn't read the number of swapped blocks from file!" );
 
+  if ( !is_valid_ram( _alloc_limit, _blocks_no, _swap_no ) )
+  {
+    std::fclose( file );
+    return true;
+  }
+
   ram->alloc_limit = _alloc_limit;
 
   // 2
@@ -629,9 +879,8 @@ bool MachineInspector::restore_state_cp0( char const * name ) noexcept
 //// 
 /**
  * After reading back the data we need to:
- * 1. set the FP Environment,
- * 2. set the rounding mode,
- * 3. set flushing mode for denormalized numbers
+ * 1. set the rounding mode,
+ * 2. set flushing mode for denormalized numbers
  **/
 bool MachineInspector::restore_state_cp1( char const * name ) noexcept
 {
@@ -651,16 +900,18 @@ bool MachineInspector::restore_state_cp1( char const * name ) noexcept
   [[maybe_unused]] auto fpr_read_count = std::fread( cp1->fpr.data(), sizeof( FPR ), cp1->fpr.size(), file );
   [[maybe_unused]] auto fir_read_count = std::fread( &cp1->fir, sizeof( cp1->fir ), 1, file );
   [[maybe_unused]] auto fcsr_read_count = std::fread( &cp1->fcsr, sizeof( cp1->fcsr ), 1, file );
-  [[maybe_unused]] auto env_read_count = std::fread( &cp1->env, sizeof( cp1->env ), 1, file );
+  [[maybe_unused]] auto mxcsr_read_count = std::fread( &cp1->mxcsr, sizeof( cp1->mxcsr ), 1, file );
+  [[maybe_unused]] auto vpr_read_count = std::fread( cp1->vpr_high.data(), sizeof( cp1->vpr_high[0] ), cp1->vpr_high.size(), file );
+  [[maybe_unused]] auto msacsr_read_count = std::fread( &cp1->msacsr, sizeof( cp1->msacsr ), 1, file );
 
   assert( fpr_read_count == 32 && "Couldn't read the FPRs from file!" );
   assert( fir_read_count == 1 && "Couldn't read FIR from file!" );
   assert( fcsr_read_count == 1 && "Couldn't read FCSR from file!" );
-  assert( env_read_count == 1 && "Couldn't read ENV from file!" );
+  assert( mxcsr_read_count == 1 && "Couldn't read MXCSR from file!" );
+  assert( vpr_read_count == 32 && "Couldn't read the vector registers from file!" );
+  assert( msacsr_read_count == 1 && "Couldn't read MSACSR from file!" );
 
-  std::fesetenv( &cp1->env );
-  cp1->set_round_mode();
-  cp1->set_denormal_flush();
+  cp1->restore_mxcsr();
 
   bool error = std::ferror( file );
   std::fclose( file );
@@ -683,6 +934,7 @@ bool MachineInspector::restore_state_cp1( char const * name ) noexcept
  *
  * uint32_t, pc
  * uint32_t * 32, gprs
+ * uint32_t, program break
  * exit_code is always NONE
  **/
 bool MachineInspector::restore_state_cpu( char const * name ) noexcept
@@ -720,10 +972,12 @@ bool MachineInspector::restore_state_cpu( char const * name ) noexcept
   // CPU
   [[maybe_unused]] auto pc_read_count = std::fread( &cpu->pc, sizeof( cpu->pc ), 1, file );
   [[maybe_unused]] auto gpr_read_count = std::fread( cpu->gpr.data(), sizeof( cpu->gpr[0] ), cpu->gpr.size(), file );
+  [[maybe_unused]] auto brk_read_count = std::fread( &cpu->program_break, sizeof( cpu->program_break ), 1, file );
   cpu->exit_code.store( 0, std::memory_order_release );
 
   assert( pc_read_count == 1 && "Couldn't read PC from file!" );
   assert( gpr_read_count == cpu->gpr.size() && "Couldn't read GPRs from file!" );
+  assert( brk_read_count == 1 && "Couldn't read the program break from file!" );
 
   bool error = std::ferror( file );
 
@@ -731,4 +985,635 @@ bool MachineInspector::restore_state_cpu( char const * name ) noexcept
   return error;
 }
 
-} // namespace mips32
\ No newline at end of file
+////
+//// ALL
+////
+/**
+ * A single file that holds every component, described by a section table.
+ * Every offset is absolute, from the beginning of the file.
+ *
+ * StateHeader
+ * uint32_t, section_no
+ * uint32_t, reserved
+ * SnapshotSection * section_no, sections
+ *
+ * -- CP0 --
+ * Trivially copyable
+ *
+ * -- CP1 --
+ * see `save_state_cp1`
+ *
+ * -- CPU --
+ * see `save_state_cpu`, without CP0 and CP1
+ *
+ * -- RAM --
+ * uint32_t -> alloc_limit
+ * uint32_t -> blocks_no
+ * uint32_t -> swap_no
+ * uint32_t -> reserved
+ * SnapshotBlock * (blocks_no + swap_no)
+ *
+ * The blocks data is stored after all the sections, each block is aligned
+ * to `snapshot_alignment` so it can be used in place from a memory mapping.
+ **/
+
+constexpr std::uint64_t snapshot_alignment{ 4096 };
+
+enum SnapshotSectionID : std::uint32_t
+{
+  SECTION_CP0,
+  SECTION_CP1,
+  SECTION_CPU,
+  SECTION_RAM,
+  SECTION_NO
+};
+
+struct SnapshotSection
+{
+  std::uint32_t id;
+  std::uint32_t reserved;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+struct SnapshotBlock
+{
+  std::uint32_t base_address;
+  std::uint32_t access_count;
+  std::uint64_t offset;
+};
+
+constexpr std::uint64_t align_to( std::uint64_t offset, std::uint64_t alignment ) noexcept
+{
+  return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+// Keeps track of the position inside the file, so the offsets can be calculated without seeking.
+struct SnapshotWriter
+{
+  std::FILE *   file;
+  std::uint64_t offset{ 0 };
+
+  void write( void const *src, std::size_t size ) noexcept
+  {
+    offset += std::fwrite( src, 1, size, file );
+  }
+
+  void pad_to( std::uint64_t position ) noexcept
+  {
+    assert( position >= offset && "Padding would move the file position backwards" );
+
+    constexpr char zeros[64]{};
+    while ( offset < position )
+      write( zeros, ( std::size_t )std::min<std::uint64_t>( sizeof( zeros ), position - offset ) );
+  }
+};
+
+bool MachineInspector::save_state_all( char const * name ) const noexcept
+{
+  std::string file_name{ name };
+  file_name += ".state";
+
+  auto * file = std::fopen( file_name.c_str(), "wb" );
+  if ( !file )
+    return true;
+
+  if ( write_tag( file ) )
+  {
+    std::fclose( file );
+    return true;
+  }
+
+  SnapshotWriter out{ file, sizeof( StateHeader ) };
+
+  std::uint32_t const _segment_no = ( std::uint32_t )cpu->mmu.segments.size();
+  std::uint32_t const _alloc_limit = ram->alloc_limit;
+  std::uint32_t const _blocks_no = ( std::uint32_t )ram->blocks.size();
+  std::uint32_t const _swap_no = ( std::uint32_t )ram->swapped.size();
+
+  // Layout
+  std::uint64_t const sizes[SECTION_NO]{
+    sizeof( CP0 ),
+    sizeof( FPR ) * cp1->fpr.size() + sizeof( cp1->fir ) + sizeof( cp1->fcsr ) + sizeof( cp1->mxcsr )
+      + sizeof( cp1->vpr_high[0] ) * cp1->vpr_high.size() + sizeof( cp1->msacsr ),
+    sizeof( _segment_no ) + sizeof( MMU::Segment ) * _segment_no + sizeof( cpu->pc ) + sizeof( cpu->gpr[0] ) * cpu->gpr.size() + sizeof( cpu->program_break ),
+    sizeof( std::uint32_t ) * 4 + sizeof( SnapshotBlock ) * ( std::uint64_t( _blocks_no ) + _swap_no ),
+  };
+
+  SnapshotSection sections[SECTION_NO];
+  std::uint64_t   offset = out.offset + sizeof( std::uint32_t ) * 2 + sizeof( sections );
+
+  for ( std::uint32_t i = 0; i < SECTION_NO; ++i )
+  {
+    offset = align_to( offset, 8 );
+    sections[i] = { i, 0, offset, sizes[i] };
+    offset += sizes[i];
+  }
+
+  std::uint64_t const data_offset = align_to( offset, snapshot_alignment );
+
+  // Section table
+  std::uint32_t const _section_no = SECTION_NO;
+  std::uint32_t const _reserved = 0;
+
+  out.write( &_section_no, sizeof( _section_no ) );
+  out.write( &_reserved, sizeof( _reserved ) );
+  out.write( sections, sizeof( sections ) );
+
+  // CP0
+  out.pad_to( sections[SECTION_CP0].offset );
+  out.write( cp0, sizeof( CP0 ) );
+
+  // CP1
+  out.pad_to( sections[SECTION_CP1].offset );
+  out.write( cp1->fpr.data(), sizeof( FPR ) * cp1->fpr.size() );
+  out.write( &cp1->fir, sizeof( cp1->fir ) );
+  out.write( &cp1->fcsr, sizeof( cp1->fcsr ) );
+  out.write( &cp1->mxcsr, sizeof( cp1->mxcsr ) );
+  out.write( cp1->vpr_high.data(), sizeof( cp1->vpr_high[0] ) * cp1->vpr_high.size() );
+  out.write( &cp1->msacsr, sizeof( cp1->msacsr ) );
+
+  // CPU
+  out.pad_to( sections[SECTION_CPU].offset );
+  out.write( &_segment_no, sizeof( _segment_no ) );
+  out.write( cpu->mmu.segments.data(), sizeof( MMU::Segment ) * _segment_no );
+  out.write( &cpu->pc, sizeof( cpu->pc ) );
+  out.write( cpu->gpr.data(), sizeof( cpu->gpr[0] ) * cpu->gpr.size() );
+  out.write( &cpu->program_break, sizeof( cpu->program_break ) );
+
+  // RAM
+  out.pad_to( sections[SECTION_RAM].offset );
+  out.write( &_alloc_limit, sizeof( _alloc_limit ) );
+  out.write( &_blocks_no, sizeof( _blocks_no ) );
+  out.write( &_swap_no, sizeof( _swap_no ) );
+  out.write( &_reserved, sizeof( _reserved ) );
+
+  std::uint64_t block_offset = data_offset;
+
+  for ( auto const & block : ram->blocks )
+  {
+    SnapshotBlock entry{ block.base_address, block.access_count, block_offset };
+    out.write( &entry, sizeof( entry ) );
+    block_offset += RAM::block_size;
+  }
+
+  for ( auto const & block : ram->swapped )
+  {
+    SnapshotBlock entry{ block.base_address, 0, block_offset };
+    out.write( &entry, sizeof( entry ) );
+    block_offset += RAM::block_size;
+  }
+
+  // Blocks data
+  out.pad_to( data_offset );
+
+  for ( auto const & block : ram->blocks )
+    out.write( block.data.get(), RAM::block_size );
+
+  if ( _swap_no )
+  {
+    RAM::Block swapped_block;
+    swapped_block.allocate();
+
+    if ( !swapped_block.data )
+    {
+      std::fclose( file );
+      return true;
+    }
+
+    for ( auto const & block : ram->swapped )
+    {
+      swapped_block.base_address = block.base_address;
+      swapped_block.deserialize();
+
+      out.write( swapped_block.data.get(), RAM::block_size );
+    }
+  }
+
+  assert( out.offset == block_offset && "Couldn't write the whole state to file!" );
+
+  bool error = std::ferror( file ) || out.offset != block_offset;
+
+  error |= std::fclose( file ) != 0;
+  return error;
+}
+
+/**
+ * 1. Map the file and validate the section table
+ * 2. Copy CP0, CP1 and CPU from the mapping
+ * 3. Point the allocated blocks inside the mapping
+ * 4. Write the swapped blocks back to disk
+ *
+ * The mapping is private, so the blocks can be freely modified
+ * and it is released when no block can refer to it anymore.
+ **/
+bool MachineInspector::restore_state_all( char const * name ) noexcept
+{
+  std::string file_name{ name };
+  file_name += ".state";
+
+  MappedFile state;
+  if ( state.open( file_name.c_str() ) )
+    return true;
+
+  char const *        base = state.data();
+  std::uint64_t const size = state.size();
+
+  // 1
+  StateHeader header;
+  std::uint32_t _section_no = 0;
+
+  if ( size < sizeof( StateHeader ) + sizeof( std::uint32_t ) * 2 )
+    return true;
+
+  std::memcpy( &header, base, sizeof( header ) );
+  std::memcpy( &_section_no, base + sizeof( header ), sizeof( _section_no ) );
+
+  if ( !is_valid( header ) || _section_no != SECTION_NO )
+    return true;
+
+  SnapshotSection sections[SECTION_NO];
+  std::uint64_t const table_offset = sizeof( StateHeader ) + sizeof( std::uint32_t ) * 2;
+
+  if ( size < table_offset + sizeof( sections ) )
+    return true;
+
+  std::memcpy( sections, base + table_offset, sizeof( sections ) );
+
+  for ( std::uint32_t i = 0; i < SECTION_NO; ++i )
+  {
+    if ( sections[i].id != i || sections[i].offset > size || sections[i].size > size - sections[i].offset )
+      return true;
+  }
+
+  auto const &cp1_section = sections[SECTION_CP1];
+  auto const &cpu_section = sections[SECTION_CPU];
+  auto const &ram_section = sections[SECTION_RAM];
+
+  if ( sections[SECTION_CP0].size != sizeof( CP0 )
+       || cp1_section.size != sizeof( FPR ) * cp1->fpr.size() + sizeof( cp1->fir ) + sizeof( cp1->fcsr ) + sizeof( cp1->mxcsr )
+      + sizeof( cp1->vpr_high[0] ) * cp1->vpr_high.size() + sizeof( cp1->msacsr ) )
+    return true;
+
+  char const *  cpu_data = base + cpu_section.offset;
+  std::uint32_t _segment_no = 0;
+
+  if ( cpu_section.size < sizeof( _segment_no ) )
+    return true;
+
+  std::memcpy( &_segment_no, cpu_data, sizeof( _segment_no ) );
+  cpu_data += sizeof( _segment_no );
+
+  if ( cpu_section.size != sizeof( _segment_no ) + sizeof( MMU::Segment ) * std::uint64_t( _segment_no ) + sizeof( cpu->pc ) + sizeof( cpu->gpr[0] ) * cpu->gpr.size() + sizeof( cpu->program_break ) )
+    return true;
+
+  char const *  ram_data = base + ram_section.offset;
+  std::uint32_t _ram_header[4]{}; // alloc_limit, blocks_no, swap_no, reserved
+
+  if ( ram_section.size < sizeof( _ram_header ) )
+    return true;
+
+  std::memcpy( _ram_header, ram_data, sizeof( _ram_header ) );
+  ram_data += sizeof( _ram_header );
+
+  std::uint32_t const _alloc_limit = _ram_header[0];
+  std::uint32_t const _blocks_no = _ram_header[1];
+  std::uint32_t const _swap_no = _ram_header[2];
+
+  if ( ram_section.size != sizeof( _ram_header ) + sizeof( SnapshotBlock ) * ( std::uint64_t( _blocks_no ) + _swap_no )
+       || !is_valid_ram( _alloc_limit, _blocks_no, _swap_no ) )
+    return true;
+
+  std::vector<SnapshotBlock> entries( std::uint64_t( _blocks_no ) + _swap_no );
+  std::memcpy( entries.data(), ram_data, sizeof( SnapshotBlock ) * entries.size() );
+
+  for ( auto const & entry : entries )
+  {
+    if ( entry.offset % snapshot_alignment || entry.offset > size || RAM::block_size > size - entry.offset )
+      return true;
+  }
+
+  // 2
+  std::memcpy( cp0, base + sections[SECTION_CP0].offset, sizeof( CP0 ) );
+
+  char const *cp1_data = base + cp1_section.offset;
+  std::memcpy( cp1->fpr.data(), cp1_data, sizeof( FPR ) * cp1->fpr.size() );
+  cp1_data += sizeof( FPR ) * cp1->fpr.size();
+  std::memcpy( &cp1->fir, cp1_data, sizeof( cp1->fir ) );
+  cp1_data += sizeof( cp1->fir );
+  std::memcpy( &cp1->fcsr, cp1_data, sizeof( cp1->fcsr ) );
+  cp1_data += sizeof( cp1->fcsr );
+  std::memcpy( &cp1->mxcsr, cp1_data, sizeof( cp1->mxcsr ) );
+  cp1_data += sizeof( cp1->mxcsr );
+  std::memcpy( cp1->vpr_high.data(), cp1_data, sizeof( cp1->vpr_high[0] ) * cp1->vpr_high.size() );
+  cp1_data += sizeof( cp1->vpr_high[0] ) * cp1->vpr_high.size();
+  std::memcpy( &cp1->msacsr, cp1_data, sizeof( cp1->msacsr ) );
+
+  cp1->restore_mxcsr();
+
+  cpu->mmu.segments.resize( _segment_no );
+  std::memcpy( cpu->mmu.segments.data(), cpu_data, sizeof( MMU::Segment ) * _segment_no );
+  cpu_data += sizeof( MMU::Segment ) * _segment_no;
+  std::memcpy( &cpu->pc, cpu_data, sizeof( cpu->pc ) );
+  cpu_data += sizeof( cpu->pc );
+  std::memcpy( cpu->gpr.data(), cpu_data, sizeof( cpu->gpr[0] ) * cpu->gpr.size() );
+  cpu_data += sizeof( cpu->gpr[0] ) * cpu->gpr.size();
+  std::memcpy( &cpu->program_break, cpu_data, sizeof( cpu->program_break ) );
+  cpu->exit_code.store( 0, std::memory_order_release );
+
+  // 3
+  auto const mapping = std::make_shared<MappedFile>( std::move( state ) );
+
+  std::vector<RAM::Block> blocks;
+  blocks.reserve( _alloc_limit );
+
+  for ( std::uint32_t i = 0; i < _blocks_no; ++i )
+  {
+    RAM::Block block;
+    block.base_address = entries[i].base_address;
+    block.access_count = entries[i].access_count;
+    block.map( reinterpret_cast<std::uint32_t *>( mapping->data() + entries[i].offset ), mapping );
+
+    blocks.push_back( std::move( block ) );
+  }
+
+  // 4
+  std::vector<RAM::SwappedBlock> swapped( _swap_no );
+
+  for ( std::uint32_t i = 0; i < _swap_no; ++i )
+  {
+    auto const &entry = entries[std::uint64_t( _blocks_no ) + i];
+
+    RAM::Block swapped_block;
+    swapped_block.base_address = entry.base_address;
+    swapped_block.map( reinterpret_cast<std::uint32_t *>( mapping->data() + entry.offset ), mapping );
+    swapped_block.serialize();
+
+    swapped[i].base_address = entry.base_address;
+  }
+
+  // The previous blocks release their mappings
+  ram->alloc_limit = _alloc_limit;
+  ram->blocks = std::move( blocks );
+  ram->swapped = std::move( swapped );
+
+  return false;
+}
+
+////
+//// COMPRESSED
+////
+/**
+ * StateHeader
+ *
+ * -- Registers --
+ * CP0, trivially copyable
+ * CP1, see `save_state_cp1`
+ * CPU, see `save_state_cpu` without CP0 and CP1
+ *
+ * -- RAM --
+ * uint32_t -> alloc_limit
+ * uint32_t -> blocks_no
+ * uint32_t -> swap_no
+ * CompressedBlock + uint8_t * size, (blocks_no + swap_no) times: allocated blocks first, then the swapped ones
+ *
+ * See `block_codec.hpp` for the encodings.
+ **/
+
+// Number of blocks compressed together, bounds the memory used while saving.
+constexpr std::uint32_t compressed_batch_size{ 64 };
+
+struct CompressedBlock
+{
+  std::uint32_t base_address;
+  std::uint32_t access_count;
+  std::uint8_t  encoding;
+  std::uint8_t  reserved[3];
+  std::uint32_t size;
+};
+
+bool MachineInspector::write_registers( std::FILE * file ) const noexcept
+{
+  std::uint32_t _segment_no = ( std::uint32_t )cpu->mmu.segments.size();
+
+  bool error = std::fwrite( cp0, sizeof( CP0 ), 1, file ) != 1;
+
+  error |= std::fwrite( cp1->fpr.data(), sizeof( FPR ), cp1->fpr.size(), file ) != cp1->fpr.size();
+  error |= std::fwrite( &cp1->fir, sizeof( cp1->fir ), 1, file ) != 1;
+  error |= std::fwrite( &cp1->fcsr, sizeof( cp1->fcsr ), 1, file ) != 1;
+  error |= std::fwrite( &cp1->mxcsr, sizeof( cp1->mxcsr ), 1, file ) != 1;
+  error |= std::fwrite( cp1->vpr_high.data(), sizeof( cp1->vpr_high[0] ), cp1->vpr_high.size(), file ) != cp1->vpr_high.size();
+  error |= std::fwrite( &cp1->msacsr, sizeof( cp1->msacsr ), 1, file ) != 1;
+
+  error |= std::fwrite( &_segment_no, sizeof( _segment_no ), 1, file ) != 1;
+  error |= std::fwrite( cpu->mmu.segments.data(), sizeof( MMU::Segment ), _segment_no, file ) != _segment_no;
+  error |= std::fwrite( &cpu->pc, sizeof( cpu->pc ), 1, file ) != 1;
+  error |= std::fwrite( cpu->gpr.data(), sizeof( cpu->gpr[0] ), cpu->gpr.size(), file ) != cpu->gpr.size();
+  error |= std::fwrite( &cpu->program_break, sizeof( cpu->program_break ), 1, file ) != 1;
+
+  return error;
+}
+
+bool MachineInspector::read_registers( std::FILE * file ) noexcept
+{
+  std::uint32_t _segment_no = 0;
+
+  bool error = std::fread( cp0, sizeof( CP0 ), 1, file ) != 1;
+
+  error |= std::fread( cp1->fpr.data(), sizeof( FPR ), cp1->fpr.size(), file ) != cp1->fpr.size();
+  error |= std::fread( &cp1->fir, sizeof( cp1->fir ), 1, file ) != 1;
+  error |= std::fread( &cp1->fcsr, sizeof( cp1->fcsr ), 1, file ) != 1;
+  error |= std::fread( &cp1->mxcsr, sizeof( cp1->mxcsr ), 1, file ) != 1;
+  error |= std::fread( cp1->vpr_high.data(), sizeof( cp1->vpr_high[0] ), cp1->vpr_high.size(), file ) != cp1->vpr_high.size();
+  error |= std::fread( &cp1->msacsr, sizeof( cp1->msacsr ), 1, file ) != 1;
+
+  if ( error || std::fread( &_segment_no, sizeof( _segment_no ), 1, file ) != 1 )
+    return true;
+
+  cp1->restore_mxcsr();
+
+  cpu->mmu.segments.resize( _segment_no );
+  error |= std::fread( cpu->mmu.segments.data(), sizeof( MMU::Segment ), _segment_no, file ) != _segment_no;
+  error |= std::fread( &cpu->pc, sizeof( cpu->pc ), 1, file ) != 1;
+  error |= std::fread( cpu->gpr.data(), sizeof( cpu->gpr[0] ), cpu->gpr.size(), file ) != cpu->gpr.size();
+  error |= std::fread( &cpu->program_break, sizeof( cpu->program_break ), 1, file ) != 1;
+  cpu->exit_code.store( 0, std::memory_order_release );
+
+  return error;
+}
+
+/**
+ * The blocks are processed in batches of `compressed_batch_size`:
+ * 1. Collect the words of the batch, swapped blocks are loaded from disk
+ * 2. Compress the whole batch in parallel
+ * 3. Write the compressed blocks in order
+ **/
+bool MachineInspector::save_compressed_state( std::FILE * out, unsigned threads ) noexcept
+{
+  cpu->stop();
+  cpu->sync_count();
+  cpu->cp1.collect_exceptions();
+
+  if ( !out || write_tag( out ) || write_registers( out ) )
+    return true;
+
+  std::uint32_t const _alloc_limit = ram->alloc_limit;
+  std::uint32_t const _blocks_no = ( std::uint32_t )ram->blocks.size();
+  std::uint32_t const _swap_no = ( std::uint32_t )ram->swapped.size();
+
+  bool error = std::fwrite( &_alloc_limit, sizeof( _alloc_limit ), 1, out ) != 1;
+  error |= std::fwrite( &_blocks_no, sizeof( _blocks_no ), 1, out ) != 1;
+  error |= std::fwrite( &_swap_no, sizeof( _swap_no ), 1, out ) != 1;
+
+  if ( error )
+    return true;
+
+  BlockEncoderPool pool{ threads };
+
+  std::vector<std::uint32_t const *>     batch;
+  std::vector<CompressedBlock>           headers;
+  std::vector<BlockEncoding>             encodings;
+  std::vector<std::vector<std::uint8_t>> outputs;
+  std::vector<RAM::Block>                swapped_blocks; // buffers for the swapped blocks of a batch
+
+  std::uint32_t const total = _blocks_no + _swap_no;
+
+  for ( std::uint32_t first = 0; first < total; first += compressed_batch_size )
+  {
+    std::uint32_t const last = std::min( total, first + compressed_batch_size );
+
+    // 1
+    batch.clear();
+    headers.clear();
+
+    for ( std::uint32_t i = first; i < last; ++i )
+    {
+      if ( i < _blocks_no )
+      {
+        auto const &block = ram->blocks[i];
+
+        batch.push_back( block.data.get() );
+        headers.push_back( { block.base_address, block.access_count, 0, {}, 0 } );
+      }
+      else
+      {
+        auto const slot = i - std::max( first, _blocks_no );
+
+        if ( swapped_blocks.size() <= slot )
+        {
+          swapped_blocks.emplace_back();
+          swapped_blocks.back().allocate();
+
+          if ( !swapped_blocks.back().data )
+            return true;
+        }
+
+        auto &block = swapped_blocks[slot];
+        block.base_address = ram->swapped[i - _blocks_no].base_address;
+        block.deserialize();
+
+        batch.push_back( block.data.get() );
+        headers.push_back( { block.base_address, 0, 0, {}, 0 } );
+      }
+    }
+
+    // 2
+    pool.encode( batch, RAM::block_size / 4, encodings, outputs );
+
+    // 3
+    for ( std::size_t i = 0; i < batch.size(); ++i )
+    {
+      headers[i].encoding = ( std::uint8_t )encodings[i];
+      headers[i].size = ( std::uint32_t )outputs[i].size();
+
+      error |= std::fwrite( &headers[i], sizeof( CompressedBlock ), 1, out ) != 1;
+      error |= std::fwrite( outputs[i].data(), 1, outputs[i].size(), out ) != outputs[i].size();
+    }
+
+    if ( error )
+      return true;
+  }
+
+  return std::ferror( out );
+}
+
+/**
+ * The allocated blocks are decompressed into new blocks,
+ * the swapped ones are decompressed and written back to disk.
+ **/
+bool MachineInspector::restore_compressed_state( std::FILE * in ) noexcept
+{
+  cpu->stop();
+
+  if ( cpu->io_in_flight() || !in || read_tag( in ) || read_registers( in ) )
+    return true;
+
+  cpu->restore_timer();
+  cpu->cp1.clear_host_exceptions(); // raised before the restore
+
+  std::uint32_t _alloc_limit = 0;
+  std::uint32_t _blocks_no = 0;
+  std::uint32_t _swap_no = 0;
+
+  bool error = std::fread( &_alloc_limit, sizeof( _alloc_limit ), 1, in ) != 1;
+  error |= std::fread( &_blocks_no, sizeof( _blocks_no ), 1, in ) != 1;
+  error |= std::fread( &_swap_no, sizeof( _swap_no ), 1, in ) != 1;
+
+  if ( error || !is_valid_ram( _alloc_limit, _blocks_no, _swap_no ) )
+    return true;
+
+  std::vector<RAM::Block>        blocks;
+  std::vector<RAM::SwappedBlock> swapped( _swap_no );
+  std::vector<std::uint8_t>      payload;
+
+  blocks.reserve( _alloc_limit );
+
+  RAM::Block swapped_block;
+
+  for ( std::uint64_t i = 0; i < std::uint64_t( _blocks_no ) + _swap_no; ++i )
+  {
+    CompressedBlock header;
+
+    if ( std::fread( &header, sizeof( header ), 1, in ) != 1 || header.size > RAM::block_size )
+      return true;
+
+    payload.resize( header.size );
+
+    if ( std::fread( payload.data(), 1, payload.size(), in ) != payload.size() )
+      return true;
+
+    RAM::Block *block = &swapped_block;
+
+    if ( i < _blocks_no )
+    {
+      blocks.emplace_back();
+      block = &blocks.back();
+    }
+
+    if ( !block->data )
+      block->allocate();
+
+    if ( !block->data )
+      return true;
+
+    block->base_address = header.base_address;
+    block->access_count = header.access_count;
+
+    if ( decode_block( ( BlockEncoding )header.encoding, payload.data(), payload.size(), block->data.get(), RAM::block_size / 4 ) )
+      return true;
+
+    if ( i >= _blocks_no )
+    {
+      block->serialize();
+      swapped[i - _blocks_no].base_address = header.base_address;
+    }
+  }
+
+  ram->alloc_limit = _alloc_limit;
+  ram->blocks = std::move( blocks );
+  ram->swapped = std::move( swapped );
+
+  return std::ferror( in );
+}
+
+} // namespace mips32
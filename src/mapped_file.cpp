@@ -0,0 +1,181 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace mips32
+{
+MappedFile::MappedFile( MappedFile &&other ) noexcept
+  : region( std::exchange( other.region, nullptr ) ), length( std::exchange( other.length, 0 ) )
+{}
+
+MappedFile &MappedFile::operator=( MappedFile &&other ) noexcept
+{
+  if ( this != &other )
+  {
+    close();
+    region = std::exchange( other.region, nullptr );
+    length = std::exchange( other.length, 0 );
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open( char const *name ) noexcept
+{
+  close();
+
+  HANDLE file = CreateFileA( name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( file == INVALID_HANDLE_VALUE )
+    return true;
+
+  LARGE_INTEGER file_size;
+  if ( !GetFileSizeEx( file, &file_size ) || file_size.QuadPart == 0 )
+  {
+    CloseHandle( file );
+    return true;
+  }
+
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+  CloseHandle( file );
+
+  if ( !mapping )
+    return true;
+
+  void *view = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+  CloseHandle( mapping ); // the view keeps the mapping alive
+
+  if ( !view )
+    return true;
+
+  region = static_cast<char *>( view );
+  length = static_cast<std::size_t>( file_size.QuadPart );
+
+  return false;
+}
+
+bool MappedFile::open( std::intptr_t handle, std::uint64_t offset, std::size_t size ) noexcept
+{
+  close();
+
+  HANDLE file = reinterpret_cast<HANDLE>( handle );
+  if ( file == INVALID_HANDLE_VALUE || !size )
+    return true;
+
+  LARGE_INTEGER file_size;
+  if ( !GetFileSizeEx( file, &file_size ) || std::uint64_t( file_size.QuadPart ) <= offset )
+    return true;
+
+  if ( std::uint64_t( file_size.QuadPart ) - offset < size )
+    size = static_cast<std::size_t>( file_size.QuadPart - offset );
+
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+  if ( !mapping )
+    return true;
+
+  void *view = MapViewOfFile( mapping, FILE_MAP_COPY, DWORD( offset >> 32 ), DWORD( offset ), size );
+  CloseHandle( mapping );
+
+  if ( !view )
+    return true;
+
+  region = static_cast<char *>( view );
+  length = size;
+
+  return false;
+}
+
+void MappedFile::close() noexcept
+{
+  if ( region )
+    UnmapViewOfFile( region );
+
+  region = nullptr;
+  length = 0;
+}
+
+#else
+
+bool MappedFile::open( char const *name ) noexcept
+{
+  close();
+
+  int fd = ::open( name, O_RDONLY );
+  if ( fd == -1 )
+    return true;
+
+  struct stat info;
+  if ( ::fstat( fd, &info ) || info.st_size == 0 )
+  {
+    ::close( fd );
+    return true;
+  }
+
+  auto const size = static_cast<std::size_t>( info.st_size );
+
+  void *view = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+  ::close( fd ); // the mapping keeps the file alive
+
+  if ( view == MAP_FAILED )
+    return true;
+
+  region = static_cast<char *>( view );
+  length = size;
+
+  return false;
+}
+
+bool MappedFile::open( std::intptr_t handle, std::uint64_t offset, std::size_t size ) noexcept
+{
+  close();
+
+  int const fd = static_cast<int>( handle );
+  if ( fd < 0 || !size )
+    return true;
+
+  struct stat info;
+  if ( ::fstat( fd, &info ) || std::uint64_t( info.st_size ) <= offset )
+    return true;
+
+  if ( std::uint64_t( info.st_size ) - offset < size )
+    size = static_cast<std::size_t>( info.st_size - offset );
+
+  void *view = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>( offset ) );
+  if ( view == MAP_FAILED )
+    return true;
+
+  region = static_cast<char *>( view );
+  length = size;
+
+  return false;
+}
+
+void MappedFile::close() noexcept
+{
+  if ( region )
+    ::munmap( region, length );
+
+  region = nullptr;
+  length = 0;
+}
+
+#endif
+
+} // namespace mips32
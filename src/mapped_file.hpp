@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * Private (copy-on-write) memory mapping of a file.
+ *
+ * The whole file is mapped readable and writable, but every write
+ * stays inside the process: the file on disk is never modified.
+ * Pages are read from disk only when they are touched.
+ *
+ * It satisfies MoveConstructible and MoveAssignable.
+ **/
+class MappedFile
+{
+public:
+  MappedFile() noexcept = default;
+
+  // Movable
+  MappedFile( MappedFile &&other ) noexcept;
+  MappedFile &operator=( MappedFile &&other ) noexcept;
+
+  // Non copyable
+  MappedFile( MappedFile const & ) = delete;
+  MappedFile &operator=( MappedFile const & ) = delete;
+
+  ~MappedFile();
+
+  // Maps the file `name`.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool open( char const *name ) noexcept;
+
+  // Maps up to `size` bytes of an already opened file, starting at `offset`.
+  // `handle` is a file descriptor, or a HANDLE on Windows, it isn't closed.
+  // `offset` must be a multiple of the allocation granularity (64KB works everywhere),
+  // the mapping stops at the end of the file.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool open( std::intptr_t handle, std::uint64_t offset, std::size_t size ) noexcept;
+
+  // Releases the mapping, every pointer obtained through `data()` becomes invalid.
+  void close() noexcept;
+
+  char *data() const noexcept { return region; }
+  std::size_t size() const noexcept { return length; }
+
+private:
+  char *      region{ nullptr };
+  std::size_t length{ 0 };
+};
+} // namespace mips32
@@ -0,0 +1,227 @@
+#include <mips32/memory_tracer.hpp>
+
+#include <chrono>
+#include <cstring>
+
+namespace mips32
+{
+constexpr char          trace_magic[4]{ 'm', 't', 'r', 'c' };
+constexpr std::uint32_t trace_version{ 2 };
+constexpr std::uint8_t  dropped_tag{ 3 };
+
+// The consumer sleeps this long when the ring is empty
+constexpr std::chrono::microseconds idle_wait{ 100 };
+
+std::uint32_t zigzag( std::uint32_t delta ) noexcept
+{
+  return delta << 1 ^ std::uint32_t( std::int32_t( delta ) >> 31 );
+}
+
+std::uint32_t unzigzag( std::uint32_t value ) noexcept
+{
+  return value >> 1 ^ ( 0 - ( value & 1 ) );
+}
+
+void put_varint( std::vector<std::uint8_t> &buffer, std::uint64_t value ) noexcept
+{
+  while ( value >= 0x80 )
+  {
+    buffer.push_back( std::uint8_t( value | 0x80 ) );
+    value >>= 7;
+  }
+  buffer.push_back( std::uint8_t( value ) );
+}
+
+bool get_varint( std::FILE *in, std::uint64_t &value ) noexcept
+{
+  value = 0;
+
+  for ( int shift = 0; shift < 64; shift += 7 )
+  {
+    auto const byte = std::fgetc( in );
+    if ( byte == EOF )
+      return true;
+
+    value |= std::uint64_t( byte & 0x7F ) << shift;
+
+    if ( !( byte & 0x80 ) )
+      return false;
+  }
+
+  return true;
+}
+
+MemoryTracer::MemoryTracer( std::FILE *out, std::uint32_t capacity, Overflow overflow ) noexcept
+  : out( out ), overflow( overflow )
+{
+  std::uint32_t size = 1;
+  while ( size < capacity )
+    size <<= 1;
+
+  ring.resize( size );
+  mask = size - 1;
+
+  buffer.reserve( 64 * 1024 );
+
+  std::fwrite( trace_magic, sizeof( trace_magic ), 1, out );
+  std::fwrite( &trace_version, sizeof( trace_version ), 1, out );
+
+  consumer = std::thread( &MemoryTracer::consume, this );
+}
+
+MemoryTracer::~MemoryTracer()
+{
+  quit.store( true, std::memory_order_release );
+  consumer.join();
+}
+
+void MemoryTracer::record( Kind kind, std::uint32_t address, std::uint8_t size ) noexcept
+{
+  auto const position = head.load( std::memory_order_relaxed );
+
+  if ( position - cached_tail > mask )
+  {
+    cached_tail = tail.load( std::memory_order_acquire );
+
+    if ( overflow == Overflow::DROP )
+    {
+      if ( position - cached_tail > mask )
+      {
+        dropped_no.fetch_add( 1, std::memory_order_relaxed );
+        return;
+      }
+    }
+    else
+    {
+      while ( position - cached_tail > mask )
+      {
+        std::this_thread::yield();
+        cached_tail = tail.load( std::memory_order_acquire );
+      }
+    }
+  }
+
+  ring[position & mask] = { address, kind, size };
+  head.store( position + 1, std::memory_order_release );
+}
+
+void MemoryTracer::flush() noexcept
+{
+  auto const position = head.load( std::memory_order_relaxed );
+
+  while ( tail.load( std::memory_order_acquire ) != position )
+    std::this_thread::yield();
+
+  std::fflush( out );
+}
+
+void MemoryTracer::consume() noexcept
+{
+  for ( ;; )
+  {
+    // `quit` is read first, so the accesses recorded before it are never lost
+    auto const stopping = quit.load( std::memory_order_acquire );
+    auto const position = tail.load( std::memory_order_relaxed );
+    auto const end = head.load( std::memory_order_acquire );
+
+    if ( position == end )
+    {
+      encode_dropped();
+
+      if ( !buffer.empty() )
+      {
+        std::fwrite( buffer.data(), 1, buffer.size(), out );
+        buffer.clear();
+      }
+
+      if ( stopping )
+        return;
+
+      std::this_thread::sleep_for( idle_wait );
+      continue;
+    }
+
+    for ( auto i = position; i != end; ++i )
+      encode( ring[i & mask] );
+
+    encode_dropped();
+
+    std::fwrite( buffer.data(), 1, buffer.size(), out );
+    buffer.clear();
+
+    // The slots are released only once written
+    tail.store( end, std::memory_order_release );
+  }
+}
+
+void MemoryTracer::encode( Access const &access ) noexcept
+{
+  auto const kind = std::uint8_t( access.kind );
+
+  std::uint8_t size_log2 = 0;
+  while ( ( 1u << size_log2 ) < access.size && size_log2 < 4 )
+    ++size_log2;
+
+  buffer.push_back( std::uint8_t( kind | size_log2 << 2 ) );
+  put_varint( buffer, zigzag( access.address - previous[kind] ) );
+
+  previous[kind] = access.address;
+}
+
+void MemoryTracer::encode_dropped() noexcept
+{
+  auto const dropped = dropped_no.load( std::memory_order_relaxed );
+
+  if ( dropped == written_dropped )
+    return;
+
+  buffer.push_back( dropped_tag );
+  put_varint( buffer, dropped - written_dropped );
+
+  written_dropped = dropped;
+}
+
+bool MemoryTracer::read_trace( std::FILE *in, std::vector<Access> &accesses, std::uint64_t *dropped ) noexcept
+{
+  char          magic[4];
+  std::uint32_t version;
+
+  if ( std::fread( magic, sizeof( magic ), 1, in ) != 1 || std::memcmp( magic, trace_magic, sizeof( magic ) ) )
+    return true;
+
+  // Version 1 is the same, up to 8 bytes
+  if ( std::fread( &version, sizeof( version ), 1, in ) != 1 || !version || version > trace_version )
+    return true;
+
+  std::uint32_t previous[3]{};
+  std::uint64_t dropped_total = 0;
+
+  for ( int tag = std::fgetc( in ); tag != EOF; tag = std::fgetc( in ) )
+  {
+    std::uint64_t value;
+
+    if ( get_varint( in, value ) )
+      return true;
+
+    if ( tag == dropped_tag )
+    {
+      dropped_total += value;
+      continue;
+    }
+
+    auto const kind = tag & 0b11;
+
+    if ( kind == dropped_tag || ( tag >> 2 ) > 4 || value > 0xFFFF'FFFF )
+      return true;
+
+    previous[kind] += unzigzag( std::uint32_t( value ) );
+
+    accesses.push_back( { previous[kind], Kind( kind ), std::uint8_t( 1u << ( tag >> 2 ) ) } );
+  }
+
+  if ( dropped )
+    *dropped = dropped_total;
+
+  return std::ferror( in );
+}
+} // namespace mips32
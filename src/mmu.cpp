@@ -7,19 +7,12 @@ MMU::MMU( RAM &ram, std::initializer_list<Segment> segments ) noexcept
   : ram( ram ), segments( segments )
 {}
 
-std::uint32_t *MMU::access( std::uint32_t address, std::uint32_t access_flags ) noexcept
+void MMU::simulate_caches( std::uint32_t address, Access kind ) noexcept
 {
-  for ( auto const &segment : segments )
-  {
-  // 1
-    if ( segment.contains( address ) && segment.has_access( access_flags ) )
-    {
-      return &ram[address];
-    }
-  }
-
-  // 2
-  return nullptr;
+  if ( kind == Access::FETCH )
+    caches->l1i.access( address, false );
+  else
+    caches->l1d.access( address, kind == Access::STORE );
 }
 
 } // namespace mips32
\ No newline at end of file
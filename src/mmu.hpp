@@ -1,15 +1,16 @@
 #pragma once
 
+#include "cache.hpp"
+#include "ram.hpp"
+
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <vector>
 
 namespace mips32
 {
 
-class RAM;
-class Cache;
-
 class MMU
 {
   friend class MachineInspector;
@@ -30,13 +31,47 @@ public:
     inline bool has_access( std::uint32_t access_flags ) const noexcept { return this->access_flags & access_flags; }
   };
 
+  enum class Access
+  {
+    FETCH,
+    LOAD,
+    STORE,
+  };
+
   MMU( RAM &ram, std::initializer_list<Segment> segments )
     noexcept;
 
-  std::uint32_t *access( std::uint32_t address, std::uint32_t access_flags ) noexcept;
+  // `kind` feeds the cache model, if enabled.
+  // Inline, so a hit on the last block used by the fetches, or by the data accesses, costs no calls.
+  std::uint32_t *access( std::uint32_t address, std::uint32_t access_flags, Access kind ) noexcept
+  {
+    for ( auto const &segment : segments )
+    {
+    // 1
+      if ( segment.contains( address ) && segment.has_access( access_flags ) )
+      {
+        if ( caches )
+          simulate_caches( address, kind );
+
+        return &ram.at( address, kind == Access::FETCH ? fetch_hint : data_hint );
+      }
+    }
+
+    // 2
+    return nullptr;
+  }
 
 private:
+  void simulate_caches( std::uint32_t address, Access kind ) noexcept;
+
   RAM &ram;
   std::vector<Segment> segments;
+
+  // Blocks used by the last fetch and by the last load/store, see RAM::at
+  std::size_t fetch_hint{ 0 };
+  std::size_t data_hint{ 0 };
+
+  // Cache model, nullptr when disabled
+  std::unique_ptr<CacheHierarchy> caches;
 };
 } // namespace mips32
\ No newline at end of file
@@ -0,0 +1,1231 @@
+#include "cp1.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+// Access to the Floating-Point Environment
+#ifdef _MSC_VER
+#pragma fenv_access( on )
+#else
+#pragma STDC FENV_ACCESS ON
+#endif
+
+/**
+ * MIPS SIMD Architecture (MSA)
+ *
+ * The vector registers are 128-bit wide, their lower 64 bits are the FPRs.
+ * The integer operations that SSE2 provides are executed with it,
+ * the remaining ones go through `map` one element at a time.
+ * The floating point ones use the rounding and flushing of MSACSR,
+ * loaded in MXCSR only for the duration of the instruction.
+ *
+ * Not implemented, thus reserved:
+ * SLD, SLDI, BINSL, BINSR, SAT_S, SAT_U,
+ * FEXP2, FEXDO, FEXUPL, FEXUPR, FFQL, FFQR, FTQ and the fixed-point Q instructions.
+ **/
+
+inline constexpr std::uint32_t ROUND_NEAREST{ 0x0 };
+inline constexpr std::uint32_t ROUND_ZERO{ 0x1 };
+inline constexpr std::uint32_t ROUND_UP{ 0x2 };
+inline constexpr std::uint32_t ROUND_DOWN{ 0x3 };
+
+// MXCSR.DAZ, its macro `_MM_DENORMALS_ZERO_ON` is in the SSE3 header <pmmintrin.h>
+inline constexpr std::uint32_t DENORMALS_ZERO{ 0x0040 };
+
+// Minor opcodes, the lowest 6 bits
+inline constexpr std::uint32_t I8_LOGIC{ 0x00 };
+inline constexpr std::uint32_t I8_BIT_MOVE{ 0x01 };
+inline constexpr std::uint32_t I8_SHF{ 0x02 };
+inline constexpr std::uint32_t I5_ARITHMETIC{ 0x06 };
+inline constexpr std::uint32_t I5_COMPARE{ 0x07 };
+inline constexpr std::uint32_t BIT_SHIFT{ 0x09 };
+inline constexpr std::uint32_t R3_SHIFT{ 0x0D };
+inline constexpr std::uint32_t R3_ARITHMETIC{ 0x0E };
+inline constexpr std::uint32_t R3_COMPARE{ 0x0F };
+inline constexpr std::uint32_t R3_ADD{ 0x10 };
+inline constexpr std::uint32_t R3_SUB{ 0x11 };
+inline constexpr std::uint32_t R3_MUL{ 0x12 };
+inline constexpr std::uint32_t R3_DOT{ 0x13 };
+inline constexpr std::uint32_t R3_SHUFFLE{ 0x14 };
+inline constexpr std::uint32_t R3_HORIZONTAL{ 0x15 };
+inline constexpr std::uint32_t ELM{ 0x19 };
+inline constexpr std::uint32_t R3F_COMPARE{ 0x1A };
+inline constexpr std::uint32_t R3F_ARITHMETIC{ 0x1B };
+inline constexpr std::uint32_t R3F_COMPARE_NE{ 0x1C };
+inline constexpr std::uint32_t VEC_2R_2RF{ 0x1E };
+
+inline constexpr std::uint32_t MSACSR_WRITABLE{ 0x0107'FFFF };
+
+namespace mips32
+{
+namespace
+{
+constexpr std::uint32_t minor( std::uint32_t word ) noexcept { return word & 0x3F; }
+constexpr std::uint32_t wd( std::uint32_t word ) noexcept { return word >> 6 & 0x1F; }
+constexpr std::uint32_t ws( std::uint32_t word ) noexcept { return word >> 11 & 0x1F; }
+constexpr std::uint32_t wt( std::uint32_t word ) noexcept { return word >> 16 & 0x1F; }
+
+// Data format of the I5, 3R and 2R instructions: byte, halfword, word, doubleword
+constexpr std::uint32_t df( std::uint32_t word ) noexcept { return word >> 21 & 0b11; }
+
+// Operation of the I5, BIT and 3R instructions
+constexpr std::uint32_t operation( std::uint32_t word ) noexcept { return word >> 23 & 0b111; }
+
+// The elements of a vector register
+template<typename T>
+struct Lanes
+{
+  static constexpr int size{ 16 / sizeof( T ) };
+
+  T e[size];
+};
+
+template<typename T>
+Lanes<T> lanes( __m128i v ) noexcept
+{
+  Lanes<T> l;
+  std::memcpy( l.e, &v, sizeof( v ) );
+  return l;
+}
+
+template<typename T>
+__m128i vector( Lanes<T> const &l ) noexcept
+{
+  __m128i v;
+  std::memcpy( &v, l.e, sizeof( v ) );
+  return v;
+}
+
+// `operation( a[i], b[i], c[i] )` for each element, the result is converted back to T
+template<typename T, typename Operation>
+__m128i map( __m128i a, __m128i b, __m128i c, Operation operation ) noexcept
+{
+  auto       x = lanes<T>( a );
+  auto const y = lanes<T>( b );
+  auto const z = lanes<T>( c );
+
+  for ( int i = 0; i < Lanes<T>::size; ++i )
+    x.e[i] = T( operation( x.e[i], y.e[i], z.e[i] ) );
+
+  return vector( x );
+}
+
+template<typename T, typename Operation>
+__m128i map( __m128i a, __m128i b, Operation operation ) noexcept
+{
+  return map<T>( a, b, b, [ operation ] ( T x, T y, T ) { return operation( x, y ); } );
+}
+
+template<typename T>
+__m128i splat( T value ) noexcept
+{
+  Lanes<T> l;
+  for ( auto &e : l.e ) e = value;
+  return vector( l );
+}
+
+// Calls `operation( T{} )` with the signed integer type of the data format `df`
+template<typename Operation>
+decltype( auto ) with_df( std::uint32_t df, Operation operation ) noexcept
+{
+  switch ( df )
+  {
+  case 0: return operation( std::int8_t{} );
+  case 1: return operation( std::int16_t{} );
+  case 2: return operation( std::int32_t{} );
+  default: return operation( std::int64_t{} );
+  }
+}
+
+template<typename T>
+using unsigned_t = std::make_unsigned_t<T>;
+
+// Integer of half the size of T, for the dot products and horizontal operations
+template<typename T>
+using half_t = std::conditional_t<sizeof( T ) == 2, std::int8_t, std::conditional_t<sizeof( T ) == 4, std::int16_t, std::int32_t>>;
+
+template<typename T>
+constexpr T all_ones( bool condition ) noexcept
+{
+  return condition ? T( -1 ) : T( 0 );
+}
+
+template<typename T>
+constexpr unsigned_t<T> magnitude( T a ) noexcept
+{
+  return a < 0 ? unsigned_t<T>( 0 ) - unsigned_t<T>( a ) : unsigned_t<T>( a );
+}
+
+template<typename T>
+__m128i add( __m128i a, __m128i b ) noexcept
+{
+  if constexpr ( sizeof( T ) == 1 ) return _mm_add_epi8( a, b );
+  else if constexpr ( sizeof( T ) == 2 ) return _mm_add_epi16( a, b );
+  else if constexpr ( sizeof( T ) == 4 ) return _mm_add_epi32( a, b );
+  else return _mm_add_epi64( a, b );
+}
+
+template<typename T>
+__m128i sub( __m128i a, __m128i b ) noexcept
+{
+  if constexpr ( sizeof( T ) == 1 ) return _mm_sub_epi8( a, b );
+  else if constexpr ( sizeof( T ) == 2 ) return _mm_sub_epi16( a, b );
+  else if constexpr ( sizeof( T ) == 4 ) return _mm_sub_epi32( a, b );
+  else return _mm_sub_epi64( a, b );
+}
+
+template<typename T>
+T adds_s( T a, T b ) noexcept
+{
+  using U = unsigned_t<T>;
+
+  auto const r = T( U( a ) + U( b ) );
+  if ( ( a < 0 ) == ( b < 0 ) && ( r < 0 ) != ( a < 0 ) )
+    return a < 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+  return r;
+}
+
+template<typename T>
+T subs_s( T a, T b ) noexcept
+{
+  using U = unsigned_t<T>;
+
+  auto const r = T( U( a ) - U( b ) );
+  if ( ( a < 0 ) != ( b < 0 ) && ( r < 0 ) != ( a < 0 ) )
+    return a < 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+  return r;
+}
+
+template<typename T>
+T adds_u( T a, T b ) noexcept
+{
+  using U = unsigned_t<T>;
+
+  auto const r = U( U( a ) + U( b ) );
+  return r < U( a ) ? T( -1 ) : T( r );
+}
+
+template<typename T>
+T subs_u( T a, T b ) noexcept
+{
+  using U = unsigned_t<T>;
+
+  return U( a ) < U( b ) ? T( 0 ) : T( U( a ) - U( b ) );
+}
+
+template<typename T>
+T shift_amount( T b ) noexcept
+{
+  return T( unsigned_t<T>( b ) % ( sizeof( T ) * 8 ) );
+}
+
+// Shifts right `a` by `s`, rounding the result with the last bit shifted out
+template<typename T>
+T shift_right_rounded( T a, T s ) noexcept
+{
+  if ( s == 0 ) return a;
+  return T( ( a >> s ) + ( a >> ( s - 1 ) & 1 ) );
+}
+
+// Integer operation `op` of the 3R instructions in group `group` (the minor opcode),
+// also used by I5 and BIT instructions with the immediate in every element of `t`.
+// Returns `true` if the operation is reserved.
+template<typename T>
+bool integer( std::uint32_t group, std::uint32_t op, __m128i d, __m128i s, __m128i t, __m128i &res ) noexcept
+{
+  using U = unsigned_t<T>;
+
+  constexpr bool is_byte{ sizeof( T ) == 1 };
+
+  switch ( group << 3 | op )
+  {
+  // SLL, SRA, SRL, BCLR, BSET, BNEG
+  case R3_SHIFT << 3 | 0: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) << shift_amount( b ); } ); return false;
+  case R3_SHIFT << 3 | 1: res = map<T>( s, t, [] ( T a, T b ) { return a >> shift_amount( b ); } ); return false;
+  case R3_SHIFT << 3 | 2: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) >> shift_amount( b ); } ); return false;
+  case R3_SHIFT << 3 | 3: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) & ~( U( 1 ) << shift_amount( b ) ); } ); return false;
+  case R3_SHIFT << 3 | 4: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) | U( 1 ) << shift_amount( b ); } ); return false;
+  case R3_SHIFT << 3 | 5: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) ^ U( 1 ) << shift_amount( b ); } ); return false;
+
+  // ADDV, SUBV, MAX_S, MAX_U, MIN_S, MIN_U, MAX_A, MIN_A
+  case R3_ARITHMETIC << 3 | 0: res = add<T>( s, t ); return false;
+  case R3_ARITHMETIC << 3 | 1: res = sub<T>( s, t ); return false;
+  case R3_ARITHMETIC << 3 | 2:
+    if constexpr ( sizeof( T ) == 2 ) res = _mm_max_epi16( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return a > b ? a : b; } );
+    return false;
+  case R3_ARITHMETIC << 3 | 3:
+    if constexpr ( is_byte ) res = _mm_max_epu8( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return U( a ) > U( b ) ? a : b; } );
+    return false;
+  case R3_ARITHMETIC << 3 | 4:
+    if constexpr ( sizeof( T ) == 2 ) res = _mm_min_epi16( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return a < b ? a : b; } );
+    return false;
+  case R3_ARITHMETIC << 3 | 5:
+    if constexpr ( is_byte ) res = _mm_min_epu8( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return U( a ) < U( b ) ? a : b; } );
+    return false;
+  case R3_ARITHMETIC << 3 | 6: res = map<T>( s, t, [] ( T a, T b ) { return magnitude( a ) > magnitude( b ) ? a : b; } ); return false;
+  case R3_ARITHMETIC << 3 | 7: res = map<T>( s, t, [] ( T a, T b ) { return magnitude( a ) < magnitude( b ) ? a : b; } ); return false;
+
+  // CEQ, CLT_S, CLT_U, CLE_S, CLE_U
+  case R3_COMPARE << 3 | 0:
+    if constexpr ( is_byte ) res = _mm_cmpeq_epi8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_cmpeq_epi16( s, t );
+    else if constexpr ( sizeof( T ) == 4 ) res = _mm_cmpeq_epi32( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return all_ones<T>( a == b ); } );
+    return false;
+  case R3_COMPARE << 3 | 2: res = map<T>( s, t, [] ( T a, T b ) { return all_ones<T>( a < b ); } ); return false;
+  case R3_COMPARE << 3 | 3: res = map<T>( s, t, [] ( T a, T b ) { return all_ones<T>( U( a ) < U( b ) ); } ); return false;
+  case R3_COMPARE << 3 | 4: res = map<T>( s, t, [] ( T a, T b ) { return all_ones<T>( a <= b ); } ); return false;
+  case R3_COMPARE << 3 | 5: res = map<T>( s, t, [] ( T a, T b ) { return all_ones<T>( U( a ) <= U( b ) ); } ); return false;
+
+  // ADD_A, ADDS_A, ADDS_S, ADDS_U, AVE_S, AVE_U, AVER_S, AVER_U
+  case R3_ADD << 3 | 0: res = map<T>( s, t, [] ( T a, T b ) { return magnitude( a ) + magnitude( b ); } ); return false;
+  case R3_ADD << 3 | 1:
+    res = map<T>( s, t, [] ( T a, T b )
+    {
+      auto const sum = U( magnitude( a ) + magnitude( b ) );
+      constexpr auto max = U( std::numeric_limits<T>::max() );
+      return sum > max || sum < magnitude( a ) ? max : sum;
+    } );
+    return false;
+  case R3_ADD << 3 | 2:
+    if constexpr ( is_byte ) res = _mm_adds_epi8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_adds_epi16( s, t );
+    else res = map<T>( s, t, adds_s<T> );
+    return false;
+  case R3_ADD << 3 | 3:
+    if constexpr ( is_byte ) res = _mm_adds_epu8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_adds_epu16( s, t );
+    else res = map<T>( s, t, adds_u<T> );
+    return false;
+  case R3_ADD << 3 | 4: res = map<T>( s, t, [] ( T a, T b ) { return ( a >> 1 ) + ( b >> 1 ) + ( a & b & 1 ); } ); return false;
+  case R3_ADD << 3 | 5:
+    if constexpr ( is_byte )
+      res = _mm_sub_epi8( _mm_avg_epu8( s, t ), _mm_and_si128( _mm_xor_si128( s, t ), _mm_set1_epi8( 1 ) ) );
+    else
+      res = map<T>( s, t, [] ( T a, T b ) { return ( U( a ) >> 1 ) + ( U( b ) >> 1 ) + ( U( a ) & U( b ) & 1 ); } );
+    return false;
+  case R3_ADD << 3 | 6: res = map<T>( s, t, [] ( T a, T b ) { return ( a >> 1 ) + ( b >> 1 ) + ( ( a | b ) & 1 ); } ); return false;
+  case R3_ADD << 3 | 7:
+    if constexpr ( is_byte ) res = _mm_avg_epu8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_avg_epu16( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return ( U( a ) >> 1 ) + ( U( b ) >> 1 ) + ( ( U( a ) | U( b ) ) & 1 ); } );
+    return false;
+
+  // SUBS_S, SUBS_U, SUBSUS_U, SUBSUU_S, ASUB_S, ASUB_U
+  case R3_SUB << 3 | 0:
+    if constexpr ( is_byte ) res = _mm_subs_epi8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_subs_epi16( s, t );
+    else res = map<T>( s, t, subs_s<T> );
+    return false;
+  case R3_SUB << 3 | 1:
+    if constexpr ( is_byte ) res = _mm_subs_epu8( s, t );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_subs_epu16( s, t );
+    else res = map<T>( s, t, subs_u<T> );
+    return false;
+  case R3_SUB << 3 | 2:
+    res = map<T>( s, t, [] ( T a, T b ) { return b >= 0 ? subs_u( a, b ) : adds_u( a, T( magnitude( b ) ) ); } );
+    return false;
+  case R3_SUB << 3 | 3:
+    res = map<T>( s, t, [] ( T a, T b )
+    {
+      constexpr auto max = U( std::numeric_limits<T>::max() );
+      if ( U( a ) >= U( b ) )
+        return U( a ) - U( b ) > max ? T( max ) : T( U( a ) - U( b ) );
+      else
+        return U( b ) - U( a ) > max + 1 ? std::numeric_limits<T>::min() : T( U( 0 ) - ( U( b ) - U( a ) ) );
+    } );
+    return false;
+  case R3_SUB << 3 | 4: res = map<T>( s, t, [] ( T a, T b ) { return a > b ? U( a ) - U( b ) : U( b ) - U( a ); } ); return false;
+  case R3_SUB << 3 | 5: res = map<T>( s, t, [] ( T a, T b ) { return U( a ) > U( b ) ? U( a ) - U( b ) : U( b ) - U( a ); } ); return false;
+
+  // MULV, MADDV, MSUBV, DIV_S, DIV_U, MOD_S, MOD_U
+  // Division by zero is UNPREDICTABLE, it gives 0
+  case R3_MUL << 3 | 0:
+    if constexpr ( sizeof( T ) == 2 ) res = _mm_mullo_epi16( s, t );
+    else res = map<T>( s, t, [] ( T a, T b ) { return U( a ) * U( b ); } );
+    return false;
+  case R3_MUL << 3 | 1: res = map<T>( d, s, t, [] ( T c, T a, T b ) { return U( c ) + U( a ) * U( b ); } ); return false;
+  case R3_MUL << 3 | 2: res = map<T>( d, s, t, [] ( T c, T a, T b ) { return U( c ) - U( a ) * U( b ); } ); return false;
+  case R3_MUL << 3 | 4:
+    res = map<T>( s, t, [] ( T a, T b ) { return b == 0 ? T( 0 ) : b == -1 ? T( U( 0 ) - U( a ) ) : T( a / b ); } );
+    return false;
+  case R3_MUL << 3 | 5: res = map<T>( s, t, [] ( T a, T b ) { return b == 0 ? U( 0 ) : U( U( a ) / U( b ) ); } ); return false;
+  case R3_MUL << 3 | 6:
+    res = map<T>( s, t, [] ( T a, T b ) { return b == 0 || b == -1 ? T( 0 ) : T( a % b ); } );
+    return false;
+  case R3_MUL << 3 | 7: res = map<T>( s, t, [] ( T a, T b ) { return b == 0 ? U( 0 ) : U( U( a ) % U( b ) ); } ); return false;
+
+  // DOTP_S, DOTP_U, DPADD_S, DPADD_U, DPSUB_S, DPSUB_U, the byte format is reserved
+  case R3_DOT << 3 | 0:
+  case R3_DOT << 3 | 1:
+  case R3_DOT << 3 | 2:
+  case R3_DOT << 3 | 3:
+  case R3_DOT << 3 | 4:
+  case R3_DOT << 3 | 5:
+    if constexpr ( is_byte )
+    {
+      return true;
+    }
+    else
+    {
+      using H = half_t<T>;
+
+      auto const is_signed = ( op & 1 ) == 0;
+      auto const a = lanes<H>( s );
+      auto const b = lanes<H>( t );
+      auto       r = lanes<T>( op < 2 ? _mm_setzero_si128() : d );
+
+      for ( int i = 0; i < Lanes<T>::size; ++i )
+      {
+        auto const product = [ is_signed ] ( H x, H y )
+        {
+          using UH = unsigned_t<H>;
+          return is_signed ? U( T( x ) * T( y ) ) : U( U( UH( x ) ) * U( UH( y ) ) );
+        };
+
+        auto const dot = U( product( a.e[2 * i], b.e[2 * i] ) + product( a.e[2 * i + 1], b.e[2 * i + 1] ) );
+
+        r.e[i] = T( op < 4 ? U( r.e[i] ) + dot : U( r.e[i] ) - dot );
+      }
+
+      res = vector( r );
+      return false;
+    }
+
+  // SPLAT is handled by the caller as it needs a GPR, SLD isn't implemented
+  // PCKEV, PCKOD, ILVL, ILVR, ILVEV, ILVOD
+  case R3_SHUFFLE << 3 | 2:
+  case R3_SHUFFLE << 3 | 3:
+  {
+    auto const odd = op & 1;
+    auto const a = lanes<T>( s );
+    auto const b = lanes<T>( t );
+    Lanes<T>   r;
+
+    constexpr int half{ Lanes<T>::size / 2 };
+    for ( int i = 0; i < half; ++i )
+    {
+      r.e[i] = b.e[2 * i + odd];
+      r.e[half + i] = a.e[2 * i + odd];
+    }
+
+    res = vector( r );
+    return false;
+  }
+  case R3_SHUFFLE << 3 | 4:
+    if constexpr ( is_byte ) res = _mm_unpackhi_epi8( t, s );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_unpackhi_epi16( t, s );
+    else if constexpr ( sizeof( T ) == 4 ) res = _mm_unpackhi_epi32( t, s );
+    else res = _mm_unpackhi_epi64( t, s );
+    return false;
+  case R3_SHUFFLE << 3 | 5:
+    if constexpr ( is_byte ) res = _mm_unpacklo_epi8( t, s );
+    else if constexpr ( sizeof( T ) == 2 ) res = _mm_unpacklo_epi16( t, s );
+    else if constexpr ( sizeof( T ) == 4 ) res = _mm_unpacklo_epi32( t, s );
+    else res = _mm_unpacklo_epi64( t, s );
+    return false;
+  case R3_SHUFFLE << 3 | 6:
+  case R3_SHUFFLE << 3 | 7:
+  {
+    auto const odd = op & 1;
+    auto const a = lanes<T>( s );
+    auto const b = lanes<T>( t );
+    Lanes<T>   r;
+
+    for ( int i = 0; i < Lanes<T>::size / 2; ++i )
+    {
+      r.e[2 * i] = b.e[2 * i + odd];
+      r.e[2 * i + 1] = a.e[2 * i + odd];
+    }
+
+    res = vector( r );
+    return false;
+  }
+
+  // VSHF, SRAR, SRLR, HADD_S, HADD_U, HSUB_S, HSUB_U
+  case R3_HORIZONTAL << 3 | 0:
+  {
+    auto const a = lanes<T>( s );
+    auto const b = lanes<T>( t );
+    auto       r = lanes<T>( d );
+
+    constexpr int n{ Lanes<T>::size };
+    for ( auto &e : r.e )
+    {
+      auto const k = int( U( e ) % ( 2 * n ) );
+      e = U( e ) & 0xC0 ? T( 0 ) : k < n ? b.e[k] : a.e[k - n];
+    }
+
+    res = vector( r );
+    return false;
+  }
+  case R3_HORIZONTAL << 3 | 1: res = map<T>( s, t, [] ( T a, T b ) { return shift_right_rounded<T>( a, shift_amount( b ) ); } ); return false;
+  case R3_HORIZONTAL << 3 | 2:
+    res = map<T>( s, t, [] ( T a, T b ) { return T( shift_right_rounded<U>( U( a ), U( shift_amount( b ) ) ) ); } );
+    return false;
+  case R3_HORIZONTAL << 3 | 4:
+  case R3_HORIZONTAL << 3 | 5:
+  case R3_HORIZONTAL << 3 | 6:
+  case R3_HORIZONTAL << 3 | 7:
+    if constexpr ( is_byte )
+    {
+      return true;
+    }
+    else
+    {
+      using H = half_t<T>;
+      using UH = unsigned_t<H>;
+
+      auto const is_signed = ( op & 1 ) == 0;
+      auto const a = lanes<H>( s );
+      auto const b = lanes<H>( t );
+      Lanes<T>   r;
+
+      for ( int i = 0; i < Lanes<T>::size; ++i )
+      {
+        auto const x = is_signed ? T( a.e[2 * i + 1] ) : T( UH( a.e[2 * i + 1] ) );
+        auto const y = is_signed ? T( b.e[2 * i] ) : T( UH( b.e[2 * i] ) );
+        r.e[i] = T( op < 6 ? U( x ) + U( y ) : U( x ) - U( y ) );
+      }
+
+      res = vector( r );
+      return false;
+    }
+
+  default:
+    return true;
+  }
+}
+
+// Forces `v` to be computed before the host flags are read, see `CP1::handle_fpu_ex`
+void materialize( __m128i v ) noexcept
+{
+  std::uint64_t halves[2];
+  std::memcpy( halves, &v, sizeof( v ) );
+
+  volatile std::uint64_t sink;
+  sink = halves[0];
+  sink = halves[1];
+  ( void )sink;
+}
+
+// Calls `operation( T{} )` with the floating point type of the 3RF and 2RF data format `df`
+template<typename Operation>
+decltype( auto ) with_fp_df( std::uint32_t df, Operation operation ) noexcept
+{
+  if ( df == 0 )
+    return operation( float{} );
+  else
+    return operation( double{} );
+}
+
+// Integer of the same size of T
+template<typename T>
+using integer_t = std::conditional_t<sizeof( T ) == 4, std::int32_t, std::int64_t>;
+
+// Converts the already rounded `r` to an integer, saturating and signaling Invalid Operation if it doesn't fit
+template<typename T, typename I>
+I saturate( T r, std::uint32_t &ex ) noexcept
+{
+  // 2^(bits of I) as T, exact
+  constexpr T limit = T( std::numeric_limits<I>::max() / 2 + 1 ) * 2;
+
+  if ( std::isnan( r ) )
+  {
+    ex |= CP1::INVALID;
+    return 0;
+  }
+
+  if constexpr ( std::is_signed_v<I> )
+  {
+    if ( r >= limit / 2 || r < -limit / 2 )
+    {
+      ex |= CP1::INVALID;
+      return r < 0 ? std::numeric_limits<I>::min() : std::numeric_limits<I>::max();
+    }
+  }
+  else
+  {
+    if ( r >= limit || r < 0 )
+    {
+      ex |= CP1::INVALID;
+      return r < 0 ? 0 : std::numeric_limits<I>::max();
+    }
+  }
+
+  return I( r );
+}
+
+template<typename T>
+__m128i as_int( T v ) noexcept;
+
+template<>
+__m128i as_int( __m128 v ) noexcept
+{
+  return _mm_castps_si128( v );
+}
+
+template<>
+__m128i as_int( __m128d v ) noexcept
+{
+  return _mm_castpd_si128( v );
+}
+
+// Class mask of FCLASS, same as CLASS.fmt
+template<typename T>
+integer_t<T> classify( T value ) noexcept
+{
+  constexpr integer_t<T> QNAN{ 0x02 };
+  constexpr integer_t<T> INFINITY_{ 0x04 };
+  constexpr integer_t<T> NORMAL{ 0x08 };
+  constexpr integer_t<T> SUBNORMAL{ 0x10 };
+  constexpr integer_t<T> ZERO{ 0x20 };
+
+  integer_t<T> mask{ QNAN };
+
+  switch ( std::fpclassify( value ) )
+  {
+  case FP_INFINITE: mask = INFINITY_; break;
+  case FP_NORMAL: mask = NORMAL; break;
+  case FP_SUBNORMAL: mask = SUBNORMAL; break;
+  case FP_ZERO: mask = ZERO; break;
+  default: return mask;
+  }
+
+  return std::signbit( value ) ? mask : mask << 4;
+}
+} // namespace
+
+__m128i CP1::load_vr( std::uint32_t reg ) const noexcept
+{
+  return _mm_set_epi64x( std::int64_t( vpr_high[reg] ), std::int64_t( fpr[reg].i64 ) );
+}
+
+void CP1::store_vr( std::uint32_t reg, __m128i value ) noexcept
+{
+  std::uint64_t halves[2];
+  std::memcpy( halves, &value, sizeof( value ) );
+
+  fpr[reg].i64 = halves[0];
+  vpr_high[reg] = halves[1];
+}
+
+std::array<std::uint32_t, 4> CP1::read_vector( std::uint32_t reg ) noexcept
+{
+  assert( reg < 32 && "Invalid Vector Register!" );
+
+  std::array<std::uint32_t, 4> words;
+  auto const                   value = load_vr( reg );
+  std::memcpy( words.data(), &value, sizeof( value ) );
+  return words;
+}
+
+void CP1::write_vector( std::uint32_t reg, std::array<std::uint32_t, 4> const &words ) noexcept
+{
+  assert( reg < 32 && "Invalid Vector Register!" );
+
+  __m128i value;
+  std::memcpy( &value, words.data(), sizeof( value ) );
+  store_vr( reg, value );
+}
+
+bool CP1::msa_condition( std::uint32_t word ) noexcept
+{
+  constexpr std::uint32_t BZ_V{ 0b01'011 };
+  constexpr std::uint32_t BNZ_V{ 0b01'111 };
+  constexpr std::uint32_t BNZ_B{ 0b11'100 };
+
+  auto const type = word >> 21 & 0x1F;
+  auto const value = load_vr( wt( word ) );
+  auto const zero = _mm_setzero_si128();
+
+  if ( type == BZ_V || type == BNZ_V )
+  {
+    auto const is_zero = _mm_movemask_epi8( _mm_cmpeq_epi8( value, zero ) ) == 0xFFFF;
+    return type == BZ_V ? is_zero : !is_zero;
+  }
+
+  // BZ.df: at least one element is zero, BNZ.df: none of them
+  auto const any_zero = with_df( type & 0b11, [ value ] ( auto t )
+  {
+    using T = decltype( t );
+
+    for ( auto e : lanes<T>( value ).e )
+      if ( e == 0 ) return true;
+    return false;
+  } );
+
+  return type >= BNZ_B ? !any_zero : any_zero;
+}
+
+std::uint32_t CP1::msa_mxcsr() const noexcept
+{
+  std::uint32_t csr{ _MM_MASK_MASK };
+
+  switch ( msacsr & 0x3 )
+  {
+  case ROUND_NEAREST: csr |= _MM_ROUND_NEAREST; break;
+  case ROUND_ZERO: csr |= _MM_ROUND_TOWARD_ZERO; break;
+  case ROUND_UP: csr |= _MM_ROUND_UP; break;
+  case ROUND_DOWN: csr |= _MM_ROUND_DOWN; break;
+  }
+
+  if ( msacsr & ( 1 << 24 ) )
+    csr |= _MM_FLUSH_ZERO_ON | DENORMALS_ZERO;
+
+  return csr;
+}
+
+bool CP1::msa_raise( std::uint32_t ex ) noexcept
+{
+  // The Cause field holds only the exceptions of the last instruction
+  msacsr = msacsr & ~( 0x3F << 12 ) | ( ex & 0x3F ) << 12;
+
+  if ( ex & ( msacsr >> 7 & 0x1F ) )
+    return true; // Trap
+
+  msacsr |= ( ex & 0x1F ) << 2;
+  return false;
+}
+
+template<typename Operation>
+int CP1::msa_fp( std::uint32_t reg, Operation operation ) noexcept
+{
+  assert( active && "MSA executed outside of enter() and leave()!" );
+
+  // The FPU's rounding, flushing and pending exceptions are restored afterwards
+  auto const fpu = _mm_getcsr();
+  _mm_setcsr( msa_mxcsr() );
+
+  std::uint32_t ex{ NONE };
+  auto const    res = operation( ex );
+  materialize( res );
+
+  ex |= exceptions_of( _mm_getcsr() );
+  _mm_setcsr( fpu );
+
+  if ( msa_raise( ex ) ) return 1;
+  store_vr( reg, res );
+
+  return 0;
+}
+
+CP1::Exception CP1::execute_msa( std::uint32_t word, std::array<std::uint32_t, 32> &gpr ) noexcept
+{
+  assert( ( word >> 26 == 0b011110 ) && "Invalid Opcode!" );
+
+  int v;
+
+  switch ( minor( word ) )
+  {
+  case I8_LOGIC:
+  case I8_BIT_MOVE:
+  case I8_SHF: v = msa_i8( word ); break;
+  case I5_ARITHMETIC:
+  case I5_COMPARE:
+  case BIT_SHIFT: v = msa_immediate( word ); break;
+  case R3_SHIFT:
+  case R3_ARITHMETIC:
+  case R3_COMPARE:
+  case R3_ADD:
+  case R3_SUB:
+  case R3_MUL:
+  case R3_DOT:
+  case R3_SHUFFLE:
+  case R3_HORIZONTAL: v = msa_3r( word, gpr ); break;
+  case ELM: v = msa_elm( word, gpr ); break;
+  case R3F_COMPARE:
+  case R3F_ARITHMETIC:
+  case R3F_COMPARE_NE: v = msa_3rf( word ); break;
+  case VEC_2R_2RF: v = msa_vec_2r( word, gpr ); break;
+  default: v = -1; break;
+  }
+
+  if ( v == 1 )
+    return Exception( msacsr >> 12 & 0x3F );
+  else if ( v == -1 )
+    return RESERVED;
+  else
+    return NONE;
+}
+
+int CP1::msa_i8( std::uint32_t word ) noexcept
+{
+  auto const op = word >> 24 & 0b11;
+  auto const i8 = word >> 16 & 0xFF;
+
+  auto const d = load_vr( wd( word ) );
+  auto const s = load_vr( ws( word ) );
+  auto const imm = _mm_set1_epi8( char( i8 ) );
+
+  __m128i res;
+
+  if ( minor( word ) == I8_LOGIC )
+  {
+    switch ( op )
+    {
+    case 0: res = _mm_and_si128( s, imm ); break;                                    // ANDI.B
+    case 1: res = _mm_or_si128( s, imm ); break;                                     // ORI.B
+    case 2: res = _mm_xor_si128( _mm_or_si128( s, imm ), _mm_set1_epi8( -1 ) ); break; // NORI.B
+    default: res = _mm_xor_si128( s, imm ); break;                                   // XORI.B
+    }
+  }
+  else if ( minor( word ) == I8_BIT_MOVE )
+  {
+    switch ( op )
+    {
+    case 0: res = _mm_or_si128( _mm_and_si128( s, imm ), _mm_andnot_si128( imm, d ) ); break; // BMNZI.B
+    case 1: res = _mm_or_si128( _mm_andnot_si128( imm, s ), _mm_and_si128( imm, d ) ); break; // BMZI.B
+    case 2: res = _mm_or_si128( _mm_andnot_si128( d, s ), _mm_and_si128( d, imm ) ); break;   // BSELI.B
+    default: return -1;
+    }
+  }
+  else // SHF.df
+  {
+    if ( op == 3 ) return -1;
+
+    res = with_df( op, [ s, i8 ] ( auto t )
+    {
+      using T = decltype( t );
+
+      auto const a = lanes<T>( s );
+      Lanes<T>   r;
+
+      for ( int i = 0; i < Lanes<T>::size; ++i )
+        r.e[i] = a.e[( i & ~3 ) + ( i8 >> 2 * ( i & 3 ) & 3 )];
+
+      return vector( r );
+    } );
+  }
+
+  store_vr( wd( word ), res );
+  return 0;
+}
+
+int CP1::msa_immediate( std::uint32_t word ) noexcept
+{
+  auto const op = operation( word );
+  auto const s = load_vr( ws( word ) );
+
+  // LDI.df is the only I10 instruction
+  if ( minor( word ) == I5_COMPARE && op == 6 )
+  {
+    auto const s10 = std::int32_t( word << 11 ) >> 22;
+    store_vr( wd( word ), with_df( df( word ), [ s10 ] ( auto t ) { return splat( decltype( t )( s10 ) ); } ) );
+    return 0;
+  }
+
+  std::uint32_t group;
+  std::uint32_t format;
+  std::int32_t  imm;
+
+  if ( minor( word ) == BIT_SHIFT )
+  {
+    // SLLI, SRAI, SRLI, BCLRI, BSETI, BNEGI with the format and bit index in bits [22, 16]
+    auto const df_m = word >> 16 & 0x7F;
+
+    if ( ( df_m & 0x40 ) == 0 ) format = 3, imm = df_m & 0x3F;
+    else if ( ( df_m & 0x60 ) == 0x40 ) format = 2, imm = df_m & 0x1F;
+    else if ( ( df_m & 0x70 ) == 0x60 ) format = 1, imm = df_m & 0x0F;
+    else if ( ( df_m & 0x78 ) == 0x70 ) format = 0, imm = df_m & 0x07;
+    else return -1;
+
+    if ( op > 5 ) return -1;
+    group = R3_SHIFT;
+  }
+  else
+  {
+    format = df( word );
+
+    // MAXI_S, MINI_S, CEQI, CLTI_S and CLEI_S have a signed immediate
+    auto const is_signed = op == 2 || op == 4 || minor( word ) == I5_COMPARE && op == 0;
+
+    imm = is_signed ? std::int32_t( word << 11 ) >> 27 : std::int32_t( word >> 16 & 0x1F );
+
+    if ( op > 5 || minor( word ) == I5_COMPARE && op == 1 ) return -1;
+    group = minor( word ) == I5_ARITHMETIC ? R3_ARITHMETIC : R3_COMPARE;
+  }
+
+  __m128i res;
+
+  auto const reserved = with_df( format, [ &res, group, op, imm, s ] ( auto t )
+  {
+    using T = decltype( t );
+    return integer<T>( group, op, s, s, splat( T( imm ) ), res );
+  } );
+
+  if ( reserved ) return -1;
+
+  store_vr( wd( word ), res );
+  return 0;
+}
+
+int CP1::msa_3r( std::uint32_t word, std::array<std::uint32_t, 32> const &gpr ) noexcept
+{
+  auto const op = operation( word );
+  auto const d = load_vr( wd( word ) );
+  auto const s = load_vr( ws( word ) );
+
+  __m128i res;
+
+  if ( minor( word ) == R3_SHUFFLE && op == 1 ) // SPLAT.df, wt is a GPR
+  {
+    res = with_df( df( word ), [ s, n = gpr[wt( word )] ] ( auto t )
+    {
+      using T = decltype( t );
+      return splat( lanes<T>( s ).e[n % Lanes<T>::size] );
+    } );
+  }
+  else
+  {
+    auto const t = load_vr( wt( word ) );
+
+    auto const reserved = with_df( df( word ), [ &res, group = minor( word ), op, d, s, t ] ( auto e )
+    {
+      using T = decltype( e );
+      return integer<T>( group, op, d, s, t, res );
+    } );
+
+    if ( reserved ) return -1;
+  }
+
+  store_vr( wd( word ), res );
+  return 0;
+}
+
+int CP1::msa_elm( std::uint32_t word, std::array<std::uint32_t, 32> &gpr ) noexcept
+{
+  constexpr std::uint32_t SPLATI{ 0b0001 };
+  constexpr std::uint32_t COPY_S{ 0b0010 };
+  constexpr std::uint32_t COPY_U{ 0b0011 };
+  constexpr std::uint32_t INSERT{ 0b0100 };
+  constexpr std::uint32_t INSVE{ 0b0101 };
+
+  auto const op = word >> 22 & 0xF;
+  auto const df_n = word >> 16 & 0x3F;
+
+  // CTCMSA, CFCMSA, MOVE.V
+  if ( df_n == 0b111110 )
+  {
+    auto const reg = ws( word );
+
+    if ( op == 0 )
+    {
+      if ( wd( word ) == 1 )
+        msacsr = msacsr & ~MSACSR_WRITABLE | gpr[reg] & MSACSR_WRITABLE;
+      else if ( wd( word ) != 0 ) // MSAIR is read only
+        return -1;
+    }
+    else if ( op == 1 )
+    {
+      if ( reg > 1 ) return -1;
+      gpr[wd( word )] = reg == 0 ? msair : msacsr;
+    }
+    else if ( op == 2 )
+    {
+      store_vr( wd( word ), load_vr( reg ) );
+    }
+    else
+    {
+      return -1;
+    }
+
+    return 0;
+  }
+
+  std::uint32_t format;
+  std::uint32_t n;
+
+  if ( ( df_n & 0x30 ) == 0x00 ) format = 0, n = df_n & 0x0F;
+  else if ( ( df_n & 0x38 ) == 0x20 ) format = 1, n = df_n & 0x07;
+  else if ( ( df_n & 0x3C ) == 0x30 ) format = 2, n = df_n & 0x03;
+  else if ( ( df_n & 0x3E ) == 0x38 ) format = 3, n = df_n & 0x01;
+  else return -1;
+
+  // GPRs are 32-bit wide, doublewords can't be moved
+  if ( format == 3 && ( op == COPY_S || op == COPY_U || op == INSERT ) )
+    return -1;
+
+  auto const s = load_vr( ws( word ) );
+  auto const d = load_vr( wd( word ) );
+
+  return with_df( format, [ &, this ] ( auto t )
+  {
+    using T = decltype( t );
+    using U = unsigned_t<T>;
+
+    switch ( op )
+    {
+    case SPLATI: store_vr( wd( word ), splat( lanes<T>( s ).e[n] ) ); return 0;
+    case COPY_S: gpr[wd( word )] = std::uint32_t( std::int32_t( lanes<T>( s ).e[n] ) ); return 0;
+    case COPY_U: gpr[wd( word )] = std::uint32_t( U( lanes<T>( s ).e[n] ) ); return 0;
+    case INSERT:
+    {
+      auto r = lanes<T>( d );
+      r.e[n] = T( gpr[ws( word )] );
+      store_vr( wd( word ), vector( r ) );
+      return 0;
+    }
+    case INSVE:
+    {
+      auto r = lanes<T>( d );
+      r.e[n] = lanes<T>( s ).e[0];
+      store_vr( wd( word ), vector( r ) );
+      return 0;
+    }
+    default: return -1;
+    }
+  } );
+}
+
+int CP1::msa_3rf( std::uint32_t word ) noexcept
+{
+  auto const op = word >> 22 & 0xF;
+  auto const group = minor( word );
+
+  auto const d = load_vr( wd( word ) );
+  auto const s = load_vr( ws( word ) );
+  auto const t = load_vr( wt( word ) );
+
+  // Reserved ones and the ones not implemented
+  if ( group == R3F_ARITHMETIC && ( op == 6 || op >= 7 && op <= 11 )
+       || group == R3F_COMPARE_NE && ( op == 0 || op >= 4 && op <= 8 || op >= 12 ) )
+    return -1;
+
+  return with_fp_df( word >> 21 & 1, [ & ] ( auto f )
+  {
+    using T = decltype( f );
+    using I = integer_t<T>;
+
+    // Element-wise comparison, the signaling ones raise Invalid Operation with any NaN
+    auto const compare = [ s, t, signaling = ( op & 0b1000 ) != 0 ] ( std::uint32_t &ex, auto predicate )
+    {
+      auto const a = lanes<T>( s );
+      auto const b = lanes<T>( t );
+      Lanes<I>   r;
+
+      for ( int i = 0; i < Lanes<I>::size; ++i )
+      {
+        if ( signaling && std::isunordered( a.e[i], b.e[i] ) )
+          ex |= INVALID;
+        r.e[i] = all_ones<I>( predicate( a.e[i], b.e[i] ) );
+      }
+
+      return vector( r );
+    };
+
+    return msa_fp( wd( word ), [ & ] ( std::uint32_t &ex ) -> __m128i
+    {
+      if ( group == R3F_ARITHMETIC )
+      {
+        if constexpr ( std::is_same_v<T, float> )
+        {
+          auto const a = _mm_castsi128_ps( s );
+          auto const b = _mm_castsi128_ps( t );
+
+          switch ( op )
+          {
+          case 0: return as_int( _mm_add_ps( a, b ) ); // FADD
+          case 1: return as_int( _mm_sub_ps( a, b ) ); // FSUB
+          case 2: return as_int( _mm_mul_ps( a, b ) ); // FMUL
+          case 3: return as_int( _mm_div_ps( a, b ) ); // FDIV
+          }
+        }
+        else
+        {
+          auto const a = _mm_castsi128_pd( s );
+          auto const b = _mm_castsi128_pd( t );
+
+          switch ( op )
+          {
+          case 0: return as_int( _mm_add_pd( a, b ) );
+          case 1: return as_int( _mm_sub_pd( a, b ) );
+          case 2: return as_int( _mm_mul_pd( a, b ) );
+          case 3: return as_int( _mm_div_pd( a, b ) );
+          }
+        }
+
+        switch ( op )
+        {
+        case 4: return map<T>( d, s, t, [] ( T c, T a, T b ) { return std::fma( a, b, c ); } );  // FMADD
+        case 5: return map<T>( d, s, t, [] ( T c, T a, T b ) { return std::fma( -a, b, c ); } ); // FMSUB
+        case 12: return map<T>( s, t, [] ( T a, T b ) { return std::fmin( a, b ); } );            // FMIN
+        case 14: return map<T>( s, t, [] ( T a, T b ) { return std::fmax( a, b ); } );            // FMAX
+        case 13:                                                                                  // FMIN_A
+          return map<T>( s, t, [] ( T a, T b )
+          {
+            if ( std::isnan( a ) || std::isnan( b ) || std::fabs( a ) == std::fabs( b ) ) return std::fmin( a, b );
+            return std::fabs( a ) < std::fabs( b ) ? a : b;
+          } );
+        default: // FMAX_A
+          return map<T>( s, t, [] ( T a, T b )
+          {
+            if ( std::isnan( a ) || std::isnan( b ) || std::fabs( a ) == std::fabs( b ) ) return std::fmax( a, b );
+            return std::fabs( a ) > std::fabs( b ) ? a : b;
+          } );
+        }
+      }
+
+      if ( group == R3F_COMPARE )
+      {
+        switch ( op & 0b111 )
+        {
+        case 0: return compare( ex, [] ( T, T ) { return false; } );                                                      // FCAF
+        case 1: return compare( ex, [] ( T a, T b ) { return std::isunordered( a, b ); } );                               // FCUN
+        case 2: return compare( ex, [] ( T a, T b ) { return a == b; } );                                                 // FCEQ
+        case 3: return compare( ex, [] ( T a, T b ) { return std::isunordered( a, b ) || a == b; } );                     // FCUEQ
+        case 4: return compare( ex, [] ( T a, T b ) { return std::isless( a, b ); } );                                    // FCLT
+        case 5: return compare( ex, [] ( T a, T b ) { return std::isunordered( a, b ) || std::isless( a, b ); } );        // FCULT
+        case 6: return compare( ex, [] ( T a, T b ) { return std::islessequal( a, b ); } );                               // FCLE
+        default: return compare( ex, [] ( T a, T b ) { return std::isunordered( a, b ) || std::islessequal( a, b ); } ); // FCULE
+        }
+      }
+
+      switch ( op & 0b111 )
+      {
+      case 1: return compare( ex, [] ( T a, T b ) { return !std::isunordered( a, b ); } );          // FCOR
+      case 2: return compare( ex, [] ( T a, T b ) { return std::islessgreater( a, b ) || std::isunordered( a, b ); } ); // FCUNE
+      default: return compare( ex, [] ( T a, T b ) { return std::islessgreater( a, b ); } );        // FCNE
+      }
+    } );
+  } );
+}
+
+int CP1::msa_vec_2r( std::uint32_t word, std::array<std::uint32_t, 32> const &gpr ) noexcept
+{
+  auto const d = load_vr( wd( word ) );
+  auto const s = load_vr( ws( word ) );
+
+  // AND.V, OR.V, NOR.V, XOR.V, BMNZ.V, BMZ.V, BSEL.V
+  if ( auto const vec = word >> 21 & 0x1F; vec < 7 )
+  {
+    auto const t = load_vr( wt( word ) );
+
+    __m128i res;
+
+    switch ( vec )
+    {
+    case 0: res = _mm_and_si128( s, t ); break;
+    case 1: res = _mm_or_si128( s, t ); break;
+    case 2: res = _mm_xor_si128( _mm_or_si128( s, t ), _mm_set1_epi8( -1 ) ); break;
+    case 3: res = _mm_xor_si128( s, t ); break;
+    case 4: res = _mm_or_si128( _mm_and_si128( s, t ), _mm_andnot_si128( t, d ) ); break;
+    case 5: res = _mm_or_si128( _mm_andnot_si128( t, s ), _mm_and_si128( t, d ) ); break;
+    default: res = _mm_or_si128( _mm_andnot_si128( d, s ), _mm_and_si128( d, t ) ); break;
+    }
+
+    store_vr( wd( word ), res );
+    return 0;
+  }
+
+  // FILL, PCNT, NLOC, NLZC
+  if ( auto const op = word >> 18 & 0xFF; op >= 0b1100'0000 && op <= 0b1100'0011 )
+  {
+    auto const format = word >> 16 & 0b11;
+
+    // GPRs are 32-bit wide
+    if ( op == 0b1100'0000 && format == 3 ) return -1;
+
+    store_vr( wd( word ), with_df( format, [ op, s, r = gpr[ws( word )] ] ( auto t )
+    {
+      using T = decltype( t );
+      using U = unsigned_t<T>;
+
+      constexpr int bits{ sizeof( T ) * 8 };
+
+      auto const count_leading_zeros = [] ( U x )
+      {
+        int n = 0;
+        for ( U bit = U( 1 ) << ( bits - 1 ); bit && !( x & bit ); bit >>= 1 ) ++n;
+        return n;
+      };
+
+      switch ( op & 0b11 )
+      {
+      case 0: return splat( T( r ) );
+      case 1:
+        return map<T>( s, s, [] ( T a, T )
+        {
+          int n = 0;
+          for ( U x = U( a ); x; x &= x - 1 ) ++n;
+          return n;
+        } );
+      case 2: return map<T>( s, s, [ count_leading_zeros ] ( T a, T ) { return count_leading_zeros( U( ~U( a ) ) ); } );
+      default: return map<T>( s, s, [ count_leading_zeros ] ( T a, T ) { return count_leading_zeros( U( a ) ); } );
+      }
+    } ) );
+
+    return 0;
+  }
+
+  // 2RF: FCLASS, FTRUNC_S, FTRUNC_U, FSQRT, FRSQRT, FRCP, FRINT, FLOG2, FTINT_S, FTINT_U, FFINT_S, FFINT_U
+  auto const op = word >> 17 & 0x1FF;
+
+  if ( op < 0b1'1001'0000 || op > 0b1'1001'1111 || op >= 0b1'1001'1000 && op <= 0b1'1001'1011 )
+    return -1;
+
+  return with_fp_df( word >> 16 & 1, [ & ] ( auto f )
+  {
+    using T = decltype( f );
+    using I = integer_t<T>;
+    using U = unsigned_t<I>;
+
+    return msa_fp( wd( word ), [ & ] ( std::uint32_t &ex ) -> __m128i
+    {
+      auto const to_int = [ s, &ex ] ( auto round, auto integer )
+      {
+        using R = decltype( integer );
+
+        auto const a = lanes<T>( s );
+        Lanes<R>   r;
+
+        for ( int i = 0; i < Lanes<R>::size; ++i )
+          r.e[i] = saturate<T, R>( round( a.e[i], ex ), ex );
+
+        return vector( r );
+      };
+
+      auto const truncate = [] ( T a, std::uint32_t &ex )
+      {
+        auto const r = std::trunc( a );
+        if ( r != a && !std::isnan( a ) ) ex |= INEXACT;
+        return r;
+      };
+
+      auto const current = [] ( T a, std::uint32_t & ) { return std::rint( a ); };
+
+      switch ( op & 0xF )
+      {
+      case 0x0: return map<I>( s, s, [] ( I a, I ) { T v; std::memcpy( &v, &a, sizeof( v ) ); return classify( v ); } );
+      case 0x1: return to_int( truncate, I{} );
+      case 0x2: return to_int( truncate, U{} );
+      case 0x3:
+        if constexpr ( std::is_same_v<T, float> ) return as_int( _mm_sqrt_ps( _mm_castsi128_ps( s ) ) );
+        else return as_int( _mm_sqrt_pd( _mm_castsi128_pd( s ) ) );
+      case 0x4: return map<T>( s, s, [] ( T a, T ) { return T( 1 ) / std::sqrt( a ); } );
+      case 0x5: return map<T>( s, s, [] ( T a, T ) { return T( 1 ) / a; } );
+      case 0x6: return map<T>( s, s, [] ( T a, T ) { return std::rint( a ); } );
+      case 0x7: return map<T>( s, s, [] ( T a, T ) { return std::floor( std::log2( a ) ); } );
+      case 0xC: return to_int( current, I{} );
+      case 0xD: return to_int( current, U{} );
+      case 0xE:
+        if constexpr ( std::is_same_v<T, float> ) return as_int( _mm_cvtepi32_ps( s ) );
+        else return map<I>( s, s, [] ( I a, I ) { T v = T( a ); I r; std::memcpy( &r, &v, sizeof( r ) ); return r; } );
+      default:
+        return map<I>( s, s, [] ( I a, I ) { T v = T( U( a ) ); I r; std::memcpy( &r, &v, sizeof( r ) ); return r; } );
+      }
+    } );
+  } );
+}
+
+} // namespace mips32
@@ -0,0 +1,208 @@
+#include <mips32/profiler.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+namespace mips32
+{
+Profiler::Profiler( std::uint32_t interval, std::uint32_t max_depth ) noexcept
+  : interval( interval ), max_depth( max_depth )
+{
+  assert( interval && "The sampling interval can't be 0 (zero)." );
+
+  frames.reserve( max_depth );
+  untracked_returns.resize( max_depth );
+  key.reserve( max_depth + 2 );
+}
+
+void Profiler::add_symbol( std::uint32_t address, std::string name ) noexcept
+{
+  symbols[address] = std::move( name );
+}
+
+bool Profiler::load_symbols( std::FILE *in ) noexcept
+{
+  char line[512];
+
+  while ( std::fgets( line, sizeof( line ), in ) )
+    parse_symbol( line );
+
+  return std::ferror( in );
+}
+
+void Profiler::load_symbols( char const *text, std::size_t size ) noexcept
+{
+  char line[512];
+
+  for ( auto const *end = text + size; text != end; )
+  {
+    auto const *eol = std::find( text, end, '\n' );
+
+    // A longer line is truncated
+    auto const length = std::min( std::size_t( eol - text ), sizeof( line ) - 1 );
+    std::memcpy( line, text, length );
+    line[length] = '\0';
+
+    parse_symbol( line );
+
+    text = eol == end ? end : eol + 1;
+  }
+}
+
+void Profiler::parse_symbol( char const *line ) noexcept
+{
+  unsigned int address;
+  char         first[256];
+  char         second[256];
+
+  auto const fields = std::sscanf( line, "%x %255s %255s", &address, first, second );
+
+  if ( fields == 2 )
+    add_symbol( address, first );
+  else if ( fields == 3 )
+    add_symbol( address, second );
+}
+
+/**
+ * The PC is resolved to the function that contains it,
+ * it's omitted when it's the same as the innermost call.
+ **/
+bool Profiler::export_folded( std::FILE *out ) const noexcept
+{
+  // Different addresses can be resolved to the same stack
+  std::map<std::string, std::uint64_t> folded;
+
+  for ( auto const &stack : stacks )
+  {
+    auto const &addresses = stack.first;
+
+    std::string line;
+    std::string last;
+
+    for ( std::size_t i = 0; i < addresses.size(); ++i )
+    {
+      auto name = symbolize( addresses[i] );
+
+      if ( i + 1 == addresses.size() && i && name == last )
+        break;
+
+      if ( i )
+        line += ';';
+
+      line += name;
+      last = std::move( name );
+    }
+
+    folded[line] += stack.second;
+  }
+
+  bool error = false;
+
+  for ( auto const &stack : folded )
+    error |= std::fprintf( out, "%s %llu\n", stack.first.c_str(), ( unsigned long long )stack.second ) < 0;
+
+  return error || std::ferror( out );
+}
+
+void Profiler::clear() noexcept
+{
+  frames.clear();
+  untracked = 0;
+  retained = 0;
+  stacks.clear();
+  samples = 0;
+}
+
+std::size_t Profiler::StackHash::operator()( std::vector<std::uint32_t> const &stack ) const noexcept
+{
+  // FNV-1a
+  std::uint64_t hash = 0xCBF2'9CE4'8422'2325;
+
+  for ( auto address : stack )
+  {
+    hash ^= address;
+    hash *= 0x100'0000'01B3;
+  }
+
+  return std::size_t( hash );
+}
+
+void Profiler::sample( std::uint32_t pc ) noexcept
+{
+  key.clear();
+
+  if ( !frames.empty() )
+    key.push_back( frames.front().call_site );
+
+  for ( auto const &frame : frames )
+    key.push_back( frame.entry );
+
+  key.push_back( pc );
+
+  ++stacks[key];
+  ++samples;
+}
+
+void Profiler::call( std::uint32_t call_site, std::uint32_t entry, std::uint32_t return_address ) noexcept
+{
+  if ( frames.size() < max_depth )
+  {
+    frames.push_back( { call_site, entry, return_address } );
+    return;
+  }
+
+  if ( untracked_returns.empty() )
+    return;
+
+  untracked_returns[untracked % untracked_returns.size()] = return_address;
+  ++untracked;
+  retained = std::min( retained + 1, std::uint32_t( untracked_returns.size() ) );
+}
+
+/**
+ * The jump returns from the innermost call whose return address is `target`,
+ * every call nested inside it is discarded (e.g. a longjmp).
+ * Otherwise it isn't a return, e.g. a jump table.
+ *
+ * A return from an untracked call older than the retained ones can't be recognized,
+ * the count of the untracked calls is then too high until a tracked call returns.
+ **/
+void Profiler::jump( std::uint32_t target ) noexcept
+{
+  for ( std::uint32_t call = 0; call < retained; ++call )
+  {
+    if ( untracked_returns[( untracked - 1 - call ) % untracked_returns.size()] == target )
+    {
+      untracked -= call + 1;
+      retained -= call + 1;
+      return;
+    }
+  }
+
+  for ( auto frame = frames.size(); frame-- > 0; )
+  {
+    if ( frames[frame].return_address == target )
+    {
+      frames.resize( frame );
+      untracked = 0;
+      retained = 0;
+      return;
+    }
+  }
+}
+
+std::string Profiler::symbolize( std::uint32_t address ) const noexcept
+{
+  auto symbol = symbols.upper_bound( address );
+
+  if ( symbol != symbols.begin() )
+    return std::prev( symbol )->second;
+
+  char hex[11];
+  std::snprintf( hex, sizeof( hex ), "0x%08X", address );
+
+  return hex;
+}
+} // namespace mips32
@@ -23,15 +23,23 @@ RAM::RAM( std::uint32_t alloc_limit ) : alloc_limit( alloc_limit / block_size )
 
 RAM::Block &RAM::least_accessed() noexcept
 {
-  std::sort( blocks.begin(), blocks.end(), [] ( Block &lhs, Block &rhs ) -> bool { return lhs.access_count > rhs.access_count; } );
+  std::sort( blocks.begin(), blocks.end(), [] ( Block &lhs, Block &rhs ) -> bool
+  {
+    if ( bool( lhs.pin_count ) != bool( rhs.pin_count ) )
+      return lhs.pin_count;
+
+    return lhs.access_count > rhs.access_count;
+  } );
 
   for ( auto &block : blocks ) block.access_count = 0;
 
+  assert( !blocks.back().pin_count && "Every block is pinned, there's nothing to swap." );
+
   return blocks.back();
 }
 
 /**
- * We need to retrieve the block that contains the address.
+ * The hint of `at` missed, we need to retrieve the block that contains the address.
  * If the block doesn't exists, we need to create it.
  *
  * Case 1:
@@ -61,15 +69,17 @@ RAM::Block &RAM::least_accessed() noexcept
  *   + Overwrite the block
  *   + Return the word
  **/
-std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
+std::uint32_t &RAM::resolve( std::uint32_t address, std::size_t &hint ) noexcept
 {
   // Case 1
-  for ( auto &block : blocks )
+  for ( std::size_t i = 0; i < blocks.size(); ++i )
   {
-    if ( contains( block.base_address, address, block_size ) )
+    if ( contains( blocks[i].base_address, address, block_size ) )
     {
+      hint = i;
+
       // Return the word
-      return block[(address - block.base_address) >> 2];
+      return blocks[i][( address - blocks[i].base_address ) >> 2];
     }
   }
 
@@ -86,12 +96,15 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
       // Swap that block on disk
       allocated_block.serialize();
       allocated_block.base_address = block_on_disk.base_address;
+      allocated_block.unmap();
 
       // Load the block from disk
       allocated_block.deserialize();
 
       block_on_disk.base_address = old_addr;
 
+      hint = std::size_t( &allocated_block - blocks.data() );
+
       // Return the word
       return allocated_block[( address  - allocated_block.base_address) >> 2];
     }
@@ -103,11 +116,13 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
     Block new_block;
 
     // Allocate block
-    new_block.allocate();
     new_block.base_address = calculate_base_address( address );
+    new_block.allocate( fill_word( new_block.base_address ) );
 
     blocks.push_back( std::move( new_block ) );
 
+    hint = blocks.size() - 1;
+
     // Return the word
     auto &block = blocks.back();
     return block[(address - block.base_address) >> 2];
@@ -122,26 +137,129 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
 
     // Swap that block on disk
     allocated_block.serialize();
+    allocated_block.unmap();
 
     // Calculate the base address
     allocated_block.base_address = calculate_base_address( address );
 
+    // Overwrite the block
+    std::fill_n( allocated_block.data.get(), block_size / 4, fill_word( allocated_block.base_address ) );
+
+    hint = std::size_t( &allocated_block - blocks.data() );
+
     // Return the word
     return allocated_block[( address - allocated_block.base_address ) >> 2];
   }
 }
 
-RAM::Block &RAM::Block::allocate() noexcept
+bool RAM::map_file( std::uint32_t address, MappedFile &&file ) noexcept
 {
-  constexpr std::uint32_t sigrie{ 0x0417'CCCC };
+  std::uint64_t const size = file.size();
+
+  if ( address % block_size || !size || size > 0x1'0000'0000 - std::uint64_t( address ) )
+    return true;
+
+  std::uint32_t const full_blocks = std::uint32_t( size / block_size );
+  std::uint32_t const tail = std::uint32_t( size % block_size );
+  std::uint32_t const block_no = full_blocks + ( tail != 0 );
+
+  // Someone is using the memory of these blocks
+  for ( auto const &block : blocks )
+  {
+    if ( block.pin_count && std::uint64_t( block.base_address - address ) < std::uint64_t( block_no ) * block_size )
+      return true;
+  }
+
+  auto const  mapping = std::make_shared<MappedFile>( std::move( file ) );
+  auto *const words = reinterpret_cast<std::uint32_t *>( mapping->data() );
+
+  for ( std::uint32_t i = 0; i < full_blocks; ++i )
+    claim( address + i * block_size ).map( words + i * ( block_size / 4 ), mapping );
+
+  // Mapping past the end of the file isn't portable, the tail is copied instead
+  if ( tail )
+  {
+    auto &block = claim( address + full_blocks * block_size );
+
+    if ( !block.data || !block.data.get_deleter().owned )
+      block.deallocate().allocate( 0 );
+
+    auto *const dst = reinterpret_cast<char *>( block.data.get() );
+    std::memcpy( dst, mapping->data() + ( size - tail ), tail );
+    std::memset( dst + tail, 0, block_size - tail );
+  }
+
+  return false;
+}
+
+RAM::Block &RAM::claim( std::uint32_t base_address ) noexcept
+{
+  for ( auto &block : blocks )
+  {
+    if ( block.base_address == base_address )
+      return block;
+  }
+
+  auto const on_disk = std::find_if( swapped.begin(), swapped.end(), [base_address] ( SwappedBlock const &swapped_block )
+  {
+    return swapped_block.base_address == base_address;
+  } );
+
+  if ( on_disk != swapped.end() )
+  {
+    char file_name[18]{ '\0' };
+    addr_to_string( file_name, base_address );
+
+    std::remove( file_name );
+    swapped.erase( on_disk );
+  }
 
+  if ( blocks.size() < alloc_limit )
+  {
+    blocks.emplace_back();
+    blocks.back().base_address = base_address;
+    return blocks.back();
+  }
+
+  auto &block = least_accessed();
+
+  swapped.push_back( { block.base_address } );
+  block.serialize();
+  block.base_address = base_address;
+
+  return block;
+}
+
+RAM::Block &RAM::Block::allocate( std::uint32_t fill ) noexcept
+{
   assert( !data && "Block already allocated." );
 
   data.reset( new ( std::nothrow ) std::uint32_t[RAM::block_size / 4] );
+  data.get_deleter().owned = true;
+  data.get_deleter().mapping.reset();
   assert( data && "Couldn't allocate the block." );
 
   if ( data )
-    std::fill_n( data.get(), RAM::block_size / 4, sigrie ); // fill the new block with the 'sigrie' instruction
+    std::fill_n( data.get(), RAM::block_size / 4, fill );
+
+  return *this;
+}
+
+RAM::Block &RAM::Block::map( std::uint32_t *words, std::shared_ptr<MappedFile> mapping ) noexcept
+{
+  assert( words && "Block::map() called without a memory region." );
+
+  data.reset( words );
+  data.get_deleter().owned = false;
+  data.get_deleter().mapping = std::move( mapping );
+
+  return *this;
+}
+
+RAM::Block &RAM::Block::unmap() noexcept
+{
+  if ( data && !data.get_deleter().owned )
+    deallocate().allocate();
 
   return *this;
 }
@@ -149,6 +267,7 @@ RAM::Block &RAM::Block::allocate() noexcept
 RAM::Block &RAM::Block::deallocate() noexcept
 {
   data.reset( nullptr );
+  data.get_deleter().mapping.reset();
   return *this;
 }
 
@@ -2,6 +2,8 @@
 
 #include <mips32/literals.hpp>
 
+#include "mapped_file.hpp"
+
 #include <algorithm>
 #include <cstdint>
 #include <memory>
@@ -54,31 +56,93 @@ public:
   RAM &operator=( RAM const & ) = delete;
 
   // Returns the word at the given address
-  std::uint32_t &operator[]( std::uint32_t address ) noexcept;
+  std::uint32_t &operator[]( std::uint32_t address ) noexcept { return at( address, last_block ); }
 
-  inline static constexpr std::uint32_t calculate_base_address( std::uint32_t address ) noexcept
+  // Same as operator[], `hint` is the index of the block used by the previous access through it.
+  // A hit on that block is handled inline, otherwise `resolve` looks the block up and updates `hint`.
+  // Any value is a valid hint: it's checked against the block list, that can change between the accesses.
+  std::uint32_t &at( std::uint32_t address, std::size_t &hint ) noexcept
   {
-    std::uint32_t base_address = 0;
+    if ( hint < blocks.size() )
+    {
+      auto &block = blocks[hint];
+
+      if ( contains( block.base_address, address, block_size ) )
+        return block[( address - block.base_address ) >> 2];
+    }
 
-    while ( base_address + RAM::block_size <= address )
-      base_address += RAM::block_size;
+    return resolve( address, hint );
+  }
 
-    return base_address;
+  // Blocks created inside [begin, end) are filled with zeroes instead of the sigrie instruction,
+  // e.g. the heap, whose memory must read as zero the first time it's touched.
+  // Nothing is allocated, the blocks are still created on their first access.
+  void zero_fill( std::uint32_t begin, std::uint32_t end ) noexcept
+  {
+    zero_begin = begin;
+    zero_end = end;
+  }
+
+  // Uses the memory of `file` as the content of the blocks starting at `address`, without copying it.
+  // Writes stay inside the mapping, the file on disk isn't modified (see MappedFile).
+  // If the file doesn't fill the last block, that block is copied and the remaining bytes are zeroed.
+  // Mapped blocks count towards the allocation limit like any other block.
+  // The mapping is released once none of its blocks uses it anymore: they've been swapped or mapped again.
+  //
+  // `address` must be a multiple of `RAM::block_size`.
+  // Returns:
+  // `true`  - in case of *failure*, e.g. one of the blocks is pinned
+  // `false` - in case of success
+  bool map_file( std::uint32_t address, MappedFile &&file ) noexcept;
+
+  inline static constexpr std::uint32_t calculate_base_address( std::uint32_t address ) noexcept
+  {
+    return address - address % RAM::block_size;
   }
 
 private:
+  // Fills the blocks that don't belong to a zero filled range,
+  // executing uninitialized memory raises an exception.
+  static inline constexpr std::uint32_t sigrie{ 0x0417'CCCC };
+
+  // Releases the words of a block only if the block owns them.
+  // Blocks mapped from a file or restored from a snapshot point directly inside a memory mapped file,
+  // they share the ownership of the mapping: the last one releases it.
+  struct BlockDeleter
+  {
+    bool                        owned;
+    std::shared_ptr<MappedFile> mapping; // when not owned
+
+    BlockDeleter() noexcept : owned( true ) {}
+
+    void operator()( std::uint32_t *words ) const noexcept
+    {
+      if ( owned )
+        delete[] words;
+    }
+  };
+
   // Represent a portion of data of our RAM.
-  // It's a very simple class that owns `RAM::block_size` words.
+  // It's a very simple class that holds `RAM::block_size` words.
   struct Block
   {
-    std::uint32_t                    base_address;    // base address of our block
-    std::uint32_t                    access_count{ 0 }; // number of accesses through operator[]
-    std::unique_ptr<std::uint32_t[]> data;            // Words array
+    std::uint32_t                                  base_address;      // base address of our block
+    std::uint32_t                                  access_count{ 0 }; // number of accesses through operator[]
+    std::uint32_t                                  pin_count{ 0 };    // while > 0 the block can't be swapped on disk
+    std::unique_ptr<std::uint32_t[], BlockDeleter> data;              // Words array
 
-    // Allocate a `RAM::block_size` array of words.
+    // Allocate a `RAM::block_size` array of words, each one set to `fill`.
     // If it fails, `data` holds nullptr,
     // otherwise `data` points to a valid memory region.
-    Block &allocate() noexcept;
+    Block &allocate( std::uint32_t fill = sigrie ) noexcept;
+
+    // Uses `RAM::block_size` bytes starting at `words`, inside `mapping`, as the block's data.
+    // The memory is *not* owned by the block, which keeps `mapping` alive instead.
+    Block &map( std::uint32_t *words, std::shared_ptr<MappedFile> mapping ) noexcept;
+
+    // Replaces the memory of a mapping with an allocated one, releasing the mapping if it was the last user.
+    // The content is unspecified, it's meant for a block that's been swapped on disk.
+    Block &unmap() noexcept;
 
     // Deallocate the data.
     Block &deallocate() noexcept;
@@ -108,15 +172,21 @@ private:
   };
 
   // Helper function that checks if the given addres belongs to a block.
-  bool contains( std::uint32_t base, std::uint32_t address, std::uint32_t limit ) const noexcept
+  // The block at the end of the address space doesn't wrap around.
+  static bool contains( std::uint32_t base, std::uint32_t address, std::uint32_t limit ) noexcept
   {
-    return base <= address && address < base + limit;
+    return address - base < limit;
   }
 
+  // Slow path of `at`: finds the block that contains `address`,
+  // swapping it in or creating it if needed, and stores its index into `hint`.
+  std::uint32_t &resolve( std::uint32_t address, std::size_t &hint ) noexcept;
+
   /**
    * This is our algorithm that selects a block to overwrite.
    * It does 3 things:
-   *   1. Sort the block list by their `access_count` in descending order.
+   *   1. Sort the block list by their `access_count` in descending order,
+   *      pinned blocks are always placed before the others.
    *      This means that the most accessed block is also the first.
    *   2. Resets the `access_count`.
    *      This means that every block can be selected for the next substitution.
@@ -124,8 +194,23 @@ private:
    **/
   Block &least_accessed() noexcept;
 
+  // Returns the resident block starting at `base_address`, making room for it if needed.
+  // A block that wasn't resident has an unspecified content, a swapped one is discarded.
+  Block &claim( std::uint32_t base_address ) noexcept;
+
+  // Returns the word used to fill a new block starting at `base_address`.
+  std::uint32_t fill_word( std::uint32_t base_address ) const noexcept
+  {
+    return zero_begin <= base_address && base_address < zero_end ? 0 : sigrie;
+  }
+
   std::uint32_t             alloc_limit; // Maximum number of allocable blocks.
   std::vector<Block>        blocks;      // Block list.
   std::vector<SwappedBlock> swapped;     // Swapped block list.
+
+  std::uint32_t zero_begin{ 0 }; // Zero filled range, see `zero_fill`.
+  std::uint32_t zero_end{ 0 };
+
+  std::size_t last_block{ 0 }; // Hint of operator[], see `at`.
 };
 } // namespace mips32
\ No newline at end of file
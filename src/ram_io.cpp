@@ -1,4 +1,5 @@
 #include "ram_io.hpp"
+#include "string_scan.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -39,14 +40,23 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
 {
   std::vector<char> seq_buf; // buffer of our sequence
 
+  read( address, count, read_string, seq_buf );
+
+  return seq_buf;
+}
+
+void RAMIO::read( std::uint32_t address, std::uint32_t count, bool read_string, std::vector<char> &seq_buf ) const noexcept
+{
+  seq_buf.clear();
+
   // only valid memory regions (checked only if we are not reading a string)
   if ( !read_string && ( count == 0 || address + count < address ) )
-    return seq_buf;
+    return;
 
   auto[index, in_memory] = get_block( address );
 
   if ( index == -1 ) // [3]
-    return seq_buf;
+    return;
 
   RAM::Block *block = nullptr;
   RAM::Block tmp;
@@ -81,22 +91,13 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
     char * start = (char*)block->data.get() + begin;
     char * end = start + size;
 
-    if ( read_string )
-    {
-      while ( start != end )
-      {
-        seq_buf.emplace_back( *start );
-        if ( *start == '\0' )
-        {
-          return seq_buf;
-        }
-        ++start;
-      }
-    }
-    else
-    {
-      std::copy( start, end, std::back_inserter( seq_buf ) );
-    }
+    // A string stops at its terminator (included), the whole run is copied at once
+    char * terminator = read_string ? find_terminator( start, size ) : nullptr;
+
+    seq_buf.insert( seq_buf.end(), start, terminator ? terminator + 1 : end );
+
+    if ( terminator )
+      return;
 
     auto _new_length = seq_buf.size();
 
@@ -114,8 +115,6 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
       in_memory = _in_memory;
     }
   }
-
-  return seq_buf;
 }
 
 /**
@@ -146,8 +145,8 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
  **/
 void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count ) noexcept
 {
-  // only valid memory region can be used
-  if ( address + count < address )
+  // only valid memory region can be used, it may end at the end of the address space
+  if ( count && address + ( count - 1 ) < address )
     return;
 
   std::uint32_t byte_written = 0;
@@ -167,7 +166,7 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
       char * dst = ( char* )block.data.get() + begin;
       char * _src = ( char* )src + byte_written;
 
-      std::copy( ( char* )_src, ( char* )_src + size, dst );
+      std::memcpy( dst, _src, size );
 
       byte_written += size;
       count -= size;
@@ -213,7 +212,7 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
 
       block.base_address = RAM::calculate_base_address( address );
 
-      block.allocate();
+      block.allocate( ram.fill_word( block.base_address ) );
       assert( block.data && "Couldn't allocate block!" );
 
       // If we can push the new block directly into memory, we add it to the allocated blocks
@@ -236,6 +235,143 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
   }
 }
 
+std::uint32_t RAMIO::read_into( std::uint32_t address, void *dst, std::uint32_t count ) const noexcept
+{
+  std::uint32_t byte_read = 0;
+
+  while ( count )
+  {
+    auto[index, in_memory] = get_block( address );
+
+    if ( index == -1 )
+      break;
+
+    std::uint32_t base  = in_memory ? ram.blocks[index].base_address : ram.swapped[index].base_address;
+    std::uint32_t begin = address - base;
+    std::uint32_t size  = std::min( count, RAM::block_size - begin );
+
+    char *_dst = ( char* )dst + byte_read;
+
+    if ( in_memory )
+    {
+      std::memcpy( _dst, ( char* )ram.blocks[index].data.get() + begin, size );
+    }
+    else
+    {
+      char file_name[18]{ '\0' };
+      std::sprintf( file_name, "0x%08X.block", base );
+
+      std::FILE *block_file = std::fopen( file_name, "rb" );
+      if ( !block_file )
+        break;
+
+      bool error = std::fseek( block_file, begin, SEEK_SET ) || std::fread( _dst, 1, size, block_file ) != size;
+      std::fclose( block_file );
+
+      if ( error )
+        break;
+    }
+
+    byte_read += size;
+    count -= size;
+    address += size;
+
+    // The address overflowed
+    if ( address == 0 )
+      break;
+  }
+
+  return byte_read;
+}
+
+bool RAMIO::regions( std::uint32_t address, std::uint32_t count, std::vector<IOVec> &regions ) const noexcept
+{
+  regions.clear();
+
+  // only valid memory regions, they may end at the end of the address space
+  if ( count == 0 || address + ( count - 1 ) < address )
+    return true;
+
+  while ( count )
+  {
+    auto[index, in_memory] = get_block( address );
+
+    if ( !in_memory )
+      return true;
+
+    auto &block = ram.blocks[index];
+
+    std::uint32_t begin = address - block.base_address;
+    std::uint32_t size  = std::min( count, RAM::block_size - begin );
+
+    regions.push_back( { ( char* )block.data.get() + begin, size } );
+
+    count -= size;
+    address += size;
+  }
+
+  return false;
+}
+
+bool RAMIO::string_regions( std::uint32_t address, std::vector<IOVec> &regions ) const noexcept
+{
+  regions.clear();
+
+  for ( ;; )
+  {
+    auto[index, in_memory] = get_block( address );
+
+    if ( !in_memory )
+      return true;
+
+    auto &block = ram.blocks[index];
+
+    std::uint32_t begin = address - block.base_address;
+    std::uint32_t size  = RAM::block_size - begin;
+
+    char *start = ( char* )block.data.get() + begin;
+    char *end   = find_terminator( start, size );
+
+    if ( end )
+    {
+      regions.push_back( { start, std::uint32_t( end - start ) } );
+      return false;
+    }
+
+    regions.push_back( { start, size } );
+
+    address += size;
+
+    // The string reaches the end of the address space without a terminator
+    if ( address == 0 )
+      return true;
+  }
+}
+
+void RAMIO::pin( std::uint32_t address, std::uint32_t count ) noexcept
+{
+  if ( count == 0 )
+    return;
+
+  for ( auto &block : ram.blocks )
+  {
+    if ( block.base_address + RAM::block_size - 1 >= address && block.base_address <= address + ( count - 1 ) )
+      ++block.pin_count;
+  }
+}
+
+void RAMIO::unpin( std::uint32_t address, std::uint32_t count ) noexcept
+{
+  if ( count == 0 )
+    return;
+
+  for ( auto &block : ram.blocks )
+  {
+    if ( block.pin_count && block.base_address + RAM::block_size - 1 >= address && block.base_address <= address + ( count - 1 ) )
+      --block.pin_count;
+  }
+}
+
 std::pair<std::uint32_t, bool> RAMIO::get_block( std::uint32_t address ) const noexcept
 {
   for ( auto i = 0u; i < ram.blocks.size(); ++i )
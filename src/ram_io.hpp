@@ -2,6 +2,8 @@
 
 #include "ram.hpp"
 
+#include <mips32/io_vec.hpp>
+
 #include <vector>
 #include <utility>
 
@@ -14,8 +16,42 @@ public:
 
   std::vector<char> read( std::uint32_t address, std::uint32_t count, bool read_string = false ) const noexcept;
 
+  // Same as above, but the sequence is stored into `seq_buf`, so its memory can be reused.
+  void read( std::uint32_t address, std::uint32_t count, bool read_string, std::vector<char> &seq_buf ) const noexcept;
+
   void write( std::uint32_t address, void const *src, std::uint32_t count ) noexcept;
 
+  // Copies up to `count` bytes starting at `address` into `dst`, one block at a time.
+  // Swapped blocks are read from disk without being loaded into memory.
+  // Stops at the first block that doesn't exist.
+  // Returns the number of bytes copied.
+  std::uint32_t read_into( std::uint32_t address, void *dst, std::uint32_t count ) const noexcept;
+
+  // Describes [address, address + count) with one region per block, pointing directly inside the blocks.
+  // Returns:
+  // `true`  - if at least one block isn't resident in memory, `regions` is unspecified
+  // `false` - in case of success
+  bool regions( std::uint32_t address, std::uint32_t count, std::vector<IOVec> &regions ) const noexcept;
+
+  // Describes the null terminated string at `address` with one region per block, the terminator is excluded.
+  // The terminator, inside the last block, follows immediately the last region.
+  // Returns:
+  // `true`  - if at least one block isn't resident in memory, `regions` is unspecified
+  // `false` - in case of success
+  bool string_regions( std::uint32_t address, std::vector<IOVec> &regions ) const noexcept;
+
+  // Pins the resident blocks in [address, address + count), so they can't be swapped on disk.
+  void pin( std::uint32_t address, std::uint32_t count ) noexcept;
+
+  // Reverts `pin`.
+  void unpin( std::uint32_t address, std::uint32_t count ) noexcept;
+
+  // See `RAM::map_file`.
+  bool map_file( std::uint32_t address, MappedFile &&file ) noexcept
+  {
+    return ram.map_file( address, std::move( file ) );
+  }
+
 private:
   std::pair<std::uint32_t, bool> get_block( std::uint32_t address ) const noexcept;
 
@@ -0,0 +1,1152 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// The error-free transformations of the fast path must not be fused
+#ifdef _MSC_VER
+#pragma fp_contract( off )
+#else
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace mips32
+{
+/**
+ * IEEE 754 arithmetic on the encoding of binary32 and binary64, see `FPUBackend::SOFT`.
+ *
+ * Every operation is computed with integer arithmetic, so the results and the exceptions
+ * don't depend on the host FPU, its state or the build flags.
+ * It follows the MIPS NaN2008 semantics:
+ * - the default NaN is positive, with only the quiet bit set in the fraction
+ * - a signaling NaN operand is quieted and propagated, the first one wins
+ * - otherwise the first quiet NaN operand is propagated
+ * Tininess is detected after rounding.
+ *
+ * Round to nearest has a fast path on the host FPU: when the operands are far from
+ * the overflow and underflow thresholds, the host's result is already correctly rounded
+ * and an error-free transformation tells if it's inexact.
+ * It expects the host FPU to round to nearest.
+ **/
+namespace soft_float
+{
+// Same encoding of FCSR.RM
+enum Round : std::uint32_t
+{
+  NEAREST = 0x0,
+  ZERO = 0x1,
+  UP = 0x2,
+  DOWN = 0x3,
+};
+
+// Same encoding of FCSR's Cause, Enable and Flags fields
+enum Flag : std::uint32_t
+{
+  INEXACT = 0x01,
+  UNDERFLOW_ = 0x02,
+  OVERFLOW_ = 0x04,
+  DIVBYZERO = 0x08,
+  INVALID = 0x10,
+};
+
+struct Env
+{
+  std::uint32_t round;  // see `Round`
+  bool          flush;  // subnormal operands and results are flushed to zero, FCSR.FS
+  std::uint32_t flags;  // raised by the operations, see `Flag`
+};
+
+template<typename Bits, typename Float, int ExpBits, int FracBits, int FastWindow>
+struct Format
+{
+  using bits = Bits;
+  using value = Float;
+
+  static constexpr int exp_bits = ExpBits;
+  static constexpr int frac_bits = FracBits;
+
+  static constexpr int bias = ( 1 << ( ExpBits - 1 ) ) - 1;
+  static constexpr int max_exp = ( 1 << ExpBits ) - 1; // Infinity and NaN
+
+  // The significands are kept in 64 bits, with the implicit bit at bit 62
+  static constexpr int shift = 62 - FracBits;
+
+  static constexpr Bits sign_mask = Bits( 1 ) << ( ExpBits + FracBits );
+  static constexpr Bits frac_mask = ( Bits( 1 ) << FracBits ) - 1;
+  static constexpr Bits quiet_bit = Bits( 1 ) << ( FracBits - 1 );
+  static constexpr Bits default_nan = Bits( max_exp ) << FracBits | quiet_bit;
+  static constexpr Bits one = Bits( bias ) << FracBits;
+
+  // The fast path takes the operands whose unbiased exponent is in [-FastWindow, FastWindow]
+  static constexpr int fast_window = FastWindow;
+};
+
+using Binary32 = Format<std::uint32_t, float, 8, 23, 60>;
+using Binary64 = Format<std::uint64_t, double, 11, 52, 400>;
+
+namespace detail
+{
+inline int count_leading_zeros( std::uint64_t a ) noexcept
+{
+  int n = 0;
+
+  if ( !( a >> 32 ) ) { n += 32; a <<= 32; }
+  if ( !( a >> 48 ) ) { n += 16; a <<= 16; }
+  if ( !( a >> 56 ) ) { n += 8; a <<= 8; }
+  if ( !( a >> 60 ) ) { n += 4; a <<= 4; }
+  if ( !( a >> 62 ) ) { n += 2; a <<= 2; }
+  if ( !( a >> 63 ) ) { n += 1; }
+
+  return n;
+}
+
+// Shifts right, every bit shifted out is OR'd into the lowest one
+inline std::uint64_t shift_right_jam( std::uint64_t a, int dist ) noexcept
+{
+  if ( dist <= 0 ) return a;
+  if ( dist >= 63 ) return a != 0;
+
+  return a >> dist | ( ( a << ( 64 - dist ) ) != 0 );
+}
+
+struct U128
+{
+  std::uint64_t hi, lo;
+};
+
+inline U128 multiply( std::uint64_t a, std::uint64_t b ) noexcept
+{
+  std::uint64_t const a0 = a & 0xFFFF'FFFF, a1 = a >> 32;
+  std::uint64_t const b0 = b & 0xFFFF'FFFF, b1 = b >> 32;
+
+  std::uint64_t const p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  std::uint64_t const mid = ( p00 >> 32 ) + ( p01 & 0xFFFF'FFFF ) + ( p10 & 0xFFFF'FFFF );
+
+  return { p11 + ( p01 >> 32 ) + ( p10 >> 32 ) + ( mid >> 32 ), mid << 32 | ( p00 & 0xFFFF'FFFF ) };
+}
+
+inline U128 shift_left( U128 a, int dist ) noexcept
+{
+  if ( dist <= 0 ) return a;
+  if ( dist >= 64 ) return { a.lo << ( dist - 64 ), 0 };
+
+  return { a.hi << dist | a.lo >> ( 64 - dist ), a.lo << dist };
+}
+
+inline U128 shift_right_jam( U128 a, int dist ) noexcept
+{
+  if ( dist <= 0 ) return a;
+  if ( dist >= 127 ) return { 0, ( a.hi | a.lo ) != 0 };
+
+  if ( dist >= 64 )
+  {
+    auto const sticky = a.lo != 0 || ( dist > 64 && ( a.hi << ( 128 - dist ) ) != 0 );
+    return { 0, a.hi >> ( dist - 64 ) | sticky };
+  }
+
+  auto const sticky = ( a.lo << ( 64 - dist ) ) != 0;
+  return { a.hi >> dist, ( a.hi << ( 64 - dist ) | a.lo >> dist ) | sticky };
+}
+
+inline U128 add( U128 a, U128 b ) noexcept
+{
+  auto const lo = a.lo + b.lo;
+  return { a.hi + b.hi + ( lo < a.lo ), lo };
+}
+
+inline U128 subtract( U128 a, U128 b ) noexcept
+{
+  return { a.hi - b.hi - ( a.lo < b.lo ), a.lo - b.lo };
+}
+
+inline bool less( U128 a, U128 b ) noexcept
+{
+  return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+}
+
+inline int count_leading_zeros( U128 a ) noexcept
+{
+  return a.hi ? count_leading_zeros( a.hi ) : 64 + count_leading_zeros( a.lo );
+}
+
+template<typename F>
+constexpr typename F::bits pack( bool sign, int exp, std::uint64_t sig ) noexcept
+{
+  using Bits = typename F::bits;
+  return ( sign ? F::sign_mask : Bits( 0 ) ) + ( Bits( exp ) << F::frac_bits ) + Bits( sig );
+}
+
+template<typename F> constexpr bool sign_of( typename F::bits a ) noexcept { return ( a & F::sign_mask ) != 0; }
+template<typename F> constexpr int exp_of( typename F::bits a ) noexcept { return int( a >> F::frac_bits ) & F::max_exp; }
+template<typename F> constexpr std::uint64_t frac_of( typename F::bits a ) noexcept { return a & F::frac_mask; }
+
+template<typename F>
+constexpr bool is_nan( typename F::bits a ) noexcept
+{
+  return exp_of<F>( a ) == F::max_exp && frac_of<F>( a );
+}
+
+template<typename F>
+constexpr bool is_signaling( typename F::bits a ) noexcept
+{
+  return is_nan<F>( a ) && !( a & F::quiet_bit );
+}
+
+template<typename F>
+typename F::bits flush_operand( Env const &env, typename F::bits a ) noexcept
+{
+  if ( env.flush && !exp_of<F>( a ) )
+    return a & F::sign_mask;
+
+  return a;
+}
+
+// Normalizes the fraction of a subnormal, the implicit bit ends up at `frac_bits`
+template<typename F>
+void normalize( int &exp, std::uint64_t &sig ) noexcept
+{
+  auto const dist = count_leading_zeros( sig ) - ( 63 - F::frac_bits );
+  exp = 1 - dist;
+  sig <<= dist;
+}
+
+template<typename F>
+typename F::bits propagate_nan( Env &env, typename F::bits a ) noexcept
+{
+  if ( is_signaling<F>( a ) ) env.flags |= INVALID;
+  return a | F::quiet_bit;
+}
+
+template<typename F>
+typename F::bits propagate_nan( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  auto const signaling_a = is_signaling<F>( a ), signaling_b = is_signaling<F>( b );
+
+  if ( signaling_a || signaling_b ) env.flags |= INVALID;
+
+  if ( signaling_a ) return a | F::quiet_bit;
+  if ( signaling_b ) return b | F::quiet_bit;
+
+  return ( is_nan<F>( a ) ? a : b ) | F::quiet_bit;
+}
+
+template<typename F>
+typename F::bits invalid( Env &env ) noexcept
+{
+  env.flags |= INVALID;
+  return F::default_nan;
+}
+
+/**
+ * `exp` is the biased exponent minus 1, `sig` has the implicit bit at bit 62 (or 63 after a carry)
+ * and everything below the format's precision, the lowest bit is sticky.
+ **/
+template<typename F>
+typename F::bits round_pack( Env &env, bool sign, int exp, std::uint64_t sig ) noexcept
+{
+  constexpr std::uint64_t mask = ( std::uint64_t( 1 ) << F::shift ) - 1;
+  constexpr std::uint64_t half = std::uint64_t( 1 ) << ( F::shift - 1 );
+
+  std::uint64_t increment = half;
+
+  if ( env.round != NEAREST )
+    increment = env.round == ( sign ? DOWN : UP ) ? mask : 0;
+
+  auto round_bits = sig & mask;
+
+  if ( unsigned( exp ) >= unsigned( F::max_exp - 2 ) )
+  {
+    if ( exp < 0 )
+    {
+      auto const tiny = exp < -1 || sig + increment < 0x8000'0000'0000'0000;
+
+      if ( tiny && env.flush )
+      {
+        env.flags |= UNDERFLOW_ | INEXACT;
+        return pack<F>( sign, 0, 0 );
+      }
+
+      sig = shift_right_jam( sig, -exp );
+      exp = 0;
+      round_bits = sig & mask;
+
+      if ( tiny && round_bits ) env.flags |= UNDERFLOW_;
+    }
+    else if ( exp > F::max_exp - 2 || sig + increment >= 0x8000'0000'0000'0000 )
+    {
+      env.flags |= OVERFLOW_ | INEXACT;
+
+      // Infinity, or the largest finite number when rounding towards it
+      return pack<F>( sign, F::max_exp, 0 ) - !increment;
+    }
+  }
+
+  if ( round_bits ) env.flags |= INEXACT;
+
+  sig = ( sig + increment ) >> F::shift;
+
+  // Ties to even
+  if ( env.round == NEAREST && round_bits == half ) sig &= ~std::uint64_t( 1 );
+
+  if ( !sig ) exp = 0;
+
+  return pack<F>( sign, exp, sig );
+}
+
+template<typename F>
+typename F::bits norm_round_pack( Env &env, bool sign, int exp, std::uint64_t sig ) noexcept
+{
+  auto const dist = count_leading_zeros( sig ) - 1;
+  return round_pack<F>( env, sign, exp - dist, sig << dist );
+}
+
+template<typename F>
+typename F::bits add_magnitudes( Env &env, typename F::bits a, typename F::bits b, bool sign ) noexcept
+{
+  constexpr std::uint64_t implicit = std::uint64_t( 1 ) << 61;
+
+  auto exp_a = exp_of<F>( a ), exp_b = exp_of<F>( b );
+  auto sig_a = frac_of<F>( a ), sig_b = frac_of<F>( b );
+
+  auto const diff = exp_a - exp_b;
+
+  int exp;
+  std::uint64_t sig;
+
+  if ( !diff )
+  {
+    // Subnormals add exactly, a carry makes a normal number
+    if ( !exp_a ) return a + typename F::bits( sig_b );
+    if ( exp_a == F::max_exp ) return a;
+
+    exp = exp_a;
+    sig = ( ( std::uint64_t( 2 ) << F::frac_bits ) + sig_a + sig_b ) << ( F::shift - 1 );
+  }
+  else
+  {
+    sig_a <<= F::shift - 1;
+    sig_b <<= F::shift - 1;
+
+    if ( diff < 0 )
+    {
+      if ( exp_b == F::max_exp ) return pack<F>( sign, F::max_exp, 0 );
+
+      exp = exp_b;
+      sig_a = shift_right_jam( exp_a ? sig_a + implicit : sig_a << 1, -diff );
+    }
+    else
+    {
+      if ( exp_a == F::max_exp ) return a;
+
+      exp = exp_a;
+      sig_b = shift_right_jam( exp_b ? sig_b + implicit : sig_b << 1, diff );
+    }
+
+    sig = implicit + sig_a + sig_b;
+
+    if ( sig < 2 * implicit )
+    {
+      --exp;
+      sig <<= 1;
+    }
+  }
+
+  return round_pack<F>( env, sign, exp, sig );
+}
+
+template<typename F>
+typename F::bits subtract_magnitudes( Env &env, typename F::bits a, typename F::bits b, bool sign ) noexcept
+{
+  constexpr std::uint64_t implicit = std::uint64_t( 1 ) << 62;
+
+  auto exp_a = exp_of<F>( a ), exp_b = exp_of<F>( b );
+  auto sig_a = frac_of<F>( a ), sig_b = frac_of<F>( b );
+
+  auto const diff = exp_a - exp_b;
+
+  if ( !diff )
+  {
+    if ( exp_a == F::max_exp ) return invalid<F>( env ); // Infinity - Infinity
+
+    auto difference = std::int64_t( sig_a ) - std::int64_t( sig_b );
+
+    if ( !difference ) return pack<F>( env.round == DOWN, 0, 0 );
+
+    if ( exp_a ) --exp_a;
+
+    if ( difference < 0 )
+    {
+      sign = !sign;
+      difference = -difference;
+    }
+
+    // Exact, it can't be rounded
+    auto dist = count_leading_zeros( std::uint64_t( difference ) ) - ( 63 - F::frac_bits );
+    auto exp = exp_a - dist;
+
+    if ( exp < 0 )
+    {
+      dist = exp_a;
+      exp = 0;
+    }
+
+    if ( !exp && env.flush && !( std::uint64_t( difference ) << dist >> F::frac_bits ) )
+    {
+      env.flags |= UNDERFLOW_ | INEXACT;
+      return pack<F>( sign, 0, 0 );
+    }
+
+    return pack<F>( sign, exp, std::uint64_t( difference ) << dist );
+  }
+
+  sig_a <<= F::shift;
+  sig_b <<= F::shift;
+
+  int exp;
+  std::uint64_t sig;
+
+  if ( diff < 0 )
+  {
+    sign = !sign;
+
+    if ( exp_b == F::max_exp ) return pack<F>( sign, F::max_exp, 0 );
+
+    sig_a = shift_right_jam( exp_a ? sig_a + implicit : sig_a << 1, -diff );
+
+    exp = exp_b;
+    sig = ( sig_b | implicit ) - sig_a;
+  }
+  else
+  {
+    if ( exp_a == F::max_exp ) return a;
+
+    sig_b = shift_right_jam( exp_b ? sig_b + implicit : sig_b << 1, diff );
+
+    exp = exp_a;
+    sig = ( sig_a | implicit ) - sig_b;
+  }
+
+  return norm_round_pack<F>( env, sign, exp - 1, sig );
+}
+
+/**
+ * Fast path helpers, valid only for round to nearest.
+ *
+ * Knuth's TwoSum and Dekker's product give the exact error of the host's operation,
+ * that's 0 only if the result is exact.
+ **/
+
+template<typename F>
+bool in_fast_window( typename F::bits a ) noexcept
+{
+  auto const exp = exp_of<F>( a ) - F::bias;
+  return exp >= -F::fast_window && exp <= F::fast_window;
+}
+
+template<typename F>
+typename F::value to_value( typename F::bits a ) noexcept
+{
+  typename F::value v;
+  std::memcpy( &v, &a, sizeof( v ) );
+  return v;
+}
+
+template<typename F>
+typename F::bits to_bits( typename F::value v ) noexcept
+{
+  typename F::bits a;
+  std::memcpy( &a, &v, sizeof( a ) );
+  return a;
+}
+
+template<typename T>
+bool sum_is_inexact( T a, T b, T sum ) noexcept
+{
+  T const b_virtual = sum - a;
+  T const a_virtual = sum - b_virtual;
+  return ( a - a_virtual ) + ( b - b_virtual ) != 0;
+}
+
+// Veltkamp's splitting, a == hi + lo with half the precision each
+inline void split( double a, double &hi, double &lo ) noexcept
+{
+  double const t = 134'217'729.0 * a; // 2^27 + 1
+  hi = t - ( t - a );
+  lo = a - hi;
+}
+
+// a * b == hi + lo, exactly
+inline void product( double a, double b, double &hi, double &lo ) noexcept
+{
+  double a_hi, a_lo, b_hi, b_lo;
+
+  split( a, a_hi, a_lo );
+  split( b, b_hi, b_lo );
+
+  hi = a * b;
+  lo = ( ( a_hi * b_hi - hi ) + a_hi * b_lo + a_lo * b_hi ) + a_lo * b_lo;
+}
+
+// The smaller or the larger of two operands, -0 is smaller than +0.
+// A quiet NaN loses against a number, a signaling NaN is an invalid operation.
+template<typename F>
+typename F::bits select( Env &env, typename F::bits a, typename F::bits b, bool larger ) noexcept
+{
+  if ( is_signaling<F>( a ) || is_signaling<F>( b ) ) return propagate_nan<F>( env, a, b );
+
+  if ( is_nan<F>( a ) ) return b;
+  if ( is_nan<F>( b ) ) return a;
+
+  bool less;
+
+  if ( sign_of<F>( a ) != sign_of<F>( b ) )
+    less = sign_of<F>( a );
+  else
+    less = sign_of<F>( a ) ? a > b : a < b;
+
+  return less != larger ? a : b;
+}
+} // namespace detail
+
+template<typename F>
+typename F::bits add( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<F>( env, a );
+  b = flush_operand<F>( env, b );
+
+  if ( env.round == NEAREST && in_fast_window<F>( a ) && in_fast_window<F>( b ) )
+  {
+    auto const x = to_value<F>( a ), y = to_value<F>( b );
+    auto const sum = x + y;
+
+    if ( sum_is_inexact( x, y, sum ) ) env.flags |= INEXACT;
+
+    return to_bits<F>( sum );
+  }
+
+  if ( is_nan<F>( a ) || is_nan<F>( b ) ) return propagate_nan<F>( env, a, b );
+
+  auto const sign = sign_of<F>( a );
+
+  if ( sign == sign_of<F>( b ) )
+    return add_magnitudes<F>( env, a, b, sign );
+  else
+    return subtract_magnitudes<F>( env, a, b, sign );
+}
+
+template<typename F>
+typename F::bits sub( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  if ( detail::is_nan<F>( a ) || detail::is_nan<F>( b ) ) return detail::propagate_nan<F>( env, a, b );
+
+  return add<F>( env, a, b ^ F::sign_mask );
+}
+
+template<typename F>
+typename F::bits mul( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<F>( env, a );
+  b = flush_operand<F>( env, b );
+
+  if ( env.round == NEAREST && in_fast_window<F>( a ) && in_fast_window<F>( b ) )
+  {
+    auto const x = to_value<F>( a ), y = to_value<F>( b );
+
+    if constexpr ( std::is_same_v<typename F::value, float> )
+    {
+      // Exact in double, rounded once
+      double const exact = double( x ) * double( y );
+      float const res = float( exact );
+
+      if ( double( res ) != exact ) env.flags |= INEXACT;
+      return to_bits<F>( res );
+    }
+    else
+    {
+      double hi, lo;
+      product( x, y, hi, lo );
+
+      if ( lo != 0 ) env.flags |= INEXACT;
+      return to_bits<F>( hi );
+    }
+  }
+
+  if ( is_nan<F>( a ) || is_nan<F>( b ) ) return propagate_nan<F>( env, a, b );
+
+  auto const sign = sign_of<F>( a ) != sign_of<F>( b );
+
+  auto exp_a = exp_of<F>( a ), exp_b = exp_of<F>( b );
+  auto sig_a = frac_of<F>( a ), sig_b = frac_of<F>( b );
+
+  if ( exp_a == F::max_exp || exp_b == F::max_exp )
+  {
+    // Infinity * 0
+    if ( ( !exp_a && !sig_a ) || ( !exp_b && !sig_b ) ) return invalid<F>( env );
+
+    return pack<F>( sign, F::max_exp, 0 );
+  }
+
+  if ( ( !exp_a && !sig_a ) || ( !exp_b && !sig_b ) ) return pack<F>( sign, 0, 0 );
+
+  if ( !exp_a ) normalize<F>( exp_a, sig_a );
+  if ( !exp_b ) normalize<F>( exp_b, sig_b );
+
+  constexpr std::uint64_t implicit = std::uint64_t( 1 ) << F::frac_bits;
+
+  auto const product = multiply( ( sig_a | implicit ) << F::shift, ( sig_b | implicit ) << ( F::shift + 1 ) );
+
+  auto exp = exp_a + exp_b - F::bias;
+  auto sig = product.hi | ( product.lo != 0 );
+
+  if ( sig < ( std::uint64_t( 1 ) << 62 ) )
+  {
+    --exp;
+    sig <<= 1;
+  }
+
+  return round_pack<F>( env, sign, exp, sig );
+}
+
+template<typename F>
+typename F::bits div( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<F>( env, a );
+  b = flush_operand<F>( env, b );
+
+  if ( env.round == NEAREST && in_fast_window<F>( a ) && in_fast_window<F>( b ) )
+  {
+    auto const x = to_value<F>( a ), y = to_value<F>( b );
+
+    if constexpr ( std::is_same_v<typename F::value, float> )
+    {
+      // double has more than 2p + 2 bits, rounding twice gives the correctly rounded quotient
+      float const res = float( double( x ) / double( y ) );
+
+      if ( double( res ) * double( y ) != double( x ) ) env.flags |= INEXACT;
+      return to_bits<F>( res );
+    }
+    else
+    {
+      double const res = x / y;
+
+      // The remainder x - res * y is exact
+      double hi, lo;
+      product( res, y, hi, lo );
+
+      if ( x - hi != lo ) env.flags |= INEXACT;
+      return to_bits<F>( res );
+    }
+  }
+
+  if ( is_nan<F>( a ) || is_nan<F>( b ) ) return propagate_nan<F>( env, a, b );
+
+  auto const sign = sign_of<F>( a ) != sign_of<F>( b );
+
+  auto exp_a = exp_of<F>( a ), exp_b = exp_of<F>( b );
+  auto sig_a = frac_of<F>( a ), sig_b = frac_of<F>( b );
+
+  if ( exp_a == F::max_exp )
+  {
+    if ( exp_b == F::max_exp ) return invalid<F>( env );
+    return pack<F>( sign, F::max_exp, 0 );
+  }
+
+  if ( exp_b == F::max_exp ) return pack<F>( sign, 0, 0 );
+
+  if ( !exp_b && !sig_b )
+  {
+    if ( !exp_a && !sig_a ) return invalid<F>( env );
+
+    env.flags |= DIVBYZERO;
+    return pack<F>( sign, F::max_exp, 0 );
+  }
+
+  if ( !exp_a && !sig_a ) return pack<F>( sign, 0, 0 );
+
+  if ( !exp_a ) normalize<F>( exp_a, sig_a );
+  if ( !exp_b ) normalize<F>( exp_b, sig_b );
+
+  constexpr std::uint64_t implicit = std::uint64_t( 1 ) << F::frac_bits;
+
+  auto remainder = sig_a | implicit;
+  auto const divisor = sig_b | implicit;
+
+  auto exp = exp_a - exp_b + F::bias - 1;
+
+  if ( remainder < divisor )
+  {
+    --exp;
+    remainder <<= 1;
+  }
+
+  // Long division, the quotient's leading bit ends up at bit 62
+  std::uint64_t quotient = 0;
+
+  for ( int i = 0; i < 63; ++i )
+  {
+    quotient <<= 1;
+
+    if ( remainder >= divisor )
+    {
+      remainder -= divisor;
+      quotient |= 1;
+    }
+
+    remainder <<= 1;
+  }
+
+  return round_pack<F>( env, sign, exp, quotient | ( remainder != 0 ) );
+}
+
+template<typename F>
+typename F::bits sqrt( Env &env, typename F::bits a ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<F>( env, a );
+
+  if ( env.round == NEAREST && !sign_of<F>( a ) && in_fast_window<F>( a ) )
+  {
+    auto const x = to_value<F>( a );
+
+    if constexpr ( std::is_same_v<typename F::value, float> )
+    {
+      double const root = std::sqrt( double( x ) );
+      float const res = float( root );
+
+      if ( double( res ) * double( res ) != double( x ) ) env.flags |= INEXACT;
+      return to_bits<F>( res );
+    }
+    else
+    {
+      double const res = std::sqrt( x );
+
+      double hi, lo;
+      product( res, res, hi, lo );
+
+      if ( hi != x || lo != 0 ) env.flags |= INEXACT;
+      return to_bits<F>( res );
+    }
+  }
+
+  if ( is_nan<F>( a ) ) return propagate_nan<F>( env, a );
+
+  auto exp_a = exp_of<F>( a );
+  auto sig_a = frac_of<F>( a );
+
+  if ( !exp_a && !sig_a ) return a; // sqrt(-0) is -0
+
+  if ( sign_of<F>( a ) ) return invalid<F>( env );
+
+  if ( exp_a == F::max_exp ) return a;
+
+  if ( !exp_a ) normalize<F>( exp_a, sig_a );
+
+  auto exp = exp_a - F::bias;
+  auto sig = sig_a | std::uint64_t( 1 ) << F::frac_bits;
+
+  // With an even exponent the root's exponent is exact
+  if ( exp & 1 )
+  {
+    sig <<= 1;
+    --exp;
+  }
+
+  /**
+   * Digit by digit square root of `sig << ( 2 * precision - frac_bits )`,
+   * it gives a root of `precision + 1` bits: 2 more than needed, the remainder is sticky.
+   **/
+  constexpr int precision = F::frac_bits + 2;
+  constexpr int radicand_shift = 2 * precision - F::frac_bits;
+
+  std::uint64_t root = 0, remainder = 0;
+
+  for ( int i = precision; i >= 0; --i )
+  {
+    auto const low = 2 * i - radicand_shift;
+    auto const digits = low >= 0 ? ( sig >> low ) & 3 : low == -1 ? ( sig << 1 ) & 3 : 0;
+
+    remainder = remainder << 2 | digits;
+
+    auto const trial = root << 2 | 1;
+    root <<= 1;
+
+    if ( remainder >= trial )
+    {
+      remainder -= trial;
+      root |= 1;
+    }
+  }
+
+  return round_pack<F>( env, false, exp / 2 + F::bias - 1, root << ( 62 - precision ) | ( remainder != 0 ) );
+}
+
+// a * b + c with a single rounding, the product is negated by `negate_product`
+template<typename F>
+typename F::bits fma( Env &env, typename F::bits a, typename F::bits b, typename F::bits c, bool negate_product = false ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<F>( env, a );
+  b = flush_operand<F>( env, b );
+  c = flush_operand<F>( env, c );
+
+  auto exp_a = exp_of<F>( a ), exp_b = exp_of<F>( b ), exp_c = exp_of<F>( c );
+  auto sig_a = frac_of<F>( a ), sig_b = frac_of<F>( b ), sig_c = frac_of<F>( c );
+
+  auto const zero_a = !exp_a && !sig_a, zero_b = !exp_b && !sig_b, zero_c = !exp_c && !sig_c;
+  auto const inf_a = exp_a == F::max_exp && !sig_a, inf_b = exp_b == F::max_exp && !sig_b;
+
+  auto const infinity_times_zero = ( inf_a && zero_b ) || ( zero_a && inf_b );
+
+  if ( is_nan<F>( a ) || is_nan<F>( b ) || is_nan<F>( c ) )
+  {
+    if ( infinity_times_zero ) env.flags |= INVALID;
+
+    // Signaling NaNs first, in the order c, a, b
+    auto const signaling_c = is_signaling<F>( c ), signaling_a = is_signaling<F>( a ), signaling_b = is_signaling<F>( b );
+
+    if ( signaling_c || signaling_a || signaling_b ) env.flags |= INVALID;
+
+    if ( signaling_c ) return c | F::quiet_bit;
+    if ( signaling_a ) return a | F::quiet_bit;
+    if ( signaling_b ) return b | F::quiet_bit;
+
+    return ( is_nan<F>( c ) ? c : is_nan<F>( a ) ? a : b ) | F::quiet_bit;
+  }
+
+  if ( infinity_times_zero ) return invalid<F>( env );
+
+  auto const sign_product = ( sign_of<F>( a ) != sign_of<F>( b ) ) != negate_product;
+  auto const sign_c = sign_of<F>( c );
+
+  if ( inf_a || inf_b )
+  {
+    if ( exp_c == F::max_exp && sign_c != sign_product ) return invalid<F>( env );
+    return pack<F>( sign_product, F::max_exp, 0 );
+  }
+
+  if ( exp_c == F::max_exp ) return c;
+
+  if ( zero_a || zero_b )
+  {
+    if ( zero_c ) return pack<F>( sign_product == sign_c ? sign_c : env.round == DOWN, 0, 0 );
+    return c;
+  }
+
+  if ( !exp_a ) normalize<F>( exp_a, sig_a );
+  if ( !exp_b ) normalize<F>( exp_b, sig_b );
+
+  constexpr std::uint64_t implicit = std::uint64_t( 1 ) << F::frac_bits;
+
+  // Both terms scaled so that 1.0 is at bit 124
+  auto product = shift_left( multiply( sig_a | implicit, sig_b | implicit ), 124 - 2 * F::frac_bits );
+  auto exp = exp_a + exp_b - 2 * F::bias;
+
+  U128 addend{ 0, 0 };
+
+  if ( !zero_c )
+  {
+    if ( !exp_c ) normalize<F>( exp_c, sig_c );
+
+    addend = shift_left( { 0, sig_c | implicit }, 124 - F::frac_bits );
+
+    auto const exp_addend = exp_c - F::bias;
+
+    if ( exp >= exp_addend )
+    {
+      addend = shift_right_jam( addend, exp - exp_addend );
+    }
+    else
+    {
+      product = shift_right_jam( product, exp_addend - exp );
+      exp = exp_addend;
+    }
+  }
+
+  U128 sum;
+  bool sign = sign_product;
+
+  if ( sign_product == sign_c )
+  {
+    sum = add( product, addend );
+  }
+  else if ( less( product, addend ) )
+  {
+    sum = subtract( addend, product );
+    sign = sign_c;
+  }
+  else
+  {
+    sum = subtract( product, addend );
+  }
+
+  if ( !sum.hi && !sum.lo ) return pack<F>( env.round == DOWN, 0, 0 );
+
+  auto const leading = 127 - count_leading_zeros( sum );
+
+  sum = shift_left( sum, 126 - leading );
+
+  return round_pack<F>( env, sign, exp + leading - 124 + F::bias - 1, sum.hi | ( sum.lo != 0 ) );
+}
+
+// Converts between formats, `To` is the destination
+template<typename From, typename To>
+typename To::bits convert( Env &env, typename From::bits a ) noexcept
+{
+  using namespace detail;
+
+  a = flush_operand<From>( env, a );
+
+  auto const sign = sign_of<From>( a );
+
+  auto exp = exp_of<From>( a );
+  auto sig = frac_of<From>( a );
+
+  if ( exp == From::max_exp )
+  {
+    if ( !sig ) return pack<To>( sign, To::max_exp, 0 );
+
+    if ( is_signaling<From>( a ) ) env.flags |= INVALID;
+
+    // The payload keeps its most significant bits
+    if constexpr ( To::frac_bits >= From::frac_bits )
+      sig <<= To::frac_bits - From::frac_bits;
+    else
+      sig >>= From::frac_bits - To::frac_bits;
+
+    return pack<To>( sign, To::max_exp, sig ) | To::quiet_bit;
+  }
+
+  if ( !exp && !sig ) return pack<To>( sign, 0, 0 );
+
+  if ( !exp ) normalize<From>( exp, sig );
+
+  sig |= std::uint64_t( 1 ) << From::frac_bits;
+
+  return round_pack<To>( env, sign, exp - From::bias + To::bias - 1, sig << From::shift );
+}
+
+// Converts a signed integer, rounding it if needed
+template<typename F>
+typename F::bits from_int( Env &env, std::int64_t i ) noexcept
+{
+  using namespace detail;
+
+  if ( !i ) return 0;
+
+  auto const sign = i < 0;
+  auto magnitude = sign ? 0 - std::uint64_t( i ) : std::uint64_t( i );
+
+  auto const leading = 63 - count_leading_zeros( magnitude );
+
+  if ( leading > 62 )
+    magnitude = shift_right_jam( magnitude, leading - 62 );
+  else
+    magnitude <<= 62 - leading;
+
+  return round_pack<F>( env, sign, leading + F::bias - 1, magnitude );
+}
+
+/**
+ * Converts to a signed integer of `Width` bits, rounding it with `round`.
+ *
+ * NaN2008: a NaN converts to 0, out of range values saturate.
+ * Both raise the invalid exception.
+ **/
+template<typename F, int Width>
+std::uint64_t to_int( Env &env, typename F::bits a, std::uint32_t round ) noexcept
+{
+  using namespace detail;
+
+  static_assert( Width == 32 || Width == 64, "Invalid integer width!" );
+
+  constexpr std::uint64_t max_positive = ( std::uint64_t( 1 ) << ( Width - 1 ) ) - 1;
+  constexpr std::uint64_t mask = Width == 64 ? ~std::uint64_t( 0 ) : ( std::uint64_t( 1 ) << Width ) - 1;
+
+  a = flush_operand<F>( env, a );
+
+  auto const sign = sign_of<F>( a );
+
+  auto const saturate = [&env, sign]
+  {
+    env.flags |= INVALID;
+    return ( sign ? max_positive + 1 : max_positive ) & mask;
+  };
+
+  if ( is_nan<F>( a ) )
+  {
+    env.flags |= INVALID;
+    return 0;
+  }
+
+  auto const exp = exp_of<F>( a );
+  auto sig = frac_of<F>( a );
+
+  if ( exp == F::max_exp ) return saturate();
+
+  if ( !exp && !sig ) return 0;
+
+  int unbiased;
+
+  if ( exp )
+  {
+    sig |= std::uint64_t( 1 ) << F::frac_bits;
+    unbiased = exp - F::bias;
+  }
+  else
+  {
+    unbiased = 1 - F::bias;
+  }
+
+  // sig * 2^( unbiased - frac_bits )
+  std::uint64_t magnitude;
+
+  if ( unbiased >= F::frac_bits )
+  {
+    if ( unbiased > 62 ) return unbiased == Width - 1 && sign && sig == ( std::uint64_t( 1 ) << F::frac_bits ) ? ( max_positive + 1 ) & mask : saturate();
+
+    magnitude = sig << ( unbiased - F::frac_bits );
+  }
+  else
+  {
+    auto const dist = F::frac_bits - unbiased;
+
+    std::uint64_t remainder, half;
+
+    if ( dist > 63 )
+    {
+      magnitude = 0;
+      remainder = 1; // below 0.5, only its presence counts
+      half = 2;
+    }
+    else
+    {
+      magnitude = sig >> dist;
+      remainder = sig & ( ( std::uint64_t( 1 ) << dist ) - 1 );
+      half = std::uint64_t( 1 ) << ( dist - 1 );
+    }
+
+    if ( remainder )
+    {
+      switch ( round )
+      {
+      case NEAREST: magnitude += remainder > half || ( remainder == half && ( magnitude & 1 ) ); break;
+      case ZERO: break;
+      case UP: magnitude += !sign; break;
+      case DOWN: magnitude += sign; break;
+      }
+    }
+
+    if ( remainder && magnitude <= max_positive + sign ) env.flags |= INEXACT;
+  }
+
+  if ( magnitude > max_positive + sign ) return saturate();
+
+  return ( sign ? 0 - magnitude : magnitude ) & mask;
+}
+
+// Rounds to an integral value, in the same format
+template<typename F>
+typename F::bits round_to_integral( Env &env, typename F::bits a ) noexcept
+{
+  using namespace detail;
+  using Bits = typename F::bits;
+
+  a = flush_operand<F>( env, a );
+
+  if ( is_nan<F>( a ) ) return propagate_nan<F>( env, a );
+
+  auto const exp = exp_of<F>( a );
+
+  // Integral already, or Infinity
+  if ( exp >= F::bias + F::frac_bits ) return a;
+
+  auto const sign = sign_of<F>( a );
+
+  if ( !exp && !frac_of<F>( a ) ) return a;
+
+  if ( exp < F::bias )
+  {
+    // |a| < 1, it's either 0 or 1
+    env.flags |= INEXACT;
+
+    bool one;
+
+    switch ( env.round )
+    {
+    case NEAREST: one = exp == F::bias - 1 && frac_of<F>( a ); break;
+    case UP: one = !sign; break;
+    case DOWN: one = sign; break;
+    default: one = false; break;
+    }
+
+    return pack<F>( sign, one ? F::bias : 0, 0 );
+  }
+
+  auto const fraction_bits = F::bias + F::frac_bits - exp;
+
+  Bits const one = Bits( 1 ) << fraction_bits;
+  Bits const fraction = a & ( one - 1 );
+
+  if ( !fraction ) return a;
+
+  env.flags |= INEXACT;
+
+  // A carry into the exponent is the next power of 2
+  Bits res = a & ~( one - 1 );
+
+  switch ( env.round )
+  {
+  case NEAREST:
+    if ( fraction > one / 2 || ( fraction == one / 2 && ( res & one ) ) ) res += one;
+    break;
+  case UP:
+    if ( !sign ) res += one;
+    break;
+  case DOWN:
+    if ( sign ) res += one;
+    break;
+  }
+
+  return res;
+}
+
+// MIN, MAX, and MINA, MAXA that compare the magnitudes and return the magnitude, like the host's path
+template<typename F>
+typename F::bits min( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  return detail::select<F>( env, a, b, false );
+}
+
+template<typename F>
+typename F::bits max( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  return detail::select<F>( env, a, b, true );
+}
+
+template<typename F>
+typename F::bits mina( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  if ( detail::is_signaling<F>( a ) || detail::is_signaling<F>( b ) ) return detail::propagate_nan<F>( env, a, b );
+
+  return detail::select<F>( env, a & ~F::sign_mask, b & ~F::sign_mask, false );
+}
+
+template<typename F>
+typename F::bits maxa( Env &env, typename F::bits a, typename F::bits b ) noexcept
+{
+  if ( detail::is_signaling<F>( a ) || detail::is_signaling<F>( b ) ) return detail::propagate_nan<F>( env, a, b );
+
+  return detail::select<F>( env, a & ~F::sign_mask, b & ~F::sign_mask, true );
+}
+} // namespace soft_float
+} // namespace mips32
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#  define MIPS32_STRING_SCAN_SSE2
+#  include <emmintrin.h>
+#  ifdef __AVX2__
+#    define MIPS32_STRING_SCAN_AVX2
+#    include <immintrin.h>
+#  endif
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+namespace mips32
+{
+#ifdef MIPS32_STRING_SCAN_SSE2
+inline unsigned lowest_set_bit( std::uint32_t mask ) noexcept
+{
+#  ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward( &index, mask );
+  return ( unsigned )index;
+#  else
+  return ( unsigned )__builtin_ctz( mask );
+#  endif
+}
+#endif
+
+/**
+ * Returns a pointer to the first '\0' inside [begin, begin + size), nullptr if there's none.
+ *
+ * The bulk of the range is scanned with aligned vector loads (32 bytes with AVX2, 16 with SSE2),
+ * so no byte outside the range is ever read.
+ **/
+inline char const *find_terminator( char const *begin, std::size_t size ) noexcept
+{
+#ifdef MIPS32_STRING_SCAN_SSE2
+  char const *      it = begin;
+  char const *const end = begin + size;
+
+  // Unaligned head
+  while ( it != end && reinterpret_cast<std::uintptr_t>( it ) % 16 )
+  {
+    if ( *it == '\0' )
+      return it;
+    ++it;
+  }
+
+#  ifdef MIPS32_STRING_SCAN_AVX2
+  if ( it != end && reinterpret_cast<std::uintptr_t>( it ) % 32 && end - it >= 16 )
+  {
+    auto const mask = ( std::uint32_t )_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_load_si128( reinterpret_cast<__m128i const *>( it ) ), _mm_setzero_si128() ) );
+    if ( mask )
+      return it + lowest_set_bit( mask );
+    it += 16;
+  }
+
+  for ( auto const zero = _mm256_setzero_si256(); end - it >= 32; it += 32 )
+  {
+    auto const mask = ( std::uint32_t )_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_load_si256( reinterpret_cast<__m256i const *>( it ) ), zero ) );
+    if ( mask )
+      return it + lowest_set_bit( mask );
+  }
+#  endif
+
+  for ( auto const zero = _mm_setzero_si128(); end - it >= 16; it += 16 )
+  {
+    auto const mask = ( std::uint32_t )_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_load_si128( reinterpret_cast<__m128i const *>( it ) ), zero ) );
+    if ( mask )
+      return it + lowest_set_bit( mask );
+  }
+
+  // Tail
+  for ( ; it != end; ++it )
+  {
+    if ( *it == '\0' )
+      return it;
+  }
+
+  return nullptr;
+#else
+  return static_cast<char const *>( std::memchr( begin, '\0', size ) );
+#endif
+}
+
+inline char *find_terminator( char *begin, std::size_t size ) noexcept
+{
+  return const_cast<char *>( find_terminator( static_cast<char const *>( begin ), size ) );
+}
+} // namespace mips32
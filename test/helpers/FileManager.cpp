@@ -31,5 +31,38 @@ void FileManager::close( std::uint32_t fd ) noexcept
   param.fd = fd;
 }
 
+bool FileManager::read_async( std::uint32_t fd, mips32::IOVec const * regions, std::uint32_t count, mips32::AsyncSyscall * syscall ) noexcept
+{
+  if ( !async )
+    return false;
+
+  param.fd = fd;
+  param.dst = regions[0].data;
+  param.count = count;
+  pending = syscall;
+
+  return true;
+}
+
+bool FileManager::write_async( std::uint32_t fd, mips32::IOVec const * regions, std::uint32_t count, mips32::AsyncSyscall * syscall ) noexcept
+{
+  if ( !async )
+    return false;
+
+  param.fd = fd;
+  param.src = regions[0].data;
+  param.count = count;
+  pending = syscall;
+
+  return true;
+}
+
+std::intptr_t FileManager::native_handle( std::uint32_t fd ) noexcept
+{
+  param.fd = fd;
+
+  return native;
+}
+
 FileManager::~FileManager()
 {}
@@ -15,6 +15,12 @@ public:
 
   virtual void close( std::uint32_t fd ) noexcept;
 
+  virtual std::intptr_t native_handle( std::uint32_t fd ) noexcept;
+
+  virtual bool read_async( std::uint32_t fd, mips32::IOVec const *regions, std::uint32_t count, mips32::AsyncSyscall *syscall ) noexcept;
+
+  virtual bool write_async( std::uint32_t fd, mips32::IOVec const *regions, std::uint32_t count, mips32::AsyncSyscall *syscall ) noexcept;
+
   virtual ~FileManager();
 
   inline void reset()
@@ -23,6 +29,9 @@ public:
     param.flags.clear();
     param.dst = param.src = nullptr;
     param.fd = param.count = 0;
+    async = false;
+    pending = nullptr;
+    native = -1;
   }
 
   struct Param
@@ -37,4 +46,11 @@ public:
   static constexpr std::uint32_t write_count{ 142 };
 
   Param param{};
+
+  // When set, read_async and write_async accept the requests and store them in `pending`
+  bool                  async{ false };
+  mips32::AsyncSyscall *pending{ nullptr };
+
+  // Returned by native_handle
+  std::intptr_t native{ -1 };
 };
\ No newline at end of file
@@ -6,6 +6,9 @@
 class Terminal : public mips32::IODevice
 {
 public:
+  using mips32::IODevice::print_string;
+  using mips32::IODevice::read_string;
+
   virtual void print_integer( std::uint32_t value ) noexcept;
 
   virtual void print_float( float value ) noexcept;
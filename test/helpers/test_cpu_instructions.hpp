@@ -60,8 +60,10 @@ constexpr std::uint32_t operator""_cpu( char const *s, std::size_t n ) noexcept
       {"BOVC"sv, 0b001'000 << 26},
       {"BNVC"sv, 0b011'000 << 26},
       {"BREAK"sv, 0b001'101},
+      {"CFC1"sv, 0b010'001 << 26 | 0b010 << 21},
       {"CLO"sv, std::uint32_t( 0b1'010'001 )},
       {"CLZ"sv, std::uint32_t( 0b1'010'000 )},
+      {"CTC1"sv, 0b010'001 << 26 | 0b110 << 21},
       {"DI"sv, 0b010'000 << 26 | 0b01'011 << 21 | 0b01'100 << 11},
       {"DIV"sv, 0b00'010 << 6 | 0b011'010},
       {"MOD"sv, 0b00'011 << 6 | 0b011'010},
@@ -0,0 +1,134 @@
+#include <catch.hpp>
+
+#include <mips32/buffered_io_device.hpp>
+#include <mips32/machine_inspector.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+// Records every call, in order
+class Recorder : public IODevice
+{
+public:
+  using IODevice::print_string;
+  using IODevice::read_string;
+
+  void print_integer( std::uint32_t value ) noexcept override { calls.push_back( "int:" + std::to_string( value ) ); }
+  void print_float( float value ) noexcept override { calls.push_back( "float:" + std::to_string( value ) ); }
+  void print_double( double value ) noexcept override { calls.push_back( "double:" + std::to_string( value ) ); }
+  void print_string( char const *string ) noexcept override
+  {
+    calls.push_back( std::string( "string:" ) + string );
+    ++strings;
+  }
+
+  void read_integer( std::uint32_t *value ) noexcept override { calls.push_back( "read" ); *value = 42; }
+  void read_float( float * ) noexcept override {}
+  void read_double( double * ) noexcept override {}
+  void read_string( char *, std::uint32_t ) noexcept override {}
+
+  std::vector<std::string> calls;
+  std::atomic<int>         strings{ 0 };
+};
+
+TEST_CASE( "A BufferedIODevice wraps another IODevice" )
+{
+  Recorder recorder;
+
+  SECTION( "The output is delivered only when flushed, strings are joined" )
+  {
+    BufferedIODevice device{ &recorder, 1_KB, std::chrono::milliseconds( 0 ) };
+
+    device.print_string( "Hello" );
+    device.print_string( ", " );
+    char world[] = "World!";
+    IOVec regions[] = { { world, 3 }, { world + 3, 3 } };
+    device.print_string( regions, 2 );
+    device.print_integer( 7 );
+    device.print_string( "\n" );
+
+    REQUIRE( recorder.calls.empty() );
+
+    device.flush();
+
+    REQUIRE( recorder.calls == std::vector<std::string>{ "string:Hello, World!", "int:7", "string:\n" } );
+  }
+
+  SECTION( "Reading delivers the output first" )
+  {
+    BufferedIODevice device{ &recorder, 1_KB, std::chrono::milliseconds( 0 ) };
+
+    device.print_string( "prompt> " );
+
+    std::uint32_t value = 0;
+    device.read_integer( &value );
+
+    REQUIRE( value == 42 );
+    REQUIRE( recorder.calls == std::vector<std::string>{ "string:prompt> ", "read" } );
+  }
+
+  SECTION( "A full buffer is delivered by the caller" )
+  {
+    BufferedIODevice device{ &recorder, 64, std::chrono::milliseconds( 0 ) };
+
+    for ( int i = 0; i < 100; ++i )
+      device.print_integer( i );
+
+    REQUIRE_FALSE( recorder.calls.empty() );
+    REQUIRE( recorder.calls.size() < 100 );
+
+    device.flush();
+
+    REQUIRE( recorder.calls.size() == 100 );
+    REQUIRE( recorder.calls.back() == "int:99" );
+  }
+
+  SECTION( "The background thread delivers the output" )
+  {
+    BufferedIODevice device{ &recorder, 1_KB, std::chrono::milliseconds( 1 ) };
+
+    device.print_string( "async" );
+
+    for ( int i = 0; i < 1000 && !recorder.strings; ++i )
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+    REQUIRE( recorder.calls == std::vector<std::string>{ "string:async" } );
+  }
+
+  SECTION( "The CPU flushes the device on exit" )
+  {
+    RAM ram{ 64_KB };
+    CPU cpu{ ram };
+    cpu.hard_reset();
+
+    BufferedIODevice device{ &recorder, 1_KB, std::chrono::milliseconds( 0 ) };
+    cpu.attach_iodevice( &device );
+
+    MachineInspector inspector;
+    inspector.inspect( cpu );
+
+    auto gpr = inspector.CPU_gpr_begin();
+
+    gpr[2] = 1; // print int
+    gpr[4] = 1994;
+    ram[0xBFC0'0000] = "SYSCALL"_cpu;
+    cpu.single_step();
+
+    REQUIRE( recorder.calls.empty() );
+
+    gpr[2] = 10; // exit
+    ram[0xBFC0'0004] = "SYSCALL"_cpu;
+    cpu.single_step();
+
+    REQUIRE( recorder.calls == std::vector<std::string>{ "int:1994" } );
+  }
+}
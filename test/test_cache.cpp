@@ -0,0 +1,116 @@
+#include <catch.hpp>
+
+#include <mips32/machine_inspector.hpp>
+#include "../src/cache.hpp"
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using Level = MachineInspector::CacheLevel;
+
+TEST_CASE( "The cache model counts hits, misses and write-backs" )
+{
+  RAM ram{ 64_KB };
+  CPU cpu{ ram };
+  cpu.hard_reset();
+
+  MachineInspector inspector;
+  inspector.inspect( cpu );
+
+  auto gpr = inspector.CPU_gpr_begin();
+  gpr[1] = 0xBFC0'1000;
+
+  SECTION( "Invalid configurations are rejected" )
+  {
+    REQUIRE_FALSE( Cache::invalid( { 64, 16, 2 } ) );
+
+    REQUIRE( Cache::invalid( { 48, 16, 2 } ) );    // size
+    REQUIRE( Cache::invalid( { 64, 12, 2 } ) );    // line size
+    REQUIRE( Cache::invalid( { 64, 16, 3 } ) );    // associativity
+    REQUIRE( Cache::invalid( { 64, 16, 8 } ) );    // not even a set
+    REQUIRE( Cache::invalid( { 64, 2, 1 } ) );     // smaller than a word
+    REQUIRE( Cache::invalid( { 1024, 4, 64 } ) );  // too many ways
+
+    REQUIRE( inspector.Cache_enable( { 64, 16, 2 }, { 64, 16, 2 }, { 48, 16, 2 } ) );
+    REQUIRE_FALSE( inspector.Cache_enabled() );
+  }
+
+  SECTION( "The least recently used way is evicted" )
+  {
+    // 2 sets, 2 ways, 16 bytes per line
+    CacheConfig const l1{ 64, 16, 2 };
+
+    REQUIRE_FALSE( inspector.Cache_enable( l1, l1, { 256, 16, 4 } ) );
+    REQUIRE( inspector.Cache_enabled() );
+
+    // Every data address maps to set 0
+    ram[0xBFC0'0000] = "LW"_cpu | 1_rs | 2_rt | 0x00_imm16; // miss
+    ram[0xBFC0'0004] = "LW"_cpu | 1_rs | 2_rt | 0x04_imm16; // hit, same line
+    ram[0xBFC0'0008] = "SW"_cpu | 1_rs | 2_rt | 0x20_imm16; // miss, the line becomes dirty
+    ram[0xBFC0'000C] = "LW"_cpu | 1_rs | 2_rt | 0x00_imm16; // hit, 0x20 is now the least recently used
+    ram[0xBFC0'0010] = "LW"_cpu | 1_rs | 2_rt | 0x40_imm16; // miss, evicts 0x20 and writes it back
+    ram[0xBFC0'0014] = "LW"_cpu | 1_rs | 2_rt | 0x00_imm16; // hit
+
+    for ( int i = 0; i < 6; ++i )
+      cpu.single_step();
+
+    auto const l1d = inspector.Cache_stats( Level::L1D );
+
+    REQUIRE( l1d.hits == 3 );
+    REQUIRE( l1d.misses == 3 );
+    REQUIRE( l1d.writebacks == 1 );
+
+    // 6 fetches inside 2 lines
+    auto const l1i = inspector.Cache_stats( Level::L1I );
+
+    REQUIRE( l1i.hits == 4 );
+    REQUIRE( l1i.misses == 2 );
+    REQUIRE( l1i.writebacks == 0 );
+
+    // Every L1 miss and write-back reaches the L2, only the write-back finds its line
+    auto const l2 = inspector.Cache_stats( Level::L2 );
+
+    REQUIRE( l2.hits == 1 );
+    REQUIRE( l2.misses == 5 );
+    REQUIRE( l2.writebacks == 0 );
+
+    inspector.Cache_disable();
+
+    REQUIRE_FALSE( inspector.Cache_enabled() );
+    REQUIRE( inspector.Cache_stats( Level::L1D ).misses == 0 );
+  }
+
+  SECTION( "A direct mapped cache evicts the only way of the set" )
+  {
+    // 2 sets, 1 way, 16 bytes per line
+    CacheConfig const l1{ 32, 16, 1 };
+
+    REQUIRE_FALSE( inspector.Cache_enable( { 1024, 16, 2 }, l1, { 8192, 32, 4 } ) );
+
+    ram[0xBFC0'0000] = "LW"_cpu | 1_rs | 2_rt | 0x00_imm16; // miss
+    ram[0xBFC0'0004] = "LW"_cpu | 1_rs | 2_rt | 0x20_imm16; // miss, evicts 0x00
+    ram[0xBFC0'0008] = "LW"_cpu | 1_rs | 2_rt | 0x00_imm16; // miss, evicts 0x20
+    ram[0xBFC0'000C] = "LW"_cpu | 1_rs | 2_rt | 0x10_imm16; // miss, set 1
+    ram[0xBFC0'0010] = "SW"_cpu | 1_rs | 2_rt | 0x14_imm16; // hit, the line becomes dirty
+    ram[0xBFC0'0014] = "LW"_cpu | 1_rs | 2_rt | 0x30_imm16; // miss, evicts 0x10 and writes it back
+
+    for ( int i = 0; i < 6; ++i )
+      cpu.single_step();
+
+    auto const l1d = inspector.Cache_stats( Level::L1D );
+
+    REQUIRE( l1d.hits == 1 );
+    REQUIRE( l1d.misses == 5 );
+    REQUIRE( l1d.writebacks == 1 );
+
+    // Enabling the model again starts from empty caches
+    REQUIRE_FALSE( inspector.Cache_enable( { 1024, 16, 2 }, l1, { 8192, 32, 4 } ) );
+    REQUIRE( inspector.Cache_stats( Level::L1D ).misses == 0 );
+    REQUIRE( inspector.Cache_stats( Level::L2 ).misses == 0 );
+  }
+
+  inspector.Cache_disable();
+}
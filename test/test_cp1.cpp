@@ -9,6 +9,8 @@
 #include <cmath>
 #include <limits>
 
+#include <xmmintrin.h>
+
 #define FP(n) inspector.CP1_fpr_begin() + n
 
 using namespace mips32;
@@ -84,6 +86,15 @@ struct INF<double>
   constexpr operator double() noexcept { return std::numeric_limits<double>::infinity(); }
 };
 
+// Runs `cp1` on this thread while in scope, as the CPU does
+struct Running
+{
+  CP1 &cp1;
+
+  explicit Running( CP1 &cp1 ) noexcept : cp1( cp1 ) { cp1.enter(); }
+  ~Running() noexcept { cp1.leave(); }
+};
+
 // TODO: provoke FPU exception
 
 TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
@@ -91,6 +102,8 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
   CP1 cp1;
   cp1.reset();
 
+  Running running{ cp1 };
+
   MachineInspector inspector;
 
   inspector.inspect( cp1 );
@@ -233,16 +246,16 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
     */
 
     cp1.write( 28, 1 );
-    REQUIRE( std::fegetround() == FE_TOWARDZERO );
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_TOWARD_ZERO );
 
     cp1.write( 28, 2 );
-    REQUIRE( std::fegetround() == FE_UPWARD );
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_UP );
 
     cp1.write( 28, 3 );
-    REQUIRE( std::fegetround() == FE_DOWNWARD );
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_DOWN );
 
     cp1.write( 28, 0 );
-    REQUIRE( std::fegetround() == FE_TONEAREST );
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_NEAREST );
   }
 
   /* * * * * * * * *
@@ -1997,4 +2010,168 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
   }
 }
 
+TEST_CASE( "A Coprocessor 1 with the soft backend rounds the same on every host" )
+{
+  CP1 cp1{ FPUBackend::SOFT };
+  cp1.reset();
+
+  Running running{ cp1 };
+
+  MachineInspector inspector;
+  inspector.inspect( cp1 );
+
+  auto f0 = FP( 0 );
+  auto f1 = FP( 1 );
+  auto f2 = FP( 2 );
+
+  // FCSR.FS is set on reset
+  cp1.write( 31, 0 );
+
+  SECTION( "The rounding mode comes from FCSR, the host keeps rounding to nearest" )
+  {
+    f1->d = 1.0;
+    f2->d = std::ldexp( 1.0, -60 );
+
+    cp1.write( 28, 2 ); // Round towards Plus Infinity
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_NEAREST );
+
+    REQUIRE( cp1.execute( "ADD"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->d == std::nextafter( 1.0, 2.0 ) );
+
+    // Flags: Inexact
+    REQUIRE( ( cp1.read( 31 ) & 0x7C ) == 0x04 );
+  }
+
+  SECTION( "An invalid operation returns the positive default NaN" )
+  {
+    f1->d = 0.0;
+    f2->d = 0.0;
+
+    REQUIRE( cp1.execute( "DIV"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->i64 == 0x7FF8'0000'0000'0000 );
+
+    // Enabled: Invalid Operation
+    cp1.write( 31, 0x10 << 7 );
+
+    f1->f = -1.f;
+    REQUIRE( cp1.execute( "SQRT"_cp1 | FMT_S | 0_r1 | 1_r2 ) == CP1::Exception::INVALID );
+    REQUIRE( f0->i64 == 0x7FF8'0000'0000'0000 );
+  }
+
+  SECTION( "MIN, MAX, MINA and MAXA raise Invalid Operation on a signaling NaN" )
+  {
+    f1->i32 = 0x7F80'0001; // signaling NaN
+    f2->f = -2.f;
+
+    REQUIRE( cp1.execute( "MIN"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->i32 == 0x7FC0'0001 );
+
+    // Cause and Flags: Invalid Operation
+    REQUIRE( ( cp1.read( 31 ) & 0x3'F07C ) == 0x1'0040 );
+
+    // A quiet NaN loses against a number
+    cp1.write( 31, 0 );
+    f1->i32 = 0x7FC0'0000;
+
+    REQUIRE( cp1.execute( "MAX"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->f == -2.f );
+    REQUIRE( cp1.execute( "MAXA"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->f == 2.f );
+    REQUIRE( ( cp1.read( 31 ) & 0x3'F07C ) == 0 );
+
+    // Enabled: Invalid Operation
+    cp1.write( 31, 0x10 << 7 );
+
+    f0->d = 1.0;
+    f1->i64 = 0xFFF0'0000'0000'0001;
+    f2->d = 3.0;
+
+    REQUIRE( cp1.execute( "MAX"_cp1 | FMT_D | 0_r1 | 2_r2 | 1_r3 ) == CP1::Exception::INVALID );
+    REQUIRE( cp1.execute( "MINA"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::INVALID );
+    REQUIRE( f0->d == 1.0 );
+  }
+
+  SECTION( "MADDF and MSUBF round once" )
+  {
+    f0->d = -1.0;
+    f1->d = 1.0 + std::ldexp( 1.0, -30 );
+    f2->d = 1.0 - std::ldexp( 1.0, -30 );
+
+    // 1 - 2^-60 - 1, it would be 0 with 2 roundings
+    REQUIRE( cp1.execute( "MADDF"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->d == -std::ldexp( 1.0, -60 ) );
+
+    f0->d = 1.0;
+    REQUIRE( cp1.execute( "MSUBF"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    REQUIRE( f0->d == std::ldexp( 1.0, -60 ) );
+  }
+
+  SECTION( "Conversions to integer round ties to even" )
+  {
+    f1->f = 2.5f;
+    f2->d = -3.5;
+
+    REQUIRE( cp1.execute( "ROUND_W"_cp1 | FMT_S | 0_r1 | 1_r2 ) == CP1::Exception::NONE );
+    REQUIRE( f0->i32 == 2 );
+
+    REQUIRE( cp1.execute( "CVT_L"_cp1 | FMT_D | 0_r1 | 2_r2 ) == CP1::Exception::NONE );
+    REQUIRE( f0->i64 == std::uint64_t( -4 ) );
+  }
+}
+
+TEST_CASE( "Many Coprocessor 1 take turns on the same thread" )
+{
+  CP1 rz, rp;
+  rz.reset();
+  rp.reset();
+
+  rz.write( 28, 1 ); // Round Toward Zero
+  rp.write( 28, 2 ); // Round Towards Plus Infinity
+
+  MachineInspector inspector;
+  inspector.inspect( rz );
+
+  auto const host = _mm_getcsr();
+
+  SECTION( "Each one runs with its own rounding and flushing" )
+  {
+    rz.enter();
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_TOWARD_ZERO );
+    REQUIRE( _MM_GET_FLUSH_ZERO_MODE() == _MM_FLUSH_ZERO_ON );
+    rz.leave();
+
+    REQUIRE( _mm_getcsr() == host );
+
+    rp.enter();
+    REQUIRE( _MM_GET_ROUNDING_MODE() == _MM_ROUND_UP );
+    rp.leave();
+
+    REQUIRE( _mm_getcsr() == host );
+  }
+
+  SECTION( "The exceptions raised by one don't leak into the others" )
+  {
+    auto f0 = FP( 0 );
+    auto f1 = FP( 1 );
+    auto f2 = FP( 2 );
+
+    f1->d = 1.0;
+    f2->d = 10.0;
+
+    rz.enter();
+    REQUIRE( rz.execute( "DIV"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3 ) == CP1::Exception::NONE );
+    rz.leave();
+
+    REQUIRE( f0->d == std::nextafter( 0.1, 0.0 ) );
+
+    rp.enter();
+    REQUIRE( ( rp.read( 31 ) & 0x7C ) == 0 );
+    rp.leave();
+
+    // Flags: Inexact, collected after leaving
+    REQUIRE( ( rz.read( 31 ) & 0x7C ) == 0x04 );
+    REQUIRE( _mm_getcsr() == host );
+  }
+}
+
 #undef FP
\ No newline at end of file
@@ -8,8 +8,15 @@
 #include "helpers/FileManager.hpp"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  include <io.h>
+#endif
 
 // TODO: test for reserved(word) path
 // TODO: test BNEZALC
@@ -38,6 +45,7 @@ constexpr int _v1 = 3;
 constexpr int _a0 = 4;
 constexpr int _a1 = 5;
 constexpr int _a2 = 6;
+constexpr int _a3 = 7;
 
 enum SYSCALL
 {
@@ -58,6 +66,7 @@ enum SYSCALL
   WRITE,
   CLOSE,
   EXIT2,
+  MMAP,
 };
 
 TEST_CASE( "A CPU object exists" )
@@ -104,6 +113,137 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( *$1 == res );
   }
 
+  SECTION( "Executed instructions are counted per opcode" )
+  {
+    using Group = MachineInspector::CounterGroup;
+
+    REQUIRE( inspector.CPU_counters_enabled() );
+
+    auto const _add_s = 0x11u << 26 | 0x10u << 21; // ADD.S $f0, $f0, $f0
+
+    ram[0xBFC0'0000] = "ADD"_cpu | 1_rd | 2_rs | 3_rt;
+    ram[0xBFC0'0004] = "ADDIU"_cpu | 21_rt | 3_rs | 1_imm16;
+    ram[0xBFC0'0008] = "ADD"_cpu | 1_rd | 2_rs | 3_rt;
+    ram[0xBFC0'000C] = _add_s;
+
+    for ( int i = 0; i < 4; ++i )
+      cpu.single_step();
+
+    REQUIRE( inspector.CPU_counter( Group::OPCODE, 0x00 ) == 2 );
+    REQUIRE( inspector.CPU_counter( Group::OPCODE, 0x09 ) == 1 );
+    REQUIRE( inspector.CPU_counter( Group::OPCODE, 0x11 ) == 1 );
+    REQUIRE( inspector.CPU_counter( Group::SPECIAL, 0x20 ) == 2 );
+    REQUIRE( inspector.CPU_counter( Group::COP1, 0x00 ) == 1 );
+    REQUIRE( inspector.CPU_counter( Group::OPCODE, 0x23 ) == 0 );
+    REQUIRE( inspector.CPU_counter( Group::COP1, 64 ) == 0 );
+
+    auto const exported = [&] ( MachineInspector::CounterFormat format )
+    {
+      std::FILE *file = std::tmpfile();
+      REQUIRE( file );
+      REQUIRE_FALSE( inspector.CPU_export_counters( file, format ) );
+
+      std::string text( std::size_t( std::ftell( file ) ), '\0' );
+      std::rewind( file );
+      REQUIRE( std::fread( &text[0], 1, text.size(), file ) == text.size() );
+      std::fclose( file );
+
+      return text;
+    };
+
+    REQUIRE( exported( MachineInspector::CounterFormat::JSON )
+             == "{\"opcode\":{\"0x00\":2,\"0x09\":1,\"0x11\":1},\"special\":{\"0x20\":2},\"cop1\":{\"0x00\":1}}\n" );
+    REQUIRE( exported( MachineInspector::CounterFormat::CSV )
+             == "group,code,count\nopcode,0x00,2\nopcode,0x09,1\nopcode,0x11,1\nspecial,0x20,2\ncop1,0x00,1\n" );
+
+    inspector.CPU_reset_counters();
+
+    REQUIRE( inspector.CPU_counter( Group::OPCODE, 0x00 ) == 0 );
+    REQUIRE( exported( MachineInspector::CounterFormat::JSON ) == "{\"opcode\":{},\"special\":{},\"cop1\":{}}\n" );
+  }
+
+  SECTION( "Retired instructions advance the cycles by their class" )
+  {
+    inspector.CPU_set_timing_model( { 1, 3, 2, 5, 7 } );
+
+    auto $1 = R( 1 );
+    auto $5 = R( 5 );
+
+    *$1 = 0xBFC0'0100;
+
+    ram[0xBFC0'0000] = "LW"_cpu | 1_rs | 2_rt;
+    ram[0xBFC0'0004] = "SW"_cpu | 1_rs | 2_rt | 4_imm16;
+    ram[0xBFC0'0008] = "MUL"_cpu | 3_rd | 2_rs | 2_rt;
+    ram[0xBFC0'000C] = 0x11u << 26 | 0x10u << 21; // ADD.S $f0, $f0, $f0
+    ram[0xBFC0'0010] = "ADDIU"_cpu | 4_rt | 4_rs | 1_imm16;
+    ram[0xBFC0'0014] = 0b011110u << 26 | 1 << 11 | 1 << 6 | 0x22; // LD.W $w1, 0($1)
+    ram[0xBFC0'0018] = 0b011110u << 26 | 1 << 11 | 1 << 6 | 0x26; // ST.W $w1, 0($1)
+    ram[0xBFC0'001C] = "MFC0"_cpu | 5_rt | 9_rd; // Count
+
+    std::uint64_t const expected[]{ 3, 5, 10, 17, 18, 21, 23, 24 };
+
+    for ( auto cycles : expected )
+    {
+      cpu.single_step();
+      REQUIRE( inspector.CPU_cycles() == cycles );
+    }
+
+    REQUIRE( *$5 == 24 );
+  }
+
+  SECTION( "The timer interrupt is raised when Count reaches Compare" )
+  {
+    auto const timer_ip = cp0.timer_ip();
+
+    auto $1 = R( 1 );
+    auto $3 = R( 3 );
+    auto $4 = R( 4 );
+    auto $5 = R( 5 );
+
+    // Interrupts enabled, only the timer is unmasked
+    cp0.status = timer_ip | 1;
+
+    // main:
+    //   ADDIU $2, $0, 100
+    //   MTC0  $2, Compare
+    // loop:
+    //   ADDIU $1, $1, 1
+    //   BC    loop
+    ram[0xBFC0'0000] = "ADDIU"_cpu | 2_rt | 100_imm16;
+    ram[0xBFC0'0004] = "MTC0"_cpu | 2_rt | 11_rd;
+    ram[0xBFC0'0008] = "ADDIU"_cpu | 1_rt | 1_rs | 1_imm16;
+    ram[0xBFC0'000C] = "BC"_cpu | 0x03FF'FFFE;
+
+    // handler:
+    //   MFC0  $3, Count
+    //   MFC0  $4, Cause
+    //   MTC0  $2, Compare (acknowledges the interrupt)
+    //   MFC0  $5, Cause
+    //   BREAK
+    ram[0x8000'0180] = "MFC0"_cpu | 3_rt | 9_rd;
+    ram[0x8000'0184] = "MFC0"_cpu | 4_rt | 13_rd;
+    ram[0x8000'0188] = "MTC0"_cpu | 2_rt | 11_rd;
+    ram[0x8000'018C] = "MFC0"_cpu | 5_rt | 13_rd;
+    ram[0x8000'0190] = "BREAK"_cpu;
+
+    *$1 = 0;
+
+    REQUIRE( cpu.start() == CPU::EXCEPTION );
+
+    // Taken at the first block boundary after Count reached Compare
+    REQUIRE( *$3 >= 100 );
+    REQUIRE( *$3 < 110 );
+    REQUIRE( *$1 >= 48 );
+    REQUIRE( cp0.epc == 0xBFC0'0008 );
+
+    REQUIRE( ( *$4 >> 2 & 0x1F ) == CPU::ExCause::Int );
+    REQUIRE( ( *$4 & CP0::timer_interrupt ) );
+    REQUIRE( ( *$4 & timer_ip ) );
+
+    REQUIRE_FALSE( ( *$5 & CP0::timer_interrupt ) );
+    REQUIRE_FALSE( ( *$5 & timer_ip ) );
+  }
+
   SECTION( "ADDIU $21, $3, 32'000 is executed" )
   {
     auto const _addiu = "ADDIU"_cpu | 21_rt | 3_rs | 32000_imm16;
@@ -1864,6 +2004,77 @@ TEST_CASE( "A CPU object exists" )
     }
   }
 
+  SECTION( "LD.W $w1, n($1) and ST.W $w1, n($2) move a whole vector register" )
+  {
+    auto const _msa = 0b011110u << 26;
+    auto const _ld_w = _msa | 4 << 16 | 1 << 11 | 1 << 6 | 0x22;  // LD.W $w1, 16($1), the offset is in words
+    auto const _st_w = _msa | 0 << 16 | 2 << 11 | 1 << 6 | 0x26;  // ST.W $w1, 0($2)
+    auto const _bnz_v = 0x11u << 26 | 0b01'111 << 21 | 1 << 16 | 3; // BNZ.V $w1, 12
+
+    auto $f1 = FP( 1 );
+    auto $1 = R( 1 );
+    auto $2 = R( 2 );
+
+    PC() = pc;
+
+    *$1 = 0x8000'0000 - 16;
+    *$2 = 0x8000'0011; // unaligned
+
+    ram[0x8000'0000] = 0x0000'0001;
+    ram[0x8000'0004] = 0x0000'0002;
+    ram[0x8000'0008] = 0x0000'0003;
+    ram[0x8000'000C] = 0x0000'0004;
+    ram[0x8000'0010] = 0x0000'0000;
+    ram[0x8000'0020] = 0xFFFF'FFFF;
+
+    ram[0xBFC0'0000] = _ld_w;
+    ram[0xBFC0'0004] = _st_w;
+    ram[0xBFC0'0008] = _bnz_v;
+
+    cpu.single_step();
+    REQUIRE( $f1->i64 == 0x0000'0002'0000'0001 );
+    REQUIRE( inspector.CP1_read_vpr( 1 )[1] == 0x0000'0004'0000'0003 );
+
+    cpu.single_step();
+    REQUIRE( ram[0x8000'0010] == 0x0000'0100 );
+    REQUIRE( ram[0x8000'0014] == 0x0000'0200 );
+    REQUIRE( ram[0x8000'0018] == 0x0000'0300 );
+    REQUIRE( ram[0x8000'001C] == 0x0000'0400 );
+    REQUIRE( ram[0x8000'0020] == 0xFFFF'FF00 );
+
+    cpu.single_step();
+    REQUIRE( PC() == pc + 12 + 12 );
+    REQUIRE( ExCause() == 0 );
+  }
+
+  SECTION( "ST.W $w1, 0($2) that faults on its last word doesn't write anything" )
+  {
+    auto const _st_w = 0b011110u << 26 | 0 << 16 | 2 << 11 | 1 << 6 | 0x26;
+
+    auto $2 = R( 2 );
+
+    // forcing User Mode, useg ends at 0x7FFF'FFFF
+    cp0.status &= ~0x1E;
+    cp0.status |= 0x10;
+
+    PC() = 0x0040'0000;
+    ram[0x0040'0000] = _st_w;
+
+    *$2 = 0x7FFF'FFF4;
+    inspector.CP1_write_vpr( 1, { 0x0000'0002'0000'0001, 0x0000'0004'0000'0003 } );
+
+    ram[0x7FFF'FFF4] = 0xCCCC'CCCC;
+    ram[0x7FFF'FFF8] = 0xCCCC'CCCC;
+    ram[0x7FFF'FFFC] = 0xCCCC'CCCC;
+
+    cpu.single_step();
+
+    REQUIRE( ExCause() == 5 ); // AdES
+    REQUIRE( ram[0x7FFF'FFF4] == 0xCCCC'CCCC );
+    REQUIRE( ram[0x7FFF'FFF8] == 0xCCCC'CCCC );
+    REQUIRE( ram[0x7FFF'FFFC] == 0xCCCC'CCCC );
+  }
+
   SECTION( "SB $1, n($2) is executed with n = {0,1,2,3}" )
   {
     auto const _sb_0 = "SB"_cpu | 1_rt | 0 | 2_rs;
@@ -3353,6 +3564,46 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( $f0->i64 == 0xDDDD'EEEE'CCCC'CCCCull );
   }
 
+  SECTION( "CFC1 and CTC1 access FCSR, untrapped FPU exceptions are collected when it's read" )
+  {
+    auto const _add_s = 0x11u << 26 | 0x10u << 21 | 2_rt | 1_rd;          // ADD.S $f0, $f1, $f2
+    auto const _div_s = 0x11u << 26 | 0x10u << 21 | 3_rt | 1_rd | 0x03; // DIV.S $f0, $f1, $f3
+    auto const _cfc1 = "CFC1"_cpu | 1_rt | 31_rd;
+    auto const _ctc1 = "CTC1"_cpu | 2_rt | 31_rd;
+
+    constexpr ui32 overflow_inexact{ CP1::OVERFLOW_ | CP1::INEXACT };
+    constexpr ui32 enable_divbyzero{ CP1::DIVBYZERO << 7 };
+
+    auto $1 = R( 1 );
+    auto $2 = R( 2 );
+
+    ( FP( 1 ) )->f = 3e38f;
+    ( FP( 2 ) )->f = 3e38f;
+    ( FP( 3 ) )->f = 0.f;
+
+    ram[0xBFC0'0000] = _add_s;
+    ram[0xBFC0'0004] = _cfc1;
+    ram[0xBFC0'0008] = _ctc1;
+    ram[0xBFC0'000C] = _div_s;
+
+    // Overflows, nothing can trap
+    cpu.single_step();
+    REQUIRE( ExCause() == 0 );
+
+    cpu.single_step();
+    REQUIRE( ( *$1 >> 2 & 0x1F ) == overflow_inexact );  // Flags
+    REQUIRE( ( *$1 >> 12 & 0x3F ) == overflow_inexact ); // Cause
+
+    // The division by zero traps, the previous exceptions don't
+    *$2 = ( *$1 & ~0x3'F07Cu ) | enable_divbyzero;
+    cpu.single_step();
+    REQUIRE( ( inspector.CP1_fcsr() & 0xF80 ) == enable_divbyzero );
+
+    cpu.single_step();
+    REQUIRE( ExCause() == CPU::ExCause::FPE );
+    REQUIRE( ( inspector.CP1_fcsr() >> 12 & CP1::DIVBYZERO ) );
+  }
+
   SECTION( "Swapping 2 FPRs registers using GPRS" )
   {
     // $f0 into $1, $2
@@ -3894,15 +4145,51 @@ TEST_CASE( "A CPU object exists" )
     auto $v0 = R( _v0 );
     auto $a0 = R( _a0 );
 
+    auto & program_break = inspector.CPU_program_break();
+
+    REQUIRE( program_break == CPU::heap_begin );
+
     *$v0 = SBRK;
-    *$a0 = 0;
+    *$a0 = 98;
 
-    ram[0xBFC0'0000] = "EI"_cpu;
-    ram[0xBFC0'0004] = "SYSCALL"_cpu;
+    $start = "SYSCALL"_cpu;
     cpu.single_step();
+
+    REQUIRE( *$v0 == CPU::heap_begin );
+    REQUIRE( program_break == CPU::heap_begin + 100 ); // word aligned
+
+    // The heap is zero filled
+    REQUIRE( ram[CPU::heap_begin] == 0 );
+    REQUIRE( ram[CPU::heap_begin + 96] == 0 );
+
+    // Shrinking below the beginning of the heap fails
+    *$v0 = SBRK;
+    *$a0 = -200;
+
+    PC() = 0xBFC0'0000;
     cpu.single_step();
 
-    REQUIRE( PC() == 0x8000'0180 );
+    REQUIRE( *$v0 == 0xFFFF'FFFF );
+    REQUIRE( program_break == CPU::heap_begin + 100 );
+
+    // Growing past the end of the heap fails
+    *$v0 = SBRK;
+    *$a0 = CPU::heap_end - CPU::heap_begin;
+
+    PC() = 0xBFC0'0000;
+    cpu.single_step();
+
+    REQUIRE( *$v0 == 0xFFFF'FFFF );
+
+    *$v0 = SBRK;
+    *$a0 = -100;
+
+    PC() = 0xBFC0'0000;
+    cpu.single_step();
+
+    REQUIRE( *$v0 == CPU::heap_begin + 100 );
+    REQUIRE( program_break == CPU::heap_begin );
+    REQUIRE( ExCause() == 0 );
   }
 
   SECTION( "[SYSCALL] exit is executed" )
@@ -4018,6 +4305,150 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( *$v0 == filehandler->write_count );
   }
 
+  SECTION( "[SYSCALL] read and write are executed in place" )
+  {
+    auto $v0 = R( _v0 );
+
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+
+    auto volatile _dummy = ram[0x0000'0000];
+
+    *$v0 = READ;
+
+    *$a0 = 0xDDDD'EEEE;
+    *$a1 = 0x0000'0100;
+    *$a2 = 235;
+
+    $start = "SYSCALL"_cpu;
+    cpu.single_step();
+
+    REQUIRE( filehandler->param.dst == ( char * )std::addressof( ram[0x0000'0100] ) );
+    REQUIRE( filehandler->param.count == 235 );
+    REQUIRE( *$v0 == filehandler->read_count );
+
+    *$v0 = WRITE;
+
+    *$a0 = 0xAABB'EEDD;
+    *$a1 = 0x0000'0200;
+    *$a2 = 897;
+
+    PC() = 0xBFC0'0000;
+    cpu.single_step();
+
+    REQUIRE( filehandler->param.fd == 0xAABB'EEDD );
+    REQUIRE( filehandler->param.src == ( char * )std::addressof( ram[0x0000'0200] ) );
+    REQUIRE( filehandler->param.count == 897 );
+    REQUIRE( *$v0 == filehandler->write_count );
+  }
+
+  SECTION( "[SYSCALL] read completes asynchronously" )
+  {
+    auto $v0 = R( _v0 );
+
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+
+    auto volatile _dummy = ram[0x0000'0000];
+
+    filehandler->async = true;
+
+    *$v0 = READ;
+
+    *$a0 = 0xDDDD'EEEE;
+    *$a1 = 0x0000'0100;
+    *$a2 = 235;
+
+    $start = "SYSCALL"_cpu;
+    ram[0xBFC0'0004] = "SLL"_cpu;
+
+    REQUIRE( cpu.single_step() == 5 );
+    REQUIRE( filehandler->pending != nullptr );
+    REQUIRE( filehandler->param.dst == ( char * )std::addressof( ram[0x0000'0100] ) );
+    REQUIRE( PC() == 0xBFC0'0004 );
+
+    // Still pending, nothing is executed
+    REQUIRE( cpu.single_step() == 5 );
+    REQUIRE( PC() == 0xBFC0'0004 );
+
+    filehandler->pending->complete( 77 );
+
+    REQUIRE( cpu.single_step() == 0 );
+    REQUIRE( *$v0 == 77 );
+    REQUIRE( PC() == 0xBFC0'0008 );
+
+    filehandler->reset();
+  }
+
+  SECTION( "[SYSCALL] a reset drops a pending read" )
+  {
+    auto $v0 = R( _v0 );
+
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+
+    auto volatile _dummy = ram[0x0000'0000];
+
+    std::FILE *state = std::tmpfile();
+    REQUIRE( state );
+    REQUIRE_FALSE( inspector.save_compressed_state( state, 1 ) );
+
+    filehandler->async = true;
+
+    *$v0 = READ;
+
+    *$a0 = 0xDDDD'EEEE;
+    *$a1 = 0x0000'0100;
+    *$a2 = 235;
+
+    $start = "SYSCALL"_cpu;
+
+    REQUIRE( cpu.single_step() == 5 );
+    REQUIRE( filehandler->pending != nullptr );
+
+    // The handler can write into the RAM at any time, it can't be replaced
+    std::rewind( state );
+    REQUIRE( inspector.restore_compressed_state( state ) );
+
+    cpu.hard_reset();
+
+    // The CPU doesn't wait for the dropped read, the next I/O syscall is synchronous
+    auto *const dropped = filehandler->pending;
+    filehandler->pending = nullptr;
+    *$v0 = READ;
+    *$a1 = 0x0000'0200;
+    *$a2 = 16;
+
+    REQUIRE( PC() == 0xBFC0'0000 );
+    REQUIRE( cpu.single_step() == 0 );
+    REQUIRE( filehandler->pending == nullptr );
+    REQUIRE( *$v0 == filehandler->read_count );
+    REQUIRE( PC() == 0xBFC0'0004 );
+
+    std::rewind( state );
+    REQUIRE( inspector.restore_compressed_state( state ) );
+
+    // Its result is discarded
+    filehandler->async = false;
+    *$v0 = 0x1234;
+    ram[0xBFC0'0004] = "SLL"_cpu;
+
+    dropped->complete( 77 );
+
+    REQUIRE( cpu.single_step() == 0 );
+    REQUIRE( *$v0 == 0x1234 );
+
+    // Completed, the RAM can be replaced
+    std::rewind( state );
+    REQUIRE_FALSE( inspector.restore_compressed_state( state ) );
+
+    std::fclose( state );
+    filehandler->reset();
+  }
+
   SECTION( "[SYSCALL] close is executed" )
   {
     auto $v0 = R( _v0 );
@@ -4034,6 +4465,99 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( filehandler->param.fd == 0xDDDD'EEEE );
   }
 
+  SECTION( "[SYSCALL] a file is mapped into memory" )
+  {
+    auto $v0 = R( _v0 );
+
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+    auto $a3 = R( _a3 );
+
+    // 1 Block and a half
+    std::vector<std::uint32_t> words( RAM::block_size / 4 * 3 / 2 );
+    for ( std::uint32_t i = 0; i < words.size(); ++i )
+      words[i] = i * 3 + 1;
+
+    std::FILE *file = std::tmpfile();
+    REQUIRE( file );
+    REQUIRE( std::fwrite( words.data(), sizeof( words[0] ), words.size(), file ) == words.size() );
+    REQUIRE( std::fflush( file ) == 0 );
+
+#ifdef _WIN32
+    filehandler->native = _get_osfhandle( _fileno( file ) );
+#else
+    filehandler->native = fileno( file );
+#endif
+
+    *$v0 = MMAP;
+
+    *$a0 = 0xDDDD'EEEE;
+    *$a1 = 0x0001'0000;
+    *$a2 = 0xFFFF'FFFF; // up to the end of the file
+    *$a3 = 0;
+
+    $start = "SYSCALL"_cpu;
+    cpu.single_step();
+
+    REQUIRE( *$v0 == 0x0001'0000 );
+
+    bool equals = true;
+    for ( std::uint32_t i = 0; i < words.size(); ++i )
+      equals &= ram[0x0001'0000 + i * 4] == words[i];
+
+    REQUIRE( equals );
+
+    // The rest of the last block is zeroed
+    REQUIRE( ram[0x0001'0000 + ( std::uint32_t )words.size() * 4] == 0 );
+    REQUIRE( ram[0x0003'0000 - 4] == 0 );
+
+    // The file isn't modified
+    ram[0x0001'0000] = 0xAAAA'BBBB;
+
+    std::uint32_t first_word = 0;
+    REQUIRE( std::fseek( file, 0, SEEK_SET ) == 0 );
+    REQUIRE( std::fread( &first_word, sizeof( first_word ), 1, file ) == 1 );
+    REQUIRE( first_word == words[0] );
+
+    // Mapping the window again releases the previous mapping
+    REQUIRE( inspector.RAM_mapped_files_no() == 1 );
+
+    for ( int i = 0; i < 64; ++i )
+    {
+      *$v0 = MMAP;
+
+      PC() = 0xBFC0'0000;
+      cpu.single_step();
+
+      REQUIRE( *$v0 == 0x0001'0000 );
+    }
+
+    REQUIRE( inspector.RAM_mapped_files_no() == 1 );
+    REQUIRE( ram[0x0001'0000] == words[0] );
+
+    // The address must be aligned to a block
+    *$v0 = MMAP;
+    *$a1 = 0x0001'0004;
+
+    PC() = 0xBFC0'0000;
+    cpu.single_step();
+
+    REQUIRE( *$v0 == 0xFFFF'FFFF );
+
+    // The offset can't be past the end of the file
+    *$v0 = MMAP;
+    *$a1 = 0x0001'0000;
+    *$a3 = RAM::block_size * 2;
+
+    PC() = 0xBFC0'0000;
+    cpu.single_step();
+
+    REQUIRE( *$v0 == 0xFFFF'FFFF );
+
+    std::fclose( file );
+  }
+
   SECTION( "[SYSCALL] exit2 is executed" )
   {
     auto $v0 = R( _v0 );
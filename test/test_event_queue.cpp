@@ -0,0 +1,222 @@
+#include <catch.hpp>
+
+#include <mips32/machine_inspector.hpp>
+#include "../src/cpu.hpp"
+#include "../src/event_queue.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+struct Log
+{
+  std::vector<int> calls;
+};
+
+struct Entry
+{
+  Log *log;
+  int  value;
+};
+
+void record_call( void *user_data )
+{
+  auto const *entry = static_cast<Entry *>( user_data );
+  entry->log->calls.push_back( entry->value );
+}
+} // namespace
+
+TEST_CASE( "An EventQueue runs the events in order" )
+{
+  EventQueue queue;
+  Log        log;
+
+  Entry a{ &log, 1 }, b{ &log, 2 }, c{ &log, 3 }, d{ &log, 4 };
+
+  REQUIRE( queue.next() == EventQueue::never );
+
+  queue.schedule( 30, record_call, &a );
+  queue.schedule( 10, record_call, &b );
+  auto const id = queue.schedule( 20, record_call, &c );
+  queue.schedule( 10, record_call, &d );
+
+  REQUIRE( queue.size() == 4 );
+  REQUIRE( queue.next() == 10 );
+
+  SECTION( "The due events run in the order they have been scheduled" )
+  {
+    queue.run( 9 );
+    REQUIRE( log.calls.empty() );
+
+    queue.run( 15 );
+    REQUIRE( log.calls == std::vector<int>{ 2, 4 } );
+    REQUIRE( queue.next() == 20 );
+
+    queue.run( 100 );
+    REQUIRE( log.calls == std::vector<int>{ 2, 4, 3, 1 } );
+    REQUIRE( queue.next() == EventQueue::never );
+  }
+
+  SECTION( "A cancelled event never runs" )
+  {
+    REQUIRE_FALSE( queue.cancel( id ) );
+    REQUIRE( queue.cancel( id ) );
+    REQUIRE( queue.cancel( 1234 ) );
+
+    queue.run( 100 );
+    REQUIRE( log.calls == std::vector<int>{ 2, 4, 1 } );
+  }
+
+  SECTION( "A callback can cancel the events due with it" )
+  {
+    struct Canceller
+    {
+      EventQueue *queue;
+      EventId     id;
+    } canceller{ &queue, id };
+
+    queue.schedule( 15, []( void *user_data )
+    {
+      auto *canceller = static_cast<Canceller *>( user_data );
+      canceller->queue->cancel( canceller->id );
+    }, &canceller );
+
+    queue.run( 25 );
+    REQUIRE( log.calls == std::vector<int>{ 2, 4 } );
+    REQUIRE( queue.next() == 30 );
+  }
+
+  SECTION( "The events scheduled by a callback wait for the next run" )
+  {
+    struct Rescheduler
+    {
+      EventQueue *queue;
+      Entry *     entry;
+    } rescheduler{ &queue, &a };
+
+    queue.clear();
+
+    queue.schedule( 5, []( void *user_data )
+    {
+      auto *rescheduler = static_cast<Rescheduler *>( user_data );
+      rescheduler->queue->schedule( 0, record_call, rescheduler->entry );
+    }, &rescheduler );
+
+    queue.run( 5 );
+    REQUIRE( log.calls.empty() );
+    REQUIRE( queue.next() == 0 );
+
+    queue.run( 5 );
+    REQUIRE( log.calls == std::vector<int>{ 1 } );
+  }
+}
+
+TEST_CASE( "The CPU runs the scheduled events at block boundaries" )
+{
+  RAM ram{ 64_KB };
+  CPU cpu{ ram };
+  cpu.hard_reset();
+
+  MachineInspector inspector;
+  inspector.inspect( cpu );
+
+  auto &cp0 = inspector.access_CP0();
+
+  auto gpr = inspector.CPU_gpr_begin();
+  gpr[1] = 0;
+
+  // loop:
+  //   ADDIU $1, $1, 1
+  //   BC    loop
+  ram[0xBFC0'0000] = "ADDIU"_cpu | 1_rt | 1_rs | 1_imm16;
+  ram[0xBFC0'0004] = "BC"_cpu | 0x03FF'FFFE;
+
+  SECTION( "An event stops the CPU after the given cycles" )
+  {
+    cpu.schedule( 100, []( void *user_data )
+    {
+      static_cast<CPU *>( user_data )->stop();
+    }, &cpu );
+
+    REQUIRE( cpu.start() == CPU::MANUAL_STOP );
+
+    // Every iteration takes 2 cycles, the event runs after the branch
+    REQUIRE( inspector.CPU_cycles() == 100 );
+    REQUIRE( gpr[1] == 50 );
+    REQUIRE( inspector.CPU_pc() == 0xBFC0'0000 );
+  }
+
+  SECTION( "A periodic event reschedules itself" )
+  {
+    struct Ticker
+    {
+      CPU *                      cpu;
+      std::vector<std::uint64_t> ticks;
+      std::uint32_t const *      counter;
+    } ticker{ &cpu, {}, &gpr[1] };
+
+    // A lambda can't name itself to reschedule
+    struct Periodic
+    {
+      static void run( void *user_data )
+      {
+        auto *ticker = static_cast<Ticker *>( user_data );
+        ticker->ticks.push_back( *ticker->counter );
+
+        if ( ticker->ticks.size() == 5 )
+          ticker->cpu->stop();
+        else
+          ticker->cpu->schedule( 10, run, ticker );
+      }
+    };
+
+    cpu.schedule( 10, Periodic::run, &ticker );
+
+    REQUIRE( cpu.start() == CPU::MANUAL_STOP );
+    REQUIRE( ticker.ticks == std::vector<std::uint64_t>{ 5, 10, 15, 20, 25 } );
+  }
+
+  SECTION( "A device raises an hardware interrupt" )
+  {
+    constexpr std::uint32_t line{ 2 };              // IP4
+    constexpr std::uint32_t ip{ 1u << ( 10 + line ) };
+
+    cp0.status = ip | 1;
+
+    // handler:
+    //   BREAK
+    ram[0x8000'0180] = "BREAK"_cpu;
+
+    cpu.schedule( 20, []( void *user_data )
+    {
+      static_cast<CPU *>( user_data )->raise_interrupt( line );
+    }, &cpu );
+
+    REQUIRE( cpu.start() == CPU::EXCEPTION );
+
+    REQUIRE( gpr[1] == 10 );
+    REQUIRE( cp0.epc == 0xBFC0'0000 );
+    REQUIRE( ( cp0.cause & ip ) );
+
+    cpu.clear_interrupt( line );
+    REQUIRE_FALSE( ( cp0.cause & ip ) );
+  }
+
+  SECTION( "A reset discards the events" )
+  {
+    cpu.schedule( 10, []( void *user_data )
+    {
+      static_cast<CPU *>( user_data )->stop();
+    }, &cpu );
+
+    cpu.hard_reset();
+
+    for ( int i = 0; i < 100; ++i )
+      REQUIRE( cpu.single_step() == CPU::NONE );
+  }
+}
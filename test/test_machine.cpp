@@ -0,0 +1,186 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include <mips32/executable.hpp>
+#include <mips32/profiler.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/Terminal.hpp"
+#include "helpers/FileManager.hpp"
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+// Appends the header, the sections and the symbol table into a single image
+std::vector<char> make_image( ExecutableHeader const &header, std::vector<char> const &data, std::vector<std::uint32_t> const &text,
+                              std::string const &symbols = "" )
+{
+  auto const symtab_sz = std::uint32_t( symbols.size() );
+
+  std::vector<char> image( sizeof( header ) + data.size() + text.size() * 4 + sizeof( symtab_sz ) + symtab_sz );
+
+  auto *p = image.data();
+  std::memcpy( p, &header, sizeof( header ) );
+  p += sizeof( header );
+  std::memcpy( p, data.data(), data.size() );
+  p += data.size();
+  std::memcpy( p, text.data(), text.size() * 4 );
+  p += text.size() * 4;
+  std::memcpy( p, &symtab_sz, sizeof( symtab_sz ) );
+  std::memcpy( p + sizeof( symtab_sz ), symbols.data(), symtab_sz );
+
+  return image;
+}
+
+ExecutableHeader make_header( std::uint32_t data_sz, std::uint32_t text_sz )
+{
+  ExecutableHeader header{};
+  std::memcpy( header.magic, ExecutableHeader::magic_string, sizeof( header.magic ) );
+  header.version = ExecutableHeader::current_version;
+  header.data_sz = data_sz;
+  header.text_sz = text_sz;
+  header.data_addr = 0x1000'0000;
+  header.text_addr = 0x0040'0000;
+  return header;
+}
+} // namespace
+
+TEST_CASE( "A Machine loads an executable" )
+{
+  auto terminal = std::make_unique<Terminal>();
+  auto filemanager = std::make_unique<FileManager>();
+
+  Machine machine{ 1_MB, terminal.get(), filemanager.get() };
+
+  std::vector<char> const data{ 'H', 'i', '!', '\0' };
+
+  // Prints the string in .data, then exits
+  std::vector<std::uint32_t> const text{
+    "ORI"_cpu | 2_rt | 0_rs | 4,
+    "AUI"_cpu | 4_rt | 0_rs | 0x1000,
+    "SYSCALL"_cpu,
+    "ORI"_cpu | 2_rt | 0_rs | 10,
+    "SYSCALL"_cpu,
+  };
+
+  SECTION( "A valid executable is loaded and runs from .text" )
+  {
+    auto const image = make_image( make_header( std::uint32_t( data.size() ), std::uint32_t( text.size() * 4 ) ), data, text );
+
+    REQUIRE( !machine.load( image.data() ) );
+
+    auto inspector = machine.get_inspector();
+    REQUIRE( inspector.CPU_pc() == 0x0040'0000 );
+    REQUIRE( *( inspector.CPU_gpr_begin() + 29 ) == 0x7FFF'EFFC );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( terminal->out_string == "Hi!" );
+  }
+
+  SECTION( "The symbol table is given to the attached Profiler" )
+  {
+    Profiler profiler{ 1 };
+    machine.swap_profiler( &profiler );
+
+    auto const image = make_image( make_header( std::uint32_t( data.size() ), std::uint32_t( text.size() * 4 ) ), data, text,
+                                   "00400000 T main\n"
+                                   "0040000C exit" );
+
+    REQUIRE( !machine.load( image.data() ) );
+    REQUIRE( machine.start() == CPU::EXIT );
+
+    machine.swap_profiler( nullptr );
+
+    std::FILE *file = std::tmpfile();
+    REQUIRE( file );
+    REQUIRE_FALSE( profiler.export_folded( file ) );
+
+    std::string folded( std::size_t( std::ftell( file ) ), '\0' );
+    std::rewind( file );
+    REQUIRE( std::fread( &folded[0], 1, folded.size(), file ) == folded.size() );
+    std::fclose( file );
+
+    REQUIRE( folded == "exit 2\n"
+                       "main 3\n" );
+  }
+
+  SECTION( "A version 1 executable has no symbol table" )
+  {
+    auto header = make_header( std::uint32_t( data.size() ), std::uint32_t( text.size() * 4 ) );
+    header.version = 1;
+
+    auto image = make_image( header, data, text );
+    image.resize( image.size() - 4 );
+
+    REQUIRE( !machine.load( image.data() ) );
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( terminal->out_string == "Hi!" );
+  }
+
+  SECTION( "Without .text the entry point is .ktext" )
+  {
+    auto header = make_header( std::uint32_t( data.size() ), 0 );
+    header.ktext_sz = std::uint32_t( text.size() * 4 );
+    header.ktext_addr = 0x8000'0000;
+
+    auto const image = make_image( header, data, text );
+
+    REQUIRE( !machine.load( image.data() ) );
+    REQUIRE( machine.get_inspector().CPU_pc() == 0x8000'0000 );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( terminal->out_string == "Hi!" );
+  }
+
+  SECTION( "An invalid header is rejected and the Machine is untouched" )
+  {
+    auto inspector = machine.get_inspector();
+    inspector.CPU_pc() = 0x1234'5678;
+
+    auto header = make_header( std::uint32_t( data.size() ), std::uint32_t( text.size() * 4 ) );
+
+    SECTION( "Wrong magic" )
+    {
+      header.magic[0] = 'F';
+    }
+
+    SECTION( "Unknown version" )
+    {
+      header.version = ExecutableHeader::current_version + 1;
+    }
+
+    SECTION( "Version 0" )
+    {
+      header.version = 0;
+    }
+
+    SECTION( "No code" )
+    {
+      header.text_sz = 0;
+    }
+
+    SECTION( "Misaligned entry point" )
+    {
+      header.text_addr = 0x0040'0002;
+    }
+
+    SECTION( "A section wraps around the address space" )
+    {
+      header.data_addr = 0xFFFF'FFFE;
+    }
+
+    auto const image = make_image( header, data, text );
+
+    REQUIRE( machine.load( image.data() ) );
+    REQUIRE( inspector.CPU_pc() == 0x1234'5678 );
+  }
+}
@@ -0,0 +1,226 @@
+#include <catch.hpp>
+
+#include <mips32/memory_tracer.hpp>
+#include <mips32/machine_inspector.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using Kind = MemoryTracer::Kind;
+
+TEST_CASE( "A MemoryTracer records memory accesses" )
+{
+  std::FILE *file = std::tmpfile();
+  REQUIRE( file );
+
+  std::vector<MemoryTracer::Access> accesses;
+  std::uint64_t                     dropped = 0;
+
+  SECTION( "The accesses are read back in order" )
+  {
+    std::vector<MemoryTracer::Access> const recorded{
+        { 0xBFC0'0000, Kind::FETCH, 4 },
+        { 0x0000'1000, Kind::LOAD, 4 },
+        { 0xBFC0'0004, Kind::FETCH, 4 },
+        { 0x0000'0FFF, Kind::STORE, 1 },
+        { 0x0000'0002, Kind::LOAD, 2 }, // backwards
+        { 0xFFFF'FFFC, Kind::STORE, 4 },
+        { 0x0000'0010, Kind::LOAD, 8 },
+        { 0x0000'0020, Kind::STORE, 16 },
+    };
+
+    {
+      MemoryTracer tracer{ file };
+
+      for ( auto const &access : recorded )
+        tracer.record( access.kind, access.address, access.size );
+
+      tracer.flush();
+      REQUIRE( std::ftell( file ) > 8 );
+    }
+
+    std::rewind( file );
+    REQUIRE_FALSE( MemoryTracer::read_trace( file, accesses, &dropped ) );
+
+    REQUIRE( dropped == 0 );
+    REQUIRE( accesses.size() == recorded.size() );
+
+    for ( std::size_t i = 0; i < recorded.size(); ++i )
+    {
+      REQUIRE( accesses[i].address == recorded[i].address );
+      REQUIRE( accesses[i].kind == recorded[i].kind );
+      REQUIRE( accesses[i].size == recorded[i].size );
+    }
+  }
+
+  SECTION( "Sequential fetches take a byte each" )
+  {
+    {
+      MemoryTracer tracer{ file };
+
+      for ( std::uint32_t i = 0; i < 1000; ++i )
+        tracer.record( Kind::FETCH, 0x0040'0000 + i * 4, 4 );
+    }
+
+    // header, the first fetch and 999 sequential fetches
+    REQUIRE( std::ftell( file ) <= 8 + 5 + 2 * 999 );
+  }
+
+  SECTION( "A full ring blocks the producer" )
+  {
+    constexpr std::uint32_t count{ 100'000 };
+
+    {
+      MemoryTracer tracer{ file, 16, MemoryTracer::Overflow::BLOCK };
+
+      for ( std::uint32_t i = 0; i < count; ++i )
+        tracer.record( Kind::LOAD, i * 4, 4 );
+
+      REQUIRE( tracer.dropped() == 0 );
+    }
+
+    std::rewind( file );
+    REQUIRE_FALSE( MemoryTracer::read_trace( file, accesses, &dropped ) );
+
+    REQUIRE( dropped == 0 );
+    REQUIRE( accesses.size() == count );
+
+    bool ordered = true;
+    for ( std::uint32_t i = 0; i < count; ++i )
+      ordered &= accesses[i].address == i * 4;
+
+    REQUIRE( ordered );
+  }
+
+  SECTION( "A full ring drops the accesses" )
+  {
+    constexpr std::uint32_t count{ 100'000 };
+
+    std::uint64_t tracer_dropped;
+
+    {
+      MemoryTracer tracer{ file, 16, MemoryTracer::Overflow::DROP };
+
+      for ( std::uint32_t i = 0; i < count; ++i )
+        tracer.record( Kind::STORE, i * 4, 4 );
+
+      tracer.flush();
+      tracer_dropped = tracer.dropped();
+    }
+
+    std::rewind( file );
+    REQUIRE_FALSE( MemoryTracer::read_trace( file, accesses, &dropped ) );
+
+    REQUIRE( dropped == tracer_dropped );
+    REQUIRE( accesses.size() + dropped == count );
+  }
+
+  SECTION( "The CPU records fetches, loads and stores" )
+  {
+    RAM ram{ 64_KB };
+    CPU cpu{ ram };
+    cpu.hard_reset();
+
+    MachineInspector inspector;
+    inspector.inspect( cpu );
+
+    auto gpr = inspector.CPU_gpr_begin();
+    gpr[1] = 0xBFC0'0100;
+
+    ram[0xBFC0'0000] = "LW"_cpu | 1_rs | 2_rt | 8_imm16;
+    ram[0xBFC0'0004] = "SB"_cpu | 1_rs | 2_rt | 3_imm16;
+    ram[0xBFC0'0008] = "LHU"_cpu | 1_rs | 2_rt | 2_imm16;
+
+    {
+      MemoryTracer tracer{ file };
+      REQUIRE( cpu.attach_tracer( &tracer ) == nullptr );
+
+      for ( int i = 0; i < 3; ++i )
+        cpu.single_step();
+
+      REQUIRE( cpu.attach_tracer( nullptr ) == &tracer );
+    }
+
+    std::rewind( file );
+    REQUIRE_FALSE( MemoryTracer::read_trace( file, accesses ) );
+
+    REQUIRE( accesses.size() == 6 );
+
+    REQUIRE( accesses[0].kind == Kind::FETCH );
+    REQUIRE( accesses[0].address == 0xBFC0'0000 );
+    REQUIRE( accesses[1].kind == Kind::LOAD );
+    REQUIRE( accesses[1].address == 0xBFC0'0108 );
+    REQUIRE( accesses[1].size == 4 );
+
+    REQUIRE( accesses[2].kind == Kind::FETCH );
+    REQUIRE( accesses[2].address == 0xBFC0'0004 );
+    REQUIRE( accesses[3].kind == Kind::STORE );
+    REQUIRE( accesses[3].address == 0xBFC0'0103 );
+    REQUIRE( accesses[3].size == 1 );
+
+    REQUIRE( accesses[4].kind == Kind::FETCH );
+    REQUIRE( accesses[4].address == 0xBFC0'0008 );
+    REQUIRE( accesses[5].kind == Kind::LOAD );
+    REQUIRE( accesses[5].address == 0xBFC0'0102 );
+    REQUIRE( accesses[5].size == 2 );
+  }
+
+  SECTION( "The CPU records a doubleword or a vector access once" )
+  {
+    RAM ram{ 64_KB };
+    CPU cpu{ ram };
+    cpu.hard_reset();
+
+    MachineInspector inspector;
+    inspector.inspect( cpu );
+
+    auto gpr = inspector.CPU_gpr_begin();
+    gpr[1] = 0xBFC0'0100;
+
+    auto const msa = 0b011110u << 26;
+
+    ram[0xBFC0'0000] = "LDC1"_cpu | 1_rs | 0_rt | 8_imm16;
+    ram[0xBFC0'0004] = "SDC1"_cpu | 1_rs | 0_rt | 16_imm16;
+    ram[0xBFC0'0008] = msa | 2 << 16 | 1 << 11 | 1 << 6 | 0x22; // LD.W $w1, 8($1)
+    ram[0xBFC0'000C] = msa | 4 << 16 | 1 << 11 | 1 << 6 | 0x26; // ST.W $w1, 16($1)
+
+    {
+      MemoryTracer tracer{ file };
+      cpu.attach_tracer( &tracer );
+
+      for ( int i = 0; i < 4; ++i )
+        cpu.single_step();
+
+      cpu.attach_tracer( nullptr );
+    }
+
+    std::rewind( file );
+    REQUIRE_FALSE( MemoryTracer::read_trace( file, accesses ) );
+
+    REQUIRE( accesses.size() == 8 );
+
+    REQUIRE( accesses[1].kind == Kind::LOAD );
+    REQUIRE( accesses[1].address == 0xBFC0'0108 );
+    REQUIRE( accesses[1].size == 8 );
+
+    REQUIRE( accesses[3].kind == Kind::STORE );
+    REQUIRE( accesses[3].address == 0xBFC0'0110 );
+    REQUIRE( accesses[3].size == 8 );
+
+    REQUIRE( accesses[5].kind == Kind::LOAD );
+    REQUIRE( accesses[5].address == 0xBFC0'0108 );
+    REQUIRE( accesses[5].size == 16 );
+
+    REQUIRE( accesses[7].kind == Kind::STORE );
+    REQUIRE( accesses[7].address == 0xBFC0'0110 );
+    REQUIRE( accesses[7].size == 16 );
+  }
+
+  std::fclose( file );
+}
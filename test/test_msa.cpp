@@ -0,0 +1,411 @@
+#include <catch.hpp>
+
+#include "../src/cp1.hpp"
+#include <mips32/machine_inspector.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace mips32;
+
+using Vector = std::array<std::uint64_t, 2>;
+
+constexpr std::uint32_t MSA{ 0b011110 << 26 };
+
+constexpr std::uint32_t DF_B{ 0 };
+constexpr std::uint32_t DF_H{ 1 };
+constexpr std::uint32_t DF_W{ 2 };
+constexpr std::uint32_t DF_D{ 3 };
+
+// 3R format: operation, data format, wt, ws, wd, minor opcode
+constexpr std::uint32_t r3( std::uint32_t op, std::uint32_t df, std::uint32_t wt, std::uint32_t ws, std::uint32_t wd, std::uint32_t minor )
+{
+  return MSA | op << 23 | df << 21 | wt << 16 | ws << 11 | wd << 6 | minor;
+}
+
+// 3RF format: operation, 0 for float and 1 for double, wt, ws, wd, minor opcode
+constexpr std::uint32_t r3f( std::uint32_t op, std::uint32_t df, std::uint32_t wt, std::uint32_t ws, std::uint32_t wd, std::uint32_t minor )
+{
+  return MSA | op << 22 | df << 21 | wt << 16 | ws << 11 | wd << 6 | minor;
+}
+
+// 2RF format: operation, 0 for float and 1 for double, ws, wd
+constexpr std::uint32_t r2f( std::uint32_t op, std::uint32_t df, std::uint32_t ws, std::uint32_t wd )
+{
+  return MSA | ( 0b1'1001'0000 | op ) << 17 | df << 16 | ws << 11 | wd << 6 | 0x1E;
+}
+
+// ELM format: operation, df/n, ws, wd
+constexpr std::uint32_t elm( std::uint32_t op, std::uint32_t df_n, std::uint32_t ws, std::uint32_t wd )
+{
+  return MSA | op << 22 | df_n << 16 | ws << 11 | wd << 6 | 0x19;
+}
+
+template<typename T>
+Vector pack( std::initializer_list<T> elements )
+{
+  Vector v{};
+  std::memcpy( v.data(), elements.begin(), sizeof( v ) );
+  return v;
+}
+
+struct Running
+{
+  CP1 &cp1;
+
+  explicit Running( CP1 &cp1 ) noexcept : cp1( cp1 ) { cp1.enter(); }
+  ~Running() noexcept { cp1.leave(); }
+};
+
+TEST_CASE( "MSA integer arithmetic" )
+{
+  CP1 cp1;
+  cp1.reset();
+
+  Running running{ cp1 };
+
+  MachineInspector inspector;
+  inspector.inspect( cp1 );
+
+  std::array<std::uint32_t, 32> gpr{};
+
+  SECTION( "ADDV and SUBV wrap around" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::uint32_t>( { 1, 0xFFFF'FFFF, 3, 0x7FFF'FFFF } ) );
+    inspector.CP1_write_vpr( 2, pack<std::uint32_t>( { 2, 1, 4, 1 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 0, DF_W, 2, 1, 3, 0x0E ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint32_t>( { 3, 0, 7, 0x8000'0000 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 1, DF_D, 2, 1, 4, 0x0E ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 4 ) == Vector{ 0xFFFF'FFFF'0000'0001 - 0x0000'0001'0000'0002, 0x7FFF'FFFF'0000'0003 - 0x0000'0001'0000'0004 } );
+  }
+
+  SECTION( "The lower half of a vector register is the FPR" )
+  {
+    inspector.CP1_write_vpr( 1, Vector{ 0x1111'2222'3333'4444, 0x5555'6666'7777'8888 } );
+
+    REQUIRE( ( inspector.CP1_fpr_begin() + 1 )->i64 == 0x1111'2222'3333'4444 );
+    REQUIRE( cp1.mfhc1( 1 ) == 0x1111'2222 );
+  }
+
+  SECTION( "ADDS_S, ADDS_U and SUBS_U saturate" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int8_t>( { 100, -100, 127, -128, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 } ) );
+    inspector.CP1_write_vpr( 2, pack<std::int8_t>( { 100, -100, 1, -1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 2, DF_B, 2, 1, 3, 0x10 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int8_t>( { 127, -128, 127, -128, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24 } ) );
+
+    inspector.CP1_write_vpr( 1, pack<std::uint32_t>( { 0xFFFF'FFF0, 1, 5, 0 } ) );
+    inspector.CP1_write_vpr( 2, pack<std::uint32_t>( { 0x20, 2, 7, 0 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 3, DF_W, 2, 1, 3, 0x10 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint32_t>( { 0xFFFF'FFFF, 3, 12, 0 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 1, DF_W, 2, 1, 3, 0x11 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint32_t>( { 0xFFFF'FFD0, 0, 0, 0 } ) );
+  }
+
+  SECTION( "MAX_S, MIN_U and compare produce the expected elements" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int16_t>( { -1, 2, -3, 4, 5, 6, 7, 8 } ) );
+    inspector.CP1_write_vpr( 2, pack<std::int16_t>( { 1, -2, 3, -4, 5, 6, 7, 9 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 2, DF_H, 2, 1, 3, 0x0E ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int16_t>( { 1, 2, 3, 4, 5, 6, 7, 9 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 5, DF_H, 2, 1, 3, 0x0E ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int16_t>( { 1, 2, 3, 4, 5, 6, 7, 8 } ) );
+
+    // CLT_S
+    REQUIRE( cp1.execute_msa( r3( 2, DF_H, 2, 1, 3, 0x0F ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int16_t>( { -1, 0, -1, 0, 0, 0, 0, -1 } ) );
+
+    // CEQ
+    REQUIRE( cp1.execute_msa( r3( 0, DF_H, 2, 1, 3, 0x0F ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int16_t>( { 0, 0, 0, 0, -1, -1, -1, 0 } ) );
+  }
+
+  SECTION( "MULV, DIV_S and MOD_U, division by zero gives 0" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int32_t>( { 7, -7, 100, std::numeric_limits<std::int32_t>::min() } ) );
+    inspector.CP1_write_vpr( 2, pack<std::int32_t>( { 2, 2, 0, -1 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 0, DF_W, 2, 1, 3, 0x12 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 14, -14, 0, std::numeric_limits<std::int32_t>::min() } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 4, DF_W, 2, 1, 3, 0x12 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 3, -3, 0, std::numeric_limits<std::int32_t>::min() } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 7, DF_W, 2, 1, 3, 0x12 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint32_t>( { 1, 0xFFFF'FFF9 % 2, 0, 0x8000'0000 % 0xFFFF'FFFF } ) );
+  }
+
+  SECTION( "DOTP_S multiplies adjacent halves" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int16_t>( { 1, 2, 3, 4, -5, 6, 7, 8 } ) );
+    inspector.CP1_write_vpr( 2, pack<std::int16_t>( { 10, 20, 30, 40, 50, 60, 70, -80 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 0, DF_W, 2, 1, 3, 0x13 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 50, 250, 110, -150 } ) );
+
+    // The byte format is reserved
+    REQUIRE( cp1.execute_msa( r3( 0, DF_B, 2, 1, 3, 0x13 ), gpr ) == CP1::RESERVED );
+  }
+
+  SECTION( "Immediate forms: ADDVI, CLTI_S, LDI and SLLI" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int32_t>( { 1, -2, 3, -4 } ) );
+
+    REQUIRE( cp1.execute_msa( MSA | 0 << 23 | DF_W << 21 | 5 << 16 | 1 << 11 | 3 << 6 | 0x06, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 6, 3, 8, 1 } ) );
+
+    // CLTI_S with -3
+    REQUIRE( cp1.execute_msa( MSA | 2 << 23 | DF_W << 21 | 0b11101 << 16 | 1 << 11 | 3 << 6 | 0x07, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 0, 0, 0, -1 } ) );
+
+    // LDI.H with -2
+    REQUIRE( cp1.execute_msa( MSA | 6 << 23 | DF_H << 21 | 0x3FE << 11 | 3 << 6 | 0x07, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ 0xFFFE'FFFE'FFFE'FFFE, 0xFFFE'FFFE'FFFE'FFFE } );
+
+    // SLLI.W by 4
+    REQUIRE( cp1.execute_msa( MSA | 0 << 23 | ( 0b10'00100 ) << 16 | 1 << 11 | 3 << 6 | 0x09, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 16, -32, 48, -64 } ) );
+  }
+}
+
+TEST_CASE( "MSA logic and shuffles" )
+{
+  CP1 cp1;
+  cp1.reset();
+
+  Running running{ cp1 };
+
+  MachineInspector inspector;
+  inspector.inspect( cp1 );
+
+  std::array<std::uint32_t, 32> gpr{};
+
+  Vector const a = pack<std::uint8_t>( { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 } );
+  Vector const b = pack<std::uint8_t>( { 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31 } );
+
+  inspector.CP1_write_vpr( 1, a );
+  inspector.CP1_write_vpr( 2, b );
+
+  SECTION( "AND.V, XORI.B and BSEL.V" )
+  {
+    REQUIRE( cp1.execute_msa( MSA | 0 << 21 | 2 << 16 | 1 << 11 | 3 << 6 | 0x1E, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ a[0] & b[0], a[1] & b[1] } );
+
+    REQUIRE( cp1.execute_msa( MSA | 3 << 24 | 0xFF << 16 | 1 << 11 | 3 << 6 | 0x00, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ ~a[0], ~a[1] } );
+
+    inspector.CP1_write_vpr( 3, Vector{ 0xFFFF'FFFF'0000'0000, 0 } );
+    REQUIRE( cp1.execute_msa( MSA | 6 << 21 | 2 << 16 | 1 << 11 | 3 << 6 | 0x1E, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ ( b[0] & 0xFFFF'FFFF'0000'0000 ) | ( a[0] & 0xFFFF'FFFF ), a[1] } );
+  }
+
+  SECTION( "ILVR and ILVL interleave the halves" )
+  {
+    REQUIRE( cp1.execute_msa( r3( 5, DF_B, 2, 1, 3, 0x14 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint8_t>( { 16, 0, 17, 1, 18, 2, 19, 3, 20, 4, 21, 5, 22, 6, 23, 7 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 4, DF_W, 2, 1, 3, 0x14 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint8_t>( { 24, 25, 26, 27, 8, 9, 10, 11, 28, 29, 30, 31, 12, 13, 14, 15 } ) );
+  }
+
+  SECTION( "PCKEV takes the even elements" )
+  {
+    REQUIRE( cp1.execute_msa( r3( 2, DF_H, 2, 1, 3, 0x14 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint8_t>( { 16, 17, 20, 21, 24, 25, 28, 29, 0, 1, 4, 5, 8, 9, 12, 13 } ) );
+  }
+
+  SECTION( "SHF.W reorders each group of 4 elements" )
+  {
+    // 3, 2, 1, 0
+    REQUIRE( cp1.execute_msa( MSA | 2 << 24 | 0b00'01'10'11 << 16 | 1 << 11 | 3 << 6 | 0x02, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint8_t>( { 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 } ) );
+  }
+
+  SECTION( "VSHF.B selects from the concatenation, bits 6 and 7 give 0" )
+  {
+    inspector.CP1_write_vpr( 3, pack<std::uint8_t>( { 0, 16, 31, 15, 0x40, 0x80, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21 } ) );
+
+    REQUIRE( cp1.execute_msa( r3( 0, DF_B, 2, 1, 3, 0x15 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::uint8_t>( { 16, 0, 15, 31, 0, 0, 17, 1, 18, 2, 19, 3, 20, 4, 21, 5 } ) );
+  }
+
+  SECTION( "SPLAT and SPLATI replicate an element" )
+  {
+    gpr[4] = 5 + 16; // modulo the number of elements
+
+    REQUIRE( cp1.execute_msa( r3( 1, DF_B, 4, 1, 3, 0x14 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ 0x0505'0505'0505'0505, 0x0505'0505'0505'0505 } );
+
+    REQUIRE( cp1.execute_msa( elm( 1, 0b11'1001, 2, 3 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ b[1], b[1] } );
+  }
+
+  SECTION( "COPY_S, COPY_U, INSERT, INSVE and MOVE.V" )
+  {
+    inspector.CP1_write_vpr( 1, pack<std::int16_t>( { 0, 1, -2, 3, 4, 5, 6, 7 } ) );
+
+    REQUIRE( cp1.execute_msa( elm( 2, 0b10'0010, 1, 8 ), gpr ) == CP1::NONE );
+    REQUIRE( gpr[8] == 0xFFFF'FFFE );
+
+    REQUIRE( cp1.execute_msa( elm( 3, 0b10'0010, 1, 8 ), gpr ) == CP1::NONE );
+    REQUIRE( gpr[8] == 0xFFFE );
+
+    gpr[9] = 0xDEAD'BEEF;
+    REQUIRE( cp1.execute_msa( elm( 4, 0b11'0011, 9, 2 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 2 ) == Vector{ b[0], 0xDEAD'BEEF'0000'0000 | ( b[1] & 0xFFFF'FFFF ) } );
+
+    REQUIRE( cp1.execute_msa( elm( 5, 0b00'0000, 1, 2 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 2 )[0] == ( b[0] & ~0xFFull ) );
+
+    REQUIRE( cp1.execute_msa( elm( 2, 0b11'1110, 1, 5 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 5 ) == inspector.CP1_read_vpr( 1 ) );
+
+    // GPRs are 32-bit
+    REQUIRE( cp1.execute_msa( elm( 2, 0b11'1000, 1, 8 ), gpr ) == CP1::RESERVED );
+  }
+
+  SECTION( "FILL, PCNT and NLZC" )
+  {
+    gpr[4] = 0x0000'00F0;
+
+    REQUIRE( cp1.execute_msa( MSA | 0xC0 << 18 | DF_H << 16 | 4 << 11 | 3 << 6 | 0x1E, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ 0x00F0'00F0'00F0'00F0, 0x00F0'00F0'00F0'00F0 } );
+
+    REQUIRE( cp1.execute_msa( MSA | 0xC1 << 18 | DF_H << 16 | 3 << 11 | 4 << 6 | 0x1E, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 4 ) == Vector{ 0x0004'0004'0004'0004, 0x0004'0004'0004'0004 } );
+
+    REQUIRE( cp1.execute_msa( MSA | 0xC3 << 18 | DF_H << 16 | 3 << 11 | 4 << 6 | 0x1E, gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 4 ) == Vector{ 0x0008'0008'0008'0008, 0x0008'0008'0008'0008 } );
+  }
+
+  SECTION( "The branch conditions" )
+  {
+    constexpr std::uint32_t BZ_V{ 0x11 << 26 | 0b01'011 << 21 };
+    constexpr std::uint32_t BNZ_V{ 0x11 << 26 | 0b01'111 << 21 };
+    constexpr std::uint32_t BZ_B{ 0x11 << 26 | 0b11'000 << 21 };
+    constexpr std::uint32_t BNZ_W{ 0x11 << 26 | 0b11'110 << 21 };
+
+    inspector.CP1_write_vpr( 3, Vector{ 0, 0 } );
+
+    REQUIRE( cp1.msa_condition( BZ_V | 3 << 16 ) );
+    REQUIRE_FALSE( cp1.msa_condition( BNZ_V | 3 << 16 ) );
+
+    REQUIRE_FALSE( cp1.msa_condition( BZ_V | 1 << 16 ) );
+    REQUIRE( cp1.msa_condition( BNZ_V | 1 << 16 ) );
+
+    // `a` has a zero byte, but every word is non zero
+    REQUIRE( cp1.msa_condition( BZ_B | 1 << 16 ) );
+    REQUIRE( cp1.msa_condition( BNZ_W | 1 << 16 ) );
+    REQUIRE_FALSE( cp1.msa_condition( BNZ_W | 3 << 16 ) );
+  }
+
+  SECTION( "Unimplemented instructions are reserved" )
+  {
+    REQUIRE( cp1.execute_msa( r3( 0, DF_B, 2, 1, 3, 0x14 ), gpr ) == CP1::RESERVED ); // SLD
+    REQUIRE( cp1.execute_msa( MSA | 0x3F, gpr ) == CP1::RESERVED );
+  }
+}
+
+TEST_CASE( "MSA floating point" )
+{
+  CP1 cp1;
+  cp1.reset();
+
+  Running running{ cp1 };
+
+  MachineInspector inspector;
+  inspector.inspect( cp1 );
+
+  std::array<std::uint32_t, 32> gpr{};
+
+  SECTION( "FADD.W, FMUL.D and FSQRT.W" )
+  {
+    inspector.CP1_write_vpr( 1, pack<float>( { 1.5f, -2.0f, 4.0f, 0.25f } ) );
+    inspector.CP1_write_vpr( 2, pack<float>( { 0.5f, 3.0f, 5.0f, 0.75f } ) );
+
+    REQUIRE( cp1.execute_msa( r3f( 0, 0, 2, 1, 3, 0x1B ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<float>( { 2.0f, 1.0f, 9.0f, 1.0f } ) );
+
+    REQUIRE( cp1.execute_msa( r2f( 3, 0, 3, 4 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 4 ) == pack<float>( { std::sqrt( 2.0f ), 1.0f, 3.0f, 1.0f } ) );
+
+    inspector.CP1_write_vpr( 1, pack<double>( { 1.5, -2.0 } ) );
+    inspector.CP1_write_vpr( 2, pack<double>( { 4.0, 0.5 } ) );
+
+    REQUIRE( cp1.execute_msa( r3f( 2, 1, 2, 1, 3, 0x1B ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<double>( { 6.0, -1.0 } ) );
+  }
+
+  SECTION( "Comparisons give all ones or all zeros" )
+  {
+    inspector.CP1_write_vpr( 1, pack<double>( { 1.0, std::numeric_limits<double>::quiet_NaN() } ) );
+    inspector.CP1_write_vpr( 2, pack<double>( { 2.0, 1.0 } ) );
+
+    // FCLT
+    REQUIRE( cp1.execute_msa( r3f( 4, 1, 2, 1, 3, 0x1A ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ ~0ull, 0 } );
+
+    // FCULT
+    REQUIRE( cp1.execute_msa( r3f( 5, 1, 2, 1, 3, 0x1A ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ ~0ull, ~0ull } );
+
+    // FCNE
+    REQUIRE( cp1.execute_msa( r3f( 3, 1, 2, 1, 3, 0x1C ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ ~0ull, 0 } );
+  }
+
+  SECTION( "The rounding mode comes from MSACSR, not FCSR" )
+  {
+    gpr[4] = 1; // Round Toward Zero
+    REQUIRE( cp1.execute_msa( elm( 0, 0b11'1110, 4, 1 ), gpr ) == CP1::NONE );
+
+    REQUIRE( cp1.execute_msa( elm( 1, 0b11'1110, 1, 5 ), gpr ) == CP1::NONE );
+    REQUIRE( gpr[5] == 1 );
+
+    inspector.CP1_write_vpr( 1, pack<double>( { 1.0, -1.0 } ) );
+    inspector.CP1_write_vpr( 2, pack<double>( { 10.0, 10.0 } ) );
+
+    REQUIRE( cp1.execute_msa( r3f( 3, 1, 2, 1, 3, 0x1B ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<double>( { std::nextafter( 0.1, 0.0 ), -std::nextafter( 0.1, 0.0 ) } ) );
+
+    // Inexact is accumulated in the flags and cause fields of MSACSR only
+    REQUIRE( ( inspector.CP1_msacsr() & 0x3F << 12 ) == CP1::INEXACT << 12 );
+    REQUIRE( ( inspector.CP1_msacsr() >> 2 & 0x1F ) == CP1::INEXACT );
+    REQUIRE( ( inspector.CP1_fcsr() & 0x0003'F07C ) == 0 );
+  }
+
+  SECTION( "An enabled exception traps and doesn't write the result" )
+  {
+    gpr[4] = CP1::DIVBYZERO << 7;
+    REQUIRE( cp1.execute_msa( elm( 0, 0b11'1110, 4, 1 ), gpr ) == CP1::NONE );
+
+    inspector.CP1_write_vpr( 1, pack<float>( { 1.0f, 1.0f, 1.0f, 1.0f } ) );
+    inspector.CP1_write_vpr( 2, pack<float>( { 1.0f, 0.0f, 1.0f, 1.0f } ) );
+    inspector.CP1_write_vpr( 3, Vector{ 0, 0 } );
+
+    REQUIRE( cp1.execute_msa( r3f( 3, 0, 2, 1, 3, 0x1B ), gpr ) == CP1::DIVBYZERO );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == Vector{ 0, 0 } );
+    REQUIRE( ( inspector.CP1_msacsr() >> 2 & 0x1F ) == 0 );
+  }
+
+  SECTION( "FTINT_S saturates and signals Invalid Operation" )
+  {
+    inspector.CP1_write_vpr( 1, pack<float>( { 2.5f, -3.5f, 1e20f, std::numeric_limits<float>::quiet_NaN() } ) );
+
+    REQUIRE( cp1.execute_msa( r2f( 12, 0, 1, 3 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<std::int32_t>( { 2, -4, std::numeric_limits<std::int32_t>::max(), 0 } ) );
+    REQUIRE( ( inspector.CP1_msacsr() >> 2 & CP1::INVALID ) );
+
+    inspector.CP1_write_vpr( 1, pack<std::int32_t>( { 1, -2, 3, -4 } ) );
+    REQUIRE( cp1.execute_msa( r2f( 14, 0, 1, 3 ), gpr ) == CP1::NONE );
+    REQUIRE( inspector.CP1_read_vpr( 3 ) == pack<float>( { 1.0f, -2.0f, 3.0f, -4.0f } ) );
+  }
+}
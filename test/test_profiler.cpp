@@ -0,0 +1,168 @@
+#include <catch.hpp>
+
+#include <mips32/machine_inspector.hpp>
+#include <mips32/profiler.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdio>
+#include <string>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+std::string folded( Profiler const &profiler )
+{
+  std::FILE *file = std::tmpfile();
+  REQUIRE( file );
+  REQUIRE_FALSE( profiler.export_folded( file ) );
+
+  std::string text( std::size_t( std::ftell( file ) ), '\0' );
+  std::rewind( file );
+  REQUIRE( std::fread( &text[0], 1, text.size(), file ) == text.size() );
+  std::fclose( file );
+
+  return text;
+}
+} // namespace
+
+TEST_CASE( "A Profiler samples the guest's code" )
+{
+  RAM ram{ 64_KB };
+  CPU cpu{ ram };
+  cpu.hard_reset();
+
+  // main:
+  //   JAL func
+  //   NOP
+  //   NOP
+  // func:
+  //   NOP
+  //   NOP
+  //   NOP
+  //   JR $ra
+  ram[0xBFC0'0000] = "JAL"_cpu | ( 0xBFC0'0100 >> 2 & 0x03FF'FFFF );
+  ram[0xBFC0'0004] = "SLL"_cpu;
+  ram[0xBFC0'0008] = "SLL"_cpu;
+
+  ram[0xBFC0'0100] = "SLL"_cpu;
+  ram[0xBFC0'0104] = "SLL"_cpu;
+  ram[0xBFC0'0108] = "SLL"_cpu;
+  ram[0xBFC0'010C] = "JR"_cpu | 31_rs;
+
+  Profiler profiler{ 1 };
+  REQUIRE( cpu.attach_profiler( &profiler ) == nullptr );
+
+  SECTION( "Without symbols the addresses are printed" )
+  {
+    for ( int i = 0; i < 6; ++i )
+      cpu.single_step();
+
+    REQUIRE( profiler.sample_no() == 6 );
+    REQUIRE( folded( profiler ) == "0xBFC00000 1\n"
+                                   "0xBFC00004;0xBFC00100 1\n"
+                                   "0xBFC00004;0xBFC00100;0xBFC00104 1\n"
+                                   "0xBFC00004;0xBFC00100;0xBFC00108 1\n"
+                                   "0xBFC00004;0xBFC00100;0xBFC0010C 1\n"
+                                   "0xBFC00008 1\n" );
+  }
+
+  SECTION( "The symbols are loaded from a file" )
+  {
+    std::FILE *symbols = std::tmpfile();
+    REQUIRE( symbols );
+    std::fputs( "bfc00000 T main\n"
+                "this line is ignored\n"
+                "BFC00100 func\n",
+                symbols );
+    std::rewind( symbols );
+
+    REQUIRE_FALSE( profiler.load_symbols( symbols ) );
+    std::fclose( symbols );
+
+    for ( int i = 0; i < 6; ++i )
+      cpu.single_step();
+
+    REQUIRE( folded( profiler ) == "main 2\n"
+                                   "main;func 4\n" );
+  }
+
+  SECTION( "Calls past the maximum depth aren't tracked" )
+  {
+    Profiler shallow{ 2, 0 };
+    cpu.attach_profiler( &shallow );
+
+    shallow.add_symbol( 0xBFC0'0000, "main" );
+    shallow.add_symbol( 0xBFC0'0100, "func" );
+
+    for ( int i = 0; i < 6; ++i )
+      cpu.single_step();
+
+    REQUIRE( shallow.sample_no() == 3 );
+    REQUIRE( folded( shallow ) == "func 2\n"
+                                  "main 1\n" );
+
+    shallow.clear();
+
+    REQUIRE( shallow.sample_no() == 0 );
+    REQUIRE( folded( shallow ).empty() );
+  }
+
+  SECTION( "A jump table past the maximum depth isn't a return" )
+  {
+    // main:
+    //   $a0 = 2, $sp = 0xBFC0'0F00
+    //   JAL f
+    //   NOP
+    //   NOP
+    // f:
+    //   push $ra
+    //   if ( $a0 ) { --$a0; JAL f; NOP }
+    //   jump table: JR to the next instruction
+    //   pop $ra
+    //   JR $ra
+    ram[0xBFC0'0000] = "ORI"_cpu | 4_rt | 0_rs | 2;
+    ram[0xBFC0'0004] = "AUI"_cpu | 29_rt | 0_rs | 0xBFC0;
+    ram[0xBFC0'0008] = "ORI"_cpu | 29_rt | 29_rs | 0x0F00;
+    ram[0xBFC0'000C] = "JAL"_cpu | ( 0xBFC0'0100 >> 2 & 0x03FF'FFFF );
+    ram[0xBFC0'0010] = "SLL"_cpu;
+    ram[0xBFC0'0014] = "SLL"_cpu;
+
+    ram[0xBFC0'0100] = "ADDIU"_cpu | 29_rt | 29_rs | 0xFFFC;
+    ram[0xBFC0'0104] = "SW"_cpu | 31_rt | 29_rs | 0;
+    ram[0xBFC0'0108] = "BEQ"_cpu | 4_rs | 0_rt | 4;
+    ram[0xBFC0'010C] = "ADDIU"_cpu | 4_rt | 4_rs | 0xFFFF;
+    ram[0xBFC0'0110] = "JAL"_cpu | ( 0xBFC0'0100 >> 2 & 0x03FF'FFFF );
+    ram[0xBFC0'0114] = "SLL"_cpu;
+    ram[0xBFC0'0118] = "SLL"_cpu;
+    ram[0xBFC0'011C] = "AUI"_cpu | 8_rt | 0_rs | 0xBFC0;
+    ram[0xBFC0'0120] = "ORI"_cpu | 8_rt | 8_rs | 0x0128;
+    ram[0xBFC0'0124] = "JR"_cpu | 8_rs;
+    ram[0xBFC0'0128] = "LW"_cpu | 31_rt | 29_rs | 0;
+    ram[0xBFC0'012C] = "ADDIU"_cpu | 29_rt | 29_rs | 4;
+    ram[0xBFC0'0130] = "JR"_cpu | 31_rs;
+
+    // f( 0 ) isn't tracked and it returns where f( 1 ) did
+    Profiler shallow{ 1, 2 };
+    cpu.attach_profiler( &shallow );
+
+    shallow.add_symbol( 0xBFC0'0000, "main" );
+    shallow.add_symbol( 0xBFC0'0100, "f" );
+
+    for ( int i = 0; i < 38; ++i )
+      cpu.single_step();
+
+    MachineInspector inspector;
+    inspector.inspect( cpu );
+
+    REQUIRE( inspector.CPU_pc() == 0xBFC0'0018 );
+    REQUIRE( folded( shallow ) == "main 5\n"
+                                  "main;f 12\n"
+                                  "main;f;f 21\n" );
+  }
+
+  cpu.attach_profiler( nullptr );
+}
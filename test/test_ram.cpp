@@ -89,3 +89,43 @@ TEST_CASE( "A RAM object exists and can allocate 1 block only" )
     REQUIRE( inspector.RAM_allocated_addresses()[0] == std::uint32_t( 0 ) );
   }
 }
+
+TEST_CASE( "A RAM object is accessed through hints while its blocks are reordered and swapped" )
+{
+  MachineInspector inspector;
+
+  RAM ram{ 2 * RAM::block_size };
+
+  inspector.inspect( ram );
+
+  std::size_t first_hint = 0, second_hint = 0;
+
+  // Every block holds its own base address
+  for ( std::uint32_t block = 0; block < 4; ++block )
+    ram.at( block * RAM::block_size, first_hint ) = block * RAM::block_size;
+
+  REQUIRE( inspector.RAM_allocated_blocks_no() == std::uint32_t( 2 ) );
+  REQUIRE( inspector.RAM_swapped_blocks_no() == std::uint32_t( 2 ) );
+
+  SECTION( "A stale hint only leads to the right block" )
+  {
+    for ( std::uint32_t i = 0; i < 64; ++i )
+    {
+      auto const first = ( i % 4 ) * RAM::block_size;
+      auto const second = ( ( i * 3 + 1 ) % 4 ) * RAM::block_size;
+
+      REQUIRE( ram.at( first + 8, first_hint ) == 0x0417'CCCC ); // sigrie
+      REQUIRE( ram.at( first, first_hint ) == first );
+      REQUIRE( ram.at( second, second_hint ) == second );
+      REQUIRE( ram[first] == first );
+    }
+  }
+
+  SECTION( "Any value is a valid hint" )
+  {
+    std::size_t hint = 1'000;
+
+    REQUIRE( ram.at( 3 * RAM::block_size, hint ) == 3 * RAM::block_size );
+    REQUIRE( hint < inspector.RAM_allocated_blocks_no() );
+  }
+}
@@ -5,6 +5,7 @@
 #include <mips32/machine_inspector.hpp>
 
 #include <cstring>
+#include <vector>
 
 using namespace mips32;
 
@@ -95,4 +96,142 @@ TEST_CASE( "A RAM instance is used to perform IO" )
     REQUIRE( std::memcmp( raw_data.data(), block_2.data(), block_2.size() ) == 0 );
     REQUIRE( std::memcmp( raw_data.data(), block_g.data(), block_g.size() ) == 0 );
   }
+
+  SECTION( "A write can end at the end of the address space" )
+  {
+    constexpr std::uint32_t size = ram.block_size;
+    constexpr std::uint32_t addr = 0xFFFF'0000;
+
+    std::vector<unsigned char> raw_data( size );
+    for ( std::uint32_t i = 0; i < size; ++i )
+      raw_data[i] = ( unsigned char )( i * 3 );
+
+    REQUIRE( inspector.RAM_write_from( addr, raw_data.data(), size ) == size );
+
+    std::vector<unsigned char> read( size );
+    REQUIRE( inspector.RAM_read_into( addr, read.data(), size ) == size );
+    REQUIRE( read == raw_data );
+
+    // One byte more wraps around
+    raw_data.push_back( 0 );
+    REQUIRE( inspector.RAM_write_from( addr, raw_data.data(), size + 1 ) == 0 );
+  }
+
+  SECTION( "Spans of multiple Blocks are visited in place" )
+  {
+    constexpr int size = ram.block_size * 2;
+    constexpr std::uint32_t addr = 0x0000'8000;
+
+    std::vector<unsigned char> raw_data( size );
+    for ( int i = 0; i < size; ++i )
+      raw_data[i] = ( unsigned char )( i * 7 );
+
+    REQUIRE( inspector.RAM_write_from( addr, raw_data.data(), size ) == size );
+
+    std::vector<MachineInspector::RAMSpan> spans;
+    auto visited = inspector.RAM_visit( addr, size, [&] ( MachineInspector::RAMSpan span )
+    {
+      spans.push_back( span );
+      return true;
+    } );
+
+    REQUIRE( visited == size );
+    REQUIRE( spans.size() == 3 );
+    REQUIRE( spans[0].address == addr );
+    REQUIRE( spans[0].size == ram.block_size - 0x8000 );
+    REQUIRE( spans[1].address == 0x0001'0000 );
+    REQUIRE( spans[1].size == ram.block_size );
+    REQUIRE( spans[2].address == 0x0002'0000 );
+    REQUIRE( spans[2].size == 0x8000 );
+
+    // Spans point directly inside the RAM
+    REQUIRE( ( void * )spans[1].data == ( void * )&ram[0x0001'0000] );
+    REQUIRE( std::memcmp( spans[1].data, raw_data.data() + 0x8000, spans[1].size ) == 0 );
+
+    std::vector<unsigned char> read( size );
+    REQUIRE( inspector.RAM_read_into( addr, read.data(), size ) == size );
+    REQUIRE( read == raw_data );
+
+    // The visit stops when the visitor returns false
+    int calls = 0;
+    visited = inspector.RAM_visit( addr, size, [&] ( MachineInspector::RAMSpan ) { ++calls; return false; } );
+
+    REQUIRE( calls == 1 );
+    REQUIRE( visited == ram.block_size - 0x8000 );
+
+    // and at the first block that isn't resident
+    REQUIRE( inspector.RAM_visit( 0x0010'0000, 4, [] ( MachineInspector::RAMSpan ) { return true; } ) == 0 );
+    REQUIRE( inspector.RAM_read_into( 0x0002'FFFC, read.data(), 8 ) == 4 );
+  }
+
+  SECTION( "A visited Block is never swapped" )
+  {
+    RAM small_ram{ 2 * RAM::block_size };
+    MachineInspector small_inspector;
+    small_inspector.inspect( small_ram );
+
+    small_ram[0x0000'0000] = 0xABCD'0000;
+    small_ram[0x0001'0000] = 0xABCD'0001;
+
+    // the pinned block is the least accessed one
+    for ( int i = 0; i < 10; ++i )
+      small_ram[0x0001'0000] += 0;
+
+    small_inspector.RAM_visit( 0x0000'0000, 4, [&] ( MachineInspector::RAMSpan span )
+    {
+      small_ram[0x0002'0000] = 0xABCD'0002; // forces a swap
+
+      auto const swapped = small_inspector.RAM_swapped_addresses();
+      REQUIRE( swapped.size() == 1 );
+      REQUIRE( swapped[0] == 0x0001'0000 );
+
+      std::uint32_t word;
+      std::memcpy( &word, span.data, sizeof( word ) );
+      REQUIRE( word == 0xABCD'0000 );
+
+      return true;
+    } );
+
+    // It can be swapped again once the visit ended
+    for ( int i = 0; i < 10; ++i )
+      small_ram[0x0002'0000] += 0;
+
+    REQUIRE( small_ram[0x0001'0000] == 0xABCD'0001 );
+    REQUIRE( small_inspector.RAM_swapped_addresses()[0] == 0x0000'0000 );
+
+    std::uint32_t word = 0;
+    REQUIRE( small_inspector.RAM_read_into( 0x0000'0000, &word, sizeof( word ) ) == sizeof( word ) );
+    REQUIRE( word == 0xABCD'0000 );
+  }
+
+  SECTION( "Strings are read up to their terminator, across Blocks" )
+  {
+    // Every length around the vector widths, at every alignment, ending in the next block
+    for ( std::uint32_t offset = 0; offset < 48; ++offset )
+    {
+      for ( std::uint32_t length : { 0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 64u, 100u } )
+      {
+        std::uint32_t const addr = 0x0001'0000 - offset;
+
+        std::vector<char> raw_data( length + 1, 'x' );
+        raw_data.back() = '\0';
+
+        ram_io.write( addr, raw_data.data(), length + 1 );
+
+        // garbage after the terminator
+        char const garbage[] = "garbage";
+        ram_io.write( addr + length + 1, garbage, sizeof( garbage ) - 1 );
+
+        auto read = ram_io.read( addr, 0xFFFF'FFFF, true );
+
+        REQUIRE( read == raw_data );
+      }
+    }
+
+    // Without a terminator, the string stops at the first missing Block
+    std::vector<char> raw_data( ram.block_size, 'y' );
+    ram_io.write( 0x0008'0000, raw_data.data(), ram.block_size );
+
+    REQUIRE( ram_io.read( 0x0008'0000 + 10, 0xFFFF'FFFF, true ).size() == ram.block_size - 10 );
+  }
 }
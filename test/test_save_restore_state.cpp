@@ -4,7 +4,11 @@
 #include "../src/cpu.hpp"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <string>
+
+#include <pmmintrin.h>
 
 using namespace mips32;
 using namespace mips32::literals;
@@ -180,8 +184,269 @@ TEST_CASE( "A functional machine exists" )
 
   SECTION( "I save and restore the entire Machine" )
   {
-    // Just to increase the coverage
-    inspector.save_state( MachineInspector::Component::ALL, state_name );
-    inspector.restore_state( MachineInspector::Component::ALL, state_name );
+    ram[0x0000'0000] = 0x0000'0000;
+    ram[0x0004'0000] = 0x0004'0000;
+    ram[0x0500'0000] = 0x0500'0000;
+
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      ram[0x8000'0000 + i] = i;
+
+    std::fill( inspector.CPU_gpr_begin(), inspector.CPU_gpr_end(), 0x1234'5678 );
+    inspector.CPU_pc() = 0x0040'0000;
+    inspector.access_CP0().bad_vaddr = 0xABCD'0000;
+    inspector.CP1_fpr_begin()->i64 = 0x0102'0304'0506'0708;
+    inspector.CP1_write_vpr( 1, { 0x1111'2222'3333'4444, 0x5555'6666'7777'8888 } );
+
+    auto const ram_info = inspector.RAM_info();
+
+    REQUIRE( ram_info.swapped_blocks_no == 1 );
+
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::ALL, state_name ) );
+
+    ram[0x0000'0000] = 0xFFFF'FFFF;
+    ram[0x0500'0000] = 0xFFFF'FFFF;
+    std::fill( inspector.CPU_gpr_begin(), inspector.CPU_gpr_end(), 42 );
+    inspector.CPU_pc() = 0xAABB'CCDD;
+    inspector.access_CP0().bad_vaddr = 0;
+    inspector.CP1_fpr_begin()->i64 = 0;
+    inspector.CP1_write_vpr( 1, { 0, 0 } );
+    inspector.CPU_write_exit_code( 142 );
+
+    REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::ALL, state_name ) );
+
+    auto new_info = inspector.RAM_info();
+
+    REQUIRE( ram_info.alloc_limit == new_info.alloc_limit );
+    REQUIRE( std::equal( ram_info.allocated_addresses.cbegin(),
+                         ram_info.allocated_addresses.cend(),
+                         new_info.allocated_addresses.cbegin(),
+                         new_info.allocated_addresses.cend() ) );
+    REQUIRE( std::equal( ram_info.swapped_addresses.cbegin(),
+                         ram_info.swapped_addresses.cend(),
+                         new_info.swapped_addresses.cbegin(),
+                         new_info.swapped_addresses.cend() ) );
+
+    REQUIRE( std::all_of( inspector.CPU_gpr_begin(), inspector.CPU_gpr_end(), [] ( std::uint32_t r ) { return r == 0x1234'5678; } ) );
+    REQUIRE( inspector.CPU_pc() == 0x0040'0000 );
+    REQUIRE( inspector.access_CP0().bad_vaddr == 0xABCD'0000 );
+    REQUIRE( inspector.CP1_fpr_begin()->i64 == 0x0102'0304'0506'0708 );
+    REQUIRE( inspector.CP1_read_vpr( 1 ) == std::array<std::uint64_t, 2>{ 0x1111'2222'3333'4444, 0x5555'6666'7777'8888 } );
+    REQUIRE_FALSE( inspector.CPU_read_exit_code() );
+
+    REQUIRE( ram[0x0000'0000] == 0x0000'0000 );
+    REQUIRE( ram[0x0004'0000] == 0x0004'0000 );
+    REQUIRE( ram[0x0500'0000] == 0x0500'0000 );
+
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      REQUIRE( ram[0x8000'0000 + i] == i );
+
+    // The restored blocks are private, writing them must not modify the saved state
+    ram[0x0000'0000] = 0xFFFF'FFFF;
+
+    REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::ALL, state_name ) );
+    REQUIRE( ram[0x0000'0000] == 0x0000'0000 );
   }
+
+  SECTION( "A state with a corrupted allocation limit is rejected" )
+  {
+    ram[0x0000'0000] = 0x0000'0000;
+    inspector.CPU_pc() = 0x0040'0000;
+
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::ALL, state_name ) );
+
+    std::string const file_name = std::string( state_name ) + ".state";
+
+    // StateHeader, section_no, reserved, then the sections: { id, reserved, offset, size }
+    constexpr long ram_section_offset{ 8 + 4 + 4 + 3 * 24 + 4 + 4 };
+
+    std::uint32_t alloc_limit = 0;
+
+    SECTION( "Zero" )
+    {
+      alloc_limit = 0;
+    }
+
+    SECTION( "Larger than the address space" )
+    {
+      alloc_limit = 0xFFFF'FFFF;
+    }
+
+    std::FILE *file = std::fopen( file_name.c_str(), "r+b" );
+    REQUIRE( file );
+
+    std::uint64_t ram_offset = 0;
+    REQUIRE( std::fseek( file, ram_section_offset, SEEK_SET ) == 0 );
+    REQUIRE( std::fread( &ram_offset, sizeof( ram_offset ), 1, file ) == 1 );
+    REQUIRE( std::fseek( file, long( ram_offset ), SEEK_SET ) == 0 );
+    REQUIRE( std::fwrite( &alloc_limit, sizeof( alloc_limit ), 1, file ) == 1 );
+    REQUIRE( std::fclose( file ) == 0 );
+
+    inspector.CPU_pc() = 0xAABB'CCDD;
+
+    REQUIRE( inspector.restore_state( MachineInspector::Component::ALL, state_name ) );
+    REQUIRE( inspector.CPU_pc() == 0xAABB'CCDD );
+    REQUIRE( inspector.RAM_info().alloc_limit == 192_KB );
+  }
+
+  SECTION( "A compressed stream with a corrupted allocation limit is rejected" )
+  {
+    ram[0x0000'0000] = 0x0000'0000;
+    inspector.CPU_pc() = 0x0040'0000;
+
+    // The registers of a compressed stream are the CP0, CP1 and CPU sections of a whole state, without padding
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::ALL, state_name ) );
+
+    std::string const file_name = std::string( state_name ) + ".state";
+
+    std::FILE *file = std::fopen( file_name.c_str(), "rb" );
+    REQUIRE( file );
+
+    long ram_header_offset = 8;
+
+    for ( long section = 0; section < 3; ++section )
+    {
+      std::uint64_t size = 0;
+      REQUIRE( std::fseek( file, 8 + 4 + 4 + section * 24 + 4 + 4 + 8, SEEK_SET ) == 0 );
+      REQUIRE( std::fread( &size, sizeof( size ), 1, file ) == 1 );
+      ram_header_offset += long( size );
+    }
+
+    std::fclose( file );
+
+    std::FILE *stream = std::tmpfile();
+    REQUIRE( stream );
+
+    REQUIRE_FALSE( inspector.save_compressed_state( stream, 1 ) );
+
+    // alloc_limit, blocks_no
+    std::uint32_t ram_header[2]{};
+
+    SECTION( "Zero, without blocks" )
+    {
+      ram_header[0] = 0;
+      ram_header[1] = 0;
+    }
+
+    SECTION( "Larger than the address space" )
+    {
+      ram_header[0] = 0xFFFF'FFFF;
+      ram_header[1] = 1;
+    }
+
+    REQUIRE( std::fseek( stream, ram_header_offset, SEEK_SET ) == 0 );
+    REQUIRE( std::fwrite( ram_header, sizeof( ram_header ), 1, stream ) == 1 );
+
+    inspector.CPU_pc() = 0xAABB'CCDD;
+
+    std::rewind( stream );
+    REQUIRE( inspector.restore_compressed_state( stream ) );
+    std::fclose( stream );
+
+    REQUIRE( inspector.RAM_info().alloc_limit == 192_KB );
+  }
+
+  SECTION( "I save and restore the entire Machine through a compressed stream" )
+  {
+    // A uniform block, a block with runs and a swapped block full of distinct words
+    ram[0x0000'0000] = 0x0417'CCCC;
+    ram[0x0004'0000] = 0x0004'0000;
+    ram[0x0004'0100] = 0x0004'0100;
+    ram[0x0500'0000] = 0x0500'0000;
+
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      ram[0x8000'0000 + i] = i;
+
+    inspector.CPU_pc() = 0x0040'0000;
+
+    auto const ram_info = inspector.RAM_info();
+
+    REQUIRE( ram_info.swapped_blocks_no == 1 );
+
+    std::FILE *stream = std::tmpfile();
+    REQUIRE( stream );
+
+    REQUIRE_FALSE( inspector.save_compressed_state( stream, 2 ) );
+
+    auto const stream_size = std::ftell( stream );
+    REQUIRE( stream_size > 0 );
+    REQUIRE( stream_size < long( ram_info.allocated_blocks_no + ram_info.swapped_blocks_no ) * RAM::block_size / 2 );
+
+    ram[0x0004'0000] = 0xFFFF'FFFF;
+    ram[0x0500'0000] = 0xFFFF'FFFF;
+    inspector.CPU_pc() = 0xAABB'CCDD;
+
+    std::rewind( stream );
+    REQUIRE_FALSE( inspector.restore_compressed_state( stream ) );
+    std::fclose( stream );
+
+    auto new_info = inspector.RAM_info();
+
+    REQUIRE( std::equal( ram_info.allocated_addresses.cbegin(),
+                         ram_info.allocated_addresses.cend(),
+                         new_info.allocated_addresses.cbegin(),
+                         new_info.allocated_addresses.cend() ) );
+    REQUIRE( std::equal( ram_info.swapped_addresses.cbegin(),
+                         ram_info.swapped_addresses.cend(),
+                         new_info.swapped_addresses.cbegin(),
+                         new_info.swapped_addresses.cend() ) );
+
+    REQUIRE( inspector.CPU_pc() == 0x0040'0000 );
+
+    REQUIRE( ram[0x0000'0000] == 0x0417'CCCC );
+    REQUIRE( ram[0x0004'0000] == 0x0004'0000 );
+    REQUIRE( ram[0x0004'0004] == 0x0417'CCCC );
+    REQUIRE( ram[0x0004'0100] == 0x0004'0100 );
+    REQUIRE( ram[0x0500'0000] == 0x0500'0000 );
+
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      REQUIRE( ram[0x8000'0000 + i] == i );
+  }
+}
+
+TEST_CASE( "A corrupted MXCSR in a state doesn't reach the host" )
+{
+  RAM ram{ 64_KB };
+  CPU cpu{ ram };
+  cpu.hard_reset();
+
+  // The CPU is stopped while saving, the state is the one of `cp1` that we can enter
+  CP1 cp1;
+  cp1.reset();
+
+  MachineInspector inspector;
+  inspector.inspect( ram ).inspect( cpu ).inspect( cp1 );
+
+  REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::CP1, state_name ) );
+
+  std::string const file_name = std::string( state_name ) + ".cp1";
+
+  // StateHeader, the FPRs, FIR, FCSR, then MXCSR
+  constexpr long mxcsr_offset{ 8 + 32 * 8 + 4 + 4 };
+
+  std::uint32_t mxcsr = 0;
+
+  SECTION( "Reserved bits" )
+  {
+    mxcsr = 0xFFFF'1F80;
+  }
+
+  SECTION( "Unmasked exceptions" )
+  {
+    mxcsr = _MM_EXCEPT_INVALID;
+  }
+
+  std::FILE *file = std::fopen( file_name.c_str(), "r+b" );
+  REQUIRE( file );
+  REQUIRE( std::fseek( file, mxcsr_offset, SEEK_SET ) == 0 );
+  REQUIRE( std::fwrite( &mxcsr, sizeof( mxcsr ), 1, file ) == 1 );
+  REQUIRE( std::fclose( file ) == 0 );
+
+  REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::CP1, state_name ) );
+
+  cp1.enter();
+  auto const csr = _mm_getcsr();
+  cp1.leave();
+
+  // Only the exception flags come from the state, the rest from FCSR
+  REQUIRE( ( csr & ~( _MM_ROUND_MASK | _MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK ) ) == ( _MM_MASK_MASK | mxcsr & _MM_EXCEPT_MASK ) );
 }
@@ -0,0 +1,346 @@
+#include <catch.hpp>
+
+#include "../src/soft_float.hpp"
+
+#include <cfenv>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <xmmintrin.h>
+#include <pmmintrin.h>
+
+#ifdef _MSC_VER
+#pragma fenv_access( on )
+#else
+#pragma STDC FENV_ACCESS ON
+#endif
+
+using namespace mips32;
+using namespace mips32::soft_float;
+
+namespace
+{
+constexpr int host_rounding[] = { FE_TONEAREST, FE_TOWARDZERO, FE_UPWARD, FE_DOWNWARD };
+
+std::uint32_t host_flags() noexcept
+{
+  auto const raised = std::fetestexcept( FE_ALL_EXCEPT );
+
+  std::uint32_t flags{ 0 };
+
+  if ( raised & FE_INVALID ) flags |= INVALID;
+  if ( raised & FE_DIVBYZERO ) flags |= DIVBYZERO;
+  if ( raised & FE_OVERFLOW ) flags |= OVERFLOW_;
+  if ( raised & FE_UNDERFLOW ) flags |= UNDERFLOW_;
+  if ( raised & FE_INEXACT ) flags |= INEXACT;
+
+  return flags;
+}
+
+// The host must round like IEEE 754 says, without flushing the subnormals
+struct HostEnvironment
+{
+  HostEnvironment() noexcept
+  {
+    std::fegetenv( &env );
+    _MM_SET_FLUSH_ZERO_MODE( _MM_FLUSH_ZERO_OFF );
+    _MM_SET_DENORMALS_ZERO_MODE( _MM_DENORMALS_ZERO_OFF );
+  }
+
+  ~HostEnvironment() noexcept { std::fesetenv( &env ); }
+
+  std::fenv_t env;
+};
+
+template<typename F>
+typename F::value value_of( typename F::bits a ) noexcept
+{
+  typename F::value v;
+  std::memcpy( &v, &a, sizeof( v ) );
+  return v;
+}
+
+template<typename F>
+typename F::bits bits_of( typename F::value v ) noexcept
+{
+  typename F::bits a;
+  std::memcpy( &a, &v, sizeof( a ) );
+  return a;
+}
+
+/**
+ * Random operands: raw patterns, numbers near each other (cancellations),
+ * near the overflow and underflow thresholds, subnormals and specials.
+ **/
+template<typename F>
+struct Operands
+{
+  using Bits = typename F::bits;
+
+  std::mt19937_64 rng{ 0x5EED };
+
+  Bits any() noexcept { return Bits( rng() ); }
+
+  Bits with_exp( int exp ) noexcept
+  {
+    return ( rng() & 1 ? F::sign_mask : 0 ) | Bits( exp ) << F::frac_bits | ( Bits( rng() ) & F::frac_mask );
+  }
+
+  Bits next() noexcept
+  {
+    switch ( rng() % 8 )
+    {
+    case 0: return any();
+    case 1: return with_exp( int( rng() % 4 ) );                 // subnormal or tiny
+    case 2: return with_exp( F::max_exp - 1 - int( rng() % 4 ) ); // huge
+    case 3: return Bits( rng() % 4 == 0 ? F::default_nan : ( F::max_exp + 0ull ) << F::frac_bits ) | ( rng() & 1 ? F::sign_mask : 0 );
+    default: return with_exp( F::bias - 40 + int( rng() % 80 ) );
+    }
+  }
+
+  // Close to `a`, for the cancellations
+  Bits near( Bits a ) noexcept
+  {
+    return ( a ^ ( rng() & 1 ? F::sign_mask : 0 ) ) + Bits( rng() % 16 ) - 8;
+  }
+};
+
+template<typename F>
+bool same( typename F::bits a, typename F::bits b ) noexcept
+{
+  // The host's NaN propagation isn't MIPS's, only check it's a NaN
+  if ( detail::is_nan<F>( a ) && detail::is_nan<F>( b ) ) return true;
+  return a == b;
+}
+
+// Returns a description of the first mismatch, only the `checked` flags are compared
+template<typename F, typename Soft, typename Host>
+std::string compare( int operands, Soft soft, Host host, std::uint32_t checked = ~0u ) noexcept
+{
+  using Bits = typename F::bits;
+
+  HostEnvironment environment;
+  Operands<F> gen;
+
+  for ( int round = NEAREST; round <= DOWN; ++round )
+  {
+    for ( int i = 0; i < 20'000; ++i )
+    {
+      Bits const a = gen.next();
+      Bits const b = i & 1 ? gen.near( a ) : gen.next();
+      Bits const c = i & 2 ? gen.near( a ) : gen.next();
+
+      Env env{ std::uint32_t( round ), false, 0 };
+      auto const expected_bits = soft( env, a, b, c );
+
+      std::fesetround( host_rounding[round] );
+      std::feclearexcept( FE_ALL_EXCEPT );
+
+      volatile auto const x = value_of<F>( a ), y = value_of<F>( b ), z = value_of<F>( c );
+      volatile auto const res = host( x, y, z );
+      auto const flags = host_flags();
+      auto const host_bits = bits_of<F>( res );
+
+      std::fesetround( FE_TONEAREST );
+
+      if ( !same<F>( expected_bits, host_bits ) || ( ( env.flags ^ flags ) & checked ) )
+      {
+        std::ostringstream message;
+        message << std::hex << "round " << round << " operands " << a;
+        if ( operands > 1 ) message << ' ' << b;
+        if ( operands > 2 ) message << ' ' << c;
+        message << " soft " << expected_bits << '/' << env.flags << " host " << host_bits << '/' << flags;
+        return message.str();
+      }
+    }
+  }
+
+  return {};
+}
+
+template<typename F>
+void compare_arithmetic()
+{
+  using Bits = typename F::bits;
+  using T = typename F::value;
+
+  SECTION( "Addition" )
+  {
+    REQUIRE( compare<F>( 2, []( Env &env, Bits a, Bits b, Bits ) { return add<F>( env, a, b ); },
+                         []( T x, T y, T ) { return x + y; } ) == "" );
+  }
+
+  SECTION( "Subtraction" )
+  {
+    REQUIRE( compare<F>( 2, []( Env &env, Bits a, Bits b, Bits ) { return sub<F>( env, a, b ); },
+                         []( T x, T y, T ) { return x - y; } ) == "" );
+  }
+
+  SECTION( "Multiplication" )
+  {
+    REQUIRE( compare<F>( 2, []( Env &env, Bits a, Bits b, Bits ) { return mul<F>( env, a, b ); },
+                         []( T x, T y, T ) { return x * y; } ) == "" );
+  }
+
+  SECTION( "Division" )
+  {
+    REQUIRE( compare<F>( 2, []( Env &env, Bits a, Bits b, Bits ) { return div<F>( env, a, b ); },
+                         []( T x, T y, T ) { return x / y; } ) == "" );
+  }
+
+  SECTION( "Square root" )
+  {
+    REQUIRE( compare<F>( 1, []( Env &env, Bits a, Bits, Bits ) { return soft_float::sqrt<F>( env, a ); },
+                         []( T x, T, T ) { return std::sqrt( x ); } ) == "" );
+  }
+
+  SECTION( "Fused multiply add" )
+  {
+    REQUIRE( compare<F>( 3, []( Env &env, Bits a, Bits b, Bits c ) { return soft_float::fma<F>( env, a, b, c ); },
+                         []( T x, T y, T z ) { return std::fma( x, y, z ); } ) == "" );
+  }
+
+  // std::rint rounds some tiny negative numbers to -1 upwards, nearbyint doesn't raise inexact
+  SECTION( "Round to integral" )
+  {
+    REQUIRE( compare<F>( 1, []( Env &env, Bits a, Bits, Bits ) { return round_to_integral<F>( env, a ); },
+                         []( T x, T, T ) { return std::nearbyint( x ); }, ~std::uint32_t( INEXACT ) ) == "" );
+  }
+}
+} // namespace
+
+TEST_CASE( "The soft float backend matches an IEEE 754 host in every rounding mode" )
+{
+  SECTION( "binary32" )
+  {
+    compare_arithmetic<Binary32>();
+
+    SECTION( "Conversion to binary64" )
+    {
+      REQUIRE( compare<Binary64>( 1, []( Env &env, std::uint64_t a, std::uint64_t, std::uint64_t ) { return convert<Binary32, Binary64>( env, std::uint32_t( a ) ); },
+                                  []( double x, double, double ) { return double( value_of<Binary32>( bits_of<Binary64>( x ) & 0xFFFF'FFFF ) ); } ) == "" );
+    }
+
+    SECTION( "Conversion from a 64-bit integer" )
+    {
+      REQUIRE( compare<Binary64>( 1, []( Env &env, std::uint64_t a, std::uint64_t, std::uint64_t ) { return std::uint64_t( from_int<Binary32>( env, std::int64_t( a ) ) ); },
+                                  []( double x, double, double ) { return value_of<Binary64>( bits_of<Binary32>( float( std::int64_t( bits_of<Binary64>( x ) ) ) ) ); } ) == "" );
+    }
+  }
+
+  SECTION( "binary64" )
+  {
+    compare_arithmetic<Binary64>();
+
+    SECTION( "Conversion to binary32" )
+    {
+      REQUIRE( compare<Binary64>( 1, []( Env &env, std::uint64_t a, std::uint64_t, std::uint64_t ) { return std::uint64_t( convert<Binary64, Binary32>( env, a ) ); },
+                                  []( double x, double, double ) { return value_of<Binary64>( bits_of<Binary32>( float( x ) ) ); } ) == "" );
+    }
+
+    SECTION( "Conversion from a 64-bit integer" )
+    {
+      REQUIRE( compare<Binary64>( 1, []( Env &env, std::uint64_t a, std::uint64_t, std::uint64_t ) { return from_int<Binary64>( env, std::int64_t( a ) ); },
+                                  []( double x, double, double ) { return double( std::int64_t( bits_of<Binary64>( x ) ) ); } ) == "" );
+    }
+
+    // In range only, out of range the host returns the "integer indefinite" value
+    SECTION( "Conversion to a 64-bit integer" )
+    {
+      REQUIRE( compare<Binary64>( 1, []( Env &env, std::uint64_t a, std::uint64_t, std::uint64_t )
+                                  {
+                                    auto const in_range = ( ( a >> 52 ) & 0x7FF ) < 0x3FF + 62;
+                                    return in_range ? to_int<Binary64, 64>( env, a, env.round ) : 0;
+                                  },
+                                  []( double x, double, double )
+                                  {
+                                    auto const in_range = ( ( bits_of<Binary64>( x ) >> 52 ) & 0x7FF ) < 0x3FF + 62;
+                                    return value_of<Binary64>( in_range ? std::uint64_t( std::llrint( x ) ) : 0 );
+                                  } ) == "" );
+    }
+  }
+}
+
+TEST_CASE( "The soft float backend follows the MIPS NaN2008 semantics" )
+{
+  Env env{ NEAREST, false, 0 };
+
+  SECTION( "An invalid operation returns the positive default NaN" )
+  {
+    REQUIRE( div<Binary32>( env, 0, 0 ) == 0x7FC0'0000 );
+    REQUIRE( sub<Binary64>( env, 0x7FF0'0000'0000'0000, 0x7FF0'0000'0000'0000 ) == 0x7FF8'0000'0000'0000 );
+    REQUIRE( soft_float::sqrt<Binary32>( env, 0xBF80'0000 ) == 0x7FC0'0000 ); // sqrt(-1)
+    REQUIRE( env.flags == INVALID );
+  }
+
+  SECTION( "A signaling NaN is quieted, keeping its payload, and wins over a quiet NaN" )
+  {
+    std::uint32_t const quiet{ 0x7FC0'0001 }, signaling{ 0xFF80'0002 };
+
+    REQUIRE( add<Binary32>( env, quiet, signaling ) == 0xFFC0'0002 );
+    REQUIRE( env.flags == INVALID );
+
+    env.flags = 0;
+    REQUIRE( mul<Binary32>( env, quiet, 0x3F80'0000 ) == quiet );
+    REQUIRE( env.flags == 0 );
+
+    // NaN payloads keep their most significant bits
+    REQUIRE( convert<Binary32, Binary64>( env, quiet ) == 0x7FF8'0000'2000'0000 );
+  }
+
+  SECTION( "Minimum and maximum prefer a number to a quiet NaN, but not to a signaling one" )
+  {
+    std::uint32_t const quiet{ 0x7FC0'0001 }, signaling{ 0xFF80'0002 }, minus_one{ 0xBF80'0000 };
+
+    REQUIRE( soft_float::min<Binary32>( env, quiet, minus_one ) == minus_one );
+    REQUIRE( soft_float::maxa<Binary32>( env, minus_one, quiet ) == 0x3F80'0000 );
+    REQUIRE( env.flags == 0 );
+
+    // -0 is smaller than +0
+    REQUIRE( soft_float::min<Binary64>( env, 0, 0x8000'0000'0000'0000 ) == 0x8000'0000'0000'0000 );
+    REQUIRE( soft_float::max<Binary64>( env, 0x8000'0000'0000'0000, 0 ) == 0 );
+
+    REQUIRE( soft_float::max<Binary32>( env, minus_one, signaling ) == 0xFFC0'0002 );
+    REQUIRE( env.flags == INVALID );
+
+    env.flags = 0;
+    REQUIRE( soft_float::mina<Binary32>( env, signaling, minus_one ) == 0xFFC0'0002 );
+    REQUIRE( env.flags == INVALID );
+  }
+
+  SECTION( "Out of range conversions to integer saturate, NaN converts to 0" )
+  {
+    REQUIRE( to_int<Binary32, 32>( env, 0x7FC0'0000, NEAREST ) == 0 );
+    REQUIRE( to_int<Binary32, 32>( env, 0x4F00'0000, NEAREST ) == 0x7FFF'FFFF ); //  2^31
+    REQUIRE( to_int<Binary32, 32>( env, 0xCF00'0000, NEAREST ) == 0x8000'0000 ); // -2^31, in range
+    REQUIRE( to_int<Binary64, 64>( env, 0xFFF0'0000'0000'0000, NEAREST ) == 0x8000'0000'0000'0000 );
+    REQUIRE( env.flags == INVALID );
+  }
+
+  SECTION( "Conversions to integer round with the given mode" )
+  {
+    std::uint64_t const two_and_half{ 0x4004'0000'0000'0000 }, minus_two_and_half{ 0xC004'0000'0000'0000 };
+
+    REQUIRE( to_int<Binary64, 32>( env, two_and_half, NEAREST ) == 2 );
+    REQUIRE( to_int<Binary64, 32>( env, two_and_half, UP ) == 3 );
+    REQUIRE( to_int<Binary64, 32>( env, minus_two_and_half, ZERO ) == std::uint32_t( -2 ) );
+    REQUIRE( to_int<Binary64, 32>( env, minus_two_and_half, DOWN ) == std::uint32_t( -3 ) );
+    REQUIRE( env.flags == INEXACT );
+  }
+
+  SECTION( "Subnormals are flushed to zero with FCSR.FS" )
+  {
+    env.flush = true;
+
+    // Operand: the smallest subnormal
+    REQUIRE( add<Binary32>( env, 0x0000'0001, 0x0000'0001 ) == 0 );
+    REQUIRE( env.flags == 0 );
+
+    // Result: the smallest normal / 2
+    REQUIRE( mul<Binary32>( env, 0x0080'0000, 0xBF00'0000 ) == 0x8000'0000 );
+    REQUIRE( env.flags == ( UNDERFLOW_ | INEXACT ) );
+  }
+}